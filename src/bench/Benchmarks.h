@@ -0,0 +1,103 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+
+/*
+ * Each benchmark takes the list of its arguments and the stream to report
+ * the timings to. A benchmark checks the results it computes and throws
+ * nc::Exception if they are wrong.
+ */
+
+/**
+ * Builds a synthetic chain of basic blocks with diamonds in it, computes
+ * its control flow graph and dominator tree, and checks the latter.
+ * Then builds a program consisting of a long loop, makes a function of
+ * it, builds the function's structural graph, runs structural analysis
+ * on it, and checks that the loop is recognized.
+ *
+ * Arguments: [number of basic blocks, 10 millions by default] [number of
+ * basic blocks in the loop, 1 million by default].
+ */
+void benchmarkCfg(const QStringList &args, QTextStream &out);
+
+/**
+ * Builds a synthetic set of instructions and the model of the instructions
+ * view for it, scrolls the model with the mouse wheel and by jumps to
+ * random positions, asking for the data of every visible row, highlights
+ * instructions scattered over the set, and checks the texts and the
+ * highlighting of the rows.
+ *
+ * Arguments: [number of instructions, 20 millions by default] [number of
+ * scroll steps, 100000 by default].
+ */
+void benchmarkInstructions(const QStringList &args, QTextStream &out);
+
+/**
+ * Builds a synthetic LikeC tree, simplifies and destroys it, first
+ * allocating the nodes on the heap, then in the tree's arena, and checks
+ * that both trees are the same.
+ *
+ * Arguments: [number of functions, 100000 by default] [number of statements
+ * in a function, 50 by default].
+ */
+void benchmarkLikec(const QStringList &args, QTextStream &out);
+
+/**
+ * Builds a synthetic LikeC tree and prints it a number of times into
+ * a QTextStream, a TextBuffer, and a TextBuffer recording the ranges of
+ * printed nodes, reporting the throughput of each. Checks that all the
+ * printed texts are the same.
+ *
+ * Arguments: [number of functions, 10000 by default] [number of statements
+ * in a function, 50 by default] [number of repetitions, 5 by default].
+ */
+void benchmarkPrint(const QStringList &args, QTextStream &out);
+
+/**
+ * Builds the range tree of a synthetic text with many uses of identifiers
+ * and renames the uses the way the C++ view does: computes the range of
+ * a use, removes the old name and inserts the new one. Checks the ranges
+ * of all the uses after the renames.
+ *
+ * Arguments: [number of renames, 50000 by default] [number of functions,
+ * enough to have that many uses by default].
+ */
+void benchmarkRename(const QStringList &args, QTextStream &out);
+
+/**
+ * Builds a synthetic function consisting of a chain of diamonds, each
+ * writing a register in both branches and reading it in the join, builds
+ * its SSA form, and checks the phi functions and def-use chains.
+ *
+ * Arguments: [number of diamonds, 1 by default].
+ */
+void benchmarkSsa(const QStringList &args, QTextStream &out);
+
+/**
+ * \param args      Arguments of a benchmark.
+ * \param index     Index of the argument.
+ * \param byDefault Value to return if there is no such argument.
+ *
+ * \return Value of the argument being a nonnegative integer.
+ */
+std::size_t getSizeArgument(const QStringList &args, int index, std::size_t byDefault);
+
+/**
+ * Prints the time elapsed since the timer was started and restarts the timer.
+ *
+ * \param out   Output stream.
+ * \param phase Name of the measured phase.
+ * \param timer Started timer.
+ */
+void reportTime(QTextStream &out, const QString &phase, QElapsedTimer &timer);
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,165 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Benchmarks.h"
+
+#include <vector>
+
+#include <nc/common/CancellationToken.h>
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/CFG.h>
+#include <nc/core/ir/Dominators.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/FunctionsGenerator.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/Program.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/ir/cflow/Graph.h>
+#include <nc/core/ir/cflow/GraphBuilder.h>
+#include <nc/core/ir/cflow/Region.h>
+#include <nc/core/ir/cflow/StructureAnalyzer.h>
+#include <nc/core/ir/dflow/Dataflow.h>
+
+void benchmarkCfg(const QStringList &args, QTextStream &out) {
+    using namespace nc::core::ir;
+
+    auto size = getSizeArgument(args, 0, 10000000);
+    if (size == 0) {
+        throw nc::Exception("the number of basic blocks must be positive");
+    }
+    auto loopSize = getSizeArgument(args, 1, 1000000);
+    if (loopSize == 0) {
+        throw nc::Exception("the number of basic blocks in the loop must be positive");
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /*
+     * Every fourth basic block starts a diamond: it jumps conditionally
+     * to the next basic block and to the one after it, so the latter has
+     * two predecessors. All the other basic blocks jump to the next one.
+     */
+    Function function;
+    std::vector<BasicBlock *> basicBlocks;
+    basicBlocks.reserve(size);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        auto basicBlock = std::make_unique<BasicBlock>();
+        basicBlocks.push_back(basicBlock.get());
+        function.addBasicBlock(std::move(basicBlock));
+    }
+    function.setEntry(basicBlocks.front());
+
+    for (std::size_t i = 0; i + 1 < size; ++i) {
+        if (i % 4 == 0 && i + 2 < size) {
+            basicBlocks[i]->pushBack(std::make_unique<Jump>(
+                std::make_unique<Constant>(nc::SizedValue(1, 1)),
+                JumpTarget(basicBlocks[i + 1]),
+                JumpTarget(basicBlocks[i + 2])));
+        } else {
+            basicBlocks[i]->pushBack(std::make_unique<Jump>(JumpTarget(basicBlocks[i + 1])));
+        }
+    }
+
+    reportTime(out, "build basic blocks", timer);
+
+    const CFG &cfg = function.cfg();
+
+    reportTime(out, "build CFG", timer);
+
+    if (cfg.size() != size || cfg.postOrder().size() != size || cfg.reversePostOrder().front() != 0) {
+        throw nc::Exception("wrong orders of basic blocks");
+    }
+
+    nc::CancellationToken canceled;
+    Dominators dominators(cfg, canceled);
+
+    reportTime(out, "compute dominators", timer);
+
+    if (dominators.getImmediateDominator(CFG::Index(0)) != cfg.size()) {
+        throw nc::Exception("entry has an immediate dominator");
+    }
+    for (CFG::Index index = 1; index < size; ++index) {
+        auto expected = index % 4 == 2 ? index - 2 : index - 1;
+        if (dominators.getImmediateDominator(index) != expected) {
+            throw nc::Exception(QString("wrong immediate dominator of basic block %1").arg(index));
+        }
+    }
+    if (!dominators.isDominating(CFG::Index(0), size - 1) ||
+        (size > 2 && dominators.isDominating(CFG::Index(1), CFG::Index(2))))
+    {
+        throw nc::Exception("wrong dominance relation");
+    }
+
+    reportTime(out, "check dominators", timer);
+
+    /*
+     * A program consisting of a do-while loop, whose body is a chain of
+     * basic blocks, followed by an exit basic block. Splitting it into
+     * functions, exploring the loop and structuring it traverse the whole
+     * chain at once.
+     */
+    Program program;
+    std::vector<BasicBlock *> loopBlocks;
+    loopBlocks.reserve(loopSize);
+
+    for (std::size_t i = 0; i < loopSize; ++i) {
+        loopBlocks.push_back(program.createBasicBlock(i));
+    }
+    auto exit = program.createBasicBlock(loopSize);
+
+    for (std::size_t i = 0; i + 1 < loopSize; ++i) {
+        loopBlocks[i]->pushBack(std::make_unique<Jump>(JumpTarget(loopBlocks[i + 1])));
+    }
+    loopBlocks.back()->pushBack(std::make_unique<Jump>(
+        std::make_unique<Constant>(nc::SizedValue(1, 1)),
+        JumpTarget(loopBlocks.front()),
+        JumpTarget(exit)));
+
+    program.addCalledAddress(0);
+
+    reportTime(out, "build program", timer);
+
+    Functions functions;
+    FunctionsGenerator().makeFunctions(program, functions);
+
+    reportTime(out, "make functions", timer);
+
+    if (functions.list().size() != 1 || functions.list().front()->basicBlocks().size() != loopSize + 1) {
+        throw nc::Exception("the program was not made into one function");
+    }
+
+    const Function *loopFunction = functions.list().front();
+
+    cflow::Graph graph;
+    cflow::GraphBuilder()(graph, loopFunction);
+
+    reportTime(out, "build structural graph", timer);
+
+    dflow::Dataflow dataflow;
+    cflow::StructureAnalyzer(graph, dataflow).analyze();
+
+    reportTime(out, "structural analysis", timer);
+
+    const cflow::Region *loop = nullptr;
+    foreach (auto node, graph.root()->nodes()) {
+        if (auto region = node->as<cflow::Region>()) {
+            loop = region;
+        }
+    }
+    if (graph.root()->nodes().size() != 2 || !loop ||
+        loop->regionKind() != cflow::Region::DO_WHILE || loop->nodes().size() != loopSize)
+    {
+        throw nc::Exception("the loop was not recognized");
+    }
+
+    reportTime(out, "check structure", timer);
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,136 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+
+#include <nc/core/arch/Instruction.h>
+#include <nc/core/arch/Instructions.h>
+
+#include <nc/gui/InstructionsModel.h>
+
+namespace {
+
+using nc::core::arch::Instruction;
+
+/** Number of rows visible in the view at once. */
+const int pageSize = 50;
+
+/** Number of rows scrolled by one step of the mouse wheel. */
+const int wheelStep = 3;
+
+/**
+ * Instruction with a short text derived from its address.
+ */
+class SyntheticInstruction: public Instruction {
+public:
+    explicit SyntheticInstruction(nc::ByteAddr addr):
+        Instruction(addr, 4)
+    {}
+
+    void print(QTextStream &out) const override {
+        out << "mov r" << (addr() / 4 % 16) << ", " << addr();
+    }
+};
+
+/**
+ * Asks the model for everything the view needs to paint the rows
+ * [top, top + pageSize), the way QListView does on a repaint.
+ *
+ * \return Number of highlighted rows on the page.
+ */
+int showPage(const nc::gui::InstructionsModel &model, int top) {
+    int highlighted = 0;
+    for (int row = top, end = std::min(top + pageSize, model.rowCount()); row < end; ++row) {
+        auto index = model.index(row, 0);
+        auto instruction = model.getInstruction(index);
+
+        auto text = model.data(index, Qt::DisplayRole).toString();
+        if (!text.startsWith(QString("%1:").arg(instruction->addr(), 0, 16))) {
+            throw nc::Exception(QString("row %1 shows a wrong text: %2").arg(row).arg(text));
+        }
+        if (model.data(index, Qt::BackgroundRole).isValid()) {
+            ++highlighted;
+        }
+    }
+    return highlighted;
+}
+
+} // anonymous namespace
+
+void benchmarkInstructions(const QStringList &args, QTextStream &out) {
+    auto size = getSizeArgument(args, 0, 20000000);
+    auto stepCount = getSizeArgument(args, 1, 100000);
+
+    if (size < pageSize || size > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw nc::Exception(QString("the number of instructions must be between %1 and %2")
+            .arg(pageSize).arg(std::numeric_limits<int>::max()));
+    }
+    auto rowCount = static_cast<int>(size);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto instructions = std::make_shared<nc::core::arch::Instructions>();
+    for (std::size_t i = 0; i < size; ++i) {
+        instructions->add(std::make_shared<SyntheticInstruction>(i * 4));
+    }
+
+    reportTime(out, QString("build %1 instructions").arg(size), timer);
+
+    nc::gui::InstructionsModel model(nullptr, instructions);
+
+    reportTime(out, "create model", timer);
+
+    if (model.rowCount() != rowCount) {
+        throw nc::Exception("wrong number of rows");
+    }
+
+    /* Scroll with the mouse wheel from the top. */
+    int top = 0;
+    for (std::size_t i = 0; i < stepCount; ++i) {
+        showPage(model, top);
+        top = std::min(top + wheelStep, rowCount - pageSize);
+    }
+
+    reportTime(out, QString("scroll %1 wheel steps").arg(stepCount), timer);
+
+    /*
+     * Drag the scroll bar: every step jumps to a pseudorandom position
+     * in the whole list, so neither the chunk nor the text caches help.
+     */
+    unsigned seed = 1;
+    for (std::size_t i = 0; i < stepCount; ++i) {
+        seed = seed * 1103515245 + 12345;
+        showPage(model, static_cast<int>(seed % static_cast<unsigned>(rowCount - pageSize + 1)));
+    }
+
+    reportTime(out, QString("jump %1 times").arg(stepCount), timer);
+
+    /* Highlight a page worth of instructions scattered over the list, as a selection in the C++ view does. */
+    std::vector<const Instruction *> highlighted;
+    for (int row = 0; row < rowCount; row += rowCount / pageSize) {
+        highlighted.push_back(model.getInstruction(model.index(row, 0)));
+    }
+    model.setHighlightedInstructions(highlighted);
+
+    reportTime(out, QString("highlight %1 instructions").arg(highlighted.size()), timer);
+
+    foreach (auto instruction, highlighted) {
+        auto index = model.getIndex(instruction);
+        if (model.getInstruction(index) != instruction || showPage(model, std::min(index.row(), rowCount - pageSize)) == 0) {
+            throw nc::Exception(QString("instruction at %1 is not highlighted").arg(instruction->addr(), 0, 16));
+        }
+    }
+
+    reportTime(out, "check highlighting", timer);
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,231 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <nc/common/Arena.h>
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
+#include <nc/common/TextBuffer.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/likec/BinaryOperator.h>
+#include <nc/core/likec/Block.h>
+#include <nc/core/likec/CompilationUnit.h>
+#include <nc/core/likec/ExpressionStatement.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/If.h>
+#include <nc/core/likec/IntegerConstant.h>
+#include <nc/core/likec/Return.h>
+#include <nc/core/likec/Simplifier.h>
+#include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
+#include <nc/core/likec/Typecast.h>
+#include <nc/core/likec/VariableDeclaration.h>
+#include <nc/core/likec/VariableIdentifier.h>
+
+namespace {
+
+using namespace nc::core::likec;
+
+/**
+ * Builds a function definition with a local variable that a given number
+ * of statements update, half of them under conditions, and that the
+ * function returns. The statements contain redundant casts for the
+ * simplifier to remove.
+ */
+std::unique_ptr<FunctionDefinition> makeDefinition(Tree &tree, std::size_t index, std::size_t statementCount) {
+    auto intType = tree.makeIntegerType(32, false);
+    auto definition = std::make_unique<FunctionDefinition>(tree, QString("f%1").arg(index), intType);
+
+    auto variable = std::make_unique<VariableDeclaration>(
+        "v", intType, std::make_unique<IntegerConstant>(nc::SizedValue(32, index), intType));
+    auto declaration = variable.get();
+    definition->block()->addDeclaration(std::move(variable));
+
+    auto use = [&]() -> std::unique_ptr<Expression> {
+        return std::make_unique<Typecast>(Typecast::C_STYLE_CAST, intType, std::make_unique<VariableIdentifier>(declaration));
+    };
+    auto constant = [&](std::size_t value) -> std::unique_ptr<Expression> {
+        return std::make_unique<IntegerConstant>(nc::SizedValue(32, value), intType);
+    };
+    auto update = [&](std::size_t value) -> std::unique_ptr<Statement> {
+        return std::make_unique<ExpressionStatement>(std::make_unique<BinaryOperator>(BinaryOperator::ASSIGN,
+            std::make_unique<VariableIdentifier>(declaration),
+            std::make_unique<BinaryOperator>(BinaryOperator::ADD, use(), constant(value))));
+    };
+
+    for (std::size_t i = 0; i < statementCount; ++i) {
+        if (i % 2 == 0) {
+            definition->block()->addStatement(update(i));
+        } else {
+            auto block = std::make_unique<Block>();
+            block->addStatement(update(i));
+            definition->block()->addStatement(std::make_unique<If>(
+                std::make_unique<BinaryOperator>(BinaryOperator::LT, use(), constant(i)), std::move(block)));
+        }
+    }
+
+    definition->block()->addStatement(std::make_unique<Return>(use()));
+
+    return definition;
+}
+
+/**
+ * Builds, simplifies, and destroys a tree, allocating its nodes on the heap or in the tree's arena.
+ *
+ * \return Text of the first function definition after simplification.
+ */
+QString run(std::size_t functionCount, std::size_t statementCount, bool useArena, QTextStream &out) {
+    QString phasePrefix = useArena ? "arena: " : "heap: ";
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto tree = std::make_unique<Tree>();
+    auto arena = useArena ? &tree->arena() : nullptr;
+
+    std::vector<std::unique_ptr<FunctionDefinition>> definitions(functionCount);
+
+    /* Functions are generated concurrently, as CodeGenerator does. */
+    nc::parallelFor(functionCount, [&](std::size_t index) {
+        nc::Arena::Scope scope(arena);
+        definitions[index] = makeDefinition(*tree, index, statementCount);
+    });
+
+    reportTime(out, phasePrefix + "build", timer);
+
+    nc::parallelFor(functionCount, [&](std::size_t index) {
+        nc::Arena::Scope scope(arena);
+        definitions[index] = Simplifier(*tree).simplify(std::move(definitions[index]));
+    });
+
+    reportTime(out, phasePrefix + "simplify", timer);
+
+    {
+        nc::Arena::Scope scope(arena);
+        tree->setRoot(std::make_unique<CompilationUnit>());
+    }
+    foreach (auto &definition, definitions) {
+        tree->root()->addDeclaration(std::move(definition));
+    }
+
+    if (tree->root()->declarations().size() != functionCount) {
+        throw nc::Exception("wrong number of declarations");
+    }
+    auto result = tree->root()->declarations().front()->toString();
+
+    timer.restart();
+    tree.reset();
+
+    reportTime(out, phasePrefix + "destroy", timer);
+
+    return result;
+}
+
+/**
+ * Prints the time taken by printing and the printing speed.
+ *
+ * \param out   Output stream.
+ * \param phase Name of the measured phase.
+ * \param size  Size of the printed text in bytes.
+ * \param timer Timer started before printing, restarted on return.
+ */
+void reportThroughput(QTextStream &out, const QString &phase, std::size_t size, QElapsedTimer &timer) {
+    auto elapsed = timer.restart();
+    out << QString("%1: %2 ms, %3 MB/s")
+        .arg(phase).arg(elapsed).arg(size / 1e6 / (std::max<qint64>(elapsed, 1) / 1e3), 0, 'f', 1) << endl;
+}
+
+} // anonymous namespace
+
+void benchmarkLikec(const QStringList &args, QTextStream &out) {
+    auto functionCount = getSizeArgument(args, 0, 100000);
+    auto statementCount = getSizeArgument(args, 1, 50);
+    if (functionCount == 0) {
+        throw nc::Exception("the number of functions must be positive");
+    }
+
+    auto heapText = run(functionCount, statementCount, false, out);
+    auto arenaText = run(functionCount, statementCount, true, out);
+
+    if (heapText != arenaText) {
+        throw nc::Exception("trees allocated on the heap and in the arena differ");
+    }
+    if (heapText.contains("(uint32_t)")) {
+        throw nc::Exception("redundant casts were not removed");
+    }
+}
+
+void benchmarkPrint(const QStringList &args, QTextStream &out) {
+    auto functionCount = getSizeArgument(args, 0, 10000);
+    auto statementCount = getSizeArgument(args, 1, 50);
+    auto repetitionCount = getSizeArgument(args, 2, 5);
+    if (functionCount == 0 || repetitionCount == 0) {
+        throw nc::Exception("the numbers of functions and repetitions must be positive");
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Tree tree;
+    {
+        nc::Arena::Scope scope(&tree.arena());
+        tree.setRoot(std::make_unique<CompilationUnit>());
+        for (std::size_t index = 0; index < functionCount; ++index) {
+            tree.root()->addDeclaration(makeDefinition(tree, index, statementCount));
+        }
+    }
+    tree.rewriteRoot();
+
+    reportTime(out, "build", timer);
+
+    QString string;
+    for (std::size_t i = 0; i < repetitionCount; ++i) {
+        string.clear();
+        QTextStream stream(&string);
+        tree.print(stream);
+    }
+    auto expected = string.toUtf8();
+
+    reportThroughput(out, "QTextStream", expected.size() * repetitionCount, timer);
+
+    for (std::size_t i = 0; i < repetitionCount; ++i) {
+        nc::MemoryTextSink sink;
+        {
+            nc::TextBuffer buffer(sink);
+            tree.print(buffer);
+        }
+        if (sink.data() != expected) {
+            throw nc::Exception("text printed into a text buffer differs from the one printed into a text stream");
+        }
+    }
+
+    reportThroughput(out, "TextBuffer", expected.size() * repetitionCount, timer);
+
+    std::size_t rangeCount = 0;
+    for (std::size_t i = 0; i < repetitionCount; ++i) {
+        nc::MemoryTextSink sink;
+        std::vector<PrintedRange> ranges;
+        {
+            nc::TextBuffer buffer(sink);
+            tree.print(buffer, &ranges);
+        }
+        if (sink.data() != expected) {
+            throw nc::Exception("text printed with ranges differs from the one printed without them");
+        }
+        rangeCount = ranges.size();
+    }
+
+    reportThroughput(out, "TextBuffer with ranges", expected.size() * repetitionCount, timer);
+
+    if (rangeCount == 0) {
+        throw nc::Exception("no ranges of printed nodes were recorded");
+    }
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,132 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Benchmarks.h"
+
+#include <vector>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+
+#include <nc/gui/RangeTree.h>
+#include <nc/gui/RangeTreeBuilder.h>
+
+namespace {
+
+using nc::gui::RangeNode;
+
+/** Length of an identifier before the rename. */
+const int oldLength = 2;
+
+/** Length of an identifier after the rename. */
+const int newLength = 9;
+
+/** Number of statements in a function. */
+const int statementCount = 50;
+
+/** Number of uses of the identifier in a statement. */
+const int useCount = 2;
+
+/**
+ * Collects the leaves of a subtree in the document order.
+ */
+void collectLeaves(const RangeNode *node, std::vector<const RangeNode *> &leaves) {
+    if (node->children().empty()) {
+        leaves.push_back(node);
+    }
+    foreach (const auto &child, node->children()) {
+        collectLeaves(&child, leaves);
+    }
+}
+
+} // anonymous namespace
+
+void benchmarkRename(const QStringList &args, QTextStream &out) {
+    auto renameCount = getSizeArgument(args, 0, 50000);
+    auto functionCount = getSizeArgument(args, 1, (renameCount + statementCount * useCount - 1) / (statementCount * useCount));
+
+    if (renameCount > functionCount * statementCount * useCount) {
+        throw nc::Exception("there are fewer uses than renames");
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /*
+     * The text of a function looks like "f() {\n" followed by statements
+     * like "    v1 = v1 + 1;\n" and "}\n". Uses of the identifier are the
+     * leaves of the tree.
+     */
+    nc::gui::RangeTree tree;
+    int position = 0;
+    {
+        nc::gui::RangeTreeBuilder builder(tree);
+        builder.onStart(nullptr, position);
+
+        for (std::size_t f = 0; f < functionCount; ++f) {
+            builder.onStart(nullptr, position);
+            position += 6;
+
+            for (int s = 0; s < statementCount; ++s) {
+                builder.onStart(nullptr, position);
+                position += 4;
+
+                for (int u = 0; u < useCount; ++u) {
+                    builder.onStart(nullptr, position);
+                    position += oldLength;
+                    builder.onEnd(nullptr, position);
+                    position += 3;
+                }
+
+                position += 3;
+                builder.onEnd(nullptr, position);
+            }
+
+            position += 2;
+            builder.onEnd(nullptr, position);
+        }
+
+        builder.onEnd(nullptr, position);
+    }
+
+    std::vector<const RangeNode *> uses;
+    collectLeaves(tree.root(), uses);
+
+    reportTime(out, "build range tree", timer);
+
+    /*
+     * Rename the uses the way a text document does: look up the range of
+     * the use, then remove the old name and insert the new one. Uses are
+     * renamed from the last one, so that the earlier ones keep their
+     * positions, as a document replacing all the uses would do.
+     */
+    std::size_t renamed = 0;
+    for (auto i = uses.size(); i > 0 && renamed < renameCount; --i, ++renamed) {
+        auto range = tree.getRange(uses[i - 1]);
+        if (range.length() != oldLength) {
+            throw nc::Exception(QString("use %1 has a wrong range before the rename").arg(i - 1));
+        }
+        tree.handleRemoval(range.start(), oldLength);
+        tree.handleInsertion(range.start(), newLength);
+    }
+
+    reportTime(out, QString("rename %1 uses").arg(renamed), timer);
+
+    if (tree.root()->size() != position + static_cast<int>(renamed) * (newLength - oldLength)) {
+        throw nc::Exception("wrong size of the text after the renames");
+    }
+
+    int end = 0;
+    for (std::size_t i = 0; i < uses.size(); ++i) {
+        auto range = tree.getRange(uses[i]);
+        auto expected = i + renamed >= uses.size() ? newLength : oldLength;
+        if (range.length() != expected || range.start() < end) {
+            throw nc::Exception(QString("use %1 has a wrong range after the renames").arg(i));
+        }
+        end = range.end();
+    }
+
+    reportTime(out, "check ranges", timer);
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,172 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <nc/common/CancellationToken.h>
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/MemoryDomain.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/ir/dflow/Dataflow.h>
+#include <nc/core/ir/ssa/Ssa.h>
+#include <nc/core/ir/ssa/SsaBuilder.h>
+
+namespace {
+
+using namespace nc::core::ir;
+
+/**
+ * Terms of a diamond whose SSA form is checked.
+ */
+struct Diamond {
+    BasicBlock *join;           ///< Basic block where the branches meet.
+    const Term *leftWrite;      ///< Write of the whole register in the left branch.
+    const Term *rightWrite;     ///< Write of the whole register in the right branch.
+    const Term *joinRead;       ///< Read of the whole register in the join.
+    const Term *partialWrite;   ///< Write of the low byte of the register in the join.
+    const Term *lastRead;       ///< Read of the whole register after the partial write.
+};
+
+void check(bool condition, const char *what, std::size_t diamond) {
+    if (!condition) {
+        throw nc::Exception(QString("diamond %1: %2").arg(diamond).arg(what));
+    }
+}
+
+} // anonymous namespace
+
+void benchmarkSsa(const QStringList &args, QTextStream &out) {
+    auto size = getSizeArgument(args, 0, 1);
+    if (size == 0) {
+        throw nc::Exception("the number of diamonds must be positive");
+    }
+
+    const MemoryLocation reg(MemoryDomain::FIRST_REGISTER, 0, 32);
+    const MemoryLocation lowByte(MemoryDomain::FIRST_REGISTER, 0, 8);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Function function;
+    dflow::Dataflow dataflow;
+    std::vector<Diamond> diamonds;
+    diamonds.reserve(size);
+
+    auto addBasicBlock = [&]() -> BasicBlock * {
+        auto basicBlock = std::make_unique<BasicBlock>();
+        auto result = basicBlock.get();
+        function.addBasicBlock(std::move(basicBlock));
+        return result;
+    };
+
+    auto write = [&](BasicBlock *basicBlock, const MemoryLocation &location) -> const Term * {
+        auto left = std::make_unique<MemoryLocationAccess>(location);
+        auto result = left.get();
+        basicBlock->pushBack(std::make_unique<Assignment>(std::move(left),
+            std::make_unique<Constant>(nc::SizedValue(location.size<nc::SmallBitSize>(), 0))));
+        dataflow.setMemoryLocation(result, location);
+        return result;
+    };
+
+    auto read = [&](BasicBlock *basicBlock, const MemoryLocation &location) -> const Term * {
+        auto term = std::make_unique<MemoryLocationAccess>(location);
+        auto result = term.get();
+        basicBlock->pushBack(std::make_unique<Touch>(std::move(term), Term::READ));
+        dataflow.setMemoryLocation(result, location);
+        return result;
+    };
+
+    /*
+     * Each diamond: the head jumps to the left or the right branch, both
+     * write the register and jump to the join. The join reads the
+     * register, overwrites its low byte, reads it again, and jumps to the
+     * head of the next diamond.
+     */
+    BasicBlock *previous = nullptr;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        auto head = addBasicBlock();
+        auto left = addBasicBlock();
+        auto right = addBasicBlock();
+        auto join = addBasicBlock();
+
+        if (previous) {
+            previous->pushBack(std::make_unique<Jump>(JumpTarget(head)));
+        } else {
+            function.setEntry(head);
+        }
+
+        head->pushBack(std::make_unique<Jump>(
+            std::make_unique<Constant>(nc::SizedValue(1, 1)), JumpTarget(left), JumpTarget(right)));
+
+        Diamond diamond;
+        diamond.join = join;
+        diamond.leftWrite = write(left, reg);
+        left->pushBack(std::make_unique<Jump>(JumpTarget(join)));
+        diamond.rightWrite = write(right, reg);
+        right->pushBack(std::make_unique<Jump>(JumpTarget(join)));
+        diamond.joinRead = read(join, reg);
+        diamond.partialWrite = write(join, lowByte);
+        diamond.lastRead = read(join, reg);
+        diamonds.push_back(diamond);
+
+        previous = join;
+    }
+
+    reportTime(out, "build function", timer);
+
+    nc::CancellationToken canceled;
+    ssa::Ssa ssa;
+    ssa::SsaBuilder(ssa, &function, dataflow, canceled).build();
+
+    reportTime(out, "build SSA", timer);
+
+    if (ssa.variables().size() != 1 || ssa.variables().front() != reg) {
+        throw nc::Exception("the register must be the only variable");
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto &diamond = diamonds[i];
+
+        const auto &phis = ssa.getPhis(diamond.join);
+        check(phis.size() == 1, "the join must have one phi function", i);
+
+        auto phi = phis.front();
+        auto leftDefinition = ssa.getDefinition(diamond.leftWrite);
+        auto rightDefinition = ssa.getDefinition(diamond.rightWrite);
+        auto partialDefinition = ssa.getDefinition(diamond.partialWrite);
+
+        check(leftDefinition && rightDefinition && partialDefinition, "writes must define the variable", i);
+        check(phi->operands().size() == 2, "the phi function must have two operands", i);
+        check(phi->operands()[0].definition() != phi->operands()[1].definition(), "operands must differ", i);
+
+        foreach (const auto &operand, phi->operands()) {
+            check(operand.definition() == leftDefinition || operand.definition() == rightDefinition,
+                  "operands must be the writes in the branches", i);
+        }
+
+        const auto &joinDefinitions = ssa.getDefinitions(diamond.joinRead);
+        check(joinDefinitions.size() == 1 && joinDefinitions.front() == phi,
+              "the first read must use the phi function", i);
+
+        const auto &lastDefinitions = ssa.getDefinitions(diamond.lastRead);
+        check(lastDefinitions.size() == 2 &&
+              std::find(lastDefinitions.begin(), lastDefinitions.end(), partialDefinition) != lastDefinitions.end() &&
+              std::find(lastDefinitions.begin(), lastDefinitions.end(), phi) != lastDefinitions.end(),
+              "the second read must use the partial write and the phi function", i);
+    }
+
+    reportTime(out, "check SSA", timer);
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,102 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include <nc/config.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include <nc/common/Exception.h>
+#include <nc/common/StringToInt.h>
+
+#include "Benchmarks.h"
+
+const char *self = "bench";
+
+QTextStream qout(stdout, QIODevice::WriteOnly);
+QTextStream qerr(stderr, QIODevice::WriteOnly);
+
+std::size_t getSizeArgument(const QStringList &args, int index, std::size_t byDefault) {
+    if (index >= args.size()) {
+        return byDefault;
+    }
+    if (auto result = nc::stringToInt<std::size_t>(args[index])) {
+        return *result;
+    }
+    throw nc::Exception(QString("not a number: %1").arg(args[index]));
+}
+
+void reportTime(QTextStream &out, const QString &phase, QElapsedTimer &timer) {
+    out << QString("%1: %2 ms").arg(phase).arg(timer.restart()) << endl;
+}
+
+void help() {
+    qout << "Usage: " << self << " benchmark [argument...]" << endl
+         << endl
+         << "Benchmarks:" << endl
+         << "  cfg [BLOCKS [LOOP]]         Build the CFG and dominator tree of a synthetic" << endl
+         << "                              chain of basic blocks (10000000 by default), then" << endl
+         << "                              make a function of a long loop and structure it" << endl
+         << "                              (1000000 blocks in the loop by default)." << endl
+         << "  instructions [INSTRUCTIONS [STEPS]]" << endl
+         << "                              Scroll the model of the instructions view over a" << endl
+         << "                              synthetic set of instructions and highlight some of" << endl
+         << "                              them (20000000 instructions, 100000 steps by default)." << endl
+         << "  likec [FUNCTIONS [STATEMENTS]]" << endl
+         << "                              Build, simplify, and destroy a synthetic LikeC tree" << endl
+         << "                              with nodes on the heap and in an arena (100000" << endl
+         << "                              functions of 50 statements by default)." << endl
+         << "  print [FUNCTIONS [STATEMENTS [REPETITIONS]]]" << endl
+         << "                              Print a synthetic LikeC tree into a text stream and" << endl
+         << "                              into a text buffer, and report the throughput" << endl
+         << "                              (10000 functions of 50 statements, 5 times by default)." << endl
+         << "  rename [RENAMES [FUNCTIONS]]" << endl
+         << "                              Rename identifiers in the range tree of a synthetic" << endl
+         << "                              text the way the C++ view does (50000 renames by" << endl
+         << "                              default, in functions of 50 statements)." << endl
+         << "  ssa [DIAMONDS]              Build and check the SSA form of a synthetic chain" << endl
+         << "                              of diamonds (1 by default)." << endl
+         << endl
+         << "Each benchmark prints the time taken by its phases and checks its results." << endl
+         << "The exit code is nonzero if the check fails." << endl;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    try {
+        auto args = QCoreApplication::arguments();
+
+        if (args.size() < 2 || args[1] == "--help" || args[1] == "-h") {
+            help();
+            return 1;
+        }
+
+        auto benchmark = args[1];
+        auto benchmarkArgs = args.mid(2);
+
+        if (benchmark == "cfg") {
+            benchmarkCfg(benchmarkArgs, qout);
+        } else if (benchmark == "instructions") {
+            benchmarkInstructions(benchmarkArgs, qout);
+        } else if (benchmark == "likec") {
+            benchmarkLikec(benchmarkArgs, qout);
+        } else if (benchmark == "print") {
+            benchmarkPrint(benchmarkArgs, qout);
+        } else if (benchmark == "rename") {
+            benchmarkRename(benchmarkArgs, qout);
+        } else if (benchmark == "ssa") {
+            benchmarkSsa(benchmarkArgs, qout);
+        } else {
+            throw nc::Exception(QString("unknown benchmark: %1").arg(benchmark));
+        }
+    } catch (const nc::Exception &e) {
+        qerr << self << ": " << e.unicodeWhat() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* vim:set et sts=4 sw=4: */
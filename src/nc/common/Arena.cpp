@@ -0,0 +1,144 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Arena.h"
+
+#include <cassert>
+#include <cstdint> /* std::uintptr_t */
+#include <map>
+
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QThreadStorage>
+#include <QWriteLocker>
+
+#include <nc/common/Foreach.h>
+
+namespace nc {
+
+namespace {
+
+/** Size of the chunks from which small allocations are made. */
+const std::size_t chunkSize = 256 * 1024;
+
+/** Identifier of the last created arena. */
+QAtomicInt lastArenaId;
+
+/**
+ * Arena a thread allocates memory in, and the part of the chunk
+ * the thread allocated last that is still free.
+ *
+ * The chunk is identified by the arena's identifier rather than its
+ * address, so that a chunk of a destroyed arena is never reused by an
+ * arena created at the same address.
+ */
+struct ThreadState {
+    Arena *arena;
+    int chunkArenaId;
+    char *position;
+    char *end;
+
+    ThreadState(): arena(nullptr), chunkArenaId(0), position(nullptr), end(nullptr) {}
+};
+
+QThreadStorage<ThreadState *> threadStates;
+
+/** Beginnings of the chunks of all alive arenas by the ends of the chunks. */
+std::map<const char *, const char *> chunkRanges;
+
+/** Lock guarding chunkRanges. */
+QReadWriteLock chunkRangesLock;
+
+ThreadState *getThreadState() {
+    if (!threadStates.hasLocalData()) {
+        threadStates.setLocalData(new ThreadState());
+    }
+    return threadStates.localData();
+}
+
+} // anonymous namespace
+
+Arena::Arena(): id_(lastArenaId.fetchAndAddRelaxed(1) + 1) {}
+
+Arena::~Arena() {
+    QWriteLocker lock(&chunkRangesLock);
+    foreach (const auto &chunk, chunks_) {
+        /* Chunks do not overlap, so the first chunk ending after the beginning of this one is this one. */
+        auto i = chunkRanges.upper_bound(chunk.get());
+        assert(i != chunkRanges.end() && i->second == chunk.get());
+        chunkRanges.erase(i);
+    }
+}
+
+Arena::Scope::Scope(Arena *arena) {
+    auto state = getThreadState();
+    previousArena_ = state->arena;
+    state->arena = arena;
+}
+
+Arena::Scope::~Scope() {
+    getThreadState()->arena = previousArena_;
+}
+
+void *Arena::allocate(std::size_t size) {
+    if (!threadStates.hasLocalData()) {
+        return nullptr;
+    }
+
+    auto state = threadStates.localData();
+    auto arena = state->arena;
+    if (!arena) {
+        return nullptr;
+    }
+
+    if (state->chunkArenaId != arena->id_) {
+        state->chunkArenaId = arena->id_;
+        state->position = nullptr;
+        state->end = nullptr;
+    }
+
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    if (size > static_cast<std::size_t>(state->end - state->position)) {
+        /* Large blocks get chunks of their own, so that the current chunk is not wasted. */
+        if (size > chunkSize / 4) {
+            return arena->allocateChunk(size);
+        }
+        state->position = arena->allocateChunk(chunkSize);
+        state->end = state->position + chunkSize;
+    }
+
+    auto result = state->position;
+    state->position += size;
+    return result;
+}
+
+bool Arena::contains(const void *pointer) {
+    auto address = static_cast<const char *>(pointer);
+
+    QReadLocker lock(&chunkRangesLock);
+    auto i = chunkRanges.upper_bound(address);
+    return i != chunkRanges.end() && i->second <= address;
+}
+
+char *Arena::allocateChunk(std::size_t size) {
+    /* Reserve space for aligning the beginning of the chunk. */
+    size += alignment - 1;
+    std::unique_ptr<char[]> chunk(new char[size]);
+    auto result = chunk.get() + (-reinterpret_cast<std::uintptr_t>(chunk.get()) & (alignment - 1));
+
+    {
+        QWriteLocker lock(&chunkRangesLock);
+        chunkRanges[chunk.get() + size] = chunk.get();
+    }
+
+    QMutexLocker lock(&mutex_);
+    chunks_.push_back(std::move(chunk));
+    return result;
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,105 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <memory>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <QMutex>
+
+namespace nc {
+
+/**
+ * Region allocator: hands out memory from large chunks and frees all of it
+ * at once, when destroyed. Objects allocated in an arena must not be used
+ * after the arena is destroyed.
+ *
+ * Memory is allocated in the arena of the innermost Arena::Scope alive in
+ * the calling thread. Each thread bumps a pointer in a chunk of its own, so
+ * threads contend for the lock only when they need a new chunk. The address
+ * ranges of the chunks of all arenas are registered, so that memory allocated
+ * in an arena can be told apart from other memory.
+ */
+class Arena: boost::noncopyable {
+    const int id_; ///< Identifier of the arena, unique during the run of the program.
+    QMutex mutex_; ///< Mutex guarding the list of chunks.
+    std::vector<std::unique_ptr<char[]>> chunks_; ///< Allocated chunks.
+
+public:
+    /**
+     * Alignment of the memory returned by allocate().
+     */
+    static const std::size_t alignment = 16;
+
+    /**
+     * Class constructor.
+     */
+    Arena();
+
+    /**
+     * Destructor. Frees all the memory allocated in the arena.
+     */
+    ~Arena();
+
+    /**
+     * Makes the calling thread allocate memory in a given arena
+     * (or nowhere) until the scope is destroyed.
+     */
+    class Scope: boost::noncopyable {
+        Arena *previousArena_; ///< Arena used by the thread before the scope.
+
+    public:
+        /**
+         * Constructor.
+         *
+         * \param arena Pointer to the arena to allocate memory in.
+         *              Can be nullptr, in which case allocate() returns nullptr.
+         */
+        explicit Scope(Arena *arena);
+
+        /**
+         * Destructor. Restores the arena used before the scope.
+         */
+        ~Scope();
+    };
+
+    /**
+     * Allocates memory in the arena of the innermost scope alive in the calling thread.
+     *
+     * \param size Size of the memory.
+     *
+     * \return Pointer to the memory aligned to the alignment boundary,
+     *         or nullptr if there is no such scope or its arena is nullptr.
+     */
+    static void *allocate(std::size_t size);
+
+    /**
+     * \param pointer Pointer to memory. Can be nullptr.
+     *
+     * \return True iff the memory was allocated in an arena that is not destroyed yet.
+     *
+     * \note The check takes a lock shared with other threads doing the same check,
+     *       and takes time logarithmic in the number of chunks of all arenas.
+     */
+    static bool contains(const void *pointer);
+
+private:
+    /**
+     * Allocates a new chunk.
+     *
+     * \param size Size of the chunk.
+     *
+     * \return Valid pointer to the chunk aligned to the alignment boundary.
+     */
+    char *allocateChunk(std::size_t size);
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
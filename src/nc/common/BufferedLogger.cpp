@@ -0,0 +1,111 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "BufferedLogger.h"
+
+#include <cassert>
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include "Foreach.h"
+#include "make_unique.h"
+
+namespace nc {
+
+/**
+ * Messages logged by a single thread and not yet passed further.
+ */
+class BufferedLogger::ThreadBuffer {
+public:
+    /** Guards the messages: they are added by the owning thread, but can be flushed by any. */
+    QMutex mutex;
+
+    /** The messages. */
+    std::vector<std::pair<LogLevel, QString>> messages;
+};
+
+BufferedLogger::BufferedLogger(std::shared_ptr<Logger> logger, std::size_t capacity):
+    logger_(std::move(logger)), capacity_(capacity), ownerThread_(QThread::currentThread())
+{
+    assert(logger_);
+}
+
+BufferedLogger::~BufferedLogger() {
+    flush();
+}
+
+void BufferedLogger::log(LogLevel level, const QString &text) {
+    if (QThread::currentThread() == ownerThread_) {
+        flush();
+        QMutexLocker locker(&outputMutex_);
+        logger_->log(level, text);
+        return;
+    }
+
+    auto buffer = getThreadBuffer();
+    bool full;
+    {
+        QMutexLocker locker(&buffer->mutex);
+        buffer->messages.push_back(std::make_pair(level, text));
+        full = buffer->messages.size() >= capacity_;
+    }
+
+    if (full || level >= LogLevel::WARNING) {
+        flush(buffer);
+    }
+}
+
+bool BufferedLogger::isEnabled(LogLevel level) const {
+    return logger_->isEnabled(level);
+}
+
+void BufferedLogger::flush() {
+    {
+        QReadLocker locker(&buffersLock_);
+        foreach (const auto &threadAndBuffer, buffers_) {
+            flush(threadAndBuffer.second.get());
+        }
+    }
+
+    QMutexLocker locker(&outputMutex_);
+    logger_->flush();
+}
+
+BufferedLogger::ThreadBuffer *BufferedLogger::getThreadBuffer() {
+    auto thread = QThread::currentThread();
+    {
+        QReadLocker locker(&buffersLock_);
+        auto i = buffers_.find(thread);
+        if (i != buffers_.end()) {
+            return i->second.get();
+        }
+    }
+
+    QWriteLocker locker(&buffersLock_);
+    auto &result = buffers_[thread];
+    if (!result) {
+        result = std::make_unique<ThreadBuffer>();
+    }
+    return result.get();
+}
+
+void BufferedLogger::flush(ThreadBuffer *buffer) {
+    /* Take the messages under the output mutex, so that batches of a thread cannot overtake each other. */
+    QMutexLocker outputLocker(&outputMutex_);
+
+    std::vector<std::pair<LogLevel, QString>> messages;
+    {
+        QMutexLocker locker(&buffer->mutex);
+        messages.swap(buffer->messages);
+    }
+
+    foreach (const auto &message, messages) {
+        logger_->log(message.first, message.second);
+    }
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
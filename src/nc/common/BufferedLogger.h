@@ -0,0 +1,81 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QThread>
+
+#include "Logger.h"
+
+namespace nc {
+
+/**
+ * Logger collecting messages in per-thread buffers and passing them
+ * to another logger in batches.
+ *
+ * Threads logging messages concurrently do not wait for each other,
+ * except when a buffer is passed to the underlying logger. Messages of
+ * one thread keep their order. Messages logged by the thread that
+ * created the logger are not buffered: before logging such a message,
+ * all the buffers are flushed, so that progress messages of the main
+ * thread appear in time and after the messages logged before them.
+ * Warnings and errors flush the buffer of the logging thread at once.
+ */
+class BufferedLogger: public Logger {
+    class ThreadBuffer;
+
+    /** Logger to pass the messages to. */
+    std::shared_ptr<Logger> logger_;
+
+    /** Number of messages in a buffer after which it is flushed. */
+    std::size_t capacity_;
+
+    /** Thread that created the logger. */
+    QThread *ownerThread_;
+
+    /** Mutex serializing the output of batches. */
+    QMutex outputMutex_;
+
+    /** Lock guarding the mapping of threads to buffers. */
+    QReadWriteLock buffersLock_;
+
+    /** Buffers of the threads which logged something. */
+    boost::unordered_map<QThread *, std::unique_ptr<ThreadBuffer>> buffers_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param logger Valid pointer to the logger to pass messages to.
+     * \param capacity Number of messages in a buffer after which it is flushed.
+     */
+    explicit BufferedLogger(std::shared_ptr<Logger> logger, std::size_t capacity = 256);
+
+    /**
+     * Destructor. Flushes all the buffers.
+     */
+    ~BufferedLogger();
+
+    void log(LogLevel level, const QString &text) override;
+    bool isEnabled(LogLevel level) const override;
+    void flush() override;
+
+private:
+    ThreadBuffer *getThreadBuffer();
+    void flush(ThreadBuffer *buffer);
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
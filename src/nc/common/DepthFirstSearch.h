@@ -0,0 +1,261 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cassert>
+#include <cstddef> /* std::size_t */
+#include <type_traits>
+#include <utility> /* std::declval */
+#include <vector>
+
+#include <boost/range/begin.hpp>
+#include <boost/range/end.hpp>
+#include <boost/range/iterator.hpp>
+
+#include "Foreach.h"
+
+namespace nc {
+
+namespace dfs_detail {
+    /**
+     * Head functor for graphs whose successor ranges consist of node indices.
+     */
+    struct IdentityHead {
+        std::size_t operator()(std::size_t index) const { return index; }
+    };
+
+    /**
+     * Edge visitor doing nothing.
+     */
+    struct IgnoreEdge {
+        template<class Edge, class EdgeType>
+        void operator()(std::size_t, const Edge &, EdgeType) const {}
+    };
+} // namespace dfs_detail
+
+/**
+ * Iterative depth-first search over a graph with densely numbered nodes.
+ *
+ * Nodes are numbered from 0 to size - 1. The graph is described by two functors:
+ * the first one maps the index of a node to a range of its outgoing edges,
+ * the second one maps an edge to the index of its head. Visited nodes are
+ * tracked in bit vectors, and the traversal uses an explicit stack, so that
+ * arbitrarily deep graphs can be traversed without exhausting the native stack.
+ *
+ * It can be used like this:
+ *
+ * \code
+ * auto dfs = makeDepthFirstSearch(cfg.size(), [&](std::size_t index) { return cfg.getSuccessors(index); });
+ * dfs.visit(0);
+ * \endcode
+ *
+ * \tparam Successors Functor mapping the index of a node to the range of its outgoing edges.
+ *                    Iterators of the returned range must stay valid during the search.
+ * \tparam Head Functor mapping an edge to the index of its head.
+ */
+template<class Successors, class Head = dfs_detail::IdentityHead>
+class DepthFirstSearch {
+public:
+    /** Index of a node. */
+    typedef std::size_t Index;
+
+    /** Edge type. */
+    enum EdgeType {
+        TREE, ///< Edge to a node that was not discovered yet.
+        BACK, ///< Edge to a node that was discovered but not finished yet.
+        CROSS ///< Edge to a finished node: a forward or a cross edge.
+    };
+
+private:
+    typedef typename std::remove_reference<decltype(std::declval<Successors &>()(Index()))>::type Range;
+    typedef typename boost::range_iterator<const Range>::type Iterator;
+
+    /** Stack entry: a node and the remaining range of its outgoing edges. */
+    struct Frame {
+        Index node;
+        Iterator current;
+        Iterator end;
+    };
+
+    /** Functor mapping a node to its outgoing edges. */
+    Successors successors_;
+
+    /** Functor mapping an edge to its head. */
+    Head head_;
+
+    /** Bit vector of discovered nodes. */
+    std::vector<bool> discovered_;
+
+    /** Bit vector of finished nodes. */
+    std::vector<bool> finished_;
+
+    /** Nodes in the order of discovery. */
+    std::vector<Index> preorder_;
+
+    /** Nodes in the order of finishing. */
+    std::vector<Index> postorder_;
+
+    /** Stack of nodes being visited. */
+    std::vector<Frame> stack_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param size Number of nodes in the graph.
+     * \param successors Functor mapping the index of a node to the range of its outgoing edges.
+     * \param head Functor mapping an edge to the index of its head.
+     */
+    DepthFirstSearch(std::size_t size, Successors successors, Head head = Head()):
+        successors_(std::move(successors)), head_(std::move(head)), discovered_(size), finished_(size)
+    {}
+
+    /**
+     * \return Number of nodes in the graph.
+     */
+    std::size_t size() const { return discovered_.size(); }
+
+    /**
+     * Visits the given node, if it was not discovered yet, and all the nodes
+     * reachable from it that were not discovered yet.
+     *
+     * \param root Index of the node to start from.
+     * \param visitor Functor called as visitor(tail, edge, edgeType) for each
+     *                edge traversed during the search.
+     */
+    template<class EdgeVisitor>
+    void visit(Index root, EdgeVisitor visitor) {
+        assert(root < size());
+
+        if (discovered_[root]) {
+            return;
+        }
+        discover(root);
+
+        while (!stack_.empty()) {
+            auto &frame = stack_.back();
+
+            if (frame.current != frame.end) {
+                const auto &edge = *frame.current++;
+                Index tail = frame.node;
+                Index head = head_(edge);
+                assert(head < size());
+
+                if (!discovered_[head]) {
+                    visitor(tail, edge, TREE);
+                    discover(head); /* Invalidates frame. */
+                } else if (!finished_[head]) {
+                    visitor(tail, edge, BACK);
+                } else {
+                    visitor(tail, edge, CROSS);
+                }
+            } else {
+                finished_[frame.node] = true;
+                postorder_.push_back(frame.node);
+                stack_.pop_back();
+            }
+        }
+    }
+
+    /**
+     * Visits the given node, if it was not discovered yet, and all the nodes
+     * reachable from it that were not discovered yet.
+     *
+     * \param root Index of the node to start from.
+     */
+    void visit(Index root) {
+        visit(root, dfs_detail::IgnoreEdge());
+    }
+
+    /**
+     * Marks a node as already visited, so that the search does not enter it.
+     * The node is not added to the preorder and postorder.
+     *
+     * \param node Index of the node.
+     */
+    void markVisited(Index node) {
+        assert(node < size());
+        discovered_[node] = true;
+        finished_[node] = true;
+    }
+
+    /**
+     * \param node Index of a node.
+     *
+     * \return True iff the node has been discovered.
+     */
+    bool isVisited(Index node) const {
+        assert(node < size());
+        return discovered_[node];
+    }
+
+    /**
+     * \return Nodes in the order of discovery.
+     */
+    const std::vector<Index> &preorder() const { return preorder_; }
+
+    /**
+     * \return Nodes in the order of finishing.
+     */
+    const std::vector<Index> &postorder() const { return postorder_; }
+
+    /**
+     * Forgets about all the nodes visited by the search so far,
+     * in time proportional to the number of visited nodes.
+     * Nodes marked visited via markVisited() stay marked.
+     */
+    void reset() {
+        assert(stack_.empty());
+
+        foreach (auto node, preorder_) {
+            discovered_[node] = false;
+            finished_[node] = false;
+        }
+        preorder_.clear();
+        postorder_.clear();
+    }
+
+private:
+    void discover(Index node) {
+        discovered_[node] = true;
+        preorder_.push_back(node);
+
+        const auto &range = successors_(node);
+        Frame frame = { node, boost::begin(range), boost::end(range) };
+        stack_.push_back(frame);
+    }
+};
+
+/**
+ * Creates a depth-first search object.
+ *
+ * \param size Number of nodes in the graph.
+ * \param successors Functor mapping the index of a node to the range of its outgoing edges.
+ *
+ * \return The depth-first search object.
+ */
+template<class Successors>
+DepthFirstSearch<Successors> makeDepthFirstSearch(std::size_t size, Successors successors) {
+    return DepthFirstSearch<Successors>(size, std::move(successors));
+}
+
+/**
+ * Creates a depth-first search object.
+ *
+ * \param size Number of nodes in the graph.
+ * \param successors Functor mapping the index of a node to the range of its outgoing edges.
+ * \param head Functor mapping an edge to the index of its head.
+ *
+ * \return The depth-first search object.
+ */
+template<class Successors, class Head>
+DepthFirstSearch<Successors, Head> makeDepthFirstSearch(std::size_t size, Successors successors, Head head) {
+    return DepthFirstSearch<Successors, Head>(size, std::move(successors), std::move(head));
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -106,7 +106,11 @@ class DisjointSet {
      */
     DisjointSet<T> *findSetImpl() const {
         if (parent_ != this) {
-            parent_ = parent_->findSetImpl();
+            DisjointSet<T> *root = parent_->findSetImpl();
+            /* Do not write if nothing changes, so that lookups on compressed paths are read-only. */
+            if (parent_ != root) {
+                parent_ = root;
+            }
         }
         return parent_;
     }
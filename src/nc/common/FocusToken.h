@@ -0,0 +1,74 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory> /* std::shared_ptr */
+#include <vector>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "Types.h"
+
+namespace nc {
+
+/**
+ * Class for propagating the addresses the user is currently interested in
+ * to long-running analyses, so that they can process the code at these
+ * addresses first.
+ *
+ * Like CancellationToken, all copies of a token share the same state.
+ * The token can be updated and read concurrently.
+ */
+class FocusToken {
+    struct State {
+        QMutex mutex;
+        std::vector<ByteAddr> addresses;
+        int version;
+
+        State(): version(0) {}
+    };
+
+    /** State shared by all the copies. */
+    std::shared_ptr<State> state_;
+
+public:
+    /**
+     * Creates a token with no addresses in focus.
+     */
+    FocusToken(): state_(std::make_shared<State>()) {}
+
+    /**
+     * Sets the addresses in focus for the token and all its copies.
+     *
+     * \param addresses Addresses, the most interesting first.
+     */
+    void setAddresses(std::vector<ByteAddr> addresses) {
+        QMutexLocker lock(&state_->mutex);
+        state_->addresses = std::move(addresses);
+        ++state_->version;
+    }
+
+    /**
+     * \return Addresses in focus, the most interesting first.
+     */
+    std::vector<ByteAddr> addresses() const {
+        QMutexLocker lock(&state_->mutex);
+        return state_->addresses;
+    }
+
+    /**
+     * \return Number that changes each time the addresses in focus are set.
+     */
+    int version() const {
+        QMutexLocker lock(&state_->mutex);
+        return state_->version;
+    }
+};
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
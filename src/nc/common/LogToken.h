@@ -65,11 +65,41 @@ public:
      * \param[in] text  Text of the message.
      */
     void log(LogLevel level, const QString &text) const {
-        if (logger_) {
+        if (isEnabled(level)) {
             logger_->log(level, text);
         }
     }
 
+    /**
+     * Logs a message with a given level. The text of the message is
+     * computed only if messages with this level are actually logged.
+     *
+     * \param[in] level Log level of the message.
+     * \param[in] makeText Functor returning the text of the message.
+     */
+    template<class Functor>
+    void logLazily(LogLevel level, Functor makeText) const {
+        if (isEnabled(level)) {
+            logger_->log(level, makeText());
+        }
+    }
+
+    /**
+     * \param[in] level Log level.
+     *
+     * \return True iff messages with the given level are logged.
+     */
+    bool isEnabled(LogLevel level) const { return logger_ && logger_->isEnabled(level); }
+
+    /**
+     * Makes sure that all the messages logged so far have reached their destination.
+     */
+    void flush() const {
+        if (logger_) {
+            logger_->flush();
+        }
+    }
+
     /**
      * Logs a message with the debug level.
      *
@@ -29,6 +29,7 @@
 #include <QString>
 
 #include "LogLevel.h"
+#include "Unused.h"
 
 namespace nc {
 
@@ -98,6 +99,19 @@ public:
      * \param[in] text  Text of the message.
      */
     virtual void log(LogLevel level, const QString &text) = 0;
+
+    /**
+     * \param[in] level Log level.
+     *
+     * \return True iff messages with the given level are logged.
+     *          If not, log() need not be called for them.
+     */
+    virtual bool isEnabled(LogLevel level) const { NC_UNUSED(level); return true; }
+
+    /**
+     * Makes sure that all the messages logged so far have reached their destination.
+     */
+    virtual void flush() {}
 };
 
 } // namespace nc
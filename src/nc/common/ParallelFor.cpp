@@ -0,0 +1,145 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "ParallelFor.h"
+
+#include <cassert>
+
+#ifdef NC_USE_THREADS
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+#endif
+
+namespace nc {
+
+#ifdef NC_USE_THREADS
+
+namespace {
+
+/**
+ * State shared between the threads running a single parallelFor.
+ */
+class ParallelForState {
+    const std::function<void(std::size_t)> &fun_;
+    std::size_t size_;
+    std::size_t next_;
+    std::size_t running_;
+    std::exception_ptr exception_;
+    QMutex mutex_;
+    QWaitCondition finished_;
+
+public:
+    ParallelForState(std::size_t size, const std::function<void(std::size_t)> &fun):
+        fun_(fun), size_(size), next_(0), running_(0)
+    {}
+
+    /**
+     * Processes indices until none are left.
+     */
+    void work() {
+        QMutexLocker locker(&mutex_);
+
+        while (next_ < size_) {
+            std::size_t index = next_++;
+            ++running_;
+
+            locker.unlock();
+            std::exception_ptr exception;
+            try {
+                fun_(index);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            locker.relock();
+
+            if (exception) {
+                if (!exception_) {
+                    exception_ = exception;
+                }
+                next_ = size_;
+            }
+
+            if (--running_ == 0 && next_ == size_) {
+                finished_.wakeAll();
+            }
+        }
+    }
+
+    /**
+     * Waits until all the taken indices are processed.
+     * Rethrows the first exception thrown by the function.
+     */
+    void wait() {
+        QMutexLocker locker(&mutex_);
+
+        while (running_ > 0) {
+            finished_.wait(&mutex_);
+        }
+
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+};
+
+/**
+ * Runnable helping to process the indices of a parallelFor.
+ *
+ * A helper can start after parallelFor has returned. In this case,
+ * it finds no indices left and does nothing.
+ */
+class ParallelForHelper: public QRunnable {
+    std::shared_ptr<ParallelForState> state_;
+
+public:
+    ParallelForHelper(std::shared_ptr<ParallelForState> state): state_(std::move(state)) {}
+
+    void run() override { state_->work(); }
+};
+
+} // anonymous namespace
+
+void parallelFor(std::size_t size, const std::function<void(std::size_t)> &fun) {
+    assert(fun);
+
+    if (size == 0) {
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>(size, fun);
+
+    auto threadPool = QThreadPool::globalInstance();
+    auto helperCount = std::min<std::size_t>(size - 1, std::max(threadPool->maxThreadCount() - 1, 0));
+
+    for (std::size_t i = 0; i < helperCount; ++i) {
+        auto helper = new ParallelForHelper(state);
+        helper->setAutoDelete(true);
+        threadPool->start(helper);
+    }
+
+    state->work();
+    state->wait();
+}
+
+#else
+
+void parallelFor(std::size_t size, const std::function<void(std::size_t)> &fun) {
+    assert(fun);
+
+    for (std::size_t index = 0; index < size; ++index) {
+        fun(index);
+    }
+}
+
+#endif
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
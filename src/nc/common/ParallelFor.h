@@ -0,0 +1,34 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <functional>
+
+namespace nc {
+
+/**
+ * Calls a function for each index from 0 to size - 1.
+ *
+ * When threads are enabled, the calls are distributed between the calling
+ * thread and the threads of the global thread pool, so the function must
+ * be safe to call concurrently for different indices. The calling thread
+ * takes part in the work, therefore parallelFor can be safely called from
+ * a thread of the pool. When threads are disabled, the calls are made
+ * sequentially in the order of increasing indices.
+ *
+ * If some call throws an exception, the indices that are not taken yet
+ * are skipped, and the first thrown exception is rethrown in the calling
+ * thread after all running calls have finished.
+ *
+ * \param size Number of indices.
+ * \param fun Valid function to call for each index.
+ */
+void parallelFor(std::size_t size, const std::function<void(std::size_t)> &fun);
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
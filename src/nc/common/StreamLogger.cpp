@@ -3,14 +3,21 @@
 
 #include "StreamLogger.h"
 
+#include <QMutexLocker>
 #include <QObject>
 
 namespace nc {
 
 void StreamLogger::log(LogLevel level, const QString &text) {
+    QMutexLocker locker(&mutex_);
     stream_ << tr("[%1] %2").arg(level.getName()).arg(text) << endl;
 }
 
+void StreamLogger::flush() {
+    QMutexLocker locker(&mutex_);
+    stream_.flush();
+}
+
 } // namespace nc
 
 /* vim:set et sts=4 sw=4: */
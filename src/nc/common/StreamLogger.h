@@ -6,6 +6,7 @@
 #include <nc/config.h>
 
 #include <QCoreApplication>
+#include <QMutex>
 #include <QTextStream>
 
 #include "Logger.h"
@@ -14,21 +15,27 @@ namespace nc {
 
 /**
  * Logger printing messages to a stream.
+ * Messages can be logged from several threads concurrently.
  */
 class StreamLogger: public nc::Logger {
     Q_DECLARE_TR_FUNCTIONS(StreamLogger)
 
     QTextStream &stream_;
+    LogLevel minLevel_;
+    QMutex mutex_;
 
 public:
     /**
      * Constructor.
      *
      * \param stream Reference to the stream to print messages to.
+     * \param minLevel Messages with lower levels are not printed.
      */
-    StreamLogger(QTextStream &stream): stream_(stream) {}
+    StreamLogger(QTextStream &stream, LogLevel minLevel = LogLevel::LOWEST): stream_(stream), minLevel_(minLevel) {}
 
     void log(LogLevel level, const QString &text) override;
+    bool isEnabled(LogLevel level) const override { return level >= minLevel_; }
+    void flush() override;
 };
 
 } // namespace nc
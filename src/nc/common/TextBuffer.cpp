@@ -0,0 +1,116 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "TextBuffer.h"
+
+#include <cstring> /* std::strlen */
+
+#include <QIODevice>
+#include <QTextStream>
+
+namespace nc {
+
+void MemoryTextSink::write(const char *data, std::size_t size) {
+    data_.append(data, static_cast<int>(size));
+}
+
+void FileTextSink::write(const char *data, std::size_t size) {
+    if (device_.write(data, static_cast<qint64>(size)) != static_cast<qint64>(size)) {
+        failed_ = true;
+    }
+}
+
+void TextStreamSink::write(const char *data, std::size_t size) {
+    out_ << QString::fromUtf8(data, static_cast<int>(size));
+}
+
+TextBuffer::TextBuffer(TextSink &sink, std::size_t flushThreshold):
+    sink_(sink), flushThreshold_(flushThreshold), position_(0)
+{
+    data_.reserve(flushThreshold + flushThreshold / 4);
+}
+
+TextBuffer::~TextBuffer() {
+    flush();
+}
+
+void TextBuffer::append(const char *string) {
+    std::size_t size = std::strlen(string);
+    data_.insert(data_.end(), string, string + size);
+    position_ += static_cast<int>(size);
+    flushIfFull();
+}
+
+void TextBuffer::append(const QString &string) {
+    const QChar *chars = string.unicode();
+    int size = string.size();
+
+    for (int i = 0; i < size; ++i) {
+        ushort c = chars[i].unicode();
+        if (c >= 0x80) {
+            /* Not ASCII: let Qt do the conversion of the rest. */
+            QByteArray rest = string.mid(i).toUtf8();
+            data_.insert(data_.end(), rest.constData(), rest.constData() + rest.size());
+            break;
+        }
+        data_.push_back(static_cast<char>(c));
+    }
+
+    position_ += size;
+    flushIfFull();
+}
+
+void TextBuffer::appendSpaces(int count) {
+    static const char spaces[] = "                                                                ";
+    static const int maxChunk = sizeof(spaces) - 1;
+
+    position_ += count;
+    while (count > 0) {
+        int chunk = count < maxChunk ? count : maxChunk;
+        data_.insert(data_.end(), spaces, spaces + chunk);
+        count -= chunk;
+    }
+    flushIfFull();
+}
+
+void TextBuffer::appendDecimal(boost::int64_t value) {
+    if (value < 0) {
+        append('-');
+        /* Negate in unsigned arithmetic, so that the minimal value does not overflow. */
+        appendUnsigned(0 - static_cast<boost::uint64_t>(value), 10);
+    } else {
+        appendUnsigned(static_cast<boost::uint64_t>(value), 10);
+    }
+}
+
+void TextBuffer::appendHex(boost::uint64_t value) {
+    appendUnsigned(value, 16);
+}
+
+void TextBuffer::appendUnsigned(boost::uint64_t value, unsigned base) {
+    static const char digits[] = "0123456789abcdef";
+
+    char buffer[64];
+    char *end = buffer + sizeof(buffer);
+    char *begin = end;
+
+    do {
+        *--begin = digits[value % base];
+        value /= base;
+    } while (value != 0);
+
+    data_.insert(data_.end(), begin, end);
+    position_ += static_cast<int>(end - begin);
+    flushIfFull();
+}
+
+void TextBuffer::flush() {
+    if (!data_.empty()) {
+        sink_.write(data_.data(), data_.size());
+        data_.clear();
+    }
+}
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,201 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QTextStream;
+QT_END_NAMESPACE
+
+namespace nc {
+
+/**
+ * Destination of UTF-8 text accumulated by a TextBuffer.
+ */
+class TextSink {
+public:
+    /**
+     * Consumes a chunk of UTF-8 text.
+     *
+     * \param[in] data Valid pointer to the text.
+     * \param[in] size Size of the text in bytes.
+     */
+    virtual void write(const char *data, std::size_t size) = 0;
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~TextSink() {}
+};
+
+/**
+ * Sink keeping the text in memory.
+ */
+class MemoryTextSink: public TextSink {
+    QByteArray data_;
+
+public:
+    void write(const char *data, std::size_t size) override;
+
+    /**
+     * \return The text written so far, in UTF-8.
+     */
+    const QByteArray &data() const { return data_; }
+};
+
+/**
+ * Sink writing the text to an I/O device, e.g. a file.
+ */
+class FileTextSink: public TextSink {
+    QIODevice &device_;
+    bool failed_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param device Device opened for writing.
+     */
+    explicit FileTextSink(QIODevice &device): device_(device), failed_(false) {}
+
+    void write(const char *data, std::size_t size) override;
+
+    /**
+     * \return True iff some write to the device has failed.
+     */
+    bool failed() const { return failed_; }
+};
+
+/**
+ * Sink writing the text to a text stream.
+ */
+class TextStreamSink: public TextSink {
+    QTextStream &out_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param out Output stream.
+     */
+    explicit TextStreamSink(QTextStream &out): out_(out) {}
+
+    void write(const char *data, std::size_t size) override;
+};
+
+/**
+ * Growable buffer of UTF-8 text which is passed to a sink in large chunks.
+ *
+ * In addition to the number of bytes, the buffer tracks the length of the
+ * text written so far in UTF-16 code units, i.e. the position the next
+ * character would have in a QString containing all the text.
+ *
+ * Appending ASCII strings, indentation, and integers does not allocate
+ * temporary objects. Appending a QString converts it on the fly, taking
+ * a fast path when the string consists of ASCII characters only.
+ */
+class TextBuffer: boost::noncopyable {
+    TextSink &sink_;
+    std::vector<char> data_;
+    std::size_t flushThreshold_;
+    int position_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param sink Sink to pass the text to.
+     * \param flushThreshold Number of buffered bytes after which the buffer is flushed.
+     */
+    explicit TextBuffer(TextSink &sink, std::size_t flushThreshold = 1 << 16);
+
+    /**
+     * Destructor. Flushes the buffer.
+     */
+    ~TextBuffer();
+
+    /**
+     * \return Length of the text written so far in UTF-16 code units.
+     */
+    int position() const { return position_; }
+
+    /**
+     * Appends an ASCII character.
+     *
+     * \param c The character.
+     */
+    void append(char c) {
+        data_.push_back(c);
+        ++position_;
+        flushIfFull();
+    }
+
+    /**
+     * Appends an ASCII string.
+     *
+     * \param[in] string Valid pointer to a null-terminated string.
+     */
+    void append(const char *string);
+
+    /**
+     * Appends a string.
+     *
+     * \param[in] string The string.
+     */
+    void append(const QString &string);
+
+    /**
+     * Appends the given number of spaces.
+     *
+     * \param count Number of spaces.
+     */
+    void appendSpaces(int count);
+
+    /**
+     * Appends the decimal representation of a number.
+     *
+     * \param value The number.
+     */
+    void appendDecimal(boost::int64_t value);
+
+    /**
+     * Appends the lowercase hexadecimal representation of a number, without a prefix.
+     *
+     * \param value The number.
+     */
+    void appendHex(boost::uint64_t value);
+
+    /**
+     * Passes the buffered text to the sink.
+     */
+    void flush();
+
+private:
+    void flushIfFull() {
+        if (data_.size() >= flushThreshold_) {
+            flush();
+        }
+    }
+
+    void appendUnsigned(boost::uint64_t value, unsigned base);
+};
+
+inline TextBuffer &operator<<(TextBuffer &out, char c) { out.append(c); return out; }
+inline TextBuffer &operator<<(TextBuffer &out, const char *string) { out.append(string); return out; }
+inline TextBuffer &operator<<(TextBuffer &out, const QString &string) { out.append(string); return out; }
+
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
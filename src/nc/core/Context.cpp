@@ -24,7 +24,10 @@
 
 #include "Context.h"
 
+#include <cassert>
+
 #include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
 
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/arch/Instructions.h>
@@ -46,7 +49,9 @@ namespace core {
 
 Context::Context():
     image_(std::make_shared<image::Image>()),
-    instructions_(std::make_shared<arch::Instructions>())
+    instructions_(std::make_shared<arch::Instructions>()),
+    treeComplete_(false),
+    keepStreamedDefinitions_(false)
 {}
 
 Context::~Context() {}
@@ -100,11 +105,20 @@ void Context::setTypes(std::unique_ptr<ir::types::Types> types) {
     types_ = std::move(types);
 }
 
-void Context::setTree(std::unique_ptr<likec::Tree> tree) {
+void Context::setTree(std::unique_ptr<likec::Tree> tree, bool complete,
+    boost::unordered_map<const likec::FunctionDefinition *, const ir::Function *> definition2function)
+{
     tree_ = std::move(tree);
+    treeComplete_ = complete;
+    definition2function_ = std::move(definition2function);
     Q_EMIT treeChanged();
 }
 
+const ir::Function *Context::getFunction(const likec::FunctionDefinition *definition) const {
+    assert(definition != nullptr);
+    return nc::find(definition2function_, definition);
+}
+
 } // namespace core
 } // namespace nc
 
@@ -25,11 +25,15 @@
 
 #include <nc/config.h>
 
+#include <functional>
 #include <memory> /* For std::unique_ptr. */
 
 #include <QObject>
 
+#include <boost/unordered_map.hpp>
+
 #include <nc/common/CancellationToken.h>
+#include <nc/common/FocusToken.h>
 #include <nc/common/LogToken.h>
 
 namespace nc {
@@ -56,6 +60,9 @@ namespace ir {
     namespace cflow {
         class Graphs;
     }
+    namespace cgen {
+        class DefinitionCache;
+    }
     namespace dflow {
         class Dataflows;
     }
@@ -71,9 +78,13 @@ namespace ir {
 }
 
 namespace likec {
+    class Declaration;
+    class FunctionDefinition;
     class Tree;
 }
 
+class SnapshotResults;
+
 /**
  * This class stores all the information that is required and produced during decompilation.
  */
@@ -93,8 +104,15 @@ class Context: public QObject {
     std::unique_ptr<ir::liveness::Livenesses> livenesses_; ///< Liveness information.
     std::unique_ptr<ir::types::Types> types_; ///< Information about types.
     std::unique_ptr<likec::Tree> tree_; ///< Abstract syntax tree of the LikeC program.
+    bool treeComplete_; ///< Whether the tree contains all the functions, i.e. its generation was not interrupted.
+    boost::unordered_map<const likec::FunctionDefinition *, const ir::Function *> definition2function_; ///< Functions of the definitions in the tree.
+    std::function<void(const likec::Declaration *)> declarationSink_; ///< Consumer of top-level declarations being generated.
+    bool keepStreamedDefinitions_; ///< Whether bodies of definitions passed to the sink are kept.
+    std::shared_ptr<const ir::cgen::DefinitionCache> definitionCache_; ///< Cache of generated function definitions.
+    std::shared_ptr<const SnapshotResults> snapshotResults_; ///< Decompilation results loaded from a snapshot.
     LogToken logToken_; ///< Log token.
     CancellationToken cancellationToken_; ///< Cancellation token.
+    FocusToken focusToken_; ///< Addresses of the code the user is interested in.
 
 public:
     /**
@@ -285,14 +303,93 @@ public:
      * Sets the LikeC tree.
      *
      * \param tree Valid pointer to the LikeC tree.
+     * \param complete Whether the tree contains all the functions. A tree is
+     *                 incomplete when its generation was interrupted, e.g.
+     *                 cancelled, after some declarations were streamed.
+     * \param definition2function Mapping of the function definitions in the tree
+     *                            to the functions they were generated from.
      */
-    void setTree(std::unique_ptr<likec::Tree> tree);
+    void setTree(std::unique_ptr<likec::Tree> tree, bool complete,
+        boost::unordered_map<const likec::FunctionDefinition *, const ir::Function *> definition2function);
 
     /**
      * \return The LikeC tree. Can be nullptr.
      */
     likec::Tree *tree() const { return tree_.get(); }
 
+    /**
+     * \return True if the LikeC tree is set and contains all the functions.
+     */
+    bool isTreeComplete() const { return tree_ && treeComplete_; }
+
+    /**
+     * \param definition Valid pointer to a function definition in the LikeC tree.
+     *
+     * \return Pointer to the function the definition was generated from. Can be nullptr.
+     */
+    const ir::Function *getFunction(const likec::FunctionDefinition *definition) const;
+
+    /**
+     * Sets the consumer of top-level declarations of the LikeC tree.
+     *
+     * When set, the code generator passes each top-level declaration to the
+     * sink as soon as the declaration is complete, in the order in which the
+     * declarations appear in the compilation unit. Unless keepDefinitions
+     * is true, once a function definition has been passed to the sink, its
+     * body is freed, so that the bodies of all functions are never kept in
+     * memory at once. The tree set via setTree() then contains only the
+     * headers of function definitions.
+     *
+     * Declarations passed to the sink are not modified afterwards.
+     *
+     * \param sink Consumer of declarations. Can be empty.
+     * \param keepDefinitions Whether to keep the bodies of function definitions.
+     */
+    void setDeclarationSink(std::function<void(const likec::Declaration *)> sink, bool keepDefinitions = false) {
+        declarationSink_ = std::move(sink);
+        keepStreamedDefinitions_ = keepDefinitions;
+    }
+
+    /**
+     * \return Consumer of top-level declarations of the LikeC tree. Can be empty.
+     */
+    const std::function<void(const likec::Declaration *)> &declarationSink() const { return declarationSink_; }
+
+    /**
+     * \return Whether bodies of function definitions passed to the declaration sink are kept.
+     */
+    bool keepStreamedDefinitions() const { return keepStreamedDefinitions_; }
+
+    /**
+     * Sets the cache of generated function definitions.
+     *
+     * Definitions taken from the cache have empty blocks: their bodies
+     * are kept as printed text (see likec::FunctionDefinition::bodyText()).
+     * Therefore, the cache must not be set when the bodies of definitions
+     * are inspected, e.g. when they are shown in the GUI.
+     *
+     * \param cache Pointer to the cache. Can be nullptr.
+     */
+    void setDefinitionCache(const std::shared_ptr<const ir::cgen::DefinitionCache> &cache) { definitionCache_ = cache; }
+
+    /**
+     * \return Pointer to the cache of generated function definitions. Can be nullptr.
+     */
+    const std::shared_ptr<const ir::cgen::DefinitionCache> &definitionCache() const { return definitionCache_; }
+
+    /**
+     * Sets the decompilation results loaded from a snapshot.
+     * They stay valid only as long as SnapshotResults::matches() the instructions.
+     *
+     * \param results Pointer to the results. Can be nullptr.
+     */
+    void setSnapshotResults(const std::shared_ptr<const SnapshotResults> &results) { snapshotResults_ = results; }
+
+    /**
+     * \return Pointer to the decompilation results loaded from a snapshot. Can be nullptr.
+     */
+    const std::shared_ptr<const SnapshotResults> &snapshotResults() const { return snapshotResults_; }
+
     /**
      * Sets cancellation token.
      *
@@ -305,6 +402,19 @@ public:
      */
     const CancellationToken &cancellationToken() const { return cancellationToken_; }
 
+    /**
+     * Sets the token telling which code the user is interested in.
+     * Analyses may process this code first.
+     *
+     * \param token Focus token.
+     */
+    void setFocusToken(const FocusToken &token) { focusToken_ = token; }
+
+    /**
+     * \return Focus token.
+     */
+    const FocusToken &focusToken() const { return focusToken_; }
+
     /**
      * Sets the log token.
      *
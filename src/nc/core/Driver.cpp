@@ -20,6 +20,7 @@
 
 #include "Context.h"
 #include "MasterAnalyzer.h"
+#include "Snapshot.h"
 
 namespace nc {
 namespace core {
@@ -31,6 +32,17 @@ void Driver::parse(Context &context, const QString &filename) {
         throw nc::Exception(tr("Could not open file \"%1\" for reading.").arg(filename));
     }
 
+    if (Snapshot::isSnapshot(&source)) {
+        source.close();
+
+        context.logToken().info(tr("Loading snapshot %1...").arg(filename));
+
+        Snapshot::load(context, filename);
+
+        context.logToken().info(tr("Loading completed."));
+        return;
+    }
+
     context.logToken().info(tr("Choosing a parser for %1...").arg(filename));
 
     const input::Parser *suitableParser = nullptr;
@@ -52,6 +64,10 @@ void Driver::parse(Context &context, const QString &filename) {
 
     suitableParser->parse(&source, context.image().get(), context.logToken());
 
+    context.logToken().info(tr("Demangling symbols..."));
+
+    context.image()->demangleSymbols();
+
     context.logToken().info(tr("Parsing completed."));
 }
 
@@ -28,6 +28,7 @@ class Driver {
 public:
     /**
      * Parses a file by the first suitable parser.
+     * If the file is a snapshot, loads the snapshot instead.
      *
      * \param context Context.
      * \param filename Name of the file to parse.
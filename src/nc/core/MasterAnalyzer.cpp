@@ -25,6 +25,7 @@
 #include "MasterAnalyzer.h"
 
 #include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
 #include <nc/common/make_unique.h>
 
 #include <nc/core/Context.h>
@@ -44,6 +45,7 @@
 #include <nc/core/ir/cflow/GraphBuilder.h>
 #include <nc/core/ir/cflow/StructureAnalyzer.h>
 #include <nc/core/ir/cgen/CodeGenerator.h>
+#include <nc/core/ir/cgen/DefinitionCache.h>
 #include <nc/core/ir/cgen/NameGenerator.h>
 #include <nc/core/ir/dflow/Dataflows.h>
 #include <nc/core/ir/dflow/DataflowAnalyzer.h>
@@ -118,14 +120,16 @@ void MasterAnalyzer::dataflowAnalysis(Context &context) const {
 }
 
 void MasterAnalyzer::dataflowAnalysis(Context &context, ir::Function *function) const {
-    context.logToken().info(tr("Dataflow analysis of %1.").arg(getFunctionName(context, function)));
+    context.logToken().logLazily(LogLevel::INFO, [&]() {
+        return tr("Dataflow analysis of %1.").arg(getFunctionName(context, function));
+    });
 
     std::unique_ptr<ir::dflow::Dataflow> dataflow(new ir::dflow::Dataflow());
 
     context.hooks()->instrument(function, dataflow.get());
 
     ir::dflow::DataflowAnalyzer(*dataflow, context.image()->platform().architecture(), context.cancellationToken(),
-                                context.logToken()).analyze(ir::CFG(function->basicBlocks()));
+                                context.logToken()).analyze(function->cfg());
 
     context.dataflows()->emplace(function, std::move(dataflow));
 }
@@ -154,13 +158,32 @@ void MasterAnalyzer::livenessAnalysis(Context &context) const {
 
     context.setLivenesses(std::make_unique<ir::liveness::Livenesses>());
 
+    std::vector<const ir::Function *> functions;
     foreach (const ir::Function *function, context.functions()->list()) {
-        livenessAnalysis(context, function);
+        functions.push_back(function);
+    }
+
+    std::vector<std::unique_ptr<ir::liveness::Liveness>> livenesses(functions.size());
+
+    parallelFor(functions.size(), [&](std::size_t index) {
+        livenesses[index] = computeLiveness(context, functions[index]);
+    });
+    context.logToken().flush();
+
+    /* Fill the map in the order of functions, so that its iteration order does not depend on scheduling. */
+    for (std::size_t index = 0; index < functions.size(); ++index) {
+        context.livenesses()->emplace(functions[index], std::move(livenesses[index]));
     }
 }
 
 void MasterAnalyzer::livenessAnalysis(Context &context, const ir::Function *function) const {
-    context.logToken().info(tr("Liveness analysis of %1.").arg(getFunctionName(context, function)));
+    context.livenesses()->emplace(function, computeLiveness(context, function));
+}
+
+std::unique_ptr<ir::liveness::Liveness> MasterAnalyzer::computeLiveness(Context &context, const ir::Function *function) const {
+    context.logToken().logLazily(LogLevel::INFO, [&]() {
+        return tr("Liveness analysis of %1.").arg(getFunctionName(context, function));
+    });
 
     std::unique_ptr<ir::liveness::Liveness> liveness(new ir::liveness::Liveness());
 
@@ -170,7 +193,7 @@ void MasterAnalyzer::livenessAnalysis(Context &context, const ir::Function *func
         context.signatures(), context.logToken())
     .analyze();
 
-    context.livenesses()->emplace(function, std::move(liveness));
+    return liveness;
 }
 
 void MasterAnalyzer::reconstructTypes(Context &context) const {
@@ -199,7 +222,9 @@ void MasterAnalyzer::structuralAnalysis(Context &context) const {
 }
 
 void MasterAnalyzer::structuralAnalysis(Context &context, const ir::Function *function) const {
-    context.logToken().info(tr("Structural analysis of %1.").arg(getFunctionName(context, function)));
+    context.logToken().logLazily(LogLevel::INFO, [&]() {
+        return tr("Structural analysis of %1.").arg(getFunctionName(context, function));
+    });
 
     std::unique_ptr<ir::cflow::Graph> graph(new ir::cflow::Graph());
 
@@ -214,12 +239,33 @@ void MasterAnalyzer::generateTree(Context &context) const {
 
     auto tree = std::make_unique<nc::core::likec::Tree>();
 
-    ir::cgen::CodeGenerator(*tree, *context.image(), *context.functions(), *context.hooks(),
+    ir::cgen::CodeGenerator generator(*tree, *context.image(), *context.functions(), *context.hooks(),
         *context.signatures(), *context.dataflows(), *context.variables(), *context.graphs(),
-        *context.livenesses(), *context.types(), context.cancellationToken())
-        .makeCompilationUnit();
+        *context.livenesses(), *context.types(), context.cancellationToken());
+    generator.setDeclarationSink(context.declarationSink(), context.keepStreamedDefinitions());
+    generator.setFocusToken(context.focusToken());
+    generator.setDefinitionCache(context.definitionCache().get());
+
+    try {
+        generator.makeCompilationUnit();
+    } catch (...) {
+        /*
+         * Declarations already passed to the sink must stay valid.
+         * The tree is marked incomplete, so that it is not taken for
+         * the result of a finished decompilation.
+         */
+        if (context.declarationSink()) {
+            context.setTree(std::move(tree), false, std::move(generator.definition2function()));
+        }
+        throw;
+    }
+
+    context.setTree(std::move(tree), true, std::move(generator.definition2function()));
 
-    context.setTree(std::move(tree));
+    if (auto cache = context.definitionCache()) {
+        context.logToken().info(tr("Definitions taken from the cache: %1, generated: %2.")
+            .arg(cache->hitCount()).arg(cache->missCount()));
+    }
 }
 
 void MasterAnalyzer::decompile(Context &context) const {
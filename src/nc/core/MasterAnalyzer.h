@@ -25,6 +25,8 @@
 
 #include <nc/config.h>
 
+#include <memory>
+
 #include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
 
 namespace nc {
@@ -36,6 +38,10 @@ namespace ir {
     namespace calling {
         class CalleeId;
     }
+
+    namespace liveness {
+        class Liveness;
+    }
 }
 
 class Context;
@@ -122,6 +128,7 @@ public:
 
     /**
      * Performs liveness analysis on all functions.
+     * Functions are analyzed in parallel using computeLiveness().
      *
      * \param context Context.
      */
@@ -135,6 +142,17 @@ public:
      */
     virtual void livenessAnalysis(Context &context, const ir::Function *function) const;
 
+    /**
+     * Computes liveness information for the given function.
+     * Can be called concurrently for different functions.
+     *
+     * \param context Context.
+     * \param function Valid pointer to the function.
+     *
+     * \return Valid pointer to the liveness information.
+     */
+    virtual std::unique_ptr<ir::liveness::Liveness> computeLiveness(Context &context, const ir::Function *function) const;
+
     /**
      * Performs structural analysis of all functions.
      *
@@ -0,0 +1,676 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Snapshot.h"
+
+#include <algorithm> /* std::min, std::max */
+#include <cassert>
+#include <cstring> /* memcmp, memcpy, memset */
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QTextStream>
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
+#include <nc/common/TextBuffer.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/arch/Architecture.h>
+#include <nc/core/arch/Disassembler.h>
+#include <nc/core/arch/Instructions.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Relocation.h>
+#include <nc/core/image/Section.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Functions.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Term.h>
+#include <nc/core/ir/calling/FunctionSignature.h>
+#include <nc/core/ir/calling/Signatures.h>
+#include <nc/core/ir/cgen/NameGenerator.h>
+#include <nc/core/likec/CompilationUnit.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
+
+#include "Context.h"
+
+namespace nc {
+namespace core {
+
+namespace {
+
+/** Magic bytes at the beginning of a snapshot. */
+const char snapshotMagic[8] = { 'S', 'N', 'O', 'W', 'S', 'N', 'A', 'P' };
+
+/** Current version of the snapshot format. */
+const quint32 snapshotVersion = 2;
+
+/** Size of the header: magic, version, offset and size of the metadata block. */
+const qint64 headerSize = sizeof(snapshotMagic) + sizeof(quint32) + 2 * sizeof(quint64);
+
+/** Size of the chunks in which section contents are copied to a snapshot. */
+const ByteSize copyChunkSize = 1 << 20;
+
+/** Flags of a section, as stored in a snapshot. */
+enum SectionFlags {
+    ALLOCATED  = 0x01,
+    READABLE   = 0x02,
+    WRITABLE   = 0x04,
+    EXECUTABLE = 0x08,
+    CODE       = 0x10,
+    DATA       = 0x20,
+    BSS        = 0x40
+};
+
+/**
+ * Read-only memory mapping of a whole snapshot file.
+ */
+class Mapping: boost::noncopyable {
+    QFile file_;
+    const uchar *data_;
+    qint64 size_;
+
+public:
+    explicit Mapping(const QString &filename): file_(filename), data_(nullptr), size_(0) {
+        if (!file_.open(QIODevice::ReadOnly)) {
+            throw nc::Exception(Snapshot::tr("Could not open file \"%1\" for reading.").arg(filename));
+        }
+        size_ = file_.size();
+        if (size_ > 0) {
+            data_ = file_.map(0, size_);
+            if (!data_) {
+                throw nc::Exception(Snapshot::tr("Could not map file \"%1\" into memory.").arg(filename));
+            }
+        }
+    }
+
+    ~Mapping() {
+        if (data_) {
+            file_.unmap(const_cast<uchar *>(data_));
+        }
+    }
+
+    const char *data() const { return reinterpret_cast<const char *>(data_); }
+    qint64 size() const { return size_; }
+};
+
+/**
+ * Contents of a section read directly from a mapped snapshot.
+ * Bytes past the stored contents read as zeros.
+ */
+class MappedSectionContent: public image::ByteSource {
+    std::shared_ptr<const Mapping> mapping_;
+    ByteAddr addr_;
+    const char *data_;
+    ByteSize size_;
+
+public:
+    MappedSectionContent(std::shared_ptr<const Mapping> mapping, ByteAddr addr, const char *data, ByteSize size):
+        mapping_(std::move(mapping)), addr_(addr), data_(data), size_(size)
+    {}
+
+    ByteSize readBytes(ByteAddr addr, void *buf, ByteSize size) const override {
+        auto offset = addr - addr_;
+        if (offset < 0 || size <= 0) {
+            return 0;
+        }
+
+        auto copiedSize = std::max(ByteSize(0), std::min(size, size_ - offset));
+        if (copiedSize > 0) {
+            memcpy(buf, data_ + offset, copiedSize);
+        }
+        if (copiedSize < size) {
+            memset(static_cast<char *>(buf) + copiedSize, 0, size - copiedSize);
+        }
+
+        return size;
+    }
+};
+
+void checkStatus(const QDataStream &stream, const QString &filename) {
+    if (stream.status() != QDataStream::Ok) {
+        throw nc::Exception(Snapshot::tr("File %1 is not a valid snapshot.").arg(filename));
+    }
+}
+
+void checkWrite(bool success, const QString &filename) {
+    if (!success) {
+        throw nc::Exception(Snapshot::tr("Could not write file \"%1\".").arg(filename));
+    }
+}
+
+/**
+ * \param term Valid pointer to a term.
+ *
+ * \return The printed term.
+ */
+QString printTerm(const ir::Term *term) {
+    QString result;
+    QTextStream out(&result);
+    out << *term;
+    return result;
+}
+
+/**
+ * \param a Set of instructions.
+ * \param b Set of instructions.
+ *
+ * \return True iff both sets have instructions of the same sizes at the same addresses.
+ */
+bool haveSameInstructions(const arch::Instructions &a, const arch::Instructions &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    auto i = b.all().begin();
+    foreach (const auto &instruction, a.all()) {
+        if (instruction->addr() != (*i)->addr() || instruction->size() != (*i)->size()) {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool SnapshotResults::matches(const arch::Instructions &instructions) const {
+    if (instructions.size() != instructions_.size()) {
+        return false;
+    }
+    auto i = instructions_.begin();
+    foreach (const auto &instruction, instructions.all()) {
+        if (instruction->addr() != i->first || static_cast<quint64>(instruction->size()) != i->second) {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+const SnapshotResults::Function *SnapshotResults::getDefinedFunction(std::size_t index) const {
+    assert(index < declarations_.size());
+
+    auto function = declarations_[index].function;
+    return function >= 0 ? &functions_[static_cast<std::size_t>(function)] : nullptr;
+}
+
+QString SnapshotResults::getDeclarationText(std::size_t index) const {
+    assert(index < declarations_.size());
+
+    const auto &declaration = declarations_[index];
+    return QString::fromUtf8(declaration.text.get(), static_cast<int>(declaration.size));
+}
+
+bool Snapshot::isSnapshot(QIODevice *source) {
+    assert(source != nullptr);
+
+    return source->peek(sizeof(snapshotMagic)) == QByteArray::fromRawData(snapshotMagic, sizeof(snapshotMagic));
+}
+
+void Snapshot::save(const image::Image &image, const arch::Instructions &instructions, const QString &filename,
+                    const Context *results)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw nc::Exception(tr("Could not open file \"%1\" for writing.").arg(filename));
+    }
+
+    /*
+     * The contents of sections and the texts of declarations are written
+     * right after the header, without being collected in memory. The
+     * metadata, which refers to them by offsets, follows.
+     */
+    checkWrite(file.seek(headerSize), filename);
+
+    auto writeContents = [&](const char *data, qint64 size) {
+        checkWrite(file.write(data, size) == size, filename);
+    };
+    auto contentsPosition = [&]() -> quint64 {
+        return static_cast<quint64>(file.pos() - headerSize);
+    };
+
+    QByteArray metadata;
+    {
+        QDataStream out(&metadata, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_4_8);
+
+        const auto &platform = image.platform();
+        out << (platform.architecture() ? platform.architecture()->name() : QString());
+        out << static_cast<qint32>(platform.operatingSystem());
+        out << static_cast<qint32>(platform.intSize());
+
+        out << static_cast<bool>(image.entrypoint());
+        out << static_cast<qint64>(image.entrypoint() ? *image.entrypoint() : 0);
+
+        boost::unordered_map<const image::Section *, qint64> section2index;
+
+        out << static_cast<quint64>(image.sections().size());
+        foreach (const image::Section *section, image.sections()) {
+            section2index.insert(std::make_pair(section, static_cast<qint64>(section2index.size())));
+
+            quint32 flags = 0;
+            if (section->isAllocated())  flags |= ALLOCATED;
+            if (section->isReadable())   flags |= READABLE;
+            if (section->isWritable())   flags |= WRITABLE;
+            if (section->isExecutable()) flags |= EXECUTABLE;
+            if (section->isCode())       flags |= CODE;
+            if (section->isData())       flags |= DATA;
+            if (section->isBss())        flags |= BSS;
+
+            auto contentOffset = contentsPosition();
+
+            if (!section->isBss() && section->size() > 0) {
+                std::vector<char> chunk(static_cast<std::size_t>(std::min(section->size(), copyChunkSize)));
+                for (ByteSize done = 0; done < section->size();) {
+                    auto size = std::min(section->size() - done, copyChunkSize);
+                    auto read = section->readBytes(section->addr() + done, chunk.data(), size);
+                    if (read <= 0) {
+                        break;
+                    }
+                    writeContents(chunk.data(), read);
+                    done += read;
+                    if (read < size) {
+                        break;
+                    }
+                }
+            }
+
+            out << section->name();
+            out << static_cast<qint64>(section->addr());
+            out << static_cast<quint64>(section->size());
+            out << flags;
+            out << contentOffset;
+            out << contentsPosition() - contentOffset;
+        }
+
+        boost::unordered_map<const image::Symbol *, quint64> symbol2index;
+
+        out << static_cast<quint64>(image.symbols().size());
+        foreach (const image::Symbol *symbol, image.symbols()) {
+            symbol2index.insert(std::make_pair(symbol, static_cast<quint64>(symbol2index.size())));
+
+            out << static_cast<qint32>(symbol->type());
+            out << symbol->name();
+            out << static_cast<bool>(symbol->value());
+            out << static_cast<quint64>(symbol->value() ? *symbol->value() : 0);
+            auto i = section2index.find(symbol->section());
+            out << (i != section2index.end() ? i->second : qint64(-1));
+        }
+
+        out << static_cast<quint64>(image.relocations().size());
+        foreach (const image::Relocation *relocation, image.relocations()) {
+            auto i = symbol2index.find(relocation->symbol());
+            if (i == symbol2index.end()) {
+                throw nc::Exception(tr("Relocation at address 0x%1 refers to a symbol that is not in the image.")
+                    .arg(relocation->address(), 0, 16));
+            }
+
+            out << static_cast<qint64>(relocation->address());
+            out << i->second;
+            out << static_cast<qint64>(relocation->size());
+            out << static_cast<qint64>(relocation->addend());
+        }
+
+        out << static_cast<quint64>(instructions.size());
+        foreach (const auto &instruction, instructions.all()) {
+            out << static_cast<qint64>(instruction->addr());
+            out << static_cast<quint64>(instruction->size());
+        }
+
+        bool hasResults = results && results->isTreeComplete() && results->functions() && results->signatures() &&
+            results->instructions() && haveSameInstructions(*results->instructions(), instructions);
+        out << hasResults;
+
+        if (hasResults) {
+            ir::cgen::NameGenerator nameGenerator(image);
+            boost::unordered_map<const ir::Function *, qint64> function2index;
+
+            std::vector<const ir::Function *> functions;
+            foreach (const ir::Function *function, results->functions()->list()) {
+                if (function->entry() && function->entry()->address()) {
+                    functions.push_back(function);
+                }
+            }
+
+            out << static_cast<quint64>(functions.size());
+            for (std::size_t index = 0; index < functions.size(); ++index) {
+                auto function = functions[index];
+
+                function2index[function] = static_cast<qint64>(index);
+
+                out << static_cast<qint64>(*function->entry()->address());
+                out << nameGenerator.getFunctionName(function).name();
+
+                std::vector<std::pair<ByteAddr, ByteAddr>> ranges;
+                foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
+                    if (basicBlock->address() && basicBlock->successorAddress()) {
+                        ranges.push_back(std::make_pair(*basicBlock->address(), *basicBlock->successorAddress()));
+                    }
+                }
+                out << static_cast<quint64>(ranges.size());
+                foreach (const auto &range, ranges) {
+                    out << static_cast<qint64>(range.first) << static_cast<qint64>(range.second);
+                }
+
+                auto signature = results->signatures()->getSignature(function);
+                out << static_cast<bool>(signature);
+                if (signature) {
+                    out << signature->variadic();
+                    out << static_cast<quint64>(signature->arguments().size());
+                    foreach (const auto &argument, signature->arguments()) {
+                        out << printTerm(argument.get());
+                    }
+                    out << (signature->returnValue() ? printTerm(signature->returnValue().get()) : QString());
+                }
+            }
+
+            const auto &declarations = results->tree()->root()->declarations();
+
+            out << static_cast<quint64>(declarations.size());
+            foreach (const auto &declaration, declarations) {
+                MemoryTextSink sink;
+                {
+                    TextBuffer buffer(sink);
+                    likec::TreePrinter(buffer).print(declaration.get());
+                }
+
+                auto offset = contentsPosition();
+                writeContents(sink.data().constData(), sink.data().size());
+
+                qint64 function = -1;
+                if (auto definition = declaration->as<likec::FunctionDefinition>()) {
+                    if (auto definitionFunction = results->getFunction(definition)) {
+                        function = nc::find(function2index, definitionFunction, -1);
+                    }
+                }
+
+                out << offset << static_cast<quint64>(sink.data().size()) << function;
+            }
+        }
+
+        checkWrite(out.status() == QDataStream::Ok, filename);
+    }
+
+    auto metadataOffset = file.pos();
+    writeContents(metadata.constData(), metadata.size());
+
+    checkWrite(file.seek(0), filename);
+    {
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_4_8);
+        out.writeRawData(snapshotMagic, sizeof(snapshotMagic));
+        out << snapshotVersion;
+        out << static_cast<quint64>(metadataOffset);
+        out << static_cast<quint64>(metadata.size());
+        checkWrite(out.status() == QDataStream::Ok, filename);
+    }
+}
+
+void Snapshot::load(Context &context, const QString &filename) {
+    auto mapping = std::make_shared<Mapping>(filename);
+
+    if (mapping->size() < headerSize ||
+        memcmp(mapping->data(), snapshotMagic, sizeof(snapshotMagic)) != 0)
+    {
+        throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+    }
+
+    quint32 version;
+    quint64 metadataOffset;
+    quint64 metadataSize;
+    {
+        QByteArray header = QByteArray::fromRawData(mapping->data(), static_cast<int>(headerSize));
+        QDataStream in(header);
+        in.setVersion(QDataStream::Qt_4_8);
+        in.skipRawData(sizeof(snapshotMagic));
+        in >> version >> metadataOffset >> metadataSize;
+        checkStatus(in, filename);
+    }
+
+    if (version != snapshotVersion) {
+        throw nc::Exception(tr("Snapshot %1 has unsupported version %2.").arg(filename).arg(version));
+    }
+
+    const quint64 fileSize = static_cast<quint64>(mapping->size());
+    if (metadataOffset < static_cast<quint64>(headerSize) || metadataOffset > fileSize ||
+        metadataSize > fileSize - metadataOffset || metadataSize > static_cast<quint64>(std::numeric_limits<int>::max()))
+    {
+        throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+    }
+
+    /* The contents of sections and the texts of declarations lie between the header and the metadata. */
+    const char *contents = mapping->data() + headerSize;
+    const quint64 contentsSize = metadataOffset - headerSize;
+
+    auto checkContents = [&](quint64 offset, quint64 size) {
+        if (offset > contentsSize || size > contentsSize - offset) {
+            throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+        }
+    };
+
+    /* Decode the metadata in place, without copying the file. */
+    QByteArray bytes = QByteArray::fromRawData(mapping->data() + metadataOffset, static_cast<int>(metadataSize));
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    auto image = std::make_shared<image::Image>();
+
+    QString architectureName;
+    qint32 operatingSystem;
+    qint32 intSize;
+    in >> architectureName >> operatingSystem >> intSize;
+    checkStatus(in, filename);
+
+    image->platform().setArchitecture(architectureName);
+    if (!image->platform().architecture()) {
+        throw nc::Exception(tr("Snapshot %1 uses unknown architecture %2.").arg(filename).arg(architectureName));
+    }
+    image->platform().setOperatingSystem(static_cast<image::Platform::OperatingSystem>(operatingSystem));
+    image->platform().setIntSize(intSize);
+
+    bool hasEntrypoint;
+    qint64 entrypoint;
+    in >> hasEntrypoint >> entrypoint;
+    if (hasEntrypoint) {
+        image->setEntryPoint(entrypoint);
+    }
+
+    std::vector<const image::Section *> sections;
+
+    quint64 sectionCount;
+    in >> sectionCount;
+    checkStatus(in, filename);
+
+    for (quint64 i = 0; i < sectionCount; ++i) {
+        QString name;
+        qint64 addr;
+        quint64 size, contentOffset, contentSize;
+        quint32 flags;
+        in >> name >> addr >> size >> flags >> contentOffset >> contentSize;
+        checkStatus(in, filename);
+        checkContents(contentOffset, contentSize);
+
+        auto section = std::make_unique<image::Section>(name, addr, static_cast<ByteSize>(size));
+        section->setAllocated(flags & ALLOCATED);
+        section->setReadable(flags & READABLE);
+        section->setWritable(flags & WRITABLE);
+        section->setExecutable(flags & EXECUTABLE);
+        section->setCode(flags & CODE);
+        section->setData(flags & DATA);
+        section->setBss(flags & BSS);
+
+        if (contentSize > 0) {
+            section->setExternalByteSource(std::make_unique<MappedSectionContent>(
+                mapping, addr, contents + contentOffset, static_cast<ByteSize>(contentSize)));
+        }
+
+        sections.push_back(section.get());
+        image->addSection(std::move(section));
+    }
+
+    std::vector<const image::Symbol *> symbols;
+
+    quint64 symbolCount;
+    in >> symbolCount;
+    checkStatus(in, filename);
+
+    for (quint64 i = 0; i < symbolCount; ++i) {
+        qint32 type;
+        QString name;
+        bool hasValue;
+        quint64 value;
+        qint64 sectionIndex;
+        in >> type >> name >> hasValue >> value >> sectionIndex;
+        checkStatus(in, filename);
+
+        if (sectionIndex >= static_cast<qint64>(sections.size())) {
+            throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+        }
+
+        symbols.push_back(image->addSymbol(std::make_unique<image::Symbol>(
+            static_cast<image::SymbolType::Type>(type),
+            name,
+            hasValue ? boost::optional<ConstantValue>(value) : boost::none,
+            sectionIndex >= 0 ? sections[static_cast<std::size_t>(sectionIndex)] : nullptr)));
+    }
+
+    quint64 relocationCount;
+    in >> relocationCount;
+    checkStatus(in, filename);
+
+    for (quint64 i = 0; i < relocationCount; ++i) {
+        qint64 address, size, addend;
+        quint64 symbolIndex;
+        in >> address >> symbolIndex >> size >> addend;
+        checkStatus(in, filename);
+
+        if (symbolIndex >= symbols.size()) {
+            throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+        }
+
+        image->addRelocation(std::make_unique<image::Relocation>(address, symbols[symbolIndex], size, addend));
+    }
+
+    image->demangleSymbols();
+
+    /* Disassemble the instructions again, one by one. */
+    auto instructions = std::make_shared<arch::Instructions>();
+    auto disassembler = image->platform().architecture()->createDisassembler();
+    std::size_t failures = 0;
+
+    auto results = std::make_shared<SnapshotResults>();
+
+    quint64 instructionCount;
+    in >> instructionCount;
+    checkStatus(in, filename);
+
+    for (quint64 i = 0; i < instructionCount; ++i) {
+        qint64 addr;
+        quint64 size;
+        in >> addr >> size;
+        checkStatus(in, filename);
+
+        results->instructions_.push_back(std::make_pair(addr, size));
+
+        auto instruction = disassembler->disassembleSingleInstruction(addr, image.get());
+        if (instruction && static_cast<quint64>(instruction->size()) == size) {
+            instructions->add(std::move(instruction));
+        } else {
+            ++failures;
+        }
+    }
+
+    if (failures > 0) {
+        context.logToken().warning(tr("%1 instruction(s) from snapshot %2 could not be disassembled.").arg(failures).arg(filename));
+    }
+
+    bool hasResults;
+    in >> hasResults;
+    checkStatus(in, filename);
+
+    if (hasResults) {
+        quint64 functionCount;
+        in >> functionCount;
+        checkStatus(in, filename);
+
+        for (quint64 i = 0; i < functionCount; ++i) {
+            SnapshotResults::Function function;
+
+            qint64 entryAddress;
+            quint64 rangeCount;
+            in >> entryAddress >> function.name >> rangeCount;
+            checkStatus(in, filename);
+            function.entryAddress = entryAddress;
+
+            for (quint64 j = 0; j < rangeCount; ++j) {
+                qint64 begin, end;
+                in >> begin >> end;
+                checkStatus(in, filename);
+                function.ranges.push_back(std::make_pair(begin, end));
+            }
+
+            in >> function.hasSignature;
+            if (function.hasSignature) {
+                quint64 argumentCount;
+                in >> function.variadic >> argumentCount;
+                checkStatus(in, filename);
+
+                for (quint64 j = 0; j < argumentCount; ++j) {
+                    QString argument;
+                    in >> argument;
+                    checkStatus(in, filename);
+                    function.arguments.push_back(argument);
+                }
+                in >> function.returnValue;
+            }
+            checkStatus(in, filename);
+
+            results->functions_.push_back(std::move(function));
+        }
+
+        quint64 declarationCount;
+        in >> declarationCount;
+        checkStatus(in, filename);
+
+        for (quint64 i = 0; i < declarationCount; ++i) {
+            quint64 offset, size;
+            qint64 function;
+            in >> offset >> size >> function;
+            checkStatus(in, filename);
+            checkContents(offset, size);
+
+            if (function >= static_cast<qint64>(results->functions_.size()) ||
+                size > static_cast<quint64>(std::numeric_limits<int>::max()))
+            {
+                throw nc::Exception(tr("File %1 is not a valid snapshot.").arg(filename));
+            }
+
+            /* The text shares the ownership of the mapping. */
+            SnapshotResults::Declaration declaration;
+            declaration.text = std::shared_ptr<const char>(mapping, contents + offset);
+            declaration.size = size;
+            declaration.function = function;
+            results->declarations_.push_back(std::move(declaration));
+        }
+    }
+
+    context.setImage(image);
+    context.setInstructions(instructions);
+    context.setSnapshotResults(hasResults ? std::move(results) : nullptr);
+}
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,174 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QCoreApplication> /* For Q_DECLARE_TR_FUNCTIONS. */
+#include <QString>
+#include <QStringList>
+
+#include <nc/common/Types.h>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace nc {
+namespace core {
+
+namespace arch {
+    class Instructions;
+}
+
+namespace image {
+    class Image;
+}
+
+class Context;
+
+/**
+ * Decompilation results stored in a snapshot.
+ *
+ * Functions and their signatures are decoded when the snapshot is loaded.
+ * The LikeC tree is stored as the printed texts of its top-level
+ * declarations, which are decoded from the mapped snapshot file only when
+ * asked for, so that the code of one function can be shown without
+ * reading the code of the others. The printed texts do not map back to
+ * instructions, so the GUI does not open stored results.
+ */
+class SnapshotResults {
+public:
+    /**
+     * Function and its signature.
+     */
+    class Function {
+    public:
+        ByteAddr entryAddress; ///< Entry address.
+        QString name; ///< Name.
+        std::vector<std::pair<ByteAddr, ByteAddr>> ranges; ///< Address ranges of the function's basic blocks.
+        bool hasSignature; ///< Whether the function has a signature.
+        bool variadic; ///< Whether the function is variadic.
+        QStringList arguments; ///< Printed terms of the arguments.
+        QString returnValue; ///< Printed term of the return value. Empty if there is none.
+
+        Function(): entryAddress(0), hasSignature(false), variadic(false) {}
+    };
+
+private:
+    /**
+     * Top-level declaration.
+     */
+    class Declaration {
+    public:
+        std::shared_ptr<const char> text; ///< UTF-8 text in the mapped snapshot.
+        quint64 size; ///< Size of the text in bytes.
+        qint64 function; ///< Index of the defined function, or -1.
+    };
+
+    std::vector<std::pair<ByteAddr, quint64>> instructions_;
+    std::vector<Function> functions_;
+    std::vector<Declaration> declarations_;
+
+    friend class Snapshot;
+
+public:
+    /**
+     * \param instructions Set of instructions.
+     *
+     * \return True iff the results were computed for exactly these instructions.
+     */
+    bool matches(const arch::Instructions &instructions) const;
+
+    /**
+     * \return Functions of the program.
+     */
+    const std::vector<Function> &functions() const { return functions_; }
+
+    /**
+     * \return Number of top-level declarations of the LikeC tree.
+     */
+    std::size_t declarationCount() const { return declarations_.size(); }
+
+    /**
+     * \param index Index of a declaration.
+     *
+     * \return Pointer to the function defined by the declaration, or nullptr
+     *         if the declaration is not a definition of a function.
+     */
+    const Function *getDefinedFunction(std::size_t index) const;
+
+    /**
+     * \param index Index of a declaration.
+     *
+     * \return Printed declaration.
+     */
+    QString getDeclarationText(std::size_t index) const;
+};
+
+/**
+ * Reading and writing of project snapshots.
+ *
+ * A snapshot is a versioned binary file storing everything that is needed
+ * to continue working with an executable file without parsing and
+ * disassembling it again: the platform, the sections, the symbols, the
+ * relocations, and the set of disassembled instructions.
+ *
+ * The file consists of a fixed-size header, a metadata block, and a data
+ * block with the contents of the sections. On loading, the file is mapped
+ * into memory: the metadata block is decoded in place, and the contents of
+ * the sections are not copied, but read from the mapping when needed.
+ * Instructions are stored as addresses and are disassembled again on
+ * loading, which is cheap compared to parsing and disassembling whole
+ * code sections.
+ *
+ * A snapshot can also keep the results of decompiling these instructions
+ * (see SnapshotResults). Nodes of the LikeC tree refer to the intermediate
+ * representation of the program, which is not stored, so the tree is kept
+ * in the printed form.
+ */
+class Snapshot {
+    Q_DECLARE_TR_FUNCTIONS(Snapshot)
+
+public:
+    /**
+     * \param source Valid pointer to a device opened for reading.
+     *
+     * \return True iff the device contains a snapshot.
+     *         The position in the device is not changed.
+     */
+    static bool isSnapshot(QIODevice *source);
+
+    /**
+     * Writes a snapshot to a file.
+     * Throws nc::Exception if the file cannot be written.
+     *
+     * \param image Executable image.
+     * \param instructions Disassembled instructions.
+     * \param filename Name of the file to write to.
+     * \param results If not nullptr, the context with the completed decompilation
+     *                of the given instructions, whose results are stored too.
+     */
+    static void save(const image::Image &image, const arch::Instructions &instructions, const QString &filename,
+                     const Context *results = nullptr);
+
+    /**
+     * Loads a snapshot into the context, replacing its image and instructions,
+     * and setting its snapshot results, if the snapshot has any.
+     * Throws nc::Exception if the file cannot be read or is not a valid snapshot.
+     *
+     * \param context Context.
+     * \param filename Name of the file to read from.
+     */
+    static void load(Context &context, const QString &filename);
+};
+
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
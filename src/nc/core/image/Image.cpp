@@ -24,7 +24,12 @@
 
 #include "Image.h"
 
+#include <QReadLocker>
+#include <QSet>
+#include <QWriteLocker>
+
 #include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
 #include <nc/common/Range.h>
 #include <nc/common/make_unique.h>
 
@@ -106,6 +111,52 @@ void Image::setDemangler(std::unique_ptr<mangling::Demangler> demangler) {
     assert(demangler != nullptr);
 
     demangler_ = std::move(demangler);
+
+    QWriteLocker locker(&demangledNamesLock_);
+    demangledNames_.clear();
+}
+
+QString Image::demangle(const QString &name) const {
+    {
+        QReadLocker locker(&demangledNamesLock_);
+        auto i = demangledNames_.constFind(name);
+        if (i != demangledNames_.constEnd()) {
+            return *i;
+        }
+    }
+
+    /* Demangle without holding the lock: this is the slow part. */
+    auto result = demangler_->demangle(name);
+
+    QWriteLocker locker(&demangledNamesLock_);
+    demangledNames_.insert(name, result);
+    return result;
+}
+
+void Image::demangleSymbols() {
+    std::vector<QString> names;
+    {
+        QReadLocker locker(&demangledNamesLock_);
+        QSet<QString> seen;
+
+        foreach (auto symbol, symbols()) {
+            if (!demangledNames_.contains(symbol->name()) && !seen.contains(symbol->name())) {
+                seen.insert(symbol->name());
+                names.push_back(symbol->name());
+            }
+        }
+    }
+
+    std::vector<QString> results(names.size());
+    parallelFor(names.size(), [&](std::size_t index) {
+        results[index] = demangler_->demangle(names[index]);
+    });
+
+    QWriteLocker locker(&demangledNamesLock_);
+    demangledNames_.reserve(demangledNames_.size() + static_cast<int>(names.size()));
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        demangledNames_.insert(names[i], results[i]);
+    }
 }
 
 }}} // namespace nc::core::image
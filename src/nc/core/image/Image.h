@@ -30,6 +30,8 @@
 
 #include <boost/unordered_map.hpp>
 
+#include <QHash>
+#include <QReadWriteLock>
 #include <QString>
 
 #include "ByteSource.h"
@@ -62,6 +64,8 @@ class Image: public ByteSource {
     std::vector<std::unique_ptr<Relocation>> relocations_; ///< The list of relocations.
     boost::unordered_map<ByteAddr, Relocation *> address2relocation_; ///< Mapping from an address to the relocation with this address.
     std::unique_ptr<mangling::Demangler> demangler_; ///< Demangler.
+    mutable QHash<QString, QString> demangledNames_; ///< Cache of demangled names.
+    mutable QReadWriteLock demangledNamesLock_; ///< Lock guarding the cache of demangled names.
     boost::optional<ByteAddr> entrypoint_; ///< Entrypoint of image.
 
 public:
@@ -162,6 +166,13 @@ public:
      */
     const Relocation *addRelocation(std::unique_ptr<Relocation> relocation);
 
+    /**
+     * \return List of all relocations.
+     */
+    const std::vector<const Relocation *> &relocations() const {
+        return reinterpret_cast<const std::vector<const Relocation *> &>(relocations_);
+    }
+
     /**
      * \param address Virtual address.
      *
@@ -181,6 +192,23 @@ public:
      */
     void setDemangler(std::unique_ptr<mangling::Demangler> demangler);
 
+    /**
+     * Demangles a name using the demangler of the image.
+     * Results are cached, so repeated calls for the same name are cheap.
+     * Can be called concurrently.
+     *
+     * \param name Mangled name.
+     *
+     * \return Demangled name, or QString() in case of failure.
+     */
+    QString demangle(const QString &name) const;
+
+    /**
+     * Demangles the names of all the symbols in parallel
+     * and puts the results into the cache used by demangle().
+     */
+    void demangleSymbols();
+
     /**
      * Sets the entry point address.
      *
@@ -26,6 +26,7 @@
 
 #include <QTextStream>
 
+#include <nc/core/ir/Function.h>
 #include <nc/core/ir/Jump.h>
 #include <nc/core/ir/Statements.h>
 #include <nc/core/ir/Term.h>
@@ -62,6 +63,11 @@ Statement *BasicBlock::insert(ilist<Statement>::const_iterator position, std::un
     auto result = statement.get();
     statements_.insert(position, std::move(statement));
     result->setBasicBlock(this);
+
+    if (function_ && result->is<Jump>()) {
+        function_->invalidateCFG();
+    }
+
     return result;
 }
 
@@ -95,6 +101,11 @@ std::unique_ptr<Statement> BasicBlock::erase(Statement *statement) {
     auto result = statements_.erase(statement);
     assert(result->basicBlock() == this);
     result->setBasicBlock(nullptr);
+
+    if (function_ && result->is<Jump>()) {
+        function_->invalidateCFG();
+    }
+
     return result;
 }
 
@@ -26,10 +26,7 @@
 
 #include <QTextStream>
 
-#ifndef NDEBUG
-#include <boost/unordered_set.hpp>
-#endif
-
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
 
 #include "BasicBlock.h"
@@ -40,54 +37,90 @@ namespace nc {
 namespace core {
 namespace ir {
 
-CFG::CFG(const BasicBlocks &basicBlocks):
-    basicBlocks_(basicBlocks)
+CFG::CFG(const BasicBlocks &basicBlocks, const BasicBlock *entry):
+    basicBlocks_(basicBlocks), entry_(entry)
 {
     foreach (const BasicBlock *basicBlock, basicBlocks) {
-        if (const Jump *jump = basicBlock->getJump()) {
-            addConnections(basicBlock, jump->thenTarget());
-            addConnections(basicBlock, jump->elseTarget());
-        }
+        basicBlock2index_.insert(std::make_pair(basicBlock, index2basicBlock_.size()));
+        index2basicBlock_.push_back(basicBlock);
     }
 
-#ifndef NDEBUG
-    boost::unordered_set<const BasicBlock *> set(basicBlocks.begin(), basicBlocks.end());
-    foreach (auto &pair, predecessors_) {
-        assert(nc::contains(set, pair.first));
-        foreach (const BasicBlock *predecessor, pair.second) {
-            assert(nc::contains(set, predecessor));
+    std::vector<std::pair<Index, Index>> edges;
+
+    for (Index index = 0; index < size(); ++index) {
+        if (const Jump *jump = index2basicBlock_[index]->getJump()) {
+            addConnections(index, jump->thenTarget(), edges);
+            addConnections(index, jump->elseTarget(), edges);
         }
     }
-    foreach (auto &pair, successors_) {
-        assert(nc::contains(set, pair.first));
-        foreach (const BasicBlock *successor, pair.second) {
-            assert(nc::contains(set, successor));
-        }
+
+    makeAdjacency(edges, successors_);
+
+    foreach (auto &edge, edges) {
+        std::swap(edge.first, edge.second);
     }
-#endif
-}
 
-void CFG::addConnections(const BasicBlock *predecessor, const JumpTarget &jumpTarget) {
-    assert(predecessor);
+    makeAdjacency(edges, predecessors_);
+
+    computeOrders(entry);
+}
 
+void CFG::addConnections(Index predecessor, const JumpTarget &jumpTarget, std::vector<std::pair<Index, Index>> &edges) const {
     if (jumpTarget.basicBlock()) {
-        addConnection(predecessor, jumpTarget.basicBlock());
+        edges.push_back(std::make_pair(predecessor, getIndex(jumpTarget.basicBlock())));
     }
     if (jumpTarget.table()) {
         foreach (const JumpTableEntry &entry, *jumpTarget.table()) {
             if (entry.basicBlock()) {
-                addConnection(predecessor, entry.basicBlock());
+                edges.push_back(std::make_pair(predecessor, getIndex(entry.basicBlock())));
             }
         }
     }
 }
 
-void CFG::addConnection(const BasicBlock *predecessor, const BasicBlock *successor) {
-    assert(predecessor != nullptr);
-    assert(successor != nullptr);
+void CFG::makeAdjacency(const std::vector<std::pair<Index, Index>> &edges, Adjacency &adjacency) const {
+    /*
+     * Counting sort of the edges by their sources.
+     * It is stable, so the order of the edges of each source is preserved.
+     */
+    adjacency.offsets.assign(size() + 1, 0);
+    foreach (const auto &edge, edges) {
+        ++adjacency.offsets[edge.first + 1];
+    }
+    for (Index index = 0; index < size(); ++index) {
+        adjacency.offsets[index + 1] += adjacency.offsets[index];
+    }
+
+    adjacency.indices.resize(edges.size());
+    adjacency.basicBlocks.resize(edges.size());
 
-    successors_[predecessor].push_back(successor);
-    predecessors_[successor].push_back(predecessor);
+    std::vector<std::size_t> positions(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    foreach (const auto &edge, edges) {
+        auto position = positions[edge.first]++;
+        adjacency.indices[position] = edge.second;
+        adjacency.basicBlocks[position] = index2basicBlock_[edge.second];
+    }
+}
+
+void CFG::computeOrders(const BasicBlock *entry) {
+    auto dfs = makeDepthFirstSearch(size(), [this](Index index) { return getSuccessors(index); });
+
+    if (entry) {
+        dfs.visit(getIndex(entry));
+    }
+    for (Index index = 0; index < size(); ++index) {
+        if (getPredecessors(index).empty()) {
+            dfs.visit(index);
+        }
+    }
+    for (Index index = 0; index < size(); ++index) {
+        dfs.visit(index);
+    }
+
+    assert(dfs.postorder().size() == size());
+
+    postOrder_ = dfs.postorder();
+    reversePostOrder_.assign(postOrder_.rbegin(), postOrder_.rend());
 }
 
 void CFG::print(QTextStream &out) const {
@@ -95,9 +128,9 @@ void CFG::print(QTextStream &out) const {
         out << *basicBlock;
     }
 
-    foreach (auto &pair, successors_) {
-        foreach (const BasicBlock *successor, pair.second) {
-            out << "basicBlock" << pair.first << " -> basicBlock" << successor << ';' << endl;
+    foreach (const BasicBlock *basicBlock, basicBlocks()) {
+        foreach (const BasicBlock *successor, getSuccessors(basicBlock)) {
+            out << "basicBlock" << basicBlock << " -> basicBlock" << successor << ';' << endl;
         }
     }
 }
@@ -28,6 +28,7 @@
 #include <cassert>
 #include <vector>
 
+#include <boost/range/iterator_range.hpp>
 #include <boost/unordered_map.hpp>
 
 #include <nc/common/Printable.h>
@@ -47,45 +48,126 @@ class JumpTarget;
  * Objects of this class can be constructed from a set of basic blocks
  * and contain information about the successors and predecessors of the
  * basic blocks.
+ *
+ * Basic blocks are densely numbered from 0 to size() - 1 in the order
+ * in which they are stored in the set of basic blocks. Successors and
+ * predecessors are stored in compressed sparse row form: for each basic
+ * block, its successors (predecessors) occupy a contiguous part of a
+ * single array.
  */
 class CFG: public PrintableBase<CFG> {
 public:
     typedef nc::ilist<BasicBlock> BasicBlocks;
 
+    /** Index of a basic block in the CFG. */
+    typedef std::size_t Index;
+
+    /** Range of basic blocks. */
+    typedef boost::iterator_range<std::vector<const BasicBlock *>::const_iterator> BasicBlockRange;
+
+    /** Range of indices of basic blocks. */
+    typedef boost::iterator_range<std::vector<Index>::const_iterator> IndexRange;
+
 private:
     /** References to the set of basic blocks passed to the constructor. */
     const BasicBlocks &basicBlocks_;
 
-    /** Mapping from a basic block to the list of its successors. */
-    boost::unordered_map<const BasicBlock *, std::vector<const BasicBlock *>> successors_;
+    /** Entry basic block. */
+    const BasicBlock *entry_;
+
+    /** Basic blocks by their indices. */
+    std::vector<const BasicBlock *> index2basicBlock_;
+
+    /** Mapping from a basic block to its index. */
+    boost::unordered_map<const BasicBlock *, Index> basicBlock2index_;
+
+    /**
+     * Compressed sparse row representation of an adjacency relation.
+     * The neighbours of the basic block with index i are stored
+     * in the range [offsets[i], offsets[i + 1]) of the other arrays.
+     */
+    struct Adjacency {
+        /** Offsets of the lists of neighbours. */
+        std::vector<std::size_t> offsets;
+
+        /** Indices of the neighbours. */
+        std::vector<Index> indices;
+
+        /** Pointers to the neighbours. */
+        std::vector<const BasicBlock *> basicBlocks;
+    };
+
+    /** Successors of basic blocks. */
+    Adjacency successors_;
 
-    /** Mapping from a basic block to the list of its predecessors. */
-    boost::unordered_map<const BasicBlock *, std::vector<const BasicBlock *>> predecessors_;
+    /** Predecessors of basic blocks. */
+    Adjacency predecessors_;
+
+    /** Indices of basic blocks in depth-first search postorder. */
+    std::vector<Index> postOrder_;
+
+    /** Indices of basic blocks in reverse postorder. */
+    std::vector<Index> reversePostOrder_;
 
 public:
     /**
      * Constructs control flow graph from a set of basic blocks.
      *
      * \param[in] basicBlocks Basic blocks.
+     * \param[in] entry Pointer to the entry basic block. Can be nullptr.
      *
      * Note that the set of basic blocks is not copied.
      * Instead, only a reference to it is stored.
+     *
+     * Depth-first search computing the postorder starts from the entry,
+     * if one is given, and then from each yet unvisited basic block
+     * without predecessors, and finally from each yet unvisited basic block.
      */
-    CFG(const BasicBlocks &basicBlocks);
+    CFG(const BasicBlocks &basicBlocks, const BasicBlock *entry = nullptr);
 
     /**
      * \return The set of basic blocks that was passed to the constructor.
      */
     const BasicBlocks &basicBlocks() const { return basicBlocks_; }
 
+    /**
+     * \return Pointer to the entry basic block passed to the constructor. Can be nullptr.
+     */
+    const BasicBlock *entry() const { return entry_; }
+
+    /**
+     * \return Number of basic blocks in the CFG.
+     */
+    std::size_t size() const { return index2basicBlock_.size(); }
+
+    /**
+     * \param[in] basicBlock Valid pointer to a basic block of the CFG.
+     *
+     * \return Index of the basic block.
+     */
+    Index getIndex(const BasicBlock *basicBlock) const {
+        assert(basicBlock != nullptr);
+        assert(nc::contains(basicBlock2index_, basicBlock));
+        return basicBlock2index_.find(basicBlock)->second;
+    }
+
+    /**
+     * \param[in] index Index of a basic block.
+     *
+     * \return Valid pointer to the basic block with the given index.
+     */
+    const BasicBlock *getBasicBlock(Index index) const {
+        assert(index < size());
+        return index2basicBlock_[index];
+    }
+
     /**
      * \param[in] basicBlock Valid pointer to a basic block.
      *
      * \return List of successors of the basic block.
      */
-    const std::vector<const BasicBlock *> &getSuccessors(const BasicBlock *basicBlock) const {
-        assert(basicBlock != nullptr);
-        return nc::find(successors_, basicBlock);
+    BasicBlockRange getSuccessors(const BasicBlock *basicBlock) const {
+        return getBasicBlocks(successors_, basicBlock);
     }
 
     /**
@@ -93,11 +175,38 @@ public:
      *
      * \return List of predecessors of the basic block.
      */
-    const std::vector<const BasicBlock *> &getPredecessors(const BasicBlock *basicBlock) const {
-        assert(basicBlock != nullptr);
-        return nc::find(predecessors_, basicBlock);
+    BasicBlockRange getPredecessors(const BasicBlock *basicBlock) const {
+        return getBasicBlocks(predecessors_, basicBlock);
+    }
+
+    /**
+     * \param[in] index Index of a basic block.
+     *
+     * \return Indices of the successors of the basic block.
+     */
+    IndexRange getSuccessors(Index index) const {
+        return getIndices(successors_, index);
+    }
+
+    /**
+     * \param[in] index Index of a basic block.
+     *
+     * \return Indices of the predecessors of the basic block.
+     */
+    IndexRange getPredecessors(Index index) const {
+        return getIndices(predecessors_, index);
     }
 
+    /**
+     * \return Indices of all basic blocks in depth-first search postorder.
+     */
+    const std::vector<Index> &postOrder() const { return postOrder_; }
+
+    /**
+     * \return Indices of all basic blocks in reverse postorder.
+     */
+    const std::vector<Index> &reversePostOrder() const { return reversePostOrder_; }
+
     /**
      * Prints the CFG in DOT format into a stream.
      *
@@ -107,20 +216,45 @@ public:
 
 private:
     /**
-     * Adds an edge from a predecessor to a successor.
+     * Adds edges from a predecessor to all jump targets.
      *
-     * \param[in] predecessor Valid pointer to a predecessor basic block.
-     * \param[in] successor   Valid pointer to a successor basic block.
+     * \param[in] predecessor   Index of the predecessor basic block.
+     * \param[in] jumpTarget    Jump target of the predecessor's terminating jump.
+     * \param[out] edges        Where to append the edges.
      */
-    void addConnection(const BasicBlock *predecessor, const BasicBlock *successor);
+    void addConnections(Index predecessor, const JumpTarget &jumpTarget, std::vector<std::pair<Index, Index>> &edges) const;
 
     /**
-     * Adds edges from a predecessor to all jump targets.
+     * Fills in the compressed sparse row representation of an adjacency relation.
      *
-     * \param[in] predecessor   Valid pointer to a basic block.
-     * \param[in] jumpTarget    Jump target of the predecessor's terminating jump.
+     * \param[in] edges Edges, as pairs of (source, destination) indices.
+     * \param[out] adjacency Adjacency relation mapping sources to destinations.
+     */
+    void makeAdjacency(const std::vector<std::pair<Index, Index>> &edges, Adjacency &adjacency) const;
+
+    /**
+     * Computes postorder and reverse postorder of basic blocks.
+     *
+     * \param[in] entry Pointer to the entry basic block. Can be nullptr.
      */
-    void addConnections(const BasicBlock *predecessor, const JumpTarget &jumpTarget);
+    void computeOrders(const BasicBlock *entry);
+
+    BasicBlockRange getBasicBlocks(const Adjacency &adjacency, const BasicBlock *basicBlock) const {
+        assert(basicBlock != nullptr);
+
+        auto i = basicBlock2index_.find(basicBlock);
+        if (i == basicBlock2index_.end()) {
+            return BasicBlockRange(adjacency.basicBlocks.end(), adjacency.basicBlocks.end());
+        }
+        return BasicBlockRange(adjacency.basicBlocks.begin() + adjacency.offsets[i->second],
+                               adjacency.basicBlocks.begin() + adjacency.offsets[i->second + 1]);
+    }
+
+    IndexRange getIndices(const Adjacency &adjacency, Index index) const {
+        assert(index < size());
+        return IndexRange(adjacency.indices.begin() + adjacency.offsets[index],
+                          adjacency.indices.begin() + adjacency.offsets[index + 1]);
+    }
 };
 
 } // namespace ir
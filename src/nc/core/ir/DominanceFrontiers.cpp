@@ -0,0 +1,109 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DominanceFrontiers.h"
+
+#include <algorithm>
+
+#include <nc/common/CancellationToken.h>
+#include <nc/common/Foreach.h>
+
+#include "Dominators.h"
+
+namespace nc {
+namespace core {
+namespace ir {
+
+DominanceFrontiers::DominanceFrontiers(const CFG &cfg, const Dominators &dominators, const CancellationToken &canceled):
+    cfg_(cfg)
+{
+    const auto size = cfg.size();
+
+    /* Pairs of a basic block and a basic block from its frontier. */
+    std::vector<std::pair<CFG::Index, CFG::Index>> pairs;
+
+    /* The last basic block added to the frontier of a given one, to avoid duplicates. */
+    std::vector<CFG::Index> lastAdded(size, size);
+
+    for (CFG::Index index = 0; index < size; ++index) {
+        auto idom = dominators.getImmediateDominator(index);
+
+        /*
+         * Walk up the dominator tree from each predecessor until reaching
+         * the immediate dominator of the basic block. Roots of the tree are
+         * immediately dominated by the virtual root, whose index is size.
+         */
+        foreach (auto predecessor, cfg.getPredecessors(index)) {
+            for (auto runner = predecessor; runner != idom && runner != size;
+                 runner = dominators.getImmediateDominator(runner))
+            {
+                if (lastAdded[runner] != index) {
+                    lastAdded[runner] = index;
+                    pairs.push_back(std::make_pair(runner, index));
+                }
+            }
+        }
+
+        if (index % 1024 == 0) {
+            canceled.poll();
+        }
+    }
+
+    /* Counting sort of the pairs by their first element. */
+    offsets_.assign(size + 1, 0);
+    foreach (const auto &pair, pairs) {
+        ++offsets_[pair.first + 1];
+    }
+    for (CFG::Index index = 0; index < size; ++index) {
+        offsets_[index + 1] += offsets_[index];
+    }
+
+    frontiers_.resize(pairs.size());
+
+    std::vector<std::size_t> positions(offsets_.begin(), offsets_.end() - 1);
+    foreach (const auto &pair, pairs) {
+        frontiers_[positions[pair.first]++] = pair.second;
+    }
+}
+
+std::vector<CFG::Index> DominanceFrontiers::getIteratedFrontier(const std::vector<CFG::Index> &indices) const {
+    std::vector<CFG::Index> result;
+
+    std::vector<bool> inResult(cfg_.size());
+    std::vector<bool> queued(cfg_.size());
+
+    std::vector<CFG::Index> queue;
+    foreach (auto index, indices) {
+        if (!queued[index]) {
+            queued[index] = true;
+            queue.push_back(index);
+        }
+    }
+
+    while (!queue.empty()) {
+        auto index = queue.back();
+        queue.pop_back();
+
+        foreach (auto frontier, getFrontier(index)) {
+            if (!inResult[frontier]) {
+                inResult[frontier] = true;
+                result.push_back(frontier);
+
+                if (!queued[frontier]) {
+                    queued[frontier] = true;
+                    queue.push_back(frontier);
+                }
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,73 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include "CFG.h"
+
+namespace nc {
+
+class CancellationToken;
+
+namespace core {
+namespace ir {
+
+class Dominators;
+
+/**
+ * Dominance frontiers of basic blocks.
+ *
+ * The dominance frontier of a basic block is the set of basic blocks
+ * that are not strictly dominated by it, but have a predecessor dominated by it.
+ */
+class DominanceFrontiers {
+    /** Control flow graph. */
+    const CFG &cfg_;
+
+    /** Offsets of the frontiers in frontiers_, indexed by the index of a basic block. */
+    std::vector<std::size_t> offsets_;
+
+    /** Frontiers of basic blocks, grouped by basic block. */
+    std::vector<CFG::Index> frontiers_;
+
+public:
+    /**
+     * Computes the dominance frontiers using the algorithm of Cooper, Harvey, and Kennedy.
+     *
+     * \param cfg Control flow graph. Must outlive this object.
+     * \param dominators Dominator tree of the control flow graph.
+     * \param canceled Cancellation token.
+     */
+    DominanceFrontiers(const CFG &cfg, const Dominators &dominators, const CancellationToken &canceled);
+
+    /**
+     * \param index Index of a basic block.
+     *
+     * \return Indices of the basic blocks in the dominance frontier of the given one.
+     */
+    CFG::IndexRange getFrontier(CFG::Index index) const {
+        assert(index < cfg_.size());
+        return CFG::IndexRange(frontiers_.begin() + offsets_[index], frontiers_.begin() + offsets_[index + 1]);
+    }
+
+    /**
+     * Computes the iterated dominance frontier of a set of basic blocks,
+     * i.e. the places where phi functions are needed for a variable
+     * defined in these basic blocks.
+     *
+     * \param indices Indices of basic blocks.
+     *
+     * \return Indices of the basic blocks in the iterated dominance frontier, sorted.
+     */
+    std::vector<CFG::Index> getIteratedFrontier(const std::vector<CFG::Index> &indices) const;
+};
+
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -6,63 +6,156 @@
 #include <nc/common/CancellationToken.h>
 #include <nc/common/Foreach.h>
 
-#include "BasicBlock.h"
-#include "CFG.h"
-
 namespace nc {
 namespace core {
 namespace ir {
 
-Dominators::Dominators(const CFG &cfg, const CancellationToken &canceled) {
+Dominators::Dominators(const CFG &cfg, const CancellationToken &canceled):
+    cfg_(cfg)
+{
+    const auto size = cfg.size();
+
+    /* Fake index denoting the virtual root of the dominator tree. */
+    const auto root = size;
+
+    /* Positions of basic blocks in reverse postorder, shifted by one to make place for the virtual root. */
+    std::vector<std::size_t> rpoNumbers(size + 1);
+    rpoNumbers[root] = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        rpoNumbers[cfg.reversePostOrder()[i]] = i + 1;
+    }
+
     /*
-     * Each node dominates itself.
+     * Roots of the CFG and everything unreachable from them are immediately
+     * dominated by the virtual root.
      */
-    foreach (auto basicBlock, cfg.basicBlocks()) {
-        dominators_[basicBlock].push_back(basicBlock);
+    const auto undefined = size + 1;
+    idoms_.assign(size, undefined);
+
+    std::vector<CFG::Index> queue;
+    auto addRoot = [&](CFG::Index index) {
+        if (idoms_[index] == undefined) {
+            idoms_[index] = root;
+            queue.push_back(index);
+        }
+    };
+
+    if (cfg.entry()) {
+        addRoot(cfg.getIndex(cfg.entry()));
+    }
+    for (CFG::Index index = 0; index < size; ++index) {
+        if (cfg.getPredecessors(index).empty()) {
+            addRoot(index);
+        }
     }
 
+    std::vector<bool> reachable(size);
+    foreach (auto index, queue) {
+        reachable[index] = true;
+    }
+    while (!queue.empty()) {
+        auto index = queue.back();
+        queue.pop_back();
+        foreach (auto successor, cfg.getSuccessors(index)) {
+            if (!reachable[successor]) {
+                reachable[successor] = true;
+                queue.push_back(successor);
+            }
+        }
+    }
+
+    for (CFG::Index index = 0; index < size; ++index) {
+        if (!reachable[index]) {
+            idoms_[index] = root;
+        }
+    }
+
+    auto intersect = [&](CFG::Index a, CFG::Index b) -> CFG::Index {
+        while (a != b) {
+            while (rpoNumbers[a] > rpoNumbers[b]) {
+                a = idoms_[a];
+            }
+            while (rpoNumbers[b] > rpoNumbers[a]) {
+                b = idoms_[b];
+            }
+        }
+        return a;
+    };
+
     /*
-     * Recompute dominator sets until fixpoint.
+     * Recompute immediate dominators until fixpoint.
      */
+    std::vector<bool> isRoot(size);
+    for (CFG::Index index = 0; index < size; ++index) {
+        isRoot[index] = idoms_[index] == root;
+    }
+
     bool changed;
     do {
         changed = false;
 
-        foreach (auto basicBlock, cfg.basicBlocks()) {
-            const auto &predecessors = cfg.getPredecessors(basicBlock);
+        foreach (auto index, cfg.reversePostOrder()) {
+            if (isRoot[index]) {
+                continue;
+            }
 
-            if (!predecessors.empty()) {
-                boost::unordered_map<const BasicBlock *, std::size_t> intersection;
-                foreach (auto predecessor, predecessors) {
-                    foreach (auto predDominator, dominators_[predecessor]) {
-                        ++intersection[predDominator];
-                    }
+            auto newIdom = undefined;
+            foreach (auto predecessor, cfg.getPredecessors(index)) {
+                if (idoms_[predecessor] != undefined) {
+                    newIdom = newIdom == undefined ? predecessor : intersect(predecessor, newIdom);
                 }
-                intersection.erase(basicBlock);
+            }
+            assert(newIdom != undefined);
 
-                std::vector<const BasicBlock *> newDominators;
-                foreach (const auto &pair, intersection) {
-                    if (pair.second == predecessors.size()) {
-                        newDominators.push_back(pair.first);
-                    }
-                }
-                newDominators.push_back(basicBlock);
-
-                auto &oldDominators = dominators_[basicBlock];
-                /* Sets grow monotonically, so we can just compare sizes. */
-                if (newDominators.size() != oldDominators.size()) {
-                    assert(newDominators.size() > oldDominators.size());
-                    oldDominators = std::move(newDominators);
-                    changed = true;
-                }
+            if (idoms_[index] != newIdom) {
+                idoms_[index] = newIdom;
+                changed = true;
             }
         }
 
         canceled.poll();
     } while (changed);
 
-    foreach (auto &pair, dominators_) {
-        std::sort(pair.second.begin(), pair.second.end());
+    /*
+     * Number the nodes of the dominator tree in preorder and postorder,
+     * so that dominance queries take constant time.
+     */
+    childrenOffsets_.assign(size + 2, 0);
+    for (CFG::Index index = 0; index < size; ++index) {
+        ++childrenOffsets_[idoms_[index] + 1];
+    }
+    for (std::size_t i = 0; i <= size; ++i) {
+        childrenOffsets_[i + 1] += childrenOffsets_[i];
+    }
+    children_.resize(size);
+    {
+        std::vector<std::size_t> positions(childrenOffsets_.begin(), childrenOffsets_.end() - 1);
+        for (CFG::Index index = 0; index < size; ++index) {
+            children_[positions[idoms_[index]]++] = index;
+        }
+    }
+
+    preorder_.resize(size + 1);
+    postorder_.resize(size + 1);
+
+    std::size_t preorderNumber = 0;
+    std::size_t postorderNumber = 0;
+
+    /* Stack of (node, position of the next child to visit) pairs. */
+    std::vector<std::pair<CFG::Index, std::size_t>> stack;
+    stack.push_back(std::make_pair(root, childrenOffsets_[root]));
+    preorder_[root] = preorderNumber++;
+
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        if (top.second < childrenOffsets_[top.first + 1]) {
+            auto child = children_[top.second++];
+            preorder_[child] = preorderNumber++;
+            stack.push_back(std::make_pair(child, childrenOffsets_[child]));
+        } else {
+            postorder_[top.first] = postorderNumber++;
+            stack.pop_back();
+        }
     }
 }
 
@@ -7,9 +7,7 @@
 
 #include <vector>
 
-#include <boost/unordered_map.hpp>
-
-#include <nc/common/Range.h>
+#include "CFG.h"
 
 namespace nc {
 
@@ -19,21 +17,39 @@ namespace core {
 namespace ir {
 
 class BasicBlock;
-class CFG;
 
 /**
- * Dominator sets.
+ * Dominator tree.
+ *
+ * Basic blocks without predecessors and the entry of the CFG are the roots
+ * of the tree. Basic blocks unreachable from the roots are dominated only
+ * by themselves.
  */
 class Dominators {
-    /** Mapping from a basic block to the set of its dominators. */
-    boost::unordered_map<const BasicBlock *, std::vector<const BasicBlock *>> dominators_;
+    /** Control flow graph. */
+    const CFG &cfg_;
+
+    /** Mapping from the index of a basic block to the index of its immediate dominator. */
+    std::vector<CFG::Index> idoms_;
+
+    /** Preorder numbers of basic blocks in the dominator tree. */
+    std::vector<std::size_t> preorder_;
+
+    /** Postorder numbers of basic blocks in the dominator tree. */
+    std::vector<std::size_t> postorder_;
+
+    /** Offsets of the lists of children in children_, indexed by the index of a parent. */
+    std::vector<std::size_t> childrenOffsets_;
+
+    /** Children of the nodes of the dominator tree, grouped by parent. */
+    std::vector<CFG::Index> children_;
 
 public:
     /**
-     * Constructs dominator sets from the control flow graph.
-     * Uses classic iterative algorithm for that.
+     * Constructs the dominator tree of the control flow graph.
+     * Uses the iterative algorithm of Cooper, Harvey, and Kennedy for that.
      *
-     * \param cfg Control flow graph.
+     * \param cfg Control flow graph. Must outlive this object.
      * \param canceled Cancellation token.
      */
     Dominators(const CFG &cfg, const CancellationToken &canceled);
@@ -41,12 +57,33 @@ public:
     /**
      * \param basicBlock Valid pointer to a basic block.
      *
-     * \return The set of dominators of this basic block.
+     * \return Pointer to the immediate dominator of this basic block,
+     *         nullptr if the basic block is a root of the dominator tree.
+     */
+    const BasicBlock *getImmediateDominator(const BasicBlock *basicBlock) const {
+        auto idom = idoms_[cfg_.getIndex(basicBlock)];
+        return idom < cfg_.size() ? cfg_.getBasicBlock(idom) : nullptr;
+    }
+
+    /**
+     * \param index Index of a basic block.
+     *
+     * \return Index of the immediate dominator of this basic block,
+     *         or cfg.size() if the basic block is a root of the dominator tree.
      */
-    const std::vector<const BasicBlock *> &getDominators(const BasicBlock *basicBlock) const {
-        assert(basicBlock != nullptr);
-        assert(nc::contains(dominators_, basicBlock));
-        return nc::find(dominators_, basicBlock);
+    CFG::Index getImmediateDominator(CFG::Index index) const {
+        assert(index < cfg_.size());
+        return idoms_[index];
+    }
+
+    /**
+     * \param index Index of a basic block, or cfg.size() to get the roots of the tree.
+     *
+     * \return Indices of the basic blocks immediately dominated by the given one.
+     */
+    CFG::IndexRange getChildren(CFG::Index index) const {
+        assert(index <= cfg_.size());
+        return CFG::IndexRange(children_.begin() + childrenOffsets_[index], children_.begin() + childrenOffsets_[index + 1]);
     }
 
     /**
@@ -56,13 +93,21 @@ public:
      * \return True of dominating dominates dominated.
      */
     bool isDominating(const BasicBlock *dominating, const BasicBlock *dominated) const {
-        assert(dominating != nullptr);
-        assert(nc::contains(dominators_, dominating));
-        assert(dominated != nullptr);
-        assert(nc::contains(dominators_, dominated));
+        return isDominating(cfg_.getIndex(dominating), cfg_.getIndex(dominated));
+    }
+
+    /**
+     * \param dominating Index of a basic block.
+     * \param dominated Index of a basic block.
+     *
+     * \return True of dominating dominates dominated.
+     */
+    bool isDominating(CFG::Index dominating, CFG::Index dominated) const {
+        assert(dominating < cfg_.size());
+        assert(dominated < cfg_.size());
 
-        const auto &dominators = getDominators(dominated);
-        return std::binary_search(dominators.begin(), dominators.end(), dominating);
+        return preorder_[dominating] <= preorder_[dominated] &&
+               postorder_[dominated] <= postorder_[dominating];
     }
 };
 
@@ -24,6 +24,7 @@
 
 #include "Function.h"
 
+#include <QMutexLocker>
 #include <QTextStream>
 
 #include <nc/common/Foreach.h>
@@ -44,6 +45,20 @@ Function::~Function() {}
 void Function::addBasicBlock(std::unique_ptr<BasicBlock> basicBlock) {
     basicBlock->setFunction(this);
     basicBlocks_.push_back(std::move(basicBlock));
+    invalidateCFG();
+}
+
+const CFG &Function::cfg() const {
+    QMutexLocker lock(&cfgMutex_);
+    if (!cfg_) {
+        cfg_.reset(new CFG(basicBlocks(), entry()));
+    }
+    return *cfg_;
+}
+
+void Function::invalidateCFG() {
+    QMutexLocker lock(&cfgMutex_);
+    cfg_.reset();
 }
 
 bool Function::isEmpty() const {
@@ -57,7 +72,7 @@ bool Function::isEmpty() const {
 
 void Function::print(QTextStream &out) const {
     out << "subgraph cluster" << this << " {" << endl;
-    out << CFG(basicBlocks());
+    out << cfg();
     out << '}' << endl;
 }
 
@@ -30,6 +30,8 @@
 
 #include <boost/noncopyable.hpp>
 
+#include <QMutex>
+
 #include <nc/common/Printable.h>
 #include <nc/common/ilist.h>
 
@@ -38,6 +40,7 @@ namespace core {
 namespace ir {
 
 class BasicBlock;
+class CFG;
 
 /**
  * Intermediate representation of a function.
@@ -49,6 +52,8 @@ public:
 private:
     BasicBlock *entry_; ///< Entry basic block.
     BasicBlocks basicBlocks_; ///< All basic blocks of the function.
+    mutable std::unique_ptr<CFG> cfg_; ///< Cached control flow graph of the function.
+    mutable QMutex cfgMutex_; ///< Mutex guarding cfg_.
 
 public:
     /**
@@ -79,6 +84,7 @@ public:
     void setEntry(BasicBlock *entry) {
         assert(entry != nullptr && "Function's entry must be not nullptr.");
         entry_ = entry;
+        invalidateCFG();
     }
 
     /**
@@ -101,6 +107,28 @@ public:
      */
     void addBasicBlock(std::unique_ptr<BasicBlock> basicBlock);
 
+    /**
+     * \return Control flow graph of the function.
+     *
+     * The graph is computed on the first call and cached until invalidateCFG()
+     * is called. Adding basic blocks, changing the entry, inserting or erasing
+     * jumps via methods of BasicBlock, and setting the address, basic block or
+     * table of a jump's target invalidate it automatically. Whoever changes
+     * the entries of a jump table or the statements of a basic block directly
+     * must call invalidateCFG().
+     *
+     * The method can be called concurrently from several threads, as long
+     * as none of them changes the function.
+     *
+     * \warning The returned reference is invalidated by invalidateCFG().
+     */
+    const CFG &cfg() const;
+
+    /**
+     * Drops the cached control flow graph of the function.
+     */
+    void invalidateCFG();
+
     /**
      * \return True iff this function has no statements in its basic blocks.
      */
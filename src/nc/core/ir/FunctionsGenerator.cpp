@@ -25,8 +25,8 @@
 #include "FunctionsGenerator.h"
 
 #include <boost/range/adaptor/map.hpp>
-#include <boost/unordered_set.hpp>
 
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
 #include <nc/common/Range.h>
 
@@ -44,29 +44,7 @@ namespace nc {
 namespace core {
 namespace ir {
 
-namespace {
-
-void dfs(
-    const CFG &cfg,
-    const BasicBlock *basicBlock,
-    boost::unordered_set<const BasicBlock *> &visited,
-    std::vector<const BasicBlock *> &trace)
-{
-    visited.insert(basicBlock);
-    trace.push_back(basicBlock);
-
-    foreach (const BasicBlock *successor, cfg.getSuccessors(basicBlock)) {
-        if (visited.find(successor) == visited.end()) {
-            dfs(cfg, successor, visited, trace);
-        }
-    }
-}
-
-} // anonymous namespace
-
 void FunctionsGenerator::makeFunctions(const Program &program, Functions &functions) const {
-    boost::unordered_set<const BasicBlock *> processed;
-
     CFG cfg(program.basicBlocks());
 
     auto addFunction = [&](const std::vector<const BasicBlock *> basicBlocks, const BasicBlock *entry) {
@@ -94,35 +72,69 @@ void FunctionsGenerator::makeFunctions(const Program &program, Functions &functi
         functions.addFunction(std::move(function));
     };
 
+    auto successors = [&cfg](CFG::Index index) { return cfg.getSuccessors(index); };
+
+    /* Returns the basic blocks discovered by the given search starting from the given position in its preorder. */
+    auto getTrace = [&cfg](const std::vector<CFG::Index> &preorder, std::size_t start) {
+        std::vector<const BasicBlock *> trace;
+        trace.reserve(preorder.size() - start);
+        for (std::size_t i = start; i < preorder.size(); ++i) {
+            trace.push_back(cfg.getBasicBlock(preorder[i]));
+        }
+        return trace;
+    };
+
+    /* Basic blocks that were put into some function. */
+    std::vector<bool> processed(cfg.size());
+
     /* Generate all functions being called. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && program.isCalledAddress(*basicBlock->address())) {
-            boost::unordered_set<const BasicBlock *> visited;
-            std::vector<const BasicBlock *> trace;
-
-            dfs(cfg, basicBlock, visited, trace);
-            addFunction(trace, basicBlock);
-            processed.insert(trace.begin(), trace.end());
+    {
+        auto dfs = makeDepthFirstSearch(cfg.size(), successors);
+
+        for (CFG::Index index = 0; index < cfg.size(); ++index) {
+            const BasicBlock *basicBlock = cfg.getBasicBlock(index);
+
+            if (basicBlock->address() && program.isCalledAddress(*basicBlock->address())) {
+                dfs.visit(index);
+                addFunction(getTrace(dfs.preorder(), 0), basicBlock);
+
+                foreach (auto visited, dfs.preorder()) {
+                    processed[visited] = true;
+                }
+                dfs.reset();
+            }
+        }
+    }
+
+    /* All other searches share the set of visited basic blocks. */
+    auto dfs = makeDepthFirstSearch(cfg.size(), successors);
+    for (CFG::Index index = 0; index < cfg.size(); ++index) {
+        if (processed[index]) {
+            dfs.markVisited(index);
         }
     }
 
     /* Single out all other possible functions. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && cfg.getPredecessors(basicBlock).empty() && !contains(processed, basicBlock)) {
-            std::vector<const BasicBlock *> trace;
+    for (CFG::Index index = 0; index < cfg.size(); ++index) {
+        const BasicBlock *basicBlock = cfg.getBasicBlock(index);
+
+        if (basicBlock->address() && cfg.getPredecessors(index).empty() && !dfs.isVisited(index)) {
+            auto start = dfs.preorder().size();
 
-            dfs(cfg, basicBlock, processed, trace);
-            addFunction(trace, basicBlock);
+            dfs.visit(index);
+            addFunction(getTrace(dfs.preorder(), start), basicBlock);
         }
     }
 
     /* Single out remaining weird strongly connected components. */
-    foreach (const BasicBlock *basicBlock, program.basicBlocks()) {
-        if (basicBlock->address() && !contains(processed, basicBlock)) {
-            std::vector<const BasicBlock *> trace;
+    for (CFG::Index index = 0; index < cfg.size(); ++index) {
+        const BasicBlock *basicBlock = cfg.getBasicBlock(index);
 
-            dfs(cfg, basicBlock, processed, trace);
-            addFunction(trace, basicBlock);
+        if (basicBlock->address() && !dfs.isVisited(index)) {
+            auto start = dfs.preorder().size();
+
+            dfs.visit(index);
+            addFunction(getTrace(dfs.preorder(), start), basicBlock);
         }
     }
 }
@@ -190,6 +202,9 @@ FunctionsGenerator::cloneIntoFunction(const std::vector<const BasicBlock *> &bas
         }
     }
 
+    /* Jumps were modified behind the function's back. */
+    function->invalidateCFG();
+
     return clones;
 }
 
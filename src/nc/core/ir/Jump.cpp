@@ -44,6 +44,9 @@ Jump::Jump(std::unique_ptr<Term> condition, JumpTarget thenTarget, JumpTarget el
 
     condition_->setStatement(this);
 
+    thenTarget_.setJump(this);
+    elseTarget_.setJump(this);
+
     if (thenTarget_.address()) {
         thenTarget_.address()->setStatement(this);
     }
@@ -57,6 +60,9 @@ Jump::Jump(JumpTarget thenTarget):
 {
     assert(thenTarget_ && "Jump target must be valid.");
 
+    thenTarget_.setJump(this);
+    elseTarget_.setJump(this);
+
     if (thenTarget_.address()) {
         thenTarget_.address()->setStatement(this);
     }
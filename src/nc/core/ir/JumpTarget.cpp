@@ -28,22 +28,25 @@
 
 #include <QTextStream>
 
+#include "BasicBlock.h"
+#include "Function.h"
+#include "Jump.h"
 #include "Term.h"
 
 namespace nc {
 namespace core {
 namespace ir {
 
-JumpTarget::JumpTarget(): basicBlock_(nullptr) {}
+JumpTarget::JumpTarget(): basicBlock_(nullptr), jump_(nullptr) {}
 
 JumpTarget::JumpTarget(std::unique_ptr<Term> address):
-    address_(std::move(address)), basicBlock_(nullptr)
+    address_(std::move(address)), basicBlock_(nullptr), jump_(nullptr)
 {
     assert(address_ != nullptr);
 }
 
 JumpTarget::JumpTarget(BasicBlock *basicBlock):
-    basicBlock_(basicBlock)
+    basicBlock_(basicBlock), jump_(nullptr)
 {
     assert(basicBlock != nullptr);
 }
@@ -51,11 +54,12 @@ JumpTarget::JumpTarget(BasicBlock *basicBlock):
 JumpTarget::JumpTarget(const JumpTarget &other):
     address_(other.address_ ? other.address_->clone() : nullptr),
     basicBlock_(other.basicBlock_),
-    table_(other.table_ ? new JumpTable(*other.table_) : nullptr)
+    table_(other.table_ ? new JumpTable(*other.table_) : nullptr),
+    jump_(nullptr)
 {}
 
 JumpTarget::JumpTarget(JumpTarget &&other):
-    address_(std::move(other.address_)), basicBlock_(other.basicBlock_), table_(std::move(other.table_))
+    address_(std::move(other.address_)), basicBlock_(other.basicBlock_), table_(std::move(other.table_)), jump_(nullptr)
 {}
 
 JumpTarget::~JumpTarget() {}
@@ -63,6 +67,26 @@ JumpTarget::~JumpTarget() {}
 void JumpTarget::setAddress(std::unique_ptr<Term> address) {
     assert(address != nullptr);
     address_ = std::move(address);
+    if (jump_) {
+        address_->setStatement(jump_);
+    }
+    invalidateCFG();
+}
+
+void JumpTarget::setBasicBlock(BasicBlock *basicBlock) {
+    basicBlock_ = basicBlock;
+    invalidateCFG();
+}
+
+void JumpTarget::setTable(std::unique_ptr<JumpTable> table) {
+    table_ = std::move(table);
+    invalidateCFG();
+}
+
+void JumpTarget::invalidateCFG() {
+    if (jump_ && jump_->basicBlock() && jump_->basicBlock()->function()) {
+        jump_->basicBlock()->function()->invalidateCFG();
+    }
 }
 
 void JumpTarget::print(QTextStream &out) const {
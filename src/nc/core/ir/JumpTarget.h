@@ -36,6 +36,7 @@ namespace core {
 namespace ir {
 
 class BasicBlock;
+class Jump;
 class Term;
 
 /**
@@ -92,6 +93,9 @@ class JumpTarget: public PrintableBase<JumpTarget> {
     /** Jump table. */
     std::unique_ptr<JumpTable> table_;
 
+    /** Jump having this target. Can be nullptr. */
+    Jump *jump_;
+
 public:
     /**
      * Constructs an invalid jump target.
@@ -158,10 +162,14 @@ public:
      *
      * \param basicBlock Pointer to the target basic block. Can be nullptr.
      */
-    void setBasicBlock(BasicBlock *basicBlock) { basicBlock_ = basicBlock; }
+    void setBasicBlock(BasicBlock *basicBlock);
 
     /**
      * \return Pointer to the jump table. Can be nullptr.
+     *
+     * \warning Changing the entries of the table does not invalidate the
+     *          control flow graph of the function: call
+     *          Function::invalidateCFG() afterwards.
      */
     JumpTable *table() { return table_.get(); }
 
@@ -175,7 +183,7 @@ public:
      *
      * \param[in] table Pointer to the new jump table. Can be nullptr.
      */
-    void setTable(std::unique_ptr<JumpTable> table) { table_ = std::move(table); }
+    void setTable(std::unique_ptr<JumpTable> table);
 
     /**
      * \return Non-null pointer is this is a valid jump target, nullptr otherwise.
@@ -188,6 +196,22 @@ public:
      * \param out Output stream.
      */
     void print(QTextStream &out) const;
+
+private:
+    friend class Jump;
+
+    /**
+     * Sets the jump having this target.
+     *
+     * \param jump Pointer to the jump. Can be nullptr.
+     */
+    void setJump(Jump *jump) { jump_ = jump; }
+
+    /**
+     * Invalidates the control flow graph of the function containing the jump
+     * having this target, if there is such a function.
+     */
+    void invalidateCFG();
 };
 
 } // namespace ir
@@ -8,6 +8,7 @@
 #include <boost/range/adaptor/map.hpp>
 
 #include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
 #include <nc/common/make_unique.h>
 
 #include <nc/core/ir/BasicBlock.h>
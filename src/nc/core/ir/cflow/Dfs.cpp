@@ -24,8 +24,8 @@
 
 #include "Dfs.h"
 
+#include <nc/common/DepthFirstSearch.h>
 #include <nc/common/Foreach.h>
-#include <nc/common/Range.h>
 #include <nc/common/Unreachable.h>
 
 #include "Edge.h"
@@ -39,44 +39,52 @@ namespace cflow {
 Dfs::Dfs(const cflow::Region *region) {
     assert(region != nullptr);
 
-    preordering_.reserve(region->nodes().size());
-    postordering_.reserve(region->nodes().size());
+    const auto &nodes = region->nodes();
 
-    visit(region->entry());
+    /* Nodes are numbered by their positions in the region, see Region::adoptNodes(). */
+    auto getIndex = [&](const Node *node) -> std::size_t {
+        assert(node->parent() == region);
+        assert(node->index() < nodes.size() && nodes[node->index()] == node);
+        return node->index();
+    };
 
-    foreach (cflow::Node *node, region->nodes()) {
-        if (find(node2color_, node) == WHITE) {
-            visit(node);
-        }
-    }
-}
+    auto dfs = makeDepthFirstSearch(nodes.size(),
+        [&](std::size_t index) -> const std::vector<Edge *> & { return nodes[index]->outEdges(); },
+        [&](const Edge *edge) { return getIndex(edge->head()); });
 
-void Dfs::visit(cflow::Node *node) {
-    assert(node != nullptr);
-    assert(find(node2color_, node) == WHITE);
+    typedef decltype(dfs) Search;
 
-    node2color_[node] = GRAY;
-    preordering_.push_back(node);
-
-    foreach (cflow::Edge *edge, node->outEdges()) {
-        switch (find(node2color_, edge->head())) {
-        case WHITE:
+    auto classifyEdge = [this](std::size_t, const Edge *edge, Search::EdgeType type) {
+        switch (type) {
+        case Search::TREE:
             edge2type_[edge] = FORWARD;
-            visit(edge->head());
             break;
-        case GRAY:
+        case Search::BACK:
             edge2type_[edge] = BACK;
             break;
-        case BLACK:
+        case Search::CROSS:
             edge2type_[edge] = CROSS;
             break;
         default:
             unreachable();
         }
+    };
+
+    dfs.visit(getIndex(region->entry()), classifyEdge);
+
+    for (std::size_t index = 0; index < nodes.size(); ++index) {
+        dfs.visit(index, classifyEdge);
+    }
+
+    preordering_.reserve(nodes.size());
+    foreach (auto index, dfs.preorder()) {
+        preordering_.push_back(nodes[index]);
     }
 
-    node2color_[node] = BLACK;
-    postordering_.push_back(node);
+    postordering_.reserve(nodes.size());
+    foreach (auto index, dfs.postorder()) {
+        postordering_.push_back(nodes[index]);
+    }
 }
 
 } // namespace cflow
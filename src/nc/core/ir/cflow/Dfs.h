@@ -28,7 +28,6 @@
 #include <vector>
 
 #include <boost/unordered_map.hpp>
-#include <boost/unordered_set.hpp>
 
 #include <nc/common/Range.h>
 
@@ -47,13 +46,6 @@ class Region;
  */
 class Dfs {
 public:
-    /** Node color. */
-    enum NodeColor {
-        WHITE,
-        GRAY,
-        BLACK
-    };
-
     /** Edge type. */
     enum EdgeType {
         UNKNOWN,
@@ -69,9 +61,6 @@ private:
     /** List of region nodes in the order of leaving. */
     std::vector<Node *> postordering_;
 
-    /** Mapping from a node to its color. */
-    boost::unordered_map<const Node *, NodeColor> node2color_;
-
     /** Mapping from an edge to its type. */
     boost::unordered_map<const Edge *, EdgeType> edge2type_;
 
@@ -111,14 +100,6 @@ public:
      */
     EdgeType getEdgeType(const Edge *edge) const { return nc::find(edge2type_, edge, UNKNOWN); }
 
-private:
-
-    /**
-     * Visits given node and all its unvisited successors.
-     *
-     * \param node Valid pointer to a not yet visited node.
-     */
-    void visit(Node *node);
 };
 
 } // namespace cflow
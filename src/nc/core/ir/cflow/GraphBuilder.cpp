@@ -57,15 +57,15 @@ void GraphBuilder::operator()(Graph &graph, const ir::Function *function) const
     foreach (const ir::BasicBlock *basicBlock, function->basicBlocks()) {
         auto node = graph.addNode(std::make_unique<BasicNode>(basicBlock));
         graph.root()->nodes().push_back(node);
-        node->setParent(graph.root());
         basicBlock2node[basicBlock] = node;
     }
+    graph.root()->adoptNodes();
     graph.root()->setEntry(basicBlock2node[function->entry()]);
 
     /*
      * Create edges.
      */
-    CFG cfg(function->basicBlocks());
+    const CFG &cfg = function->cfg();
 
     foreach (const ir::BasicBlock *tailBasicBlock, function->basicBlocks()) {
         Node *tail = nc::find(basicBlock2node, tailBasicBlock);
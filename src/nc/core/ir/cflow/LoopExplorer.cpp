@@ -66,15 +66,24 @@ void LoopExplorer::backwardVisit(Node *node) {
     assert(node != nullptr);
     assert(find(node2color_, node) == WHITE);
 
+    std::vector<Node *> stack;
+
     node2color_[node] = GRAY;
+    stack.push_back(node);
 
-    if (node == entry_) {
-        return;
-    }
+    while (!stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
 
-    foreach (Edge *edge, node->inEdges()) {
-        if (find(node2color_, edge->tail()) == WHITE) {
-            backwardVisit(edge->tail());
+        if (node == entry_) {
+            continue;
+        }
+
+        foreach (Edge *edge, node->inEdges()) {
+            if (find(node2color_, edge->tail()) == WHITE) {
+                node2color_[edge->tail()] = GRAY;
+                stack.push_back(edge->tail());
+            }
         }
     }
 }
@@ -83,12 +92,26 @@ void LoopExplorer::forwardVisit(Node *node) {
     assert(node != nullptr);
     assert(find(node2color_, node) == GRAY);
 
+    /* Stack of (node, index of the next outgoing edge to look at) pairs. */
+    std::vector<std::pair<Node *, std::size_t>> stack;
+
     node2color_[node] = BLACK;
     loopNodes_.push_back(node);
+    stack.push_back(std::make_pair(node, 0));
+
+    while (!stack.empty()) {
+        auto &top = stack.back();
 
-    foreach (Edge *edge, node->outEdges()) {
-        if (find(node2color_, edge->head()) == GRAY) {
-            forwardVisit(edge->head());
+        if (top.second < top.first->outEdges().size()) {
+            Node *head = top.first->outEdges()[top.second++]->head();
+
+            if (find(node2color_, head) == GRAY) {
+                node2color_[head] = BLACK;
+                loopNodes_.push_back(head);
+                stack.push_back(std::make_pair(head, 0));
+            }
+        } else {
+            stack.pop_back();
         }
     }
 }
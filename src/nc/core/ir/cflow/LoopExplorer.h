@@ -80,7 +80,7 @@ public:
 
 private:
     /**
-     * Visits given node and, if the node is not entry, recursively
+     * Visits given node and, if the node is not entry, transitively
      * visits all its WHITE predecessors. All the visited nodes are
      * painted GRAY.
      *
@@ -89,7 +89,7 @@ private:
     void backwardVisit(Node *node);
 
     /**
-     * Visits given node and recursively visits all its GRAY successors.
+     * Visits given node and, in depth-first order, all its GRAY successors.
      * All the visited nodes are painted BLACK.
      *
      * \param node Valid pointer to a GRAY node.
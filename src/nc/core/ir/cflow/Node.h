@@ -29,6 +29,7 @@
 #include <nc/common/Subclass.h>
 #include <nc/common/Types.h>
 
+#include <cstddef> /* std::size_t */
 #include <vector>
 
 namespace nc {
@@ -62,6 +63,7 @@ public:
 
 private:
     Region *parent_; ///< Parent region.
+    std::size_t index_; ///< Index of the node in the nodes of the parent region.
     std::vector<Edge *> inEdges_; ///< Incoming edges.
     std::vector<Edge *> outEdges_; ///< Outgoing edges.
 
@@ -69,7 +71,7 @@ public:
     /**
      * \param kind Kind of the node.
      */
-    Node(NodeKind kind): nodeKind_(kind), parent_(nullptr) {}
+    Node(NodeKind kind): nodeKind_(kind), parent_(nullptr), index_(0) {}
 
     /**
      * Virtual destructor.
@@ -88,6 +90,12 @@ public:
      */
     void setParent(Region *parent) { parent_ = parent; }
 
+    /**
+     * \return Index of the node in parent()->nodes(), as assigned by
+     *         Region::adoptNodes() of the parent region.
+     */
+    std::size_t index() const { return index_; }
+
     /**
      * \return Incoming edges.
      */
@@ -98,6 +106,13 @@ public:
      */
     const std::vector<Edge *> &outEdges() const { return outEdges_; }
 
+    /**
+     * Sets the index of the node in the nodes of the parent region.
+     *
+     * \param[in] index Index.
+     */
+    void setIndex(std::size_t index) { index_ = index; }
+
     /**
      * \return Valid pointer to the entry basic block of the node.
      */
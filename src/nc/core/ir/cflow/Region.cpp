@@ -40,6 +40,13 @@ const BasicBlock *Region::getEntryBasicBlock() const {
     return entry()->getEntryBasicBlock();
 }
 
+void Region::adoptNodes() {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        nodes_[i]->setParent(this);
+        nodes_[i]->setIndex(i);
+    }
+}
+
 bool Region::isCondition() const {
     return regionKind_ == COMPOUND_CONDITION;
 }
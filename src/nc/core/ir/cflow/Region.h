@@ -105,6 +105,13 @@ public:
      */
     const std::vector<Node *> &nodes() const { return nodes_; }
 
+    /**
+     * Makes this region the parent of all its nodes and numbers the nodes
+     * by their positions in nodes(). Must be called after changing nodes(),
+     * as Dfs relies on this numbering.
+     */
+    void adoptNodes();
+
     /**
      * Adds subregion to the region.
      * All nodes of the subregion are removed from the region.
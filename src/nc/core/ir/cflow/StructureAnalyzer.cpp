@@ -575,9 +575,7 @@ Region *StructureAnalyzer::insertSubregion(Region *region, std::unique_ptr<Regio
         return nullptr;
     }
 
-    foreach (auto node, subregion->nodes()) {
-        node->setParent(subregion.get());
-    }
+    subregion->adoptNodes();
 
     region->nodes().erase(
         std::remove_if(
@@ -586,8 +584,8 @@ Region *StructureAnalyzer::insertSubregion(Region *region, std::unique_ptr<Regio
             [&](Node *n) { return n->parent() == subregion.get(); }),
         region->nodes().end());
 
-    subregion->setParent(region);
     region->nodes().push_back(subregion.get());
+    region->adoptNodes();
 
     /*
      * Redirect edges properly.
@@ -24,15 +24,25 @@
 
 #include "CodeGenerator.h"
 
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <nc/common/Arena.h>
 #include <nc/common/CancellationToken.h>
+#include <nc/common/CheckedCast.h>
 #include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
 #include <nc/common/Range.h>
+#include <nc/common/TextBuffer.h>
 #include <nc/common/make_unique.h>
 
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/image/Image.h>
 #include <nc/core/image/Reader.h>
 #include <nc/core/image/Relocation.h>
+#include <nc/core/ir/BasicBlock.h>
 #include <nc/core/ir/Function.h>
 #include <nc/core/ir/Functions.h>
 #include <nc/core/ir/calling/Hooks.h>
@@ -40,13 +50,19 @@
 #include <nc/core/ir/types/Type.h>
 #include <nc/core/ir/types/Types.h>
 #include <nc/core/ir/vars/Variable.h>
+#include <nc/core/ir/vars/Variables.h>
+#include <nc/core/likec/Block.h>
 #include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/FunctionIdentifier.h>
 #include <nc/core/likec/IntegerConstant.h>
+#include <nc/core/likec/Simplifier.h>
 #include <nc/core/likec/StructType.h>
 #include <nc/core/likec/StructTypeDeclaration.h>
 #include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
 #include <nc/core/likec/Typecast.h>
 
+#include "DefinitionCache.h"
 #include "DefinitionGenerator.h"
 #include "NameGenerator.h"
 
@@ -55,36 +71,263 @@ namespace core {
 namespace ir {
 namespace cgen {
 
+namespace {
+
+/**
+ * Reorders the functions, so that the ones containing the given addresses
+ * come first, in the order of the addresses. The relative order of other
+ * functions is preserved.
+ *
+ * \param begin Iterator to the first function.
+ * \param end Iterator past the last function.
+ * \param addresses Addresses, the most interesting first.
+ */
+void moveFocusedFunctionsFirst(std::vector<const Function *>::iterator begin,
+    std::vector<const Function *>::iterator end, const std::vector<ByteAddr> &addresses)
+{
+    if (addresses.empty()) {
+        return;
+    }
+
+    boost::unordered_map<const Function *, std::size_t> function2rank;
+
+    for (auto i = begin; i != end; ++i) {
+        foreach (const BasicBlock *basicBlock, (*i)->basicBlocks()) {
+            if (!basicBlock->address() || !basicBlock->successorAddress()) {
+                continue;
+            }
+            for (std::size_t rank = 0; rank < addresses.size(); ++rank) {
+                if (*basicBlock->address() <= addresses[rank] && addresses[rank] < *basicBlock->successorAddress()) {
+                    auto &functionRank = function2rank.insert(std::make_pair(*i, rank)).first->second;
+                    functionRank = std::min(functionRank, rank);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (function2rank.empty()) {
+        return;
+    }
+
+    auto getRank = [&](const Function *function) -> std::size_t {
+        auto i = function2rank.find(function);
+        return i != function2rank.end() ? i->second : addresses.size();
+    };
+
+    std::stable_sort(begin, end, [&](const Function *a, const Function *b) {
+        return getRank(a) < getRank(b);
+    });
+}
+
+} // anonymous namespace
+
+/**
+ * Declaration that can be used by the code of several functions.
+ */
+class CodeGenerator::SharedDeclaration {
+public:
+    /** The declaration, until it is added to the compilation unit. */
+    std::unique_ptr<likec::Declaration> declaration;
+
+    /** Valid pointer to the declaration. */
+    likec::Declaration *pointer;
+
+    /** Shared declarations used by this one, in the order of use. */
+    DeclarationUses uses;
+
+    /** Signature of the function, if this is a prototype, nullptr otherwise. */
+    const calling::FunctionSignature *signature;
+
+    /** Address the prototype was made for, if this is a prototype. */
+    ByteAddr functionAddress;
+
+    /** The variable, if this is a declaration of a global variable, nullptr otherwise. */
+    const vars::Variable *variable;
+
+    /** True iff the declaration was added to the compilation unit. */
+    bool added;
+
+    SharedDeclaration(std::unique_ptr<likec::Declaration> declaration, DeclarationUses uses):
+        declaration(std::move(declaration)), pointer(this->declaration.get()), uses(std::move(uses)),
+        signature(nullptr), functionAddress(0), variable(nullptr), added(false)
+    {}
+};
+
+CodeGenerator::CodeGenerator(likec::Tree &tree, const image::Image &image, const Functions &functions,
+    const calling::Hooks &hooks, const calling::Signatures &signatures, const dflow::Dataflows &dataflows,
+    const vars::Variables &variables, const cflow::Graphs &graphs, const liveness::Livenesses &livenesses,
+    const types::Types &types, const CancellationToken &cancellationToken
+):
+    tree_(tree), image_(image), functions_(functions), hooks_(hooks), signatures_(signatures),
+    dataflows_(dataflows), variables_(variables), graphs_(graphs), livenesses_(livenesses),
+    types_(types), cancellationToken_(cancellationToken), nameGenerator_(image),
+    keepStreamedDefinitions_(false), definitionCache_(nullptr), mutex_(QMutex::Recursive), structTypeCount_(0)
+{}
+
+CodeGenerator::~CodeGenerator() {}
+
 void CodeGenerator::makeCompilationUnit() {
+    /*
+     * Nodes go to the tree's arena, unless the bodies of streamed definitions
+     * are dropped: memory of the latter must be reclaimed right away.
+     */
+    auto arena = declarationSink_ && !keepStreamedDefinitions_ ? nullptr : &tree().arena();
+    Arena::Scope arenaScope(arena);
+
     tree().setPointerSize(image().platform().architecture()->bitness());
     tree().setIntSize(image().platform().intSize());
     tree().setRoot(std::make_unique<likec::CompilationUnit>());
 
-    foreach (const Function *function, functions().list()) {
-        makeFunctionDefinition(function);
-        cancellationToken().poll();
+    /* Make lookups of types read-only, so that they can be done concurrently. */
+    types().compressPaths();
+
+    if (definitionCache_) {
+        foreach (const vars::Variable *variable, variables().list()) {
+            if (variable->isGlobal()) {
+                globalVariables_[variable->memoryLocation()] = variable;
+            }
+        }
+    }
+
+    std::vector<const Function *> functions;
+    foreach (const Function *function, this->functions().list()) {
+        functions.push_back(function);
+    }
+
+    /*
+     * When declarations are streamed to a sink, functions are generated in
+     * batches, so that only the definitions of one batch are kept at once.
+     */
+    std::size_t batchSize = functions.size();
+    if (declarationSink_) {
+        batchSize = std::max(QThread::idealThreadCount(), 1) * 4;
     }
 
-    tree().rewriteRoot();
+    std::vector<likec::FunctionDefinition *> definitionPointers;
+    definitionPointers.reserve(functions.size());
+
+    int focusVersion = -1;
+
+    for (std::size_t batchBegin = 0; batchBegin < functions.size(); batchBegin += batchSize) {
+        std::size_t batchEnd = std::min(batchBegin + batchSize, functions.size());
+
+        if (declarationSink_ && focusToken_.version() != focusVersion) {
+            focusVersion = focusToken_.version();
+            moveFocusedFunctionsFirst(functions.begin() + batchBegin, functions.end(), focusToken_.addresses());
+        }
+
+        std::vector<std::unique_ptr<likec::FunctionDefinition>> definitions(batchEnd - batchBegin);
+        std::vector<DeclarationUses> uses(batchEnd - batchBegin);
+
+        parallelFor(definitions.size(), [&](std::size_t index) {
+            Arena::Scope arenaScope(arena);
+
+            auto function = functions[batchBegin + index];
+
+            QByteArray key;
+            if (definitionCache_) {
+                key = computeDefinitionKey(*this, function);
+                definitions[index] = loadDefinition(function, key, uses[index]);
+                definitionCache_->recordLookup(definitions[index] != nullptr);
+            }
+
+            if (!definitions[index]) {
+                DefinitionGenerator generator(*this, function, cancellationToken());
+                auto definition = generator.createDefinition();
+                uses[index] = std::move(generator.uses());
+
+                /* Simplify right away, so that unsimplified definitions of all functions are not kept at once. */
+                definitions[index] = likec::Simplifier(tree()).simplify(std::move(definition));
+
+                if (!key.isEmpty()) {
+                    storeDefinition(definitions[index].get(), key, uses[index]);
+                }
+            }
+
+            cancellationToken().poll();
+        });
+
+        /*
+         * Add the definitions to the compilation unit in the order of functions,
+         * each one preceded by the shared declarations it uses.
+         */
+        for (std::size_t index = 0; index < definitions.size(); ++index) {
+            auto definition = definitions[index].get();
+            auto firstNewDeclaration = tree().root()->declarations().size();
+
+            setFunctionDeclaration(signatures().getSignature(functions[batchBegin + index]).get(), definition);
+
+            foreach (auto sharedDeclaration, uses[index]) {
+                addToCompilationUnit(sharedDeclaration);
+            }
+
+            tree().root()->addDeclaration(std::move(definitions[index]));
+            definition2function_[definition] = functions[batchBegin + index];
+
+            if (declarationSink_) {
+                /* All the functions this one calls have been declared by now. */
+                replacePrototypes(definition, getPrototypeReplacements(uses[index]));
+
+                for (auto i = firstNewDeclaration; i < tree().root()->declarations().size(); ++i) {
+                    declarationSink_(tree().root()->declarations()[i].get());
+                }
+
+                if (!keepStreamedDefinitions_) {
+                    /* The header of the definition stays, as later declarations can refer to it. */
+                    definition->block() = std::make_unique<likec::Block>();
+                    definition->labels().clear();
+                    definition->setBodyText(QString());
+                }
+            } else {
+                definitionPointers.push_back(definition);
+            }
+        }
+    }
+
+    /* Calls to functions whose prototypes were not added must refer to the existing declarations. */
+    DeclarationUses allDeclarations;
+    foreach (const auto &sharedDeclaration, sharedDeclarations_) {
+        allDeclarations.push_back(sharedDeclaration.get());
+    }
+    auto replacements = getPrototypeReplacements(allDeclarations);
+
+    if (!replacements.empty()) {
+        parallelFor(definitionPointers.size(), [&](std::size_t index) {
+            replacePrototypes(definitionPointers[index], replacements);
+        });
+    }
+
+    /*
+     * There is no need to rewrite the whole tree: definitions have already
+     * been simplified, and simplification leaves other declarations as is.
+     */
+}
+
+const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits, DeclarationUses &uses) {
+    std::vector<const types::Type *> typeCreationStack;
+    return makeType(typeTraits, typeCreationStack, uses);
 }
 
-const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits) {
+const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits, std::vector<const types::Type *> &typeCreationStack,
+                                           DeclarationUses &uses)
+{
     assert(!typeTraits || typeTraits->findSet() == typeTraits);
 
     if (!typeTraits) {
         return tree().makeVoidType();
     } else if (typeTraits->isPointer()) {
-        if (std::find(typeCreationStack_.begin(), typeCreationStack_.end(), typeTraits) != typeCreationStack_.end()) {
+        if (std::find(typeCreationStack.begin(), typeCreationStack.end(), typeTraits) != typeCreationStack.end()) {
             /* Circular dependency. */
             return tree().makePointerType(typeTraits->size(), tree().makeVoidType());
 #ifdef NC_STRUCT_RECOVERY
-        } else if (const likec::Type *structuralType = makeStructuralType(typeTraits)) {
+        } else if (const likec::Type *structuralType = makeStructuralType(typeTraits, uses)) {
             return tree().makePointerType(typeTraits->size(), structuralType);
 #endif
         } else {
-            typeCreationStack_.push_back(typeTraits);
-            const likec::Type *pointee = makeType(typeTraits->pointee());
-            typeCreationStack_.pop_back();
+            typeCreationStack.push_back(typeTraits);
+            const likec::Type *pointee = makeType(typeTraits->pointee(), typeCreationStack, uses);
+            typeCreationStack.pop_back();
 
             return tree().makePointerType(typeTraits->size(), pointee);
         }
@@ -96,7 +339,7 @@ const likec::Type *CodeGenerator::makeType(const types::Type *typeTraits) {
 }
 
 #ifdef NC_STRUCT_RECOVERY
-const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *typeTraits) {
+const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *typeTraits, DeclarationUses &uses) {
     assert(typeTraits->findSet() == typeTraits);
 
     if (!typeTraits->isPointer()) {
@@ -107,9 +350,11 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
         return nullptr;
     }
 
-    auto i = traits2structType_.find(typeTraits);
-    if (i != traits2structType_.end()) {
-        return i->second;
+    QMutexLocker locker(&mutex_);
+
+    if (auto sharedDeclaration = nc::find(traits2structType_, typeTraits)) {
+        uses.push_back(sharedDeclaration);
+        return checked_cast<likec::StructTypeDeclaration *>(sharedDeclaration->pointer)->type();
     }
 
     bool isStruct = false;
@@ -130,11 +375,19 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
         return nullptr;
     }
 
-    auto typeDeclaration = std::make_unique<likec::StructTypeDeclaration>(QString("s%1").arg(traits2structType_.size()));
-
+    /* The name is given when the declaration is added to the compilation unit. */
+    auto typeDeclaration = std::make_unique<likec::StructTypeDeclaration>(QString());
     likec::StructType *type = typeDeclaration->type();
-    traits2structType_[typeTraits] = type;
 
+    auto sharedDeclaration = addSharedDeclaration(std::move(typeDeclaration), DeclarationUses());
+    traits2structType_[typeTraits] = sharedDeclaration;
+    uses.push_back(sharedDeclaration);
+
+    /*
+     * Types of members are made from scratch, not in the context of the type
+     * being made by the caller, so that the struct is the same, no matter
+     * which function has used it first.
+     */
     foreach (auto offset, typeTraits->offsets()) {
         ByteSize offsetValue = offset.first;
         const types::Type *offsetType = offset.second->findSet();
@@ -145,41 +398,41 @@ const likec::StructType *CodeGenerator::makeStructuralType(const types::Type *ty
 
         if (offsetValue >= 0 && offsetType->pointee() && offsetType->pointee()->size()) {
             if (offsetValue > type->size() / CHAR_BIT) {
-                typeDeclaration->type()->addMember(std::make_unique<likec::MemberDeclaration>(
+                type->addMember(std::make_unique<likec::MemberDeclaration>(
                     QString("pad%1").arg(offsetValue),
                     tree_.makeArrayType(tree_.makeIntegerType(CHAR_BIT, false), offsetValue - type->size() / CHAR_BIT)));
             }
-            typeDeclaration->type()->addMember(std::make_unique<likec::MemberDeclaration>(
-                QString("f%1").arg(offsetValue), makeType(offsetType->pointee())));
+            type->addMember(std::make_unique<likec::MemberDeclaration>(
+                QString("f%1").arg(offsetValue), makeType(offsetType->pointee(), sharedDeclaration->uses)));
         }
     }
 
-    tree().root()->addDeclaration(std::move(typeDeclaration));
-
     return type;
 }
 #endif
 
-const likec::Type *CodeGenerator::makeVariableType(const vars::Variable *variable) {
+const likec::Type *CodeGenerator::makeVariableType(const vars::Variable *variable, DeclarationUses &uses) {
     assert(variable != nullptr);
 
     foreach (auto termAndLocation, variable->termsAndLocations()) {
         if (termAndLocation.location == variable->memoryLocation()) {
-            return makeType(types().getType(termAndLocation.term));
+            return makeType(types().getType(termAndLocation.term), uses);
         }
     }
 
     return tree().makeIntegerType(variable->memoryLocation().size(), true);
 }
 
-likec::VariableDeclaration *CodeGenerator::makeGlobalVariableDeclaration(const vars::Variable *variable) {
+likec::VariableDeclaration *CodeGenerator::makeGlobalVariableDeclaration(const vars::Variable *variable, DeclarationUses &uses) {
     assert(variable != nullptr);
     assert(variable->isGlobal());
 
-    if (auto result = nc::find(variableDeclarations_, variable)) {
-        return result;
-    } else {
-        auto type = makeVariableType(variable);
+    QMutexLocker locker(&mutex_);
+
+    auto sharedDeclaration = nc::find(variableDeclarations_, variable);
+    if (!sharedDeclaration) {
+        DeclarationUses typeUses;
+        auto type = makeVariableType(variable, typeUses);
         auto initialValue = makeInitialValue(variable->memoryLocation(), type);
         auto nameAndComment = nameGenerator().getGlobalVariableName(variable->memoryLocation());
 
@@ -189,14 +442,14 @@ likec::VariableDeclaration *CodeGenerator::makeGlobalVariableDeclaration(const v
             std::move(initialValue));
         declaration->setComment(std::move(nameAndComment.comment()));
 
-        result = declaration.get();
-        tree().root()->addDeclaration(std::move(declaration));
-        variableDeclarations_[variable] = result;
-
-        return result;
+        sharedDeclaration = addSharedDeclaration(std::move(declaration), std::move(typeUses));
+        sharedDeclaration->variable = variable;
+        variableDeclarations_[variable] = sharedDeclaration;
     }
-}
 
+    uses.push_back(sharedDeclaration);
+    return checked_cast<likec::VariableDeclaration *>(sharedDeclaration->pointer);
+}
 std::unique_ptr<likec::Expression> CodeGenerator::makeInitialValue(const MemoryLocation &memoryLocation, const likec::Type *type) {
     assert(memoryLocation);
     assert(type != nullptr);
@@ -225,25 +478,124 @@ std::unique_ptr<likec::Expression> CodeGenerator::makeInitialValue(const MemoryL
     return nullptr;
 }
 
-likec::FunctionDeclaration *CodeGenerator::makeFunctionDeclaration(ByteAddr addr) {
+likec::FunctionDeclaration *CodeGenerator::makeFunctionDeclaration(ByteAddr addr, DeclarationUses &uses) {
     auto signature = signatures().getSignature(addr).get();
     if (!signature) {
         return nullptr;
     }
 
-    if (auto declaration = nc::find(signature2declaration_, signature)) {
-        return declaration;
+    QMutexLocker locker(&mutex_);
+
+    auto sharedDeclaration = nc::find(signature2prototype_, signature);
+    if (!sharedDeclaration) {
+        DeclarationGenerator generator(*this, calling::EntryAddress(addr), signature);
+        auto declaration = generator.createDeclaration();
+
+        sharedDeclaration = addSharedDeclaration(std::move(declaration), std::move(generator.uses()));
+        sharedDeclaration->signature = signature;
+        sharedDeclaration->functionAddress = addr;
+        signature2prototype_[signature] = sharedDeclaration;
     }
 
-    DeclarationGenerator generator(*this, calling::EntryAddress(addr), signature);
-    tree().root()->addDeclaration(generator.createDeclaration());
-    return generator.declaration();
+    uses.push_back(sharedDeclaration);
+    return checked_cast<likec::FunctionDeclaration *>(sharedDeclaration->pointer);
+}
+
+CodeGenerator::SharedDeclaration *CodeGenerator::addSharedDeclaration(std::unique_ptr<likec::Declaration> declaration, DeclarationUses uses) {
+    assert(declaration != nullptr);
+
+    sharedDeclarations_.push_back(std::make_unique<SharedDeclaration>(std::move(declaration), std::move(uses)));
+    return sharedDeclarations_.back().get();
 }
 
-likec::FunctionDefinition *CodeGenerator::makeFunctionDefinition(const Function *function) {
+std::unique_ptr<likec::FunctionDefinition> CodeGenerator::loadDefinition(const Function *function,
+    const QByteArray &key, DeclarationUses &uses)
+{
+    DefinitionCache::Entry entry;
+    if (!definitionCache_->load(key, entry)) {
+        return nullptr;
+    }
+
+    /* Recreate the shared declarations in the order the generated definition has used them. */
+    DeclarationUses cachedUses;
+    foreach (const auto &use, entry.uses) {
+        if (use.kind() == DefinitionCache::Use::FUNCTION) {
+            if (!makeFunctionDeclaration(use.address(), cachedUses)) {
+                return nullptr;
+            }
+        } else {
+            auto variable = nc::find(globalVariables_, use.memoryLocation());
+            if (!variable) {
+                return nullptr;
+            }
+            makeGlobalVariableDeclaration(variable, cachedUses);
+        }
+    }
+
+    /* The header is generated as usual: later declarations refer to it. */
     DefinitionGenerator generator(*this, function, cancellationToken());
-    tree().root()->addDeclaration(generator.createDefinition());
-    return generator.definition();
+    auto definition = generator.createHeader();
+    definition->block() = std::make_unique<likec::Block>();
+    definition->setBodyText(std::move(entry.bodyText));
+
+    uses.insert(uses.end(), cachedUses.begin(), cachedUses.end());
+    return definition;
+}
+
+void CodeGenerator::storeDefinition(const likec::FunctionDefinition *definition, const QByteArray &key,
+    const DeclarationUses &uses)
+{
+    assert(definition != nullptr);
+
+    DefinitionCache::Entry entry;
+
+    foreach (auto sharedDeclaration, uses) {
+        if (sharedDeclaration->signature) {
+            entry.uses.push_back(DefinitionCache::Use(sharedDeclaration->functionAddress));
+        } else if (sharedDeclaration->variable) {
+            entry.uses.push_back(DefinitionCache::Use(sharedDeclaration->variable->memoryLocation()));
+        } else {
+            /* Names of structural types depend on the order of adding them to the compilation unit. */
+            return;
+        }
+    }
+
+    MemoryTextSink sink;
+    {
+        TextBuffer buffer(sink);
+        likec::TreePrinter(buffer).print(definition->block());
+    }
+    entry.bodyText = QString::fromUtf8(sink.data().constData(), sink.data().size());
+
+    definitionCache_->store(key, entry);
+}
+
+void CodeGenerator::addToCompilationUnit(SharedDeclaration *sharedDeclaration) {
+    assert(sharedDeclaration != nullptr);
+
+    if (sharedDeclaration->added) {
+        return;
+    }
+
+    if (sharedDeclaration->signature) {
+        if (nc::contains(signature2declaration_, sharedDeclaration->signature)) {
+            /* The function has already been declared or defined. */
+            return;
+        }
+        setFunctionDeclaration(sharedDeclaration->signature, checked_cast<likec::FunctionDeclaration *>(sharedDeclaration->pointer));
+    }
+
+    sharedDeclaration->added = true;
+
+    if (sharedDeclaration->pointer->is<likec::StructTypeDeclaration>()) {
+        sharedDeclaration->pointer->setIdentifier(QString("s%1").arg(structTypeCount_++));
+    }
+
+    foreach (auto use, sharedDeclaration->uses) {
+        addToCompilationUnit(use);
+    }
+
+    tree().root()->addDeclaration(std::move(sharedDeclaration->declaration));
 }
 
 void CodeGenerator::setFunctionDeclaration(const calling::FunctionSignature *signature, likec::FunctionDeclaration *declaration) {
@@ -258,6 +610,49 @@ void CodeGenerator::setFunctionDeclaration(const calling::FunctionSignature *sig
     }
 }
 
+boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDeclaration *>
+CodeGenerator::getPrototypeReplacements(const DeclarationUses &declarations) const {
+    boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDeclaration *> result;
+
+    foreach (auto sharedDeclaration, declarations) {
+        if (sharedDeclaration->signature && !sharedDeclaration->added) {
+            auto declaration = nc::find(signature2declaration_, sharedDeclaration->signature);
+            assert(declaration != nullptr);
+            result[checked_cast<likec::FunctionDeclaration *>(sharedDeclaration->pointer)] = declaration;
+        }
+    }
+
+    return result;
+}
+
+void CodeGenerator::replacePrototypes(likec::FunctionDefinition *definition,
+    const boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDeclaration *> &replacements)
+{
+    assert(definition != nullptr);
+
+    std::vector<likec::TreeNode *> stack;
+    stack.push_back(definition);
+
+    std::function<void(likec::TreeNode *)> push = [&](likec::TreeNode *node) {
+        stack.push_back(node);
+    };
+
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+
+        if (auto expression = node->as<likec::Expression>()) {
+            if (auto identifier = expression->as<likec::FunctionIdentifier>()) {
+                if (auto declaration = nc::find(replacements, identifier->declaration())) {
+                    identifier->setDeclaration(declaration);
+                }
+            }
+        }
+
+        node->callOnChildren(push);
+    }
+}
+
 } // namespace cgen
 } // namespace ir
 } // namespace core
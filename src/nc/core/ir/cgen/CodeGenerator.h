@@ -25,11 +25,17 @@
 
 #include <nc/config.h>
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <boost/unordered_map.hpp>
 
+#include <QByteArray>
+#include <QMutex>
+
+#include <nc/common/FocusToken.h>
 #include <nc/core/ir/MemoryLocation.h>
 
 #include "NameGenerator.h"
@@ -45,6 +51,7 @@ namespace image {
 }
 
 namespace likec {
+    class Declaration;
     class FunctionDeclaration;
     class FunctionDefinition;
     class Expression;
@@ -91,10 +98,29 @@ namespace vars {
 
 namespace cgen {
 
+class DefinitionCache;
+
 /**
  * LikeC code generator.
+ *
+ * Definitions of functions are generated in parallel. Declarations used
+ * by several functions (structural types, global variables, prototypes
+ * of functions) are created on first use by any function and are shared.
+ * The generated definitions are added to the compilation unit in the
+ * order of functions, and each shared declaration is added just before
+ * the first definition or declaration using it. This way, the result
+ * does not depend on how the generation of functions was scheduled.
  */
 class CodeGenerator: boost::noncopyable {
+public:
+    class SharedDeclaration;
+
+    /**
+     * Shared declarations used by a piece of generated code, in the order of use.
+     */
+    typedef std::vector<SharedDeclaration *> DeclarationUses;
+
+private:
     likec::Tree &tree_;
     const image::Image &image_;
     const Functions &functions_;
@@ -108,18 +134,45 @@ class CodeGenerator: boost::noncopyable {
     const CancellationToken &cancellationToken_;
     const NameGenerator nameGenerator_;
 
-    /** Types being translated to LikeC. */
-    std::vector<const ir::types::Type *> typeCreationStack_;
+    /** Consumer of complete top-level declarations. Can be empty. */
+    std::function<void(const likec::Declaration *)> declarationSink_;
+
+    /** Whether bodies of definitions passed to the sink are kept. */
+    bool keepStreamedDefinitions_;
+
+    /** Addresses of the code to generate first. */
+    FocusToken focusToken_;
+
+    /** Cache of generated definitions. Can be nullptr. */
+    const DefinitionCache *definitionCache_;
+
+    /** Global variables by their memory locations, for definitions taken from the cache. */
+    boost::unordered_map<MemoryLocation, const vars::Variable *> globalVariables_;
+
+    /** Mutex guarding the shared declarations. */
+    QMutex mutex_;
+
+    /** All shared declarations created so far. */
+    std::vector<std::unique_ptr<SharedDeclaration>> sharedDeclarations_;
 
     /** Structural types generated for IR types. */
-    boost::unordered_map<const ir::types::Type *, const likec::StructType *> traits2structType_;
+    boost::unordered_map<const ir::types::Type *, SharedDeclaration *> traits2structType_;
+
+    /** Declarations of global variables. */
+    boost::unordered_map<const vars::Variable *, SharedDeclaration *> variableDeclarations_;
 
-    /** Already declared global variables. */
-    boost::unordered_map<const vars::Variable *, likec::VariableDeclaration *> variableDeclarations_;
+    /** Prototypes of functions. */
+    boost::unordered_map<const calling::FunctionSignature *, SharedDeclaration *> signature2prototype_;
 
-    /** Mapping of functions to their declarations. */
+    /** Mapping of functions to the first of their declarations added to the compilation unit. */
     boost::unordered_map<const calling::FunctionSignature *, likec::FunctionDeclaration *> signature2declaration_;
 
+    /** Number of structural types added to the compilation unit. */
+    std::size_t structTypeCount_;
+
+    /** Mapping of the generated function definitions to their functions. */
+    boost::unordered_map<const likec::FunctionDefinition *, const Function *> definition2function_;
+
 public:
 
     /**
@@ -140,12 +193,12 @@ public:
     CodeGenerator(likec::Tree &tree, const image::Image &image, const Functions &functions, const calling::Hooks &hooks,
         const calling::Signatures &signatures, const dflow::Dataflows &dataflows, const vars::Variables &variables,
         const cflow::Graphs &graphs, const liveness::Livenesses &livenesses, const types::Types &types,
-        const CancellationToken &cancellationToken
-    ):
-        tree_(tree), image_(image), functions_(functions), hooks_(hooks), signatures_(signatures),
-        dataflows_(dataflows), variables_(variables), graphs_(graphs), livenesses_(livenesses),
-        types_(types), cancellationToken_(cancellationToken), nameGenerator_(image)
-    {}
+        const CancellationToken &cancellationToken);
+
+    /**
+     * Destructor.
+     */
+    ~CodeGenerator();
 
     /**
      * \return Abstract syntax tree to generate code in.
@@ -204,6 +257,54 @@ public:
 
     const NameGenerator &nameGenerator() const { return nameGenerator_; }
 
+    /**
+     * \return Mapping of the function definitions added to the compilation
+     *         unit to the functions they were generated from.
+     */
+    boost::unordered_map<const likec::FunctionDefinition *, const Function *> &definition2function() {
+        return definition2function_;
+    }
+
+    /**
+     * Sets the consumer of top-level declarations.
+     *
+     * When set, functions are generated in batches, and each top-level
+     * declaration is passed to the sink as soon as it is added to the
+     * compilation unit. Unless keepDefinitions is true, the body of a function
+     * definition is freed right after the definition has been passed to the sink.
+     *
+     * \param sink Consumer of declarations. Can be empty.
+     * \param keepDefinitions Whether to keep the bodies of function definitions.
+     */
+    void setDeclarationSink(std::function<void(const likec::Declaration *)> sink, bool keepDefinitions = false) {
+        declarationSink_ = std::move(sink);
+        keepStreamedDefinitions_ = keepDefinitions;
+    }
+
+    /**
+     * Sets the token telling which code the user is interested in.
+     *
+     * When declarations are streamed to a sink, functions containing the
+     * addresses in focus are generated before the others. The focus is
+     * checked again before each batch of functions.
+     *
+     * \param token Focus token.
+     */
+    void setFocusToken(const FocusToken &token) { focusToken_ = token; }
+
+    /**
+     * Sets the cache of generated definitions.
+     *
+     * When set, the body of a function definition is taken from the cache
+     * if the function and everything the analyses know about it have not
+     * changed since the definition was stored. Such a definition has an empty
+     * block and keeps the printed body instead (see likec::FunctionDefinition::bodyText()).
+     * Generated definitions are stored in the cache.
+     *
+     * \param cache Pointer to the cache. Can be nullptr.
+     */
+    void setDefinitionCache(const DefinitionCache *cache) { definitionCache_ = cache; }
+
     /**
      * Translates input program into LikeC compilation unit.
      */
@@ -211,33 +312,43 @@ public:
 
     /**
      * Creates high-level type object from given type traits.
+     * Can be called concurrently.
      *
-     * \param typeTraits Type traits.
+     * \param[in] typeTraits Type traits.
+     * \param[out] uses Shared declarations used by the type are appended here.
      */
-    const likec::Type *makeType(const types::Type *typeTraits);
+    const likec::Type *makeType(const types::Type *typeTraits, DeclarationUses &uses);
 
 #ifdef NC_STRUCT_RECOVERY
     /**
      * Creates high-level description of struct type from given type traits of a pointer to such struct.
+     * Can be called concurrently.
      *
-     * \param typeTraits Type traits.
+     * \param[in] typeTraits Type traits.
+     * \param[out] uses The declaration of the struct is appended here.
      */
-    const likec::StructType *makeStructuralType(const types::Type *typeTraits);
+    const likec::StructType *makeStructuralType(const types::Type *typeTraits, DeclarationUses &uses);
 #endif
 
     /**
-     * \param variable Valid pointer to a variable.
+     * Can be called concurrently.
+     *
+     * \param[in] variable Valid pointer to a variable.
+     * \param[out] uses Shared declarations used by the type are appended here.
      *
      * \return Valid pointer to the LikeC type of this variable.
      */
-    const likec::Type *makeVariableType(const vars::Variable *variable);
+    const likec::Type *makeVariableType(const vars::Variable *variable, DeclarationUses &uses);
 
     /**
+     * Can be called concurrently.
+     *
      * \param[in] variable Valid pointer to a global variable.
+     * \param[out] uses The shared declaration of the variable is appended here.
      *
      * \return Valid pointer to corresponding global variable declaration.
      */
-    likec::VariableDeclaration *makeGlobalVariableDeclaration(const vars::Variable *variable);
+    likec::VariableDeclaration *makeGlobalVariableDeclaration(const vars::Variable *variable, DeclarationUses &uses);
 
     /**
      * \param[in] memoryLocation Valid memory location.
@@ -249,36 +360,104 @@ public:
     std::unique_ptr<likec::Expression> makeInitialValue(const MemoryLocation &memoryLocation, const likec::Type *type);
 
     /**
-     * Creates a function's declaration, if it was not yet, and adds it to the compilation unit.
+     * Creates a prototype of a function, if it was not yet.
+     * Can be called concurrently.
      *
      * \param[in] addr Address of a function.
+     * \param[out] uses The shared prototype is appended here.
      *
-     * \return Pointer to the declaration for a function with this address.
+     * \return Pointer to the prototype for a function with this address.
      *         Will be nullptr if no signature is known for the function at this address.
+     *
+     * \note If the compilation unit gets a definition of the function before
+     *       the prototype is used, references to the prototype are replaced
+     *       by references to the definition, and the prototype is not added
+     *       to the compilation unit.
+     */
+    likec::FunctionDeclaration *makeFunctionDeclaration(ByteAddr addr, DeclarationUses &uses);
+
+private:
+    /**
+     * Creates high-level type object from given type traits.
+     *
+     * \param[in] typeTraits Type traits.
+     * \param[in,out] typeCreationStack Pointer types being translated to LikeC.
+     * \param[out] uses Shared declarations used by the type are appended here.
+     */
+    const likec::Type *makeType(const types::Type *typeTraits, std::vector<const types::Type *> &typeCreationStack,
+                                DeclarationUses &uses);
+
+    /**
+     * Takes ownership of a shared declaration.
+     * Must be called with the mutex locked.
+     *
+     * \param[in] declaration Valid pointer to the declaration.
+     * \param[in] uses Shared declarations used by this one.
+     *
+     * \return Valid pointer to the shared declaration.
      */
-    likec::FunctionDeclaration *makeFunctionDeclaration(ByteAddr addr);
+    SharedDeclaration *addSharedDeclaration(std::unique_ptr<likec::Declaration> declaration, DeclarationUses uses);
 
     /**
-     * Creates function's definition and adds it to the compilation unit.
+     * Takes the definition of a function from the cache, if it is there.
+     * Can be called concurrently.
      *
-     * \param[in] function Function to create definition for.
+     * \param[in] function Valid pointer to the function.
+     * \param[in] key Key of the definition in the cache.
+     * \param[out] uses Shared declarations used by the definition are appended here.
      *
-     * \return Created function definition.
+     * \return Pointer to the definition with the body taken from the cache,
+     *         or nullptr if the cache has no usable definition.
      */
-    likec::FunctionDefinition *makeFunctionDefinition(const Function *function);
+    std::unique_ptr<likec::FunctionDefinition> loadDefinition(const Function *function, const QByteArray &key,
+                                                               DeclarationUses &uses);
 
     /**
-     * Registers a declaration of a function.
+     * Stores a generated definition in the cache, unless it uses
+     * declarations that cannot be recreated from the cache.
+     * Can be called concurrently.
+     *
+     * \param[in] definition Valid pointer to the simplified definition.
+     * \param[in] key Key of the definition in the cache.
+     * \param[in] uses Shared declarations used by the definition.
+     */
+    void storeDefinition(const likec::FunctionDefinition *definition, const QByteArray &key, const DeclarationUses &uses);
+
+    /**
+     * Adds a shared declaration to the compilation unit, if it was not added yet,
+     * preceded by the shared declarations it uses.
+     *
+     * \param[in] sharedDeclaration Valid pointer to the shared declaration.
+     */
+    void addToCompilationUnit(SharedDeclaration *sharedDeclaration);
+
+    /**
+     * Registers a declaration of a function added to the compilation unit.
      *
      * \param[in] signature Valid pointer to the signature of this function.
      * \param[in] declaration Valid pointer to the function's declaration.
-     *
-     * This function is called from DeclarationGenerator and DefinitionGenerator
-     * immediately after they have created the declaration or definition.
-     * Thus, when a function, whose body is being generated, is looking for
-     * its own declaration, CodeGenerator already knows about it.
      */
     void setFunctionDeclaration(const calling::FunctionSignature *signature, likec::FunctionDeclaration *declaration);
+
+    /**
+     * \param[in] declarations Shared declarations.
+     *
+     * \return Mapping from the prototypes among the given declarations which were not
+     *         added to the compilation unit to the declarations to use instead.
+     */
+    boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDeclaration *>
+    getPrototypeReplacements(const DeclarationUses &declarations) const;
+
+    /**
+     * Makes the given definition refer to the first declarations of called
+     * functions instead of the prototypes which were not added to the
+     * compilation unit.
+     *
+     * \param[in] definition Valid pointer to a function definition.
+     * \param[in] replacements Mapping from the prototypes to the declarations to use instead.
+     */
+    static void replacePrototypes(likec::FunctionDefinition *definition,
+        const boost::unordered_map<const likec::FunctionDeclaration *, likec::FunctionDeclaration *> &replacements);
 };
 
 } // namespace cgen
@@ -57,7 +57,6 @@ DeclarationGenerator::DeclarationGenerator(CodeGenerator &parent, const calling:
 void DeclarationGenerator::setDeclaration(likec::FunctionDeclaration *declaration) {
     assert(!declaration_); 
     declaration_ = declaration;
-    parent().setFunctionDeclaration(signature_, declaration);
 }
 
 std::unique_ptr<likec::FunctionDeclaration> DeclarationGenerator::createDeclaration() {
@@ -78,7 +77,7 @@ std::unique_ptr<likec::FunctionDeclaration> DeclarationGenerator::createDeclarat
 
 const likec::Type *DeclarationGenerator::makeReturnType() {
     if (signature()->returnValue()) {
-        return parent().makeType(parent().types().getType(signature()->returnValue().get()));
+        return parent().makeType(parent().types().getType(signature()->returnValue().get()), uses());
     }
     return tree().makeVoidType();
 }
@@ -87,7 +86,7 @@ likec::ArgumentDeclaration *DeclarationGenerator::makeArgumentDeclaration(const
     auto nameAndComment = parent().nameGenerator().getArgumentName(term, declaration()->arguments().size() + 1);
 
     auto argumentDeclaration = std::make_unique<likec::ArgumentDeclaration>(
-        std::move(nameAndComment.name()), parent().makeType(parent().types().getType(term)));
+        std::move(nameAndComment.name()), parent().makeType(parent().types().getType(term), uses()));
     argumentDeclaration->setComment(std::move(nameAndComment.comment()));
 
     auto result = argumentDeclaration.get();
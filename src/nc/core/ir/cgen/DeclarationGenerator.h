@@ -58,6 +58,7 @@ class DeclarationGenerator: boost::noncopyable {
     calling::CalleeId calleeId_;
     const calling::FunctionSignature *signature_;
     likec::FunctionDeclaration *declaration_;
+    CodeGenerator::DeclarationUses uses_;
 
 public:
     /**
@@ -102,6 +103,11 @@ public:
      */
     void setDeclaration(likec::FunctionDeclaration *declaration);
 
+    /**
+     * \return Shared declarations used by the generated code, in the order of use.
+     */
+    CodeGenerator::DeclarationUses &uses() { return uses_; }
+
     /**
      * Creates function's declaration and sets function's declaration to it.
      *
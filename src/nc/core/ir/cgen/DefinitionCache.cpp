@@ -0,0 +1,491 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DefinitionCache.h"
+
+#include <cassert>
+#include <cstring> /* memcmp */
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+#include <nc/common/Foreach.h>
+
+#include <nc/core/arch/Architecture.h>
+#include <nc/core/arch/Instruction.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Reader.h>
+#include <nc/core/image/Section.h>
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Term.h>
+#include <nc/core/ir/calling/CallSignature.h>
+#include <nc/core/ir/calling/FunctionSignature.h>
+#include <nc/core/ir/calling/Signatures.h>
+#include <nc/core/ir/dflow/ArchValue.h>
+#include <nc/core/ir/dflow/Dataflow.h>
+#include <nc/core/ir/dflow/Dataflows.h>
+#include <nc/core/ir/dflow/Value.h>
+#include <nc/core/ir/liveness/Liveness.h>
+#include <nc/core/ir/liveness/Livenesses.h>
+#include <nc/core/ir/types/Type.h>
+#include <nc/core/ir/types/Types.h>
+#include <nc/core/ir/vars/Variable.h>
+#include <nc/core/ir/vars/Variables.h>
+
+#include "CodeGenerator.h"
+
+namespace nc {
+namespace core {
+namespace ir {
+namespace cgen {
+
+namespace {
+
+/** Magic bytes at the beginning of a cache entry. */
+const char entryMagic[8] = { 'S', 'N', 'O', 'W', 'D', 'E', 'F', 'N' };
+
+/**
+ * Current version of the entry format and of the key computation.
+ * Must be incremented whenever code generation changes the way it
+ * prints definitions, so that stale entries are not used.
+ */
+const quint32 entryVersion = 1;
+
+/** Maximal length of strings referred to by constants, as in DefinitionGenerator. */
+const ByteSize maxStringLength = 1024;
+
+/** Maximal depth of pointee types taken into account. */
+const int maxPointeeDepth = 4;
+
+/**
+ * \param value A flag.
+ *
+ * \return Character representing the flag in a key.
+ */
+inline char flag(bool value) {
+    return value ? '1' : '0';
+}
+
+/**
+ * Writes the facts about a function that code generation reads
+ * into a text stream, from which the key is then computed.
+ */
+class KeyWriter {
+    const CodeGenerator &generator_;
+    const dflow::Dataflow &dataflow_;
+    const liveness::Liveness &liveness_;
+    QTextStream &out_;
+
+public:
+    KeyWriter(const CodeGenerator &generator, const Function *function, QTextStream &out):
+        generator_(generator),
+        dataflow_(*generator.dataflows().at(function)),
+        liveness_(*generator.livenesses().at(function)),
+        out_(out)
+    {}
+
+    void writeFunction(const Function *function) {
+        const auto &platform = generator_.image().platform();
+
+        out_ << "version " << entryVersion << '\n';
+#ifdef NC_PREFER_CSTRINGS_TO_CONSTANTS
+        out_ << "cstrings\n";
+#endif
+#ifdef NC_PREFER_CONSTANTS_TO_EXPRESSIONS
+        out_ << "constants\n";
+#endif
+#ifdef NC_PREFER_GLOBAL_VARIABLES_TO_CONSTANTS
+        out_ << "globals\n";
+#endif
+#ifdef NC_PREFER_FUNCTIONS_TO_CONSTANTS
+        out_ << "functions\n";
+#endif
+#ifdef NC_STRUCT_RECOVERY
+        out_ << "structs\n";
+#endif
+        out_ << "platform " << platform.architecture()->name() << ' ' << platform.architecture()->bitness()
+             << ' ' << platform.intSize() << '\n';
+
+        auto nameAndComment = generator_.nameGenerator().getFunctionName(function);
+        out_ << "function " << *function->entry()->address() << ' ' << nameAndComment.name() << '\n'
+             << nameAndComment.comment() << '\n';
+
+        writeSignature(generator_.signatures().getSignature(function).get());
+
+        foreach (const BasicBlock *basicBlock, function->basicBlocks()) {
+            out_ << "block ";
+            writeBasicBlock(basicBlock);
+            out_ << '\n';
+
+            foreach (const Statement *statement, basicBlock->statements()) {
+                writeStatement(statement);
+            }
+        }
+    }
+
+private:
+    void writeSignature(const calling::FunctionSignature *signature) {
+        if (!signature) {
+            out_ << "no signature\n";
+            return;
+        }
+
+        out_ << "signature " << flag(signature->variadic()) << '\n';
+        writeSignatureTerms(signature);
+    }
+
+    void writeSignature(const calling::CallSignature *signature) {
+        if (!signature) {
+            out_ << "no signature\n";
+            return;
+        }
+
+        out_ << "call signature\n";
+        writeSignatureTerms(signature);
+    }
+
+    template<class Signature>
+    void writeSignatureTerms(const Signature *signature) {
+        foreach (const auto &argument, signature->arguments()) {
+            out_ << "argument " << *argument << ' ' << argument->size() << '\n';
+        }
+        if (signature->returnValue()) {
+            out_ << "return " << *signature->returnValue() << ' ' << signature->returnValue()->size() << '\n';
+        }
+    }
+
+    void writeBasicBlock(const BasicBlock *basicBlock) {
+        if (!basicBlock) {
+            out_ << "none";
+        } else if (basicBlock->address()) {
+            out_ << *basicBlock->address();
+        } else {
+            out_ << "noaddr";
+        }
+    }
+
+    void writeStatement(const Statement *statement) {
+        out_ << "statement " << statement->kind() << ' ';
+        if (statement->instruction()) {
+            out_ << statement->instruction()->addr() << ' ' << *statement->instruction();
+        }
+        out_ << '\n';
+
+        switch (statement->kind()) {
+            case Statement::INLINE_ASSEMBLY:
+            case Statement::HALT:
+            case Statement::CALLBACK:
+            case Statement::REMEMBER_REACHING_DEFINITIONS:
+                break;
+            case Statement::ASSIGNMENT:
+                writeTerm(statement->asAssignment()->left());
+                writeTerm(statement->asAssignment()->right());
+                break;
+            case Statement::TOUCH:
+                writeTerm(statement->asTouch()->term());
+                break;
+            case Statement::CALL: {
+                auto call = statement->asCall();
+                writeTerm(call->target());
+                writeSignature(generator_.signatures().getSignature(call).get());
+                break;
+            }
+            case Statement::JUMP: {
+                auto jump = statement->asJump();
+                if (jump->condition()) {
+                    writeTerm(jump->condition());
+                }
+                writeJumpTarget(jump->thenTarget());
+                writeJumpTarget(jump->elseTarget());
+                break;
+            }
+            default:
+                out_ << "unknown\n";
+                break;
+        }
+    }
+
+    void writeJumpTarget(const JumpTarget &target) {
+        out_ << "target ";
+        writeBasicBlock(target.basicBlock());
+        out_ << '\n';
+
+        if (target.address()) {
+            writeTerm(target.address());
+        }
+        if (target.table()) {
+            foreach (const auto &entry, *target.table()) {
+                out_ << "entry " << entry.address() << ' ';
+                writeBasicBlock(entry.basicBlock());
+                out_ << '\n';
+            }
+        }
+    }
+
+    /**
+     * Writes the term, its children, and everything the analyses have
+     * established about them. Names of functions and global variables the
+     * term can refer to are written too, as well as the strings it can
+     * point to, so that the key changes when these do.
+     */
+    void writeTerm(const Term *term) {
+        bool live = liveness_.isLive(term);
+        out_ << "term " << *term << ' ' << term->size() << ' ' << flag(live) << '\n';
+
+        if (live) {
+            if (const auto &memoryLocation = dataflow_.getMemoryLocation(term)) {
+                out_ << "location " << memoryLocation << '\n';
+            }
+
+            writeType(generator_.types().getType(term), 0);
+
+            if (auto variable = generator_.variables().getVariable(term)) {
+                out_ << "variable " << variable->memoryLocation() << ' ' << flag(variable->isGlobal()) << '\n';
+                if (variable->isGlobal()) {
+                    writeGlobalVariable(variable);
+                }
+            }
+
+            writeValue(term);
+        }
+
+        term->callOnChildren([this](const Term *child) {
+            writeTerm(child);
+        });
+    }
+
+    void writeType(const types::Type *type, int depth) {
+        if (!type) {
+            out_ << "void\n";
+            return;
+        }
+
+        out_ << "type " << type->size() << ' ' << flag(type->isInteger()) << flag(type->isFloat())
+             << flag(type->isPointer()) << flag(type->isSigned()) << flag(type->isUnsigned()) << ' ' << type->factor() << ' ' << type->offsets().size() << '\n';
+
+        if (type->isPointer() && depth < maxPointeeDepth) {
+            writeType(type->pointee(), depth + 1);
+        }
+    }
+
+    void writeGlobalVariable(const vars::Variable *variable) {
+        out_ << "global " << generator_.nameGenerator().getGlobalVariableName(variable->memoryLocation()).name() << '\n';
+
+        foreach (auto termAndLocation, variable->termsAndLocations()) {
+            if (termAndLocation.location == variable->memoryLocation()) {
+                writeType(generator_.types().getType(termAndLocation.term), 0);
+                break;
+            }
+        }
+    }
+
+    void writeValue(const Term *term) {
+        if (auto source = term->source()) {
+            term = source;
+        }
+
+        auto i = dataflow_.term2value().find(term);
+        if (i == dataflow_.term2value().end()) {
+            return;
+        }
+
+        auto value = boost::get<dflow::Value>(i->second.get());
+        if (!value) {
+            return;
+        }
+
+        const auto &abstractValue = value->abstractValue();
+        out_ << "value " << abstractValue.size() << ' ' << abstractValue.zeroBits() << ' ' << abstractValue.oneBits()
+             << ' ' << flag(value->isProduct()) << flag(value->isReturnAddress());
+        if (value->isStackOffset()) {
+            out_ << " stack " << value->stackOffset();
+        }
+        out_ << '\n';
+
+        if (abstractValue.isConcrete()) {
+            writeAddress(abstractValue.asConcrete().value());
+        }
+    }
+
+    void writeAddress(ByteAddr addr) {
+        if (auto section = generator_.image().getSectionContainingAddress(addr)) {
+            out_ << "section " << flag(section->isCode()) << '\n';
+        }
+
+        if (generator_.signatures().getSignature(addr)) {
+            out_ << "callee " << generator_.nameGenerator().getFunctionName(addr).name() << '\n';
+        }
+
+        auto string = image::Reader(&generator_.image()).readAsciizString(addr, maxStringLength);
+        if (!string.isEmpty()) {
+            out_ << "string " << string << '\n';
+        }
+    }
+};
+
+/**
+ * Writes a use of a shared declaration to a data stream.
+ */
+QDataStream &operator<<(QDataStream &out, const DefinitionCache::Use &use) {
+    out << static_cast<quint32>(use.kind());
+    if (use.kind() == DefinitionCache::Use::FUNCTION) {
+        out << static_cast<qint64>(use.address());
+    } else {
+        const auto &location = use.memoryLocation();
+        out << static_cast<qint32>(location.domain()) << static_cast<qint64>(location.addr())
+            << static_cast<qint64>(location.size());
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+DefinitionCache::DefinitionCache(QString directory):
+    directory_(std::move(directory))
+{}
+
+QString DefinitionCache::getFileName(const QByteArray &key) const {
+    auto hex = QString::fromLatin1(key.toHex().constData());
+    return QString("%1/%2/%3").arg(directory_).arg(hex.left(2)).arg(hex.mid(2));
+}
+
+bool DefinitionCache::load(const QByteArray &key, Entry &entry) const {
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    QFile file(getFileName(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    char magic[sizeof(entryMagic)];
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, entryMagic, sizeof(magic)) != 0) {
+        return false;
+    }
+
+    quint32 version;
+    QByteArray storedKey;
+    quint64 useCount;
+    in >> version >> storedKey >> entry.bodyText >> useCount;
+    if (in.status() != QDataStream::Ok || version != entryVersion || storedKey != key) {
+        return false;
+    }
+
+    entry.uses.clear();
+    for (quint64 i = 0; i < useCount; ++i) {
+        quint32 kind;
+        in >> kind;
+
+        if (kind == Use::FUNCTION) {
+            qint64 address;
+            in >> address;
+            entry.uses.push_back(Use(address));
+        } else if (kind == Use::GLOBAL_VARIABLE) {
+            qint32 domain;
+            qint64 addr, size;
+            in >> domain >> addr >> size;
+            if (size <= 0) {
+                return false;
+            }
+            entry.uses.push_back(Use(MemoryLocation(domain, addr, size)));
+        } else {
+            return false;
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+    }
+
+    return !entry.bodyText.isEmpty();
+}
+
+void DefinitionCache::store(const QByteArray &key, const Entry &entry) const {
+    if (key.isEmpty()) {
+        return;
+    }
+
+    auto fileName = getFileName(key);
+    if (!QDir().mkpath(QFileInfo(fileName).path())) {
+        return;
+    }
+
+    /* Write to a file of our own and rename it, so that readers never see a partial entry. */
+    auto temporaryName = QString("%1.%2.%3")
+        .arg(fileName)
+        .arg(QCoreApplication::applicationPid())
+        .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()), 0, 16);
+
+    {
+        QFile file(temporaryName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return;
+        }
+
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_4_8);
+        out.writeRawData(entryMagic, sizeof(entryMagic));
+        out << entryVersion << key << entry.bodyText << static_cast<quint64>(entry.uses.size());
+        foreach (const auto &use, entry.uses) {
+            out << use;
+        }
+
+        if (out.status() != QDataStream::Ok) {
+            file.close();
+            file.remove();
+            return;
+        }
+    }
+
+    /* Another run may have stored the same entry in the meantime: it is as good as ours. */
+    QFile::remove(fileName);
+    if (!QFile::rename(temporaryName, fileName)) {
+        QFile::remove(temporaryName);
+    }
+}
+
+void DefinitionCache::recordLookup(bool hit) const {
+    if (hit) {
+        hitCount_.fetchAndAddRelaxed(1);
+    } else {
+        missCount_.fetchAndAddRelaxed(1);
+    }
+}
+
+QByteArray computeDefinitionKey(const CodeGenerator &generator, const Function *function) {
+    assert(function != nullptr);
+
+    /* Names of functions without an entry address are not stable between runs. */
+    if (!function->entry() || !function->entry()->address()) {
+        return QByteArray();
+    }
+
+    QByteArray text;
+    {
+        QTextStream out(&text, QIODevice::WriteOnly);
+        out.setCodec("UTF-8");
+        KeyWriter(generator, function, out).writeFunction(function);
+    }
+
+    return QCryptographicHash::hash(text, QCryptographicHash::Sha1);
+}
+
+} // namespace cgen
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,190 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+#include <nc/common/Types.h>
+#include <nc/core/ir/MemoryLocation.h>
+
+namespace nc {
+namespace core {
+namespace ir {
+
+class Function;
+
+namespace cgen {
+
+class CodeGenerator;
+
+/**
+ * On-disk cache of the bodies of generated function definitions.
+ *
+ * An entry is looked up by a key computed by computeDefinitionKey() from
+ * everything code generation reads about the function: its intermediate
+ * representation, and the results of the analyses, including those that
+ * depend on its callers and callees. An entry keeps the printed body of the
+ * definition and the shared declarations (prototypes of functions, global
+ * variables) the definition uses, so that these can be regenerated from the
+ * current program when the body is taken from the cache.
+ *
+ * Each entry is kept in a file of its own, named after the key, so that
+ * the cache can be shared by runs working in parallel. Methods of this
+ * class can be called concurrently.
+ */
+class DefinitionCache: boost::noncopyable {
+    QString directory_; ///< Directory with the cache files.
+    mutable QAtomicInt hitCount_; ///< Number of definitions taken from the cache.
+    mutable QAtomicInt missCount_; ///< Number of definitions not found in the cache.
+
+public:
+    /**
+     * Shared declaration used by a cached definition.
+     */
+    class Use {
+    public:
+        /**
+         * Kind of the declaration.
+         */
+        enum Kind {
+            FUNCTION,       ///< Prototype of the function at a given address.
+            GLOBAL_VARIABLE ///< Global variable at a given memory location.
+        };
+
+    private:
+        Kind kind_;
+        ByteAddr address_;
+        MemoryLocation memoryLocation_;
+
+    public:
+        /**
+         * Constructs a use of a prototype.
+         *
+         * \param address Entry address of the function.
+         */
+        explicit Use(ByteAddr address): kind_(FUNCTION), address_(address) {}
+
+        /**
+         * Constructs a use of a global variable.
+         *
+         * \param memoryLocation Valid memory location of the variable.
+         */
+        explicit Use(const MemoryLocation &memoryLocation):
+            kind_(GLOBAL_VARIABLE), address_(0), memoryLocation_(memoryLocation)
+        {}
+
+        /**
+         * \return Kind of the declaration.
+         */
+        Kind kind() const { return kind_; }
+
+        /**
+         * \return Entry address of the function, if kind() is FUNCTION.
+         */
+        ByteAddr address() const { return address_; }
+
+        /**
+         * \return Memory location of the global variable, if kind() is GLOBAL_VARIABLE.
+         */
+        const MemoryLocation &memoryLocation() const { return memoryLocation_; }
+    };
+
+    /**
+     * Cached results of generating a function definition.
+     */
+    class Entry {
+    public:
+        QString bodyText; ///< Printed body of the definition.
+        std::vector<Use> uses; ///< Shared declarations used by the definition, in the order of use.
+    };
+
+    /**
+     * Constructor.
+     *
+     * \param directory Name of the directory with the cache files.
+     *                  It is created when the first entry is stored.
+     */
+    explicit DefinitionCache(QString directory);
+
+    /**
+     * \return Name of the directory with the cache files.
+     */
+    const QString &directory() const { return directory_; }
+
+    /**
+     * Looks up an entry.
+     *
+     * \param[in] key Key of the entry.
+     * \param[out] entry The entry, if found.
+     *
+     * \return True if the entry was found and read successfully.
+     */
+    bool load(const QByteArray &key, Entry &entry) const;
+
+    /**
+     * Stores an entry. Failures to write the entry are ignored:
+     * the entry will be computed once again next time.
+     *
+     * \param key Key of the entry.
+     * \param entry The entry.
+     */
+    void store(const QByteArray &key, const Entry &entry) const;
+
+    /**
+     * Counts a lookup of a definition in the cache.
+     *
+     * \param hit Whether the definition was taken from the cache.
+     */
+    void recordLookup(bool hit) const;
+
+    /**
+     * \return Number of definitions taken from the cache so far.
+     */
+    int hitCount() const { return hitCount_.fetchAndAddOrdered(0); }
+
+    /**
+     * \return Number of definitions not found in the cache so far.
+     */
+    int missCount() const { return missCount_.fetchAndAddOrdered(0); }
+
+private:
+    /**
+     * \param key Key of an entry.
+     *
+     * \return Name of the file keeping the entry.
+     */
+    QString getFileName(const QByteArray &key) const;
+};
+
+/**
+ * Computes the key of the definition of a function in a DefinitionCache.
+ *
+ * The key is a hash of the function's name, signature, and intermediate
+ * representation, of the names and signatures of the functions it calls
+ * or refers to, of the strings its constants point to, and of the facts
+ * that the analyses have established about its terms: liveness, values,
+ * types, and variables. These facts capture the context the function's
+ * callers and callees contribute to its analysis.
+ *
+ * \param generator Code generator that will generate the definition.
+ * \param function Valid pointer to the function.
+ *
+ * \return The key.
+ */
+QByteArray computeDefinitionKey(const CodeGenerator &generator, const Function *function);
+
+} // namespace cgen
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
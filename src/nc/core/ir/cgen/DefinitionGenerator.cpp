@@ -103,10 +103,8 @@ DefinitionGenerator::DefinitionGenerator(CodeGenerator &parent, const Function *
     dataflow_(*parent.dataflows().at(function)),
     graph_(*parent.graphs().at(function)),
     liveness_(*parent.livenesses().at(function)),
-    uses_(std::make_unique<dflow::Uses>(dataflow_)),
-    cfg_(std::make_unique<CFG>(function->basicBlocks())),
-    dominators_(std::make_unique<Dominators>(*cfg_, canceled)),
-    hookStatements_(getHookStatements(function, dataflow_, parent.hooks())),
+    cfg_(function->cfg()),
+    canceled_(canceled),
     definition_(nullptr)
 {
     assert(function != nullptr);
@@ -120,7 +118,7 @@ void DefinitionGenerator::setDefinition(likec::FunctionDefinition *definition) {
     setDeclaration(definition);
 }
 
-std::unique_ptr<likec::FunctionDefinition> DefinitionGenerator::createDefinition() {
+std::unique_ptr<likec::FunctionDefinition> DefinitionGenerator::createHeader() {
     auto nameAndComment = parent().nameGenerator().getFunctionName(function_);
 
     auto functionDefinition = std::make_unique<likec::FunctionDefinition>(tree(),
@@ -154,6 +152,16 @@ std::unique_ptr<likec::FunctionDefinition> DefinitionGenerator::createDefinition
         }
     }
 
+    return functionDefinition;
+}
+
+std::unique_ptr<likec::FunctionDefinition> DefinitionGenerator::createDefinition() {
+    auto functionDefinition = createHeader();
+
+    uses_ = std::make_unique<dflow::Uses>(dataflow_);
+    dominators_ = std::make_unique<Dominators>(cfg_, canceled_);
+    hookStatements_ = getHookStatements(function_, dataflow_, parent().hooks());
+
     SwitchContext switchContext;
     makeStatements(graph_.root(), definition()->block().get(), nullptr, nullptr, nullptr, switchContext);
 
@@ -169,7 +177,7 @@ likec::VariableDeclaration *DefinitionGenerator::makeLocalVariableDeclaration(co
         auto nameAndComment = parent().nameGenerator().getLocalVariableName(variable->memoryLocation(), variableDeclarations_.size());
 
         auto variableDeclaration = std::make_unique<likec::VariableDeclaration>(
-            std::move(nameAndComment.name()), parent().makeVariableType(variable));
+            std::move(nameAndComment.name()), parent().makeVariableType(variable, uses()));
         variableDeclaration->setComment(std::move(nameAndComment.comment()));
 
         result = variableDeclaration.get();
@@ -182,7 +190,7 @@ likec::VariableDeclaration *DefinitionGenerator::makeVariableDeclaration(const v
     assert(variable != nullptr);
 
     if (variable->isGlobal()) {
-        return parent().makeGlobalVariableDeclaration(variable);
+        return parent().makeGlobalVariableDeclaration(variable, uses());
     } else {
         return makeLocalVariableDeclaration(variable);
     }
@@ -652,7 +660,7 @@ std::unique_ptr<likec::Statement> DefinitionGenerator::doMakeStatement(const Sta
                     std::move(left),
                     std::make_unique<likec::Typecast>(
                         likec::Typecast::REINTERPRET_CAST,
-                        parent().makeType(parent().types().getType(assignment->left())),
+                        parent().makeType(parent().types().getType(assignment->left()), uses()),
                         std::move(right))));
         }
         case Statement::JUMP: {
@@ -683,7 +691,7 @@ std::unique_ptr<likec::Statement> DefinitionGenerator::doMakeStatement(const Sta
 
             auto targetValue = dataflow_.getValue(call->target());
             if (targetValue->abstractValue().isConcrete()) {
-                if (auto functionDeclaration = parent().makeFunctionDeclaration(targetValue->abstractValue().asConcrete().value())) {
+                if (auto functionDeclaration = parent().makeFunctionDeclaration(targetValue->abstractValue().asConcrete().value(), uses())) {
                     target = std::make_unique<likec::FunctionIdentifier>(functionDeclaration);
                     target->setTerm(call->target());
                 }
@@ -711,7 +719,7 @@ std::unique_ptr<likec::Statement> DefinitionGenerator::doMakeStatement(const Sta
                                     makeExpression(returnValueTerm),
                                     std::make_unique<likec::Typecast>(
                                         likec::Typecast::REINTERPRET_CAST,
-                                        parent().makeType(parent().types().getType(returnValueTerm)),
+                                        parent().makeType(parent().types().getType(returnValueTerm), uses()),
                                         std::move(callOperator))));
                         }
                     }
@@ -848,7 +856,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::doMakeExpression(const T
             return std::make_unique<likec::UnaryOperator>(likec::UnaryOperator::DEREFERENCE,
                 std::make_unique<likec::Typecast>(
                     likec::Typecast::REINTERPRET_CAST,
-                    tree().makePointerType(addressType->size(), parent().makeType(type)),
+                    tree().makePointerType(addressType->size(), parent().makeType(type, uses())),
                     makeExpression(dereference->address())));
         }
         case Term::UNARY_OPERATOR: {
@@ -1091,7 +1099,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::doMakeExpression(const I
         case Intrinsic::UNDEFINED:
             return makeIntrinsicCall(
                 QLatin1String("__undefined"),
-                parent().makeType(parent().types().getType(intrinsic)));
+                parent().makeType(parent().types().getType(intrinsic), uses()));
         case Intrinsic::ZERO_STACK_OFFSET:
             return makeIntrinsicCall(
                 QLatin1String("__zero_stack_offset"),
@@ -1101,7 +1109,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::doMakeExpression(const I
                 QLatin1String("__return_address"),
                 parent().tree().makePointerType(parent().tree().pointerSize(), parent().tree().makeVoidType()));
     }
-    return makeIntrinsicCall(QLatin1String("__intrinsic"), parent().makeType(parent().types().getType(intrinsic)));
+    return makeIntrinsicCall(QLatin1String("__intrinsic"), parent().makeType(parent().types().getType(intrinsic), uses()));
 }
 
 std::unique_ptr<likec::Expression> DefinitionGenerator::doMakeExpression(const TypeConversion *conversion) {
@@ -1143,7 +1151,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::makeConstant(const Term
 #ifdef NC_PREFER_FUNCTIONS_TO_CONSTANTS
     if (auto section = parent().image().getSectionContainingAddress(value.value())) {
         if (section->isCode()) {
-            if (auto functionDeclaration = parent().makeFunctionDeclaration(value.value())) {
+            if (auto functionDeclaration = parent().makeFunctionDeclaration(value.value(), uses())) {
                 return std::make_unique<likec::FunctionIdentifier>(functionDeclaration);
             }
         }
@@ -1176,7 +1184,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::makeConstant(const Term
             std::make_unique<likec::VariableIdentifier>(
                 parent().makeGlobalVariableDeclaration(
                     MemoryLocation(MemoryDomain::MEMORY, value.value() * CHAR_BIT, type->pointee()->size()),
-                    type)));
+                    type, uses())));
     }
 #endif
 
@@ -1234,7 +1242,7 @@ std::unique_ptr<likec::Expression> DefinitionGenerator::makeVariableAccess(const
             likec::UnaryOperator::DEREFERENCE,
             std::make_unique<likec::Typecast>(
                 likec::Typecast::REINTERPRET_CAST,
-                tree().makePointerType(parent().makeType(parent().types().getType(term))),
+                tree().makePointerType(parent().makeType(parent().types().getType(term), uses())),
                 std::move(termAddress)));
     }
 }
@@ -1374,7 +1382,7 @@ bool DefinitionGenerator::canBeMoved(const Term *term, const Statement *destinat
                  */
                 return variable->isLocal() &&
                      allOfStatementsBetween(
-                        term->statement(), destination, *cfg_,
+                        term->statement(), destination, cfg_,
                         [&](const Statement *statement) -> bool {
                             auto term = getWrittenTerm(statement);
                             return !term || parent().variables().getVariable(term) != variable;
@@ -1383,7 +1391,7 @@ bool DefinitionGenerator::canBeMoved(const Term *term, const Statement *destinat
 
             Domain domain = *getDomain(term);
             return allOfStatementsBetween(
-                term->statement(), destination, *cfg_,
+                term->statement(), destination, cfg_,
                 [&](const Statement *statement) -> bool {
                     auto term = getWrittenTerm(statement);
                     return !term || getDomain(term) != domain;
@@ -88,8 +88,11 @@ class DefinitionGenerator: public DeclarationGenerator {
     const dflow::Dataflow &dataflow_;
     const cflow::Graph &graph_;
     const liveness::Liveness &liveness_;
+    const CFG &cfg_;
+    const CancellationToken &canceled_;
+
+    /* Facts needed only for generating the body, computed by createDefinition(). */
     std::unique_ptr<dflow::Uses> uses_;
-    std::unique_ptr<CFG> cfg_;
     std::unique_ptr<Dominators> dominators_;
     boost::unordered_set<const Statement *> hookStatements_;
 
@@ -131,6 +134,14 @@ public:
      */
     std::unique_ptr<likec::FunctionDefinition> createDefinition();
 
+    /**
+     * Creates function's definition with the name, return type, and arguments,
+     * but with an empty body, and sets function's declaration to it.
+     * This is cheaper than createDefinition(), as the body-specific
+     * analyses of the function are not done.
+     */
+    std::unique_ptr<likec::FunctionDefinition> createHeader();
+
 private:
     /**
      * \param[in] variable Valid pointer to a local variable.
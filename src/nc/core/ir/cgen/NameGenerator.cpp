@@ -13,7 +13,6 @@
 #include <nc/core/ir/MemoryLocation.h>
 #include <nc/core/ir/Terms.h>
 #include <nc/core/ir/calling/CalleeId.h>
-#include <nc/core/mangling/Demangler.h>
 
 namespace nc {
 namespace core {
@@ -59,7 +58,7 @@ NameAndComment NameGenerator::getFunctionName(const image::Symbol *symbol) const
         comment += '\n';
     }
 
-    auto demangledName = image_.demangler()->demangle(symbol->name());
+    auto demangledName = image_.demangle(symbol->name());
     if (demangledName.contains('(')) {
         comment += demangledName;
         comment += '\n';
@@ -73,8 +73,8 @@ void DataflowAnalyzer::analyze(const CFG &cfg) {
         return !dataflow().getMemoryLocation(term).covers(mloc);
     };
 
-    /* Mapping of a basic block to the definitions reaching its end. */
-    boost::unordered_map<const BasicBlock *, ReachingDefinitions> outDefinitions;
+    /* Mapping of a basic block's index to the definitions reaching its end. */
+    std::vector<ReachingDefinitions> outDefinitions(cfg.size());
 
     /*
      * Running abstract interpretation until reaching a fixpoint several times in a row.
@@ -86,11 +86,13 @@ void DataflowAnalyzer::analyze(const CFG &cfg) {
         /*
          * Run abstract interpretation on all basic blocks.
          */
-        foreach (auto basicBlock, cfg.basicBlocks()) {
+        for (CFG::Index index = 0; index < cfg.size(); ++index) {
+            const BasicBlock *basicBlock = cfg.getBasicBlock(index);
+
             ReachingDefinitions definitions;
 
             /* Merge reaching definitions from predecessors. */
-            foreach (const BasicBlock *predecessor, cfg.getPredecessors(basicBlock)) {
+            foreach (auto predecessor, cfg.getPredecessors(index)) {
                 definitions.merge(outDefinitions[predecessor]);
             }
 
@@ -103,7 +105,7 @@ void DataflowAnalyzer::analyze(const CFG &cfg) {
             }
 
             /* Something has changed? */
-            ReachingDefinitions &oldDefinitions(outDefinitions[basicBlock]);
+            ReachingDefinitions &oldDefinitions(outDefinitions[index]);
             if (oldDefinitions != definitions) {
                 oldDefinitions = std::move(definitions);
                 nfixpoints = 0;
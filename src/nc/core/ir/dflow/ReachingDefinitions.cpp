@@ -38,17 +38,96 @@ namespace core {
 namespace ir {
 namespace dflow {
 
+void ReachingDefinitions::ChunkIterator::enterSegment() {
+    while (owner_->getSegment(segment_, current_, end_)) {
+        if (current_ != end_) {
+            return;
+        }
+        ++segment_;
+    }
+    current_ = end_ = nullptr;
+}
+
+std::size_t ReachingDefinitions::ChunkRange::size() const {
+    std::size_t result = 0;
+
+    const Chunk *begin, *end;
+    for (std::size_t i = 0; owner_->getSegment(i, begin, end); ++i) {
+        result += end - begin;
+    }
+
+    return result;
+}
+
+const ReachingDefinitions::Chunk &ReachingDefinitions::ChunkRange::back() const {
+    assert(!empty());
+
+    const Chunk *result = nullptr;
+
+    const Chunk *begin, *end;
+    for (std::size_t i = 0; owner_->getSegment(i, begin, end); ++i) {
+        if (begin != end) {
+            result = end - 1;
+        }
+    }
+
+    assert(result != nullptr);
+    return *result;
+}
+
+bool ReachingDefinitions::getSegment(std::size_t index, const Chunk *&begin, const Chunk *&end) const {
+    std::size_t slotCount = registers_ ? registers_->entries.size() : 0;
+
+    begin = end = nullptr;
+
+    if (index == 0 || index == slotCount + 1) {
+        if (chunks_) {
+            auto split = std::lower_bound(chunks_->begin(), chunks_->end(), MemoryDomain::FIRST_REGISTER,
+                [](const Chunk &chunk, Domain domain) -> bool {
+                    return chunk.location().domain() < domain;
+                });
+
+            const Chunk *data = chunks_->data();
+            if (index == 0) {
+                begin = data;
+                end = data + (split - chunks_->begin());
+            } else {
+                begin = data + (split - chunks_->begin());
+                end = data + chunks_->size();
+            }
+        }
+        return true;
+    }
+
+    if (index <= slotCount) {
+        const auto &slot = registers_->entries[index - 1];
+        if (slot.chunks) {
+            begin = slot.chunks->data();
+            end = begin + slot.chunks->size();
+        }
+        return true;
+    }
+
+    return false;
+}
+
 void ReachingDefinitions::addDefinition(const MemoryLocation &mloc, const Term *term) {
     assert(mloc);
 
-    killDefinitions(mloc);
-    
-    auto i = std::lower_bound(chunks_.begin(), chunks_.end(), mloc,
+    const auto &chunks = getChunks(mloc.domain());
+
+    std::vector<Chunk> result;
+    if (!mayOverlap(mloc) || !killChunks(chunks, mloc, result)) {
+        result = chunks;
+    }
+
+    auto i = std::lower_bound(result.begin(), result.end(), mloc,
         [](const Chunk &a, const MemoryLocation &b) -> bool {
             return a.location() < b;
         });
+    result.insert(i, Chunk(mloc, std::vector<const Term *>(1, term)));
 
-    chunks_.insert(i, Chunk(mloc, std::vector<const Term *>(1, term)));
+    setChunks(mloc.domain(), makeChunks(std::move(result)));
 
     selfTest();
 }
@@ -56,57 +135,31 @@ void ReachingDefinitions::addDefinition(const MemoryLocation &mloc, const Term *
 void ReachingDefinitions::killDefinitions(const MemoryLocation &mloc) {
     assert(mloc);
 
-    if (chunks_.empty()) {
+    if (!mayOverlap(mloc)) {
         return;
     }
 
     std::vector<Chunk> result;
-    result.reserve(chunks_.size() + 1);
-
-    foreach (auto &chunk, chunks_) {
-        if (!mloc.overlaps(chunk.location())) {
-            result.push_back(std::move(chunk));
-        } else {
-            if (chunk.location().addr() < mloc.addr()) {
-                if (mloc.endAddr() < chunk.location().endAddr()) {
-                    result.push_back(Chunk(
-                        MemoryLocation(mloc.domain(), chunk.location().addr(), mloc.addr() - chunk.location().addr()),
-                        chunk.definitions()));
-                } else {
-                    result.push_back(Chunk(
-                        MemoryLocation(mloc.domain(), chunk.location().addr(), mloc.addr() - chunk.location().addr()),
-                        std::move(chunk.definitions())));
-                }
-            }
-            if (mloc.endAddr() < chunk.location().endAddr()) {
-                result.push_back(Chunk(
-                    MemoryLocation(mloc.domain(), mloc.endAddr(), chunk.location().endAddr() - mloc.endAddr()),
-                    std::move(chunk.definitions())));
-            }
-        }
+    if (killChunks(getChunks(mloc.domain()), mloc, result)) {
+        setChunks(mloc.domain(), makeChunks(std::move(result)));
     }
 
-    chunks_ = std::move(result);
-
     selfTest();
 }
 
 void ReachingDefinitions::project(const MemoryLocation &mloc, ReachingDefinitions &result) const {
     assert(mloc);
 
-    result.clear();
-
-    foreach (const auto &chunk, chunks_) {
-        if (chunk.location().domain() == mloc.domain()) {
-            auto addr = std::max(chunk.location().addr(), mloc.addr());
-            auto endAddr = std::min(chunk.location().endAddr(), mloc.endAddr());
+    std::vector<Chunk> chunks;
+    if (mayOverlap(mloc)) {
+        projectChunks(getChunks(mloc.domain()), mloc, chunks);
+    }
 
-            if (addr < endAddr) {
-                result.chunks_.push_back(Chunk(
-                    MemoryLocation(mloc.domain(), addr, endAddr - addr),
-                    chunk.definitions()));
-            }
-        }
+    /* Keep the storage of the result if it already holds the same projection. */
+    auto resultChunks = result.chunks();
+    if (chunks.size() != resultChunks.size() || !std::equal(chunks.begin(), chunks.end(), resultChunks.begin())) {
+        result.clear();
+        result.setChunks(mloc.domain(), makeChunks(std::move(chunks)));
     }
 
     result.selfTest();
@@ -114,9 +167,8 @@ void ReachingDefinitions::project(const MemoryLocation &mloc, ReachingDefinition
 
 std::vector<MemoryLocation> ReachingDefinitions::getDefinedMemoryLocationsWithin(Domain domain) const {
     std::vector<MemoryLocation> result;
-    result.reserve(chunks_.size());
 
-    foreach (const auto &chunk, chunks_) {
+    foreach (const auto &chunk, getChunks(domain)) {
         if (chunk.location().domain() == domain) {
             result.push_back(chunk.location());
         }
@@ -128,14 +180,223 @@ std::vector<MemoryLocation> ReachingDefinitions::getDefinedMemoryLocationsWithin
 void ReachingDefinitions::merge(const ReachingDefinitions &those) {
     selfTest();
 
+    auto chunks = mergeChunks(chunks_, those.chunks_);
+    if (chunks != chunks_) {
+        chunks_ = std::move(chunks);
+    }
+
+    if (those.registers_ && registers_ != those.registers_) {
+        if (!registers_) {
+            registers_ = those.registers_;
+        } else {
+            for (std::size_t i = 0; i < those.registers_->entries.size(); ++i) {
+                const auto &slot = those.registers_->entries[i];
+                if (!slot.chunks) {
+                    continue;
+                }
+
+                auto oldChunks = i < registers_->entries.size() ? registers_->entries[i].chunks : SharedChunks();
+                auto newChunks = mergeChunks(oldChunks, slot.chunks);
+
+                if (newChunks != oldChunks) {
+                    setSlot(detachRegisters(), i, std::move(newChunks));
+                }
+            }
+        }
+    }
+
+    selfTest();
+}
+
+bool ReachingDefinitions::operator==(const ReachingDefinitions &those) const {
+    if (!equal(chunks_, those.chunks_)) {
+        return false;
+    }
+    if (registers_ == those.registers_) {
+        return true;
+    }
+    if (!registers_ || !those.registers_ || registers_->nonEmptySlots != those.registers_->nonEmptySlots) {
+        return false;
+    }
+
+    auto size = std::min(registers_->entries.size(), those.registers_->entries.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!equal(registers_->entries[i].chunks, those.registers_->entries[i].chunks)) {
+            return false;
+        }
+    }
+
+    /* Slots beyond the common size are empty, since the numbers of non-empty entries are equal. */
+    return true;
+}
+
+uint64_t ReachingDefinitions::getMask(const MemoryLocation &mloc) {
+    const BitAddr width = 64;
+
+    auto addr = std::max<BitAddr>(mloc.addr(), 0);
+    auto endAddr = std::min<BitAddr>(mloc.endAddr(), width);
+
+    if (addr >= endAddr) {
+        return 0;
+    }
+
+    auto mask = endAddr - addr == width ? ~uint64_t() : ((uint64_t(1) << (endAddr - addr)) - 1);
+    return mask << addr;
+}
+
+const std::vector<ReachingDefinitions::Chunk> &ReachingDefinitions::getChunks(Domain domain) const {
+    static const std::vector<Chunk> empty;
+
+    if (isRegisterDomain(domain)) {
+        std::size_t index = domain - MemoryDomain::FIRST_REGISTER;
+        if (registers_ && index < registers_->entries.size() && registers_->entries[index].chunks) {
+            return *registers_->entries[index].chunks;
+        }
+        return empty;
+    }
+
+    return chunks_ ? *chunks_ : empty;
+}
+
+void ReachingDefinitions::setChunks(Domain domain, SharedChunks chunks) {
+    if (isRegisterDomain(domain)) {
+        if (!chunks && !registers_) {
+            return;
+        }
+        setSlot(detachRegisters(), domain - MemoryDomain::FIRST_REGISTER, std::move(chunks));
+        dropEmptyRegisters();
+    } else {
+        chunks_ = std::move(chunks);
+    }
+}
+
+bool ReachingDefinitions::mayOverlap(const MemoryLocation &mloc) const {
+    if (!isRegisterDomain(mloc.domain())) {
+        return chunks_ != nullptr;
+    }
+
+    std::size_t index = mloc.domain() - MemoryDomain::FIRST_REGISTER;
+    if (!registers_ || index >= registers_->entries.size()) {
+        return false;
+    }
+
+    const auto &slot = registers_->entries[index];
+    if (!slot.chunks) {
+        return false;
+    }
+
+    /* The mask is exact for locations lying within the first 64 bits of the domain. */
+    if (mloc.addr() >= 0 && mloc.endAddr() <= 64) {
+        return (slot.mask & getMask(mloc)) != 0;
+    }
+    return true;
+}
+
+void ReachingDefinitions::setSlot(RegisterFile &file, std::size_t index, SharedChunks chunks) {
+    if (index >= file.entries.size()) {
+        if (!chunks) {
+            return;
+        }
+        file.entries.resize(index + 1);
+    }
+
+    auto &slot = file.entries[index];
+
+    if (slot.chunks && !chunks) {
+        --file.nonEmptySlots;
+    } else if (!slot.chunks && chunks) {
+        ++file.nonEmptySlots;
+    }
+
+    slot.chunks = std::move(chunks);
+    slot.mask = 0;
+    if (slot.chunks) {
+        foreach (const auto &chunk, *slot.chunks) {
+            slot.mask |= getMask(chunk.location());
+        }
+    }
+}
+
+ReachingDefinitions::RegisterFile &ReachingDefinitions::detachRegisters() {
+    if (!registers_) {
+        registers_ = std::make_shared<const RegisterFile>();
+    } else if (registers_.use_count() > 1) {
+        registers_ = std::make_shared<const RegisterFile>(*registers_);
+    }
+
+    /* Nobody else refers to the file, so it can be modified in place. */
+    return const_cast<RegisterFile &>(*registers_);
+}
+
+void ReachingDefinitions::dropEmptyRegisters() {
+    if (registers_ && registers_->nonEmptySlots == 0) {
+        registers_.reset();
+    }
+}
+
+bool ReachingDefinitions::killChunks(const std::vector<Chunk> &chunks, const MemoryLocation &mloc,
+                                     std::vector<Chunk> &result)
+{
+    auto begin = findFirstOverlapping(chunks, mloc);
+    auto end = begin;
+    while (end != chunks.end() && mloc.overlaps(end->location())) {
+        ++end;
+    }
+
+    if (begin == end) {
+        return false;
+    }
+
+    result.reserve(chunks.size() + 1);
+    result.insert(result.end(), chunks.begin(), begin);
+
+    for (auto i = begin; i != end; ++i) {
+        const auto &chunk = *i;
+
+        if (chunk.location().addr() < mloc.addr()) {
+            result.push_back(Chunk(
+                MemoryLocation(mloc.domain(), chunk.location().addr(), mloc.addr() - chunk.location().addr()),
+                chunk.sharedDefinitions()));
+        }
+        if (mloc.endAddr() < chunk.location().endAddr()) {
+            result.push_back(Chunk(
+                MemoryLocation(mloc.domain(), mloc.endAddr(), chunk.location().endAddr() - mloc.endAddr()),
+                chunk.sharedDefinitions()));
+        }
+    }
+
+    result.insert(result.end(), end, chunks.end());
+
+    return true;
+}
+
+void ReachingDefinitions::projectChunks(const std::vector<Chunk> &chunks, const MemoryLocation &mloc,
+                                        std::vector<Chunk> &result)
+{
+    for (auto i = findFirstOverlapping(chunks, mloc); i != chunks.end() && mloc.overlaps(i->location()); ++i) {
+        auto addr = std::max(i->location().addr(), mloc.addr());
+        auto endAddr = std::min(i->location().endAddr(), mloc.endAddr());
+
+        result.push_back(Chunk(MemoryLocation(mloc.domain(), addr, endAddr - addr), i->sharedDefinitions()));
+    }
+}
+
+ReachingDefinitions::SharedChunks ReachingDefinitions::mergeChunks(const SharedChunks &these, const SharedChunks &those) {
+    if (!those || these == those) {
+        return these;
+    }
+    if (!these) {
+        return those;
+    }
+
     std::vector<Chunk> result;
-    result.reserve(chunks_.size() + those.chunks_.size());
+    result.reserve(these->size() + those->size());
 
-    auto i = chunks_.begin();
-    auto iend = chunks_.end();
+    auto i = these->begin();
+    auto iend = these->end();
 
-    auto j = those.chunks_.begin();
-    auto jend = those.chunks_.end();
+    auto j = those->begin();
+    auto jend = those->end();
 
     while (i != iend || j != jend) {
         auto a = i != iend ? i->location() : MemoryLocation();
@@ -152,31 +413,41 @@ void ReachingDefinitions::merge(const ReachingDefinitions &those) {
         }
 
         if (!b) {
-            result.push_back(Chunk(a, i->definitions()));
+            result.push_back(Chunk(a, i->sharedDefinitions()));
             ++i;
         } else if (!a) {
-            result.push_back(Chunk(b, j->definitions()));
+            result.push_back(Chunk(b, j->sharedDefinitions()));
             ++j;
         } else if (a.domain() < b.domain()) {
-            result.push_back(Chunk(a, i->definitions()));
+            result.push_back(Chunk(a, i->sharedDefinitions()));
             ++i;
         } else if (b.domain() < a.domain()) {
-            result.push_back(Chunk(b, j->definitions()));
+            result.push_back(Chunk(b, j->sharedDefinitions()));
             ++j;
         } else if (a.endAddr() <= b.addr()) {
-            result.push_back(Chunk(a, i->definitions()));
+            result.push_back(Chunk(a, i->sharedDefinitions()));
             ++i;
         } else if (b.endAddr() <= a.addr()) {
-            result.push_back(Chunk(b, j->definitions()));
+            result.push_back(Chunk(b, j->sharedDefinitions()));
             ++j;
         } else if (a.addr() < b.addr()) {
-            result.push_back(Chunk(MemoryLocation(a.domain(), a.addr(), b.addr() - a.addr()), i->definitions()));
+            result.push_back(Chunk(MemoryLocation(a.domain(), a.addr(), b.addr() - a.addr()), i->sharedDefinitions()));
         } else if (b.addr() < a.addr()) {
-            result.push_back(Chunk(MemoryLocation(b.domain(), b.addr(), a.addr() - b.addr()), j->definitions()));
+            result.push_back(Chunk(MemoryLocation(b.domain(), b.addr(), a.addr() - b.addr()), j->sharedDefinitions()));
         } else {
-            std::vector<const Term *> merged;
-            merged.reserve(i->definitions().size() + j->definitions().size());
-            std::set_union(i->definitions().begin(), i->definitions().end(), j->definitions().begin(), j->definitions().end(), std::back_inserter(merged));
+            Chunk::SharedDefinitions merged;
+
+            if (i->sharedDefinitions() == j->sharedDefinitions() ||
+                std::includes(i->definitions().begin(), i->definitions().end(), j->definitions().begin(), j->definitions().end())) {
+                merged = i->sharedDefinitions();
+            } else if (std::includes(j->definitions().begin(), j->definitions().end(), i->definitions().begin(), i->definitions().end())) {
+                merged = j->sharedDefinitions();
+            } else {
+                std::vector<const Term *> definitions;
+                definitions.reserve(i->definitions().size() + j->definitions().size());
+                std::set_union(i->definitions().begin(), i->definitions().end(), j->definitions().begin(), j->definitions().end(), std::back_inserter(definitions));
+                merged = std::make_shared<const std::vector<const Term *>>(std::move(definitions));
+            }
 
             if (a.size() < b.size()) {
                 result.push_back(Chunk(a, std::move(merged)));
@@ -192,14 +463,47 @@ void ReachingDefinitions::merge(const ReachingDefinitions &those) {
         }
     }
 
-    chunks_ = std::move(result);
+    /* Keep the storage if nothing new was added. */
+    if (result == *these) {
+        return these;
+    }
 
-    selfTest();
+    return makeChunks(std::move(result));
+}
+
+void ReachingDefinitions::selfTest() const {
+#ifndef NDEBUG
+    if (chunks_) {
+        selfTest(*chunks_);
+        foreach (const auto &chunk, *chunks_) {
+            assert(!isRegisterDomain(chunk.location().domain()));
+        }
+    }
+    if (registers_) {
+        std::size_t nonEmptySlots = 0;
+        for (std::size_t i = 0; i < registers_->entries.size(); ++i) {
+            const auto &slot = registers_->entries[i];
+            if (slot.chunks) {
+                ++nonEmptySlots;
+                selfTest(*slot.chunks);
+
+                uint64_t mask = 0;
+                foreach (const auto &chunk, *slot.chunks) {
+                    assert(chunk.location().domain() == static_cast<Domain>(MemoryDomain::FIRST_REGISTER + i));
+                    mask |= getMask(chunk.location());
+                }
+                assert(slot.mask == mask);
+            }
+        }
+        assert(nonEmptySlots == registers_->nonEmptySlots);
+        assert(nonEmptySlots > 0);
+    }
+#endif
 }
 
 void ReachingDefinitions::print(QTextStream &out) const {
     out << '{';
-    foreach (const auto &chunk, chunks_) {
+    foreach (const auto &chunk, chunks()) {
         out << chunk.location() << ':';
         foreach (const Term *term, chunk.definitions()) {
             out << ' ' << *term;
@@ -27,6 +27,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 #include <nc/common/Foreach.h>
@@ -44,6 +48,15 @@ namespace dflow {
 
 /**
  * Reaching definitions.
+ *
+ * Objects of this class are cheap to copy: copies share the list of chunks
+ * until one of them is modified, and chunks share their lists of terms.
+ * Lists of terms are never modified after creation.
+ *
+ * Chunks of register domains are kept in a separate slot per domain, so that
+ * a write to a register copies only the chunks of its domain. A bit mask of
+ * the covered bits lets killing and projecting skip registers having no
+ * definitions of the accessed bits without looking at the chunks.
  */
 class ReachingDefinitions: public PrintableBase<ReachingDefinitions> {
 public:
@@ -51,8 +64,13 @@ public:
      * Memory location and the list of terms defining this memory location.
      */
     class Chunk {
+    public:
+        /** Immutable list of terms shared between chunks. */
+        typedef std::shared_ptr<const std::vector<const Term *>> SharedDefinitions;
+
+    private:
         MemoryLocation location_; ///< Memory location.
-        std::vector<const Term *> definitions_; ///< Terms defining this memory location.
+        SharedDefinitions definitions_; ///< Terms defining this memory location.
 
         public:
 
@@ -63,9 +81,22 @@ public:
          * \param definitions   List of terms defining this memory location.
          */
         Chunk(const MemoryLocation &location, std::vector<const Term *> definitions):
+            location_(location), definitions_(std::make_shared<const std::vector<const Term *>>(std::move(definitions)))
+        {
+            assert(location);
+        }
+
+        /**
+         * Constructor.
+         *
+         * \param location      Valid memory location.
+         * \param definitions   Valid pointer to the list of terms defining this memory location.
+         */
+        Chunk(const MemoryLocation &location, SharedDefinitions definitions):
             location_(location), definitions_(std::move(definitions))
         {
             assert(location);
+            assert(definitions_);
         }
 
         /**
@@ -76,12 +107,12 @@ public:
         /**
          * \return List of terms defining the memory location.
          */
-        std::vector<const Term *> &definitions() { return definitions_; }
+        const std::vector<const Term *> &definitions() const { return *definitions_; }
 
         /**
-         * \return List of terms defining the memory location.
+         * \return Valid pointer to the shared list of terms defining the memory location.
          */
-        const std::vector<const Term *> &definitions() const { return definitions_; }
+        const SharedDefinitions &sharedDefinitions() const { return definitions_; }
 
         /**
          * \param that Another object of the same type.
@@ -90,17 +121,168 @@ public:
          *         false otherwise.
          */
         bool operator==(const Chunk &that) const {
-            return location_ == that.location_ && definitions_ == that.definitions_;
+            return location_ == that.location_ &&
+                (definitions_ == that.definitions_ || *definitions_ == *that.definitions_);
+        }
+    };
+
+    /**
+     * Forward iterator over the chunks of all domains in the order of memory locations.
+     *
+     * The chunks are stored in several sorted lists (segments): the chunks of
+     * non-register domains below the register ones, the chunks of each register
+     * domain, and the chunks of non-register domains above the register ones.
+     * The iterator walks through the segments one after another.
+     */
+    class ChunkIterator {
+        const ReachingDefinitions *owner_; ///< Reaching definitions being iterated over.
+        std::size_t segment_; ///< Index of the current segment, see getSegment().
+        const Chunk *current_; ///< Current chunk, nullptr for the end iterator.
+        const Chunk *end_; ///< End of the current segment.
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Chunk value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Chunk *pointer;
+        typedef const Chunk &reference;
+
+        /**
+         * Constructs the end iterator.
+         */
+        ChunkIterator(): owner_(nullptr), segment_(0), current_(nullptr), end_(nullptr) {}
+
+        /**
+         * Constructs an iterator pointing to the first chunk in the given or a later segment.
+         *
+         * \param owner Valid pointer to the reaching definitions.
+         * \param segment Index of the segment.
+         */
+        ChunkIterator(const ReachingDefinitions *owner, std::size_t segment):
+            owner_(owner), segment_(segment), current_(nullptr), end_(nullptr)
+        {
+            assert(owner != nullptr);
+            enterSegment();
+        }
+
+        reference operator*() const { return *current_; }
+        pointer operator->() const { return current_; }
+
+        ChunkIterator &operator++() {
+            if (++current_ == end_) {
+                ++segment_;
+                enterSegment();
+            }
+            return *this;
+        }
+
+        ChunkIterator operator++(int) {
+            ChunkIterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const ChunkIterator &that) const { return current_ == that.current_; }
+        bool operator!=(const ChunkIterator &that) const { return current_ != that.current_; }
+
+    private:
+        /**
+         * Moves to the first chunk of the first non-empty segment, starting
+         * from the current one, or to the end if there is no such segment.
+         */
+        void enterSegment();
+    };
+
+    /**
+     * Range of the chunks of all domains in the order of memory locations.
+     * The range is valid until the reaching definitions are modified.
+     */
+    class ChunkRange {
+        const ReachingDefinitions *owner_; ///< Reaching definitions.
+
+    public:
+        typedef ChunkIterator iterator;
+        typedef ChunkIterator const_iterator;
+
+        /**
+         * Constructor.
+         *
+         * \param owner Valid pointer to the reaching definitions.
+         */
+        explicit ChunkRange(const ReachingDefinitions *owner): owner_(owner) { assert(owner != nullptr); }
+
+        ChunkIterator begin() const { return ChunkIterator(owner_, 0); }
+        ChunkIterator end() const { return ChunkIterator(); }
+
+        /**
+         * \return True iff there are no chunks.
+         */
+        bool empty() const { return owner_->empty(); }
+
+        /**
+         * \return Number of chunks.
+         */
+        std::size_t size() const;
+
+        /**
+         * \return The first chunk. The range must be not empty.
+         */
+        const Chunk &front() const {
+            assert(!empty());
+            return *begin();
         }
+
+        /**
+         * \return The last chunk. The range must be not empty.
+         */
+        const Chunk &back() const;
     };
 
 private:
+    /** Immutable list of chunks shared between copies, nullptr stands for an empty list. */
+    typedef std::shared_ptr<const std::vector<Chunk>> SharedChunks;
+
     /**
-     * Pairs of memory locations and terms defining them.
-     * The pairs are sorted by memory location.
-     * Terms are sorted using default comparator.
+     * Chunks of a single register domain.
      */
-    std::vector<Chunk> chunks_;
+    struct RegisterSlot {
+        /** Chunks of the domain. */
+        SharedChunks chunks;
+
+        /** Bit i is set iff bit i of the domain is covered by some chunk, for i < 64. */
+        uint64_t mask;
+
+        RegisterSlot(): mask(0) {}
+    };
+
+    /**
+     * Chunks of register domains, one slot per domain.
+     *
+     * Register tables number the domains of an architecture densely,
+     * so the slot of a domain is found by subtracting MemoryDomain::FIRST_REGISTER.
+     */
+    struct RegisterFile {
+        /** Slots of register domains, indexed by domain - MemoryDomain::FIRST_REGISTER. */
+        std::vector<RegisterSlot> entries;
+
+        /** Number of slots having at least one chunk. */
+        std::size_t nonEmptySlots;
+
+        RegisterFile(): nonEmptySlots(0) {}
+    };
+
+    /**
+     * Pairs of memory locations and terms defining them, for all domains
+     * except register ones. The pairs are sorted by memory location,
+     * their locations do not overlap. Terms are sorted using default comparator.
+     */
+    SharedChunks chunks_;
+
+    /**
+     * Pairs of memory locations and terms defining them, for register domains.
+     * nullptr stands for a register file without chunks.
+     */
+    std::shared_ptr<const RegisterFile> registers_;
 
 public:
     /**
@@ -108,17 +290,20 @@ public:
      *         The pairs are sorted by memory location.
      *         Terms are sorted using default comparator.
      */
-    const std::vector<Chunk> &chunks() const { return chunks_; }
+    ChunkRange chunks() const { return ChunkRange(this); }
 
     /**
      * \return True if the list of pairs (chunks) is empty, false otherwise.
      */
-    bool empty() const { return chunks_.empty(); }
+    bool empty() const { return !chunks_ && !registers_; }
 
     /**
      * Clears the reaching definitions.
      */
-    void clear() { chunks_.clear(); }
+    void clear() {
+        chunks_.reset();
+        registers_.reset();
+    }
 
     /**
      * Adds a definition of memory location, removing all previous definitions of overlapping memory locations.
@@ -177,7 +362,7 @@ public:
      *
      * \param[in] those Reaching definitions.
      */
-    bool operator==(const ReachingDefinitions &those) const { return chunks_ == those.chunks_; }
+    bool operator==(const ReachingDefinitions &those) const;
 
     /**
      * \return True, if these and given reaching definitions are different.
@@ -196,16 +381,22 @@ public:
     template<class T>
     void filterOut(const T &pred) {
         selfTest();
-        foreach (auto &chunk, chunks_) {
-            chunk.definitions().erase(
-                std::remove_if(chunk.definitions().begin(), chunk.definitions().end(),
-                    [&](const Term *term) -> bool { return pred(chunk.location(), term); }),
-                chunk.definitions().end());
+
+        std::vector<Chunk> result;
+        if (chunks_ && filterChunks(*chunks_, pred, result)) {
+            chunks_ = makeChunks(std::move(result));
         }
-        chunks_.erase(
-            std::remove_if(chunks_.begin(), chunks_.end(),
-                [](const Chunk &chunk) -> bool { return chunk.definitions().empty(); }),
-            chunks_.end());
+
+        if (registers_) {
+            for (std::size_t i = 0; i < registers_->entries.size(); ++i) {
+                result.clear();
+                if (registers_->entries[i].chunks && filterChunks(*registers_->entries[i].chunks, pred, result)) {
+                    setSlot(detachRegisters(), i, makeChunks(std::move(result)));
+                }
+            }
+            dropEmptyRegisters();
+        }
+
         selfTest();
     }
 
@@ -213,16 +404,206 @@ public:
 
 private:
     /**
-     * Checks if the data structure is in a valid state.
+     * \param domain Domain.
+     *
+     * \return True iff the domain is a register one.
+     */
+    static bool isRegisterDomain(Domain domain) {
+        return MemoryDomain::FIRST_REGISTER <= domain && domain <= MemoryDomain::LAST_REGISTER;
+    }
+
+    /**
+     * \param memoryLocation Valid memory location.
+     *
+     * \return Mask of the bits of the memory location lying below the 64th bit.
+     */
+    static uint64_t getMask(const MemoryLocation &memoryLocation);
+
+    /**
+     * \param chunks List of chunks.
+     *
+     * \return Shared list of chunks, nullptr if the list is empty.
+     */
+    static SharedChunks makeChunks(std::vector<Chunk> chunks) {
+        if (chunks.empty()) {
+            return SharedChunks();
+        }
+        return std::make_shared<const std::vector<Chunk>>(std::move(chunks));
+    }
+
+    /**
+     * Computes the bounds of a segment of chunks, see ChunkIterator.
+     *
+     * \param[in] index Index of the segment.
+     * \param[out] begin Pointer to the first chunk of the segment.
+     * \param[out] end Pointer past the last chunk of the segment.
+     *
+     * \return True if there is a segment with the given index, false otherwise.
+     */
+    bool getSegment(std::size_t index, const Chunk *&begin, const Chunk *&end) const;
+
+    /**
+     * \param domain Domain.
+     *
+     * \return Sorted list of chunks containing all the chunks of the given domain.
+     */
+    const std::vector<Chunk> &getChunks(Domain domain) const;
+
+    /**
+     * Replaces the chunks of the domain.
+     *
+     * \param domain Domain.
+     * \param chunks New chunks of the domain. Must contain no chunks of other domains.
+     */
+    void setChunks(Domain domain, SharedChunks chunks);
+
+    /**
+     * \param memoryLocation Valid memory location.
+     *
+     * \return False if no chunk overlaps with the given memory location, true if some may.
+     */
+    bool mayOverlap(const MemoryLocation &memoryLocation) const;
+
+    /**
+     * Replaces the chunks in a slot of the register file.
+     *
+     * \param file Register file.
+     * \param index Index of the slot.
+     * \param chunks New chunks of the slot.
+     */
+    static void setSlot(RegisterFile &file, std::size_t index, SharedChunks chunks);
+
+    /**
+     * Makes the register file owned exclusively by these reaching definitions,
+     * so that it can be modified in place. The file is copied only if it is
+     * shared with other reaching definitions, and created if there is none.
+     *
+     * \return The register file.
+     */
+    RegisterFile &detachRegisters();
+
+    /**
+     * Drops the register file if all its slots are empty.
+     */
+    void dropEmptyRegisters();
+
+    /**
+     * \param chunks Sorted list of chunks.
+     * \param memoryLocation Valid memory location.
+     *
+     * \return Iterator pointing to the first chunk which may overlap with
+     *         the memory location, i.e. the first chunk that does not end
+     *         before the memory location begins.
+     */
+    static std::vector<Chunk>::const_iterator findFirstOverlapping(const std::vector<Chunk> &chunks,
+                                                                  const MemoryLocation &memoryLocation) {
+        return std::lower_bound(chunks.begin(), chunks.end(), memoryLocation,
+            [](const Chunk &chunk, const MemoryLocation &mloc) -> bool {
+                return chunk.location().domain() < mloc.domain() ||
+                    (chunk.location().domain() == mloc.domain() && chunk.location().endAddr() <= mloc.addr());
+            });
+    }
+
+    /**
+     * Removes the parts of chunks overlapping with the given memory location.
+     *
+     * \param[in] chunks Sorted list of chunks.
+     * \param[in] memoryLocation Valid memory location.
+     * \param[out] result Resulting list of chunks.
+     *
+     * \return False if nothing was removed and result was left untouched, true otherwise.
+     */
+    static bool killChunks(const std::vector<Chunk> &chunks, const MemoryLocation &memoryLocation,
+                           std::vector<Chunk> &result);
+
+    /**
+     * Computes the parts of chunks overlapping with the given memory location.
+     *
+     * \param[in] chunks Sorted list of chunks.
+     * \param[in] memoryLocation Valid memory location.
+     * \param[out] result Resulting list of chunks.
+     */
+    static void projectChunks(const std::vector<Chunk> &chunks, const MemoryLocation &memoryLocation,
+                              std::vector<Chunk> &result);
+
+    /**
+     * \param a Shared sorted list of chunks.
+     * \param b Shared sorted list of chunks.
+     *
+     * \return Shared sorted list of chunks containing the definitions from both lists.
+     */
+    static SharedChunks mergeChunks(const SharedChunks &a, const SharedChunks &b);
+
+    /**
+     * \param a Shared list of chunks.
+     * \param b Shared list of chunks.
+     *
+     * \return True iff the lists are equal.
+     */
+    static bool equal(const SharedChunks &a, const SharedChunks &b) {
+        return a == b || (a && b && *a == *b);
+    }
+
+    /**
+     * Removes the definitions for which given predicate returns true.
+     *
+     * \param[in] chunks Sorted list of chunks.
+     * \param[in] pred Predicate.
+     * \param[out] result Resulting list of chunks.
+     *
+     * \return False if nothing was removed and result was left untouched, true otherwise.
+     */
+    template<class T>
+    static bool filterChunks(const std::vector<Chunk> &chunks, const T &pred, std::vector<Chunk> &result) {
+        bool changed = false;
+
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            const auto &chunk = chunks[i];
+            auto isFiltered = [&](const Term *term) -> bool { return pred(chunk.location(), term); };
+
+            if (!changed && std::none_of(chunk.definitions().begin(), chunk.definitions().end(), isFiltered)) {
+                continue;
+            }
+            if (!changed) {
+                changed = true;
+                result.reserve(chunks.size());
+                result.insert(result.end(), chunks.begin(), chunks.begin() + i);
+            }
+
+            std::vector<const Term *> definitions;
+            std::remove_copy_if(chunk.definitions().begin(), chunk.definitions().end(),
+                std::back_inserter(definitions), isFiltered);
+
+            if (definitions.size() == chunk.definitions().size()) {
+                result.push_back(chunk);
+            } else if (!definitions.empty()) {
+                result.push_back(Chunk(chunk.location(), std::move(definitions)));
+            }
+        }
+
+        return changed;
+    }
+
+    /**
+     * Checks if the list of chunks is sorted and the locations do not overlap.
      * Fails with an assertion if not.
+     *
+     * \param chunks List of chunks.
      */
-    void selfTest() const {
+    static void selfTest(const std::vector<Chunk> &chunks) {
 #ifndef NDEBUG
-        for (std::size_t i = 1; i < chunks_.size(); ++i) {
-            assert(chunks_[i-1].location() < chunks_[i].location());
+        for (std::size_t i = 1; i < chunks.size(); ++i) {
+            assert(chunks[i-1].location() < chunks[i].location());
+            assert(!chunks[i-1].location().overlaps(chunks[i].location()));
         }
 #endif
     }
+
+    /**
+     * Checks if the data structure is in a valid state.
+     * Fails with an assertion if not.
+     */
+    void selfTest() const;
 };
 
 } // namespace dflow
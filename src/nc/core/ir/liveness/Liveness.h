@@ -5,9 +5,10 @@
 
 #include <nc/config.h>
 
-#include <boost/unordered_set.hpp>
+#include <cassert>
+#include <vector>
 
-#include <nc/common/Range.h>
+#include <boost/unordered_map.hpp>
 
 namespace nc {
 namespace core {
@@ -19,33 +20,73 @@ namespace liveness {
 
 /**
  * Set of terms producing actual high-level code.
+ *
+ * Terms are given dense indices by a hash table built once when the terms
+ * are set. The set of live terms is kept as a bit vector over these
+ * indices, so checking whether a term is live takes constant time on
+ * average. The indices belong to the Liveness, so the liveness of several
+ * functions can be computed concurrently.
  */
 class Liveness {
-    boost::unordered_set<const Term *> liveTermSet_; ///< The set of live terms.
+    std::vector<const Term *> terms_; ///< Known terms by their indices.
+    std::vector<bool> liveBits_; ///< i-th bit is set iff terms_[i] is live.
+    boost::unordered_map<const Term *, std::size_t> term2index_; ///< Indices of the terms in terms_.
     std::vector<const Term *> liveTermList_; ///< The list of live terms.
 
 public:
+    /**
+     * Sets the list of known terms and numbers them. Terms that are not
+     * known can still be made live.
+     *
+     * \param[in] terms Valid pointers to the terms of one function, without duplicates.
+     */
+    void setTerms(std::vector<const Term *> terms) {
+        assert(liveTermList_.empty() && "Terms must be set before any term is made live.");
+
+        terms_ = std::move(terms);
+        liveBits_.assign(terms_.size(), false);
+
+        term2index_.clear();
+        for (std::size_t i = 0; i < terms_.size(); ++i) {
+            assert(term2index_.find(terms_[i]) == term2index_.end() && "Terms must not repeat.");
+            term2index_[terms_[i]] = i;
+        }
+    }
+
     /**
      * \param[in] term Term.
      *
      * \return True if term is live.
      */
     bool isLive(const Term *term) const {
-        assert(term != nullptr);
-        return nc::contains(liveTermSet_, term);
+        auto index = getIndex(term);
+        return index < terms_.size() && liveBits_[index];
     }
 
     /**
      * Marks a term as live.
      *
      * \param[in] term Valid pointer to a term.
+     *
+     * \return True if the term was not live before.
      */
-    void makeLive(const Term *term) {
-        assert(term != nullptr);
+    bool makeLive(const Term *term) {
+        auto index = getIndex(term);
+
+        if (index == terms_.size()) {
+            /* The term was not numbered by setTerms(). */
+            term2index_[term] = index;
+            terms_.push_back(term);
+            liveBits_.push_back(false);
+        }
 
-        if (liveTermSet_.insert(term).second) {
-            liveTermList_.push_back(term);
-        };
+        if (liveBits_[index]) {
+            return false;
+        }
+
+        liveBits_[index] = true;
+        liveTermList_.push_back(term);
+        return true;
     }
 
     /**
@@ -55,6 +96,23 @@ public:
      *       much faster if the terms are processed in the natural order.
      */
     const std::vector<const Term *> &liveTerms() const { return liveTermList_; }
+
+private:
+    /**
+     * \param[in] term Valid pointer to a term.
+     *
+     * \return Index of the term in terms_, or terms_.size() if the term is not there.
+     */
+    std::size_t getIndex(const Term *term) const {
+        assert(term != nullptr);
+
+        auto i = term2index_.find(term);
+        if (i != term2index_.end()) {
+            return i->second;
+        }
+
+        return terms_.size();
+    }
 };
 
 } // namespace liveness
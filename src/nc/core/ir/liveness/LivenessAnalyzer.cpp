@@ -24,6 +24,7 @@
 
 #include "LivenessAnalyzer.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <nc/common/Foreach.h>
@@ -63,6 +64,7 @@ LivenessAnalyzer::LivenessAnalyzer(Liveness &liveness, const Function *function,
 {}
 
 void LivenessAnalyzer::analyze() {
+    numberTerms();
     computeInvisibleJumps();
 
     foreach (const BasicBlock *basicBlock, function_->basicBlocks()) {
@@ -72,6 +74,63 @@ void LivenessAnalyzer::analyze() {
     }
 }
 
+void LivenessAnalyzer::numberTerms() {
+    std::vector<const Term *> terms;
+    std::vector<const Term *> stack;
+
+    /* Collects the term and its children in the preorder, using an explicit stack. */
+    auto collect = [&](const Term *term) {
+        stack.push_back(term);
+
+        while (!stack.empty()) {
+            term = stack.back();
+            stack.pop_back();
+
+            terms.push_back(term);
+
+            auto size = stack.size();
+            term->callOnChildren([&](const Term *child) { stack.push_back(child); });
+            std::reverse(stack.begin() + size, stack.end());
+        }
+    };
+
+    foreach (const BasicBlock *basicBlock, function_->basicBlocks()) {
+        foreach (const Statement *statement, basicBlock->statements()) {
+            switch (statement->kind()) {
+                case Statement::ASSIGNMENT: {
+                    auto assignment = statement->asAssignment();
+                    collect(assignment->right());
+                    collect(assignment->left());
+                    break;
+                }
+                case Statement::JUMP: {
+                    auto jump = statement->asJump();
+                    if (jump->condition()) {
+                        collect(jump->condition());
+                    }
+                    if (jump->thenTarget().address()) {
+                        collect(jump->thenTarget().address());
+                    }
+                    if (jump->elseTarget().address()) {
+                        collect(jump->elseTarget().address());
+                    }
+                    break;
+                }
+                case Statement::CALL:
+                    collect(statement->asCall()->target());
+                    break;
+                case Statement::TOUCH:
+                    collect(statement->asTouch()->term());
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    liveness_.setTerms(std::move(terms));
+}
+
 void LivenessAnalyzer::computeInvisibleJumps() {
     if (!regionGraph_) {
         return;
@@ -184,12 +243,12 @@ void LivenessAnalyzer::propagateLiveness(const Term *term) {
             if (term->isRead()) {
                 foreach (auto &chunk, dataflow_.getDefinitions(term).chunks()) {
                     foreach (const Term *definition, chunk.definitions()) {
-                        makeLive(definition);
+                        worklist_.push_back(definition);
                     }
                 }
             } else if (term->isWrite()) {
                 if (auto source = term->source()) {
-                    makeLive(source);
+                    worklist_.push_back(source);
                 }
             }
             break;
@@ -198,34 +257,34 @@ void LivenessAnalyzer::propagateLiveness(const Term *term) {
             if (term->isRead()) {
                 foreach (auto &chunk, dataflow_.getDefinitions(term).chunks()) {
                     foreach (const Term *definition, chunk.definitions()) {
-                        makeLive(definition);
+                        worklist_.push_back(definition);
                     }
                 }
             } else if (term->isWrite()) {
                 if (auto source = term->source()) {
-                    makeLive(source);
+                    worklist_.push_back(source);
                 }
             }
 
             if (!dataflow_.getMemoryLocation(term)) {
-                makeLive(term->asDereference()->address());
+                worklist_.push_back(term->asDereference()->address());
             }
             break;
         }
         case Term::UNARY_OPERATOR: {
             const UnaryOperator *unary = term->asUnaryOperator();
-            makeLive(unary->operand());
+            worklist_.push_back(unary->operand());
             break;
         }
         case Term::BINARY_OPERATOR: {
             const BinaryOperator *binary = term->asBinaryOperator();
-            makeLive(binary->left());
-            makeLive(binary->right());
+            worklist_.push_back(binary->left());
+            worklist_.push_back(binary->right());
             break;
         }
         case Term::TYPE_CONVERSION: {
             const TypeConversion *conversion = term->asTypeConversion();
-            makeLive(conversion->operand());
+            worklist_.push_back(conversion->operand());
             break;
         }
         default:
@@ -236,9 +295,25 @@ void LivenessAnalyzer::propagateLiveness(const Term *term) {
 
 void LivenessAnalyzer::makeLive(const Term *term) {
     assert(term != nullptr);
-    if (!liveness_.isLive(term)) {
-        liveness_.makeLive(term);
-        propagateLiveness(term);
+    assert(worklist_.empty());
+
+    worklist_.push_back(term);
+
+    while (!worklist_.empty()) {
+        term = worklist_.back();
+        worklist_.pop_back();
+
+        if (liveness_.makeLive(term)) {
+            /*
+             * Reverse the added terms, so that they are popped
+             * in the order in which the recursive version would
+             * have visited them. This keeps liveTerms() ordered
+             * the same way.
+             */
+            auto size = worklist_.size();
+            propagateLiveness(term);
+            std::reverse(worklist_.begin() + size, worklist_.end());
+        }
     }
 }
 
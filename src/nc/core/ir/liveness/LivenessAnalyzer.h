@@ -85,6 +85,7 @@ class LivenessAnalyzer {
     const calling::Signatures *signatures_;
     const LogToken &log_;
     std::vector<const Jump *> invisibleJumps_;
+    std::vector<const Term *> worklist_; ///< Terms to be made live.
 
 public:
     /**
@@ -110,6 +111,11 @@ public:
     void analyze();
 
 private:
+    /**
+     * Gives dense indices to all the terms of the function.
+     */
+    void numberTerms();
+
     /**
      * Computes the jumps that will not be visible in the generated code.
      */
@@ -123,7 +129,7 @@ private:
     void computeLiveness(const Statement *statement);
 
     /**
-     * Marks as used all the terms, used by given term in order to generate code.
+     * Adds to the worklist all the terms, used by given term in order to generate code.
      *
      * \param[in] term Used term.
      */
@@ -131,6 +137,8 @@ private:
 
     /**
      * If given term is not used, marks it as used and propagates liveness further.
+     * Terms are made live in the depth-first preorder, using an explicit worklist
+     * instead of recursion.
      *
      * \param[in] term Term.
      */
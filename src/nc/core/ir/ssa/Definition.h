@@ -0,0 +1,175 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <nc/core/ir/MemoryLocation.h>
+
+namespace nc {
+namespace core {
+namespace ir {
+
+class BasicBlock;
+class Term;
+
+namespace ssa {
+
+/**
+ * Definition of a variable in static single assignment form.
+ */
+class Definition: boost::noncopyable {
+public:
+    /**
+     * Kind of a definition.
+     */
+    enum Kind {
+        WRITE, ///< Write to (a part of) the variable by a term.
+        PHI,   ///< Phi function merging definitions coming from the predecessors of a basic block.
+        ENTRY  ///< Value of the variable at the entry of the function.
+    };
+
+    /**
+     * Operand of a phi function: a definition reaching the phi function
+     * from the given predecessor of the phi function's basic block.
+     */
+    class Operand {
+        const BasicBlock *predecessor_;
+        const Definition *definition_;
+
+    public:
+        Operand(const BasicBlock *predecessor, const Definition *definition):
+            predecessor_(predecessor), definition_(definition)
+        {
+            assert(predecessor != nullptr);
+            assert(definition != nullptr);
+        }
+
+        const BasicBlock *predecessor() const { return predecessor_; }
+        const Definition *definition() const { return definition_; }
+
+        bool operator==(const Operand &that) const {
+            return predecessor_ == that.predecessor_ && definition_ == that.definition_;
+        }
+    };
+
+private:
+    Kind kind_; ///< Kind of the definition.
+    std::size_t variable_; ///< Index of the variable being defined.
+    MemoryLocation location_; ///< Defined memory location.
+    const Term *term_; ///< Write term, for WRITE definitions.
+    const BasicBlock *basicBlock_; ///< Basic block of the definition, nullptr for ENTRY definitions.
+    std::vector<Operand> operands_; ///< Operands of a phi function.
+    std::vector<const Term *> uses_; ///< Read terms using the definition.
+    std::vector<const Definition *> phiUses_; ///< Phi functions using the definition.
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param kind Kind of the definition.
+     * \param variable Index of the variable being defined.
+     * \param location Valid memory location being defined: the memory location of the write
+     *                 term for WRITE definitions, the memory location of the variable otherwise.
+     * \param term Pointer to the write term for WRITE definitions, nullptr otherwise.
+     * \param basicBlock Pointer to the basic block containing the definition,
+     *                   nullptr for ENTRY definitions.
+     */
+    Definition(Kind kind, std::size_t variable, const MemoryLocation &location, const Term *term,
+               const BasicBlock *basicBlock):
+        kind_(kind), variable_(variable), location_(location), term_(term), basicBlock_(basicBlock)
+    {
+        assert(location);
+        assert((kind == WRITE) == (term != nullptr));
+        assert((kind == ENTRY) == (basicBlock == nullptr));
+    }
+
+    /**
+     * \return Kind of the definition.
+     */
+    Kind kind() const { return kind_; }
+
+    /**
+     * \return Index of the variable being defined.
+     */
+    std::size_t variable() const { return variable_; }
+
+    /**
+     * \return Memory location being defined.
+     */
+    const MemoryLocation &location() const { return location_; }
+
+    /**
+     * \return Pointer to the write term for WRITE definitions, nullptr otherwise.
+     */
+    const Term *term() const { return term_; }
+
+    /**
+     * \return Pointer to the basic block containing the definition, nullptr for ENTRY definitions.
+     */
+    const BasicBlock *basicBlock() const { return basicBlock_; }
+
+    /**
+     * \return Operands of the phi function.
+     */
+    const std::vector<Operand> &operands() const { return operands_; }
+
+    /**
+     * Adds an operand to the phi function, unless it is already there.
+     *
+     * \param operand Operand.
+     */
+    void addOperand(const Operand &operand) {
+        assert(kind_ == PHI);
+        if (std::find(operands_.begin(), operands_.end(), operand) == operands_.end()) {
+            operands_.push_back(operand);
+        }
+    }
+
+    /**
+     * \return Read terms using this definition.
+     */
+    const std::vector<const Term *> &uses() const { return uses_; }
+
+    /**
+     * Adds a read term to the list of uses.
+     *
+     * \param term Valid pointer to a read term.
+     */
+    void addUse(const Term *term) {
+        assert(term != nullptr);
+        uses_.push_back(term);
+    }
+
+    /**
+     * \return Phi functions using this definition.
+     */
+    const std::vector<const Definition *> &phiUses() const { return phiUses_; }
+
+    /**
+     * Adds a phi function to the list of uses.
+     *
+     * \param phi Valid pointer to a phi function.
+     */
+    void addPhiUse(const Definition *phi) {
+        assert(phi != nullptr);
+        assert(phi->kind() == PHI);
+        if (phiUses_.empty() || phiUses_.back() != phi) {
+            phiUses_.push_back(phi);
+        }
+    }
+};
+
+} // namespace ssa
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
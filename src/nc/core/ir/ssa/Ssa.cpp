@@ -0,0 +1,69 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Ssa.h"
+
+#include <QTextStream>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/Unreachable.h>
+
+#include <nc/core/ir/Term.h>
+
+namespace nc {
+namespace core {
+namespace ir {
+namespace ssa {
+
+void Ssa::print(QTextStream &out) const {
+    boost::unordered_map<const Definition *, std::size_t> definition2number;
+    for (std::size_t i = 0; i < definitions_.size(); ++i) {
+        definition2number[definitions_[i].get()] = i;
+    }
+
+    for (std::size_t i = 0; i < variables_.size(); ++i) {
+        out << "variable" << i << " = " << variables_[i] << endl;
+    }
+
+    foreach (const auto &definition, definitions_) {
+        out << "definition" << definition2number[definition.get()] << " = ";
+
+        switch (definition->kind()) {
+            case Definition::WRITE:
+                out << "write variable" << definition->variable() << ' ' << definition->location()
+                    << " by " << *definition->term() << " in basicBlock" << definition->basicBlock();
+                break;
+            case Definition::PHI: {
+                out << "phi variable" << definition->variable() << " in basicBlock" << definition->basicBlock() << " (";
+                bool comma = false;
+                foreach (const auto &operand, definition->operands()) {
+                    if (comma) {
+                        out << ", ";
+                    } else {
+                        comma = true;
+                    }
+                    out << "basicBlock" << operand.predecessor() << ": definition" << definition2number[operand.definition()];
+                }
+                out << ')';
+                break;
+            }
+            case Definition::ENTRY:
+                out << "entry variable" << definition->variable();
+                break;
+            default:
+                unreachable();
+        }
+        out << endl;
+
+        foreach (auto term, definition->uses()) {
+            out << "    used by " << *term << endl;
+        }
+    }
+}
+
+} // namespace ssa
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,170 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <memory>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <nc/common/Printable.h>
+#include <nc/common/Range.h>
+#include <nc/core/ir/MemoryLocation.h>
+
+#include "Definition.h"
+
+namespace nc {
+namespace core {
+namespace ir {
+
+class BasicBlock;
+class Term;
+
+namespace ssa {
+
+/**
+ * Static single assignment form of a function.
+ *
+ * Variables are the maximal groups of overlapping memory locations
+ * written in the function. Every write term defines its variable anew,
+ * phi functions merge the definitions at join points, and each read term
+ * refers to the definitions it may read. This gives sparse def-use chains
+ * instead of a set of reaching definitions per read term.
+ */
+class Ssa: public PrintableBase<Ssa> {
+    /** Memory locations of the variables, sorted. */
+    std::vector<MemoryLocation> variables_;
+
+    /** All the definitions. */
+    std::vector<std::unique_ptr<Definition>> definitions_;
+
+    /** Mapping from a write term to its definition. */
+    boost::unordered_map<const Term *, const Definition *> term2definition_;
+
+    /** Mapping from a read term to the definitions it may read. */
+    boost::unordered_map<const Term *, std::vector<const Definition *>> term2definitions_;
+
+    /** Mapping from a basic block to the phi functions at its beginning. */
+    boost::unordered_map<const BasicBlock *, std::vector<const Definition *>> basicBlock2phis_;
+
+public:
+    /**
+     * \return Memory locations of the variables, sorted.
+     */
+    const std::vector<MemoryLocation> &variables() const { return variables_; }
+
+    /**
+     * Adds a variable.
+     *
+     * \param location Valid memory location of the variable.
+     *                 Must be greater than and not overlap the locations of the previously added variables.
+     *
+     * \return Index of the variable.
+     */
+    std::size_t addVariable(const MemoryLocation &location) {
+        assert(location);
+        assert(variables_.empty() || (variables_.back() < location && !variables_.back().overlaps(location)));
+        variables_.push_back(location);
+        return variables_.size() - 1;
+    }
+
+    /**
+     * \return All the definitions.
+     */
+    const std::vector<std::unique_ptr<Definition>> &definitions() const { return definitions_; }
+
+    /**
+     * Adds a definition.
+     *
+     * \param definition Valid pointer to the definition.
+     *
+     * \return Pointer to the added definition.
+     */
+    Definition *addDefinition(std::unique_ptr<Definition> definition) {
+        assert(definition);
+        assert(definition->variable() < variables_.size());
+        definitions_.push_back(std::move(definition));
+        return definitions_.back().get();
+    }
+
+    /**
+     * \param term Valid pointer to a write term.
+     *
+     * \return Pointer to the definition made by the term,
+     *         nullptr if the term writes to an untracked memory location.
+     */
+    const Definition *getDefinition(const Term *term) const {
+        assert(term != nullptr);
+        return nc::find(term2definition_, term);
+    }
+
+    /**
+     * Sets the definition made by a write term.
+     *
+     * \param term Valid pointer to a write term.
+     * \param definition Valid pointer to the definition.
+     */
+    void setDefinition(const Term *term, const Definition *definition) {
+        assert(term != nullptr);
+        assert(definition != nullptr);
+        term2definition_[term] = definition;
+    }
+
+    /**
+     * \param term Valid pointer to a read term.
+     *
+     * \return Definitions the term may read. The list is empty if the term reads
+     *         an untracked memory location or one never written in the function.
+     */
+    const std::vector<const Definition *> &getDefinitions(const Term *term) const {
+        assert(term != nullptr);
+        return nc::find(term2definitions_, term);
+    }
+
+    /**
+     * \param term Valid pointer to a read term.
+     *
+     * \return Definitions the term may read.
+     */
+    std::vector<const Definition *> &getDefinitions(const Term *term) {
+        assert(term != nullptr);
+        return term2definitions_[term];
+    }
+
+    /**
+     * \param basicBlock Valid pointer to a basic block.
+     *
+     * \return Phi functions at the beginning of the basic block.
+     */
+    const std::vector<const Definition *> &getPhis(const BasicBlock *basicBlock) const {
+        assert(basicBlock != nullptr);
+        return nc::find(basicBlock2phis_, basicBlock);
+    }
+
+    /**
+     * \param basicBlock Valid pointer to a basic block.
+     *
+     * \return Phi functions at the beginning of the basic block.
+     */
+    std::vector<const Definition *> &getPhis(const BasicBlock *basicBlock) {
+        assert(basicBlock != nullptr);
+        return basicBlock2phis_[basicBlock];
+    }
+
+    /**
+     * Prints the variables and the definitions with their uses into a stream.
+     *
+     * \param out Output stream.
+     */
+    void print(QTextStream &out) const;
+};
+
+} // namespace ssa
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
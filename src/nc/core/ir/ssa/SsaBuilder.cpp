@@ -0,0 +1,389 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "SsaBuilder.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <nc/common/CancellationToken.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/ir/BasicBlock.h>
+#include <nc/core/ir/DominanceFrontiers.h>
+#include <nc/core/ir/Dominators.h>
+#include <nc/core/ir/Function.h>
+#include <nc/core/ir/Jump.h>
+#include <nc/core/ir/Statements.h>
+#include <nc/core/ir/Term.h>
+#include <nc/core/ir/dflow/Dataflow.h>
+
+#include "Ssa.h"
+
+namespace nc {
+namespace core {
+namespace ir {
+namespace ssa {
+
+SsaBuilder::SsaBuilder(Ssa &ssa, const Function *function, const dflow::Dataflow &dataflow,
+                       const CancellationToken &canceled):
+    ssa_(ssa), function_(function), dataflow_(dataflow), canceled_(canceled)
+{
+    assert(function != nullptr);
+}
+
+void SsaBuilder::build() {
+    const CFG &cfg = function_->cfg();
+
+    collectAccesses(cfg);
+    computeVariables();
+
+    const auto &variables = ssa_.variables();
+
+    Dominators dominators(cfg, canceled_);
+    DominanceFrontiers frontiers(cfg, dominators, canceled_);
+
+    /*
+     * Find the basic blocks defining each variable and the variables
+     * which are read before being completely overwritten in some basic block.
+     * Only the latter need phi functions.
+     */
+    std::vector<std::vector<CFG::Index>> definingBasicBlocks(variables.size());
+    std::vector<bool> upwardExposed(variables.size());
+    {
+        /* Basic block where the variable was completely overwritten last. */
+        std::vector<CFG::Index> killedIn(variables.size(), cfg.size());
+
+        for (CFG::Index index = 0; index < cfg.size(); ++index) {
+            foreach (const auto &access, accesses_[index]) {
+                auto range = getVariables(access.location);
+
+                for (auto variable = range.first; variable != range.second; ++variable) {
+                    if (access.term->isRead()) {
+                        if (killedIn[variable] != index) {
+                            upwardExposed[variable] = true;
+                        }
+                    } else {
+                        auto &basicBlocks = definingBasicBlocks[variable];
+                        if (basicBlocks.empty() || basicBlocks.back() != index) {
+                            basicBlocks.push_back(index);
+                        }
+                        if (access.location.covers(variables[variable])) {
+                            killedIn[variable] = index;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+     * Place phi functions on the iterated dominance frontiers.
+     */
+    std::vector<std::vector<Definition *>> phis(cfg.size());
+
+    for (std::size_t variable = 0; variable < variables.size(); ++variable) {
+        if (!upwardExposed[variable]) {
+            continue;
+        }
+        foreach (auto index, frontiers.getIteratedFrontier(definingBasicBlocks[variable])) {
+            auto basicBlock = cfg.getBasicBlock(index);
+            auto phi = ssa_.addDefinition(std::make_unique<Definition>(
+                Definition::PHI, variable, variables[variable], nullptr, basicBlock));
+
+            phis[index].push_back(phi);
+            ssa_.getPhis(basicBlock).push_back(phi);
+        }
+    }
+
+    canceled_.poll();
+
+    /*
+     * Rename: walk the dominator tree, keeping the definitions of each
+     * variable visible at the current point on a stack.
+     */
+    struct StackEntry {
+        Definition *definition;
+        MemoryLocation location;
+    };
+
+    std::vector<std::vector<StackEntry>> stacks(variables.size());
+
+    /* Variables whose stacks were pushed to, in the order of pushing. */
+    std::vector<std::size_t> pushed;
+
+    /* Definitions of variables at the entry of the function. */
+    std::vector<Definition *> entryDefinitions(variables.size());
+
+    auto push = [&](std::size_t variable, Definition *definition, const MemoryLocation &location) {
+        StackEntry entry = { definition, location };
+        stacks[variable].push_back(entry);
+        pushed.push_back(variable);
+    };
+
+    /*
+     * Calls fun for each definition providing some bits of the memory
+     * location, which must belong to the given variable.
+     */
+    auto resolve = [&](std::size_t variable, const MemoryLocation &location, const std::function<void(Definition *)> &fun) {
+        const auto &variableLocation = variables[variable];
+
+        /* Parts of the memory location not covered by the definitions seen so far. */
+        std::vector<std::pair<BitAddr, BitAddr>> uncovered(1, std::make_pair(
+            std::max(location.addr(), variableLocation.addr()),
+            std::min(location.endAddr(), variableLocation.endAddr())));
+        std::vector<std::pair<BitAddr, BitAddr>> remaining;
+
+        const auto &stack = stacks[variable];
+        for (auto i = stack.rbegin(); i != stack.rend() && !uncovered.empty(); ++i) {
+            auto addr = i->location.addr();
+            auto endAddr = i->location.endAddr();
+
+            bool used = false;
+            remaining.clear();
+
+            foreach (const auto &interval, uncovered) {
+                if (interval.second <= addr || endAddr <= interval.first) {
+                    remaining.push_back(interval);
+                } else {
+                    used = true;
+                    if (interval.first < addr) {
+                        remaining.push_back(std::make_pair(interval.first, addr));
+                    }
+                    if (endAddr < interval.second) {
+                        remaining.push_back(std::make_pair(endAddr, interval.second));
+                    }
+                }
+            }
+
+            if (used) {
+                fun(i->definition);
+                uncovered.swap(remaining);
+            }
+        }
+
+        if (!uncovered.empty()) {
+            auto &entry = entryDefinitions[variable];
+            if (!entry) {
+                entry = ssa_.addDefinition(std::make_unique<Definition>(
+                    Definition::ENTRY, variable, variableLocation, nullptr, nullptr));
+            }
+            fun(entry);
+        }
+    };
+
+    auto enter = [&](CFG::Index index) {
+        auto basicBlock = cfg.getBasicBlock(index);
+
+        foreach (auto phi, phis[index]) {
+            push(phi->variable(), phi, phi->location());
+        }
+
+        foreach (const auto &access, accesses_[index]) {
+            auto range = getVariables(access.location);
+
+            if (access.term->isRead()) {
+                auto &definitions = ssa_.getDefinitions(access.term);
+
+                for (auto variable = range.first; variable != range.second; ++variable) {
+                    resolve(variable, access.location, [&](Definition *definition) {
+                        if (std::find(definitions.begin(), definitions.end(), definition) == definitions.end()) {
+                            definitions.push_back(definition);
+                            definition->addUse(access.term);
+                        }
+                    });
+                }
+            } else {
+                assert(range.second - range.first == 1);
+
+                auto definition = ssa_.addDefinition(std::make_unique<Definition>(
+                    Definition::WRITE, range.first, access.location, access.term, basicBlock));
+
+                ssa_.setDefinition(access.term, definition);
+                push(range.first, definition, access.location);
+            }
+        }
+
+        foreach (auto successor, cfg.getSuccessors(index)) {
+            foreach (auto phi, phis[successor]) {
+                resolve(phi->variable(), phi->location(), [&](Definition *definition) {
+                    phi->addOperand(Definition::Operand(basicBlock, definition));
+                    definition->addPhiUse(phi);
+                });
+            }
+        }
+    };
+
+    struct Frame {
+        CFG::Index index; ///< Index of the basic block.
+        std::size_t child; ///< Position of the next child to visit.
+        std::size_t pushed; ///< Number of pushes done before entering the basic block.
+    };
+
+    /* cfg.size() denotes the virtual root of the dominator tree. */
+    Frame root = { cfg.size(), 0, 0 };
+    std::vector<Frame> frames(1, root);
+
+    while (!frames.empty()) {
+        auto &frame = frames.back();
+        auto children = dominators.getChildren(frame.index);
+
+        if (frame.child < static_cast<std::size_t>(children.size())) {
+            auto index = children[frame.child++];
+
+            Frame child = { index, 0, pushed.size() };
+            enter(index);
+            frames.push_back(child);
+
+            canceled_.poll();
+        } else {
+            while (pushed.size() > frame.pushed) {
+                stacks[pushed.back()].pop_back();
+                pushed.pop_back();
+            }
+            frames.pop_back();
+        }
+    }
+
+    accesses_.clear();
+}
+
+bool SsaBuilder::isTracked(const MemoryLocation &memoryLocation) {
+    return memoryLocation &&
+        (memoryLocation.domain() == MemoryDomain::STACK ||
+         (MemoryDomain::FIRST_REGISTER <= memoryLocation.domain() && memoryLocation.domain() <= MemoryDomain::LAST_REGISTER));
+}
+
+void SsaBuilder::collectAccesses(const CFG &cfg) {
+    accesses_.assign(cfg.size(), std::vector<Access>());
+
+    for (CFG::Index index = 0; index < cfg.size(); ++index) {
+        foreach (auto statement, cfg.getBasicBlock(index)->statements()) {
+            collectAccesses(statement, accesses_[index]);
+        }
+    }
+}
+
+void SsaBuilder::collectAccesses(const Statement *statement, std::vector<Access> &accesses) {
+    /* Terms of the statement, children before parents. */
+    std::vector<const Term *> terms;
+
+    std::function<void(const Term *)> collect = [&](const Term *term) {
+        term->callOnChildren(collect);
+        terms.push_back(term);
+    };
+
+    switch (statement->kind()) {
+        case Statement::INLINE_ASSEMBLY: /* FALLTHROUGH */
+        case Statement::HALT: /* FALLTHROUGH */
+        case Statement::CALLBACK: /* FALLTHROUGH */
+        case Statement::REMEMBER_REACHING_DEFINITIONS:
+            break;
+        case Statement::ASSIGNMENT: {
+            auto assignment = statement->asAssignment();
+            collect(assignment->right());
+            collect(assignment->left());
+            break;
+        }
+        case Statement::JUMP: {
+            auto jump = statement->asJump();
+            if (jump->condition()) {
+                collect(jump->condition());
+            }
+            if (jump->thenTarget().address()) {
+                collect(jump->thenTarget().address());
+            }
+            if (jump->elseTarget().address()) {
+                collect(jump->elseTarget().address());
+            }
+            break;
+        }
+        case Statement::CALL: {
+            collect(statement->asCall()->target());
+            break;
+        }
+        case Statement::TOUCH: {
+            collect(statement->asTouch()->term());
+            break;
+        }
+        default:
+            /* User-defined statements access nothing known to dataflow analysis. */
+            break;
+    }
+
+    /* Reads happen before writes. */
+    foreach (auto term, terms) {
+        if (term->isRead()) {
+            const auto &location = dataflow_.getMemoryLocation(term);
+            if (isTracked(location)) {
+                Access access = { term, location };
+                accesses.push_back(access);
+            }
+        }
+    }
+    foreach (auto term, terms) {
+        if (term->isWrite()) {
+            const auto &location = dataflow_.getMemoryLocation(term);
+            if (isTracked(location)) {
+                Access access = { term, location };
+                accesses.push_back(access);
+            }
+        }
+    }
+}
+
+void SsaBuilder::computeVariables() {
+    std::vector<MemoryLocation> locations;
+
+    foreach (const auto &accesses, accesses_) {
+        foreach (const auto &access, accesses) {
+            if (access.term->isWrite()) {
+                locations.push_back(access.location);
+            }
+        }
+    }
+
+    std::sort(locations.begin(), locations.end());
+
+    /* Join overlapping locations into variables. */
+    MemoryLocation current;
+    foreach (const auto &location, locations) {
+        if (current && current.domain() == location.domain() && location.addr() < current.endAddr()) {
+            current = MemoryLocation(current.domain(), current.addr(),
+                std::max(current.endAddr(), location.endAddr()) - current.addr());
+        } else {
+            if (current) {
+                ssa_.addVariable(current);
+            }
+            current = location;
+        }
+    }
+    if (current) {
+        ssa_.addVariable(current);
+    }
+}
+
+std::pair<std::size_t, std::size_t> SsaBuilder::getVariables(const MemoryLocation &memoryLocation) const {
+    const auto &variables = ssa_.variables();
+
+    auto first = std::lower_bound(variables.begin(), variables.end(), memoryLocation,
+        [](const MemoryLocation &variable, const MemoryLocation &mloc) -> bool {
+            return variable.domain() < mloc.domain() ||
+                (variable.domain() == mloc.domain() && variable.endAddr() <= mloc.addr());
+        });
+
+    auto last = first;
+    while (last != variables.end() && last->overlaps(memoryLocation)) {
+        ++last;
+    }
+
+    return std::make_pair(first - variables.begin(), last - variables.begin());
+}
+
+} // namespace ssa
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,122 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <nc/core/ir/CFG.h>
+#include <nc/core/ir/MemoryLocation.h>
+
+namespace nc {
+
+class CancellationToken;
+
+namespace core {
+namespace ir {
+
+class Function;
+class Statement;
+class Term;
+
+namespace dflow {
+    class Dataflow;
+}
+
+namespace ssa {
+
+class Definition;
+class Ssa;
+
+/**
+ * This class builds the static single assignment form of a function
+ * for registers and stack slots, using the memory locations of terms
+ * computed by dataflow analysis.
+ *
+ * Phi functions are placed on the iterated dominance frontiers of the
+ * definitions of variables that are read before being completely
+ * overwritten in some basic block (semi-pruned SSA). Renaming walks the
+ * dominator tree.
+ *
+ * A write may define only a part of its variable, e.g. al of eax.
+ * A read is then connected to all the definitions providing the bits
+ * it reads, so a read may have several definitions.
+ */
+class SsaBuilder {
+    Ssa &ssa_;
+    const Function *function_;
+    const dflow::Dataflow &dataflow_;
+    const CancellationToken &canceled_;
+
+    /**
+     * Read or write access to a memory location.
+     */
+    struct Access {
+        const Term *term; ///< Read or write term.
+        MemoryLocation location; ///< Accessed memory location.
+    };
+
+    /** Accesses to tracked memory locations, in execution order, for each basic block. */
+    std::vector<std::vector<Access>> accesses_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param[out] ssa      SSA form of the function.
+     * \param[in]  function Valid pointer to a function.
+     * \param[in]  dataflow Dataflow information for the function.
+     * \param[in]  canceled Cancellation token.
+     */
+    SsaBuilder(Ssa &ssa, const Function *function, const dflow::Dataflow &dataflow,
+               const CancellationToken &canceled);
+
+    /**
+     * Builds the SSA form.
+     */
+    void build();
+
+private:
+    /**
+     * \param memoryLocation Memory location.
+     *
+     * \return True iff the memory location belongs to a register or the stack frame.
+     */
+    static bool isTracked(const MemoryLocation &memoryLocation);
+
+    /**
+     * Collects the accesses to tracked memory locations of all basic blocks.
+     *
+     * \param cfg Control flow graph of the function.
+     */
+    void collectAccesses(const CFG &cfg);
+
+    /**
+     * Appends the accesses done by a statement: first the reads, then the writes.
+     *
+     * \param[in]  statement Valid pointer to a statement.
+     * \param[out] accesses  List of accesses.
+     */
+    void collectAccesses(const Statement *statement, std::vector<Access> &accesses);
+
+    /**
+     * Creates variables from the memory locations being written to.
+     */
+    void computeVariables();
+
+    /**
+     * \param memoryLocation Valid memory location.
+     *
+     * \return Range [first, last) of indices of the variables overlapping the memory location.
+     */
+    std::pair<std::size_t, std::size_t> getVariables(const MemoryLocation &memoryLocation) const;
+};
+
+} // namespace ssa
+} // namespace ir
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
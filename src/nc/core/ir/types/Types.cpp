@@ -24,6 +24,10 @@
 
 #include "Types.h"
 
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include <nc/common/Foreach.h>
 #include <nc/core/ir/Term.h>
 
 #include "Type.h"
@@ -49,9 +53,24 @@ Type *Types::getType(const Term *term) {
 }
 
 const Type *Types::getType(const Term *term) const {
+    {
+        QReadLocker locker(&lock_);
+        auto i = types_.find(term);
+        if (i != types_.end()) {
+            return i->second->findSet();
+        }
+    }
+
+    QWriteLocker locker(&lock_);
     return const_cast<Types *>(this)->getType(term);
 }
 
+void Types::compressPaths() const {
+    foreach (const auto &termAndType, types_) {
+        termAndType.second->findSet();
+    }
+}
+
 }}}} // namespace nc::core::ir::types
 
 /* vim:set et sts=4 sw=4: */
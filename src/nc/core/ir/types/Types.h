@@ -25,6 +25,8 @@
 
 #include <boost/unordered_map.hpp>
 
+#include <QReadWriteLock>
+
 namespace nc {
 namespace core {
 namespace ir {
@@ -40,6 +42,7 @@ class Type;
  */
 class Types {
     mutable boost::unordered_map<const Term *, std::unique_ptr<Type> > types_; ///< Mapping of terms to their type traits.
+    mutable QReadWriteLock lock_; ///< Lock guarding the mapping in const lookups.
 
     public:
 
@@ -64,9 +67,18 @@ class Types {
      * \param[in] term Term.
      *
      * \return Valid pointer to type traits for this term.
+     *
+     * This function can be called concurrently, provided that
+     * compressPaths() has been called after the last union of types.
      */
     const Type *getType(const Term *term) const;
 
+    /**
+     * Makes all the type traits point directly to the representatives
+     * of their sets, so that subsequent lookups do not modify them.
+     */
+    void compressPaths() const;
+
     /**
      * \return Mapping of terms to their type traits.
      */
@@ -39,7 +39,7 @@ namespace likec {
 class Declaration: public TreeNode {
     NC_BASE_CLASS(Declaration, declarationKind)
 
-    const QString identifier_;
+    QString identifier_;
 
 public:
 
@@ -69,6 +69,13 @@ public:
      * \return Name of declared entity.
      */
     const QString &identifier() const { return identifier_; }
+
+    /**
+     * Sets the name of declared entity.
+     *
+     * \param[in] identifier New name.
+     */
+    void setIdentifier(QString identifier) { identifier_ = std::move(identifier); }
 };
 
 } // namespace likec
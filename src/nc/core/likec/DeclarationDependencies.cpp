@@ -0,0 +1,159 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DeclarationDependencies.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include <boost/unordered_set.hpp>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/Range.h>
+
+#include "CompilationUnit.h"
+#include "FunctionDefinition.h"
+#include "FunctionIdentifier.h"
+#include "FunctionPointerType.h"
+#include "MemberDeclaration.h"
+#include "StructType.h"
+#include "StructTypeDeclaration.h"
+#include "Typecast.h"
+#include "Types.h"
+#include "VariableDeclaration.h"
+#include "VariableIdentifier.h"
+
+namespace nc {
+namespace core {
+namespace likec {
+
+namespace {
+
+class DependencyCollector {
+    const boost::unordered_map<const Declaration *, std::size_t> &positions_;
+    const Declaration *declaration_;
+    boost::unordered_set<const Declaration *> visited_;
+    std::vector<const TreeNode *> stack_;
+    std::vector<const Declaration *> result_;
+
+public:
+    DependencyCollector(const boost::unordered_map<const Declaration *, std::size_t> &positions,
+                        const Declaration *declaration):
+        positions_(positions), declaration_(declaration)
+    {}
+
+    std::vector<const Declaration *> collect() {
+        stack_.push_back(declaration_);
+
+        std::function<void(const TreeNode *)> push = [this](const TreeNode *node) {
+            stack_.push_back(node);
+        };
+
+        while (!stack_.empty()) {
+            auto node = stack_.back();
+            stack_.pop_back();
+
+            visit(node);
+            node->callOnChildren(push);
+        }
+
+        std::sort(result_.begin(), result_.end(), [this](const Declaration *a, const Declaration *b) {
+            return positions_.find(a)->second < positions_.find(b)->second;
+        });
+
+        return std::move(result_);
+    }
+
+private:
+    void visit(const TreeNode *node) {
+        if (auto declaration = node->as<Declaration>()) {
+            switch (declaration->declarationKind()) {
+                case Declaration::FUNCTION_DECLARATION:
+                    addType(declaration->as<FunctionDeclaration>()->type());
+                    break;
+                case Declaration::FUNCTION_DEFINITION:
+                    addType(declaration->as<FunctionDefinition>()->type());
+                    break;
+                case Declaration::MEMBER_DECLARATION:
+                    addType(declaration->as<MemberDeclaration>()->type());
+                    break;
+                case Declaration::STRUCT_TYPE_DECLARATION:
+                    foreach (auto member, declaration->as<StructTypeDeclaration>()->type()->members()) {
+                        addType(member->type());
+                    }
+                    break;
+                case Declaration::VARIABLE_DECLARATION:
+                    addType(declaration->as<VariableDeclaration>()->type());
+                    break;
+                default:
+                    break;
+            }
+        } else if (auto expression = node->as<Expression>()) {
+            if (auto identifier = expression->as<FunctionIdentifier>()) {
+                addDeclaration(identifier->declaration());
+            } else if (auto identifier = expression->as<VariableIdentifier>()) {
+                addDeclaration(identifier->declaration());
+            } else if (auto typecast = expression->as<Typecast>()) {
+                addType(typecast->type());
+            }
+        }
+    }
+
+    void addDeclaration(const Declaration *declaration) {
+        if (declaration == declaration_ || !nc::contains(positions_, declaration) || !visited_.insert(declaration).second) {
+            return;
+        }
+
+        result_.push_back(declaration);
+
+        if (auto definition = declaration->as<FunctionDefinition>()) {
+            /* The definition will be printed as a prototype. */
+            addType(definition->type());
+            foreach (const auto &argument, definition->arguments()) {
+                addType(argument->type());
+            }
+        } else {
+            stack_.push_back(declaration);
+        }
+    }
+
+    void addType(const Type *type) {
+        while (type != nullptr) {
+            if (auto functionPointerType = type->as<FunctionPointerType>()) {
+                foreach (auto argumentType, functionPointerType->argumentTypes()) {
+                    addType(argumentType);
+                }
+                type = functionPointerType->returnType();
+            } else if (auto structType = type->as<StructType>()) {
+                addDeclaration(structType->typeDeclaration());
+                break;
+            } else if (type->isPointer()) {
+                type = static_cast<const PointerType *>(type)->pointeeType();
+            } else {
+                break;
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+DeclarationDependencies::DeclarationDependencies(const CompilationUnit &compilationUnit) {
+    std::size_t position = 0;
+    foreach (auto declaration, compilationUnit.declarations()) {
+        positions_[declaration] = position++;
+    }
+}
+
+std::vector<const Declaration *> DeclarationDependencies::getDependencies(const Declaration *declaration) const {
+    assert(declaration != nullptr);
+
+    return DependencyCollector(positions_, declaration).collect();
+}
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
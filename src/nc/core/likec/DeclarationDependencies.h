@@ -0,0 +1,58 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+namespace nc {
+namespace core {
+namespace likec {
+
+class CompilationUnit;
+class Declaration;
+
+/**
+ * Finds the top-level declarations of a compilation unit which must
+ * precede a given top-level declaration when it is printed on its own,
+ * e.g. into a separate file.
+ *
+ * The dependencies of a declaration are the structural types, global
+ * variables, and functions it refers to, and, recursively, the
+ * dependencies of those. Only the signature of a function definition
+ * is considered when the definition is a dependency, so that it can be
+ * printed as a prototype.
+ *
+ * getDependencies() can be called concurrently.
+ */
+class DeclarationDependencies {
+    /** Positions of the top-level declarations in the compilation unit. */
+    boost::unordered_map<const Declaration *, std::size_t> positions_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param[in] compilationUnit Compilation unit.
+     */
+    explicit DeclarationDependencies(const CompilationUnit &compilationUnit);
+
+    /**
+     * \param[in] declaration Valid pointer to a top-level declaration.
+     *
+     * \return Dependencies of the declaration, excluding the declaration
+     *         itself, in the order of their appearance in the compilation unit.
+     */
+    std::vector<const Declaration *> getDependencies(const Declaration *declaration) const;
+};
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
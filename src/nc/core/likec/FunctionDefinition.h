@@ -28,6 +28,8 @@
 #include <vector>
 #include <memory> /* unique_ptr */
 
+#include <QString>
+
 #include "Block.h"
 #include "FunctionDeclaration.h"
 #include "LabelDeclaration.h"
@@ -42,6 +44,7 @@ namespace likec {
 class FunctionDefinition: public FunctionDeclaration {
     std::unique_ptr<Block> block_; ///< Block of the function.
     std::vector<std::unique_ptr<LabelDeclaration>> labels_; ///< Label declarations.
+    QString bodyText_; ///< Printed body of the function, used instead of the block if not empty.
 
 public:
     /**
@@ -79,6 +82,20 @@ public:
      */
     void addLabel(std::unique_ptr<LabelDeclaration> label) { labels_.push_back(std::move(label)); }
 
+    /**
+     * \return Printed body of the function, if it was taken from a cache
+     *         instead of being generated, or an empty string.
+     */
+    const QString &bodyText() const { return bodyText_; }
+
+    /**
+     * Sets the printed body of the function. If not empty, it is printed
+     * instead of the block, which is expected to be empty.
+     *
+     * \param text Printed body, starting with the opening brace.
+     */
+    void setBodyText(QString text) { bodyText_ = std::move(text); }
+
 protected:
     void doCallOnChildren(const std::function<void(TreeNode *)> &fun) override;
 };
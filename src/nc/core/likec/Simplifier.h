@@ -57,9 +57,18 @@ public:
      */
     std::unique_ptr<CompilationUnit> simplify(std::unique_ptr<CompilationUnit> node);
 
+    /**
+     * Simplifies a single function definition. Definitions of different
+     * functions can be simplified concurrently by different simplifiers.
+     *
+     * \param node Valid pointer to a function definition.
+     *
+     * \return Valid pointer to the simplified definition.
+     */
+    std::unique_ptr<FunctionDefinition> simplify(std::unique_ptr<FunctionDefinition> node);
+
 private:
     std::unique_ptr<Declaration> simplify(std::unique_ptr<Declaration> node);
-    std::unique_ptr<FunctionDefinition> simplify(std::unique_ptr<FunctionDefinition> node);
     std::unique_ptr<LabelDeclaration> simplify(std::unique_ptr<LabelDeclaration> node);
     std::unique_ptr<VariableDeclaration> simplify(std::unique_ptr<VariableDeclaration> node);
 
@@ -25,6 +25,7 @@
 #include "Tree.h"
 
 #include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
 
 #include "Simplifier.h"
 #include "TreePrinter.h"
@@ -34,8 +35,19 @@ namespace nc {
 namespace core {
 namespace likec {
 
+Tree::~Tree() {
+    if (root_) {
+        /* Declarations do not touch each other when destroyed. */
+        auto &declarations = root_->declarations();
+        parallelFor(declarations.size(), [&](std::size_t index) {
+            declarations[index].reset();
+        });
+    }
+}
+
 void Tree::rewriteRoot() {
     if (root_) {
+        Arena::Scope scope(&arena_);
         root_ = Simplifier(*this).simplify(std::move(root_));
     }
 }
@@ -44,60 +56,28 @@ void Tree::print(QTextStream &out, PrintCallback<const TreeNode *> *callback) co
     TreePrinter(out, callback).print(root());
 }
 
+void Tree::print(TextBuffer &out, std::vector<PrintedRange> *ranges) const {
+    TreePrinter(out, ranges).print(root());
+}
+
 const VoidType *Tree::makeVoidType() {
     return &voidType_;
 }
 
 const IntegerType *Tree::makeIntegerType(SmallBitSize size, bool isUnsigned) {
-    foreach (const auto &type, integerTypes_) {
-        if (type->size() == size && type->isUnsigned() == isUnsigned) {
-            return type.get();
-        }
-    }
-
-    IntegerType *type = new IntegerType(size, isUnsigned);
-    integerTypes_.push_back(std::unique_ptr<IntegerType>(type));
-
-    return type;
+    return typeTable_.makeIntegerType(size, isUnsigned);
 }
 
 const FloatType *Tree::makeFloatType(SmallBitSize size) {
-    foreach (const auto &type, floatTypes_) {
-        if (type->size() == size) {
-            return type.get();
-        }
-    }
-
-    FloatType *type = new FloatType(size);
-    floatTypes_.push_back(std::unique_ptr<FloatType>(type));
-
-    return type;
+    return typeTable_.makeFloatType(size);
 }
 
 const PointerType *Tree::makePointerType(SmallBitSize size, const Type *pointee) {
-    auto range = pointerTypes_.equal_range(pointee);
-    for (auto i = range.first; i != range.second; ++i) {
-        if (i->second->size() == size) {
-            return i->second.get();
-        }
-    }
-
-    PointerType *type = new PointerType(size, pointee);
-    pointerTypes_.insert(std::make_pair(pointee, std::unique_ptr<PointerType>(type)));
-    return type;
+    return typeTable_.makePointerType(size, pointee);
 }
 
 const ArrayType *Tree::makeArrayType(SmallBitSize size, const Type *elementType, std::size_t length) {
-    auto range = arrayTypes_.equal_range(elementType);
-    for (auto i = range.first; i != range.second; ++i) {
-        if (i->second->length() == length && i->second->size() == size) {
-            return i->second.get();
-        }
-    }
-
-    ArrayType *type = new ArrayType(size, elementType, length);
-    arrayTypes_.insert(std::make_pair(elementType, std::unique_ptr<ArrayType>(type)));
-    return type;
+    return typeTable_.makeArrayType(size, elementType, length);
 }
 
 const ErroneousType *Tree::makeErroneousType() {
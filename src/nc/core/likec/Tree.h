@@ -32,19 +32,32 @@
 
 #include <boost/noncopyable.hpp>
 
+#include <nc/common/Arena.h>
 #include <nc/common/PrintCallback.h>
 
 #include "CompilationUnit.h"
+#include "TypeTable.h"
 #include "Types.h"
 
 namespace nc {
+
+class TextBuffer;
+
 namespace core {
 namespace likec {
 
+struct PrintedRange;
+
 /**
  * Abstract syntax tree of high-level program in a C-like language.
+ *
+ * Functions creating types can be called concurrently.
+ *
+ * Nodes created within an Arena::Scope of the tree's arena are allocated
+ * in the arena and must not outlive the tree.
  */
 class Tree: boost::noncopyable {
+    Arena arena_; ///< Arena for the nodes of the tree. Goes first, so that it is destroyed last.
     std::unique_ptr<CompilationUnit> root_; ///< Tree root node.
 
     SmallBitSize intSize_; ///< Size of int in bits for target platform.
@@ -52,10 +65,7 @@ class Tree: boost::noncopyable {
     SmallBitSize ptrdiffSize_; ///< Size of ptrdiff_t in bits for target platform.
 
     const VoidType voidType_; ///< Void type.
-    std::vector<std::unique_ptr<IntegerType> > integerTypes_; ///< Integer types.
-    std::vector<std::unique_ptr<FloatType> > floatTypes_; ///< Float types.
-    std::multimap<const Type *, std::unique_ptr<PointerType> > pointerTypes_; ///< Pointers to other types.
-    std::multimap<const Type *, std::unique_ptr<ArrayType> > arrayTypes_; ///< Arrays of other types.
+    TypeTable typeTable_; ///< Interned integer, float, pointer, and array types.
     const ErroneousType erroneousType_; ///< Erroneous type.
 
 public:
@@ -64,6 +74,20 @@ public:
      */
     Tree(): intSize_(sizeof(int) * CHAR_BIT), pointerSize_(sizeof(void *) * CHAR_BIT), ptrdiffSize_(sizeof(ptrdiff_t) * CHAR_BIT) {}
 
+    /**
+     * Destructor.
+     *
+     * Top-level declarations are destroyed in parallel, as tearing down
+     * the tree of a large program takes noticeable time. Memory of the
+     * nodes allocated in the arena is freed at once afterwards.
+     */
+    ~Tree();
+
+    /**
+     * \return Arena for allocating the nodes of the tree.
+     */
+    Arena &arena() { return arena_; }
+
     /**
      * \return Size of int in bits for target platform.
      */
@@ -132,6 +156,14 @@ public:
      */
     void print(QTextStream &out, PrintCallback<const TreeNode *> *callback = 0) const;
 
+    /**
+     * Prints the whole tree into a text buffer.
+     *
+     * \param[in] out Output buffer.
+     * \param[out] ranges If not NULL, the ranges of printed nodes are appended here.
+     */
+    void print(TextBuffer &out, std::vector<PrintedRange> *ranges = nullptr) const;
+
     /**
      * \return Void type.
      */
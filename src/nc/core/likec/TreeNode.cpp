@@ -24,6 +24,10 @@
 
 #include "TreeNode.h"
 
+#include <new>
+
+#include <nc/common/Arena.h>
+
 #include "TreePrinter.h"
 
 namespace nc {
@@ -32,6 +36,19 @@ namespace likec {
 
 TreeNode::~TreeNode() {}
 
+void *TreeNode::operator new(std::size_t size) {
+    if (auto memory = Arena::allocate(size)) {
+        return memory;
+    }
+    return ::operator new(size);
+}
+
+void TreeNode::operator delete(void *pointer) {
+    if (!Arena::contains(pointer)) {
+        ::operator delete(pointer);
+    }
+}
+
 void TreeNode::print(QTextStream &out) const {
     TreePrinter(out, nullptr).print(this);
 }
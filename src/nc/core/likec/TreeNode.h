@@ -25,6 +25,7 @@
 
 #include <nc/config.h>
 
+#include <cstddef> /* std::size_t */
 #include <functional>
 
 #include <nc/common/Printable.h>
@@ -65,6 +66,24 @@ public:
      */
     virtual ~TreeNode();
 
+    /**
+     * Allocates memory for a node in the arena of the innermost Arena::Scope
+     * alive in the calling thread, or on the heap if there is no arena.
+     *
+     * \param size Size of the node.
+     *
+     * \return Valid pointer to the memory.
+     */
+    static void *operator new(std::size_t size);
+
+    /**
+     * Frees the memory of a node allocated on the heap.
+     * The memory of a node allocated in an arena is freed with the arena.
+     *
+     * \param pointer Pointer to the memory, can be nullptr.
+     */
+    static void operator delete(void *pointer);
+
     /**
      * Calls a given function on all the children of this node.
      *
@@ -34,6 +34,7 @@
 #include "String.h"
 #include "StructTypeDeclaration.h"
 #include "Switch.h"
+#include "Type.h"
 #include "Typecast.h"
 #include "UnaryOperator.h"
 #include "UndeclaredIdentifier.h"
@@ -167,19 +168,60 @@ int getPrecedence(const UnaryOperator *node) {
 } // anonymous namespace
 
 TreePrinter::TreePrinter(QTextStream &out, PrintCallback<const TreeNode *> *callback):
-    out_(out), callback_(callback), indentStep_(4), indent_(0)
+    ownedSink_(new TextStreamSink(out)), ownedBuffer_(new TextBuffer(*ownedSink_)), out_(*ownedBuffer_),
+    callback_(callback), ranges_(nullptr), currentRange_(-1), indentStep_(4), indent_(0)
 {}
 
+TreePrinter::TreePrinter(TextBuffer &out, std::vector<PrintedRange> *ranges):
+    out_(out), callback_(nullptr), ranges_(ranges), currentRange_(-1), indentStep_(4), indent_(0)
+{}
+
+TreePrinter::~TreePrinter() {}
+
 void TreePrinter::print(const TreeNode *node) {
+    printNode(node);
+
+    if (ownedBuffer_) {
+        ownedBuffer_->flush();
+    }
+}
+
+void TreePrinter::printPrototype(const FunctionDeclaration *node) {
+    assert(node);
+
+    printSignature(node);
+    out_ << ';';
+
+    if (ownedBuffer_) {
+        ownedBuffer_->flush();
+    }
+}
+
+void TreePrinter::printNode(const TreeNode *node) {
     assert(node);
 
     if (callback_) {
+        /* The callback may look at the size of the output. */
+        out_.flush();
         callback_->onStartPrinting(node);
     }
 
+    int parentRange = currentRange_;
+    if (ranges_) {
+        PrintedRange range = { node, out_.position(), -1, parentRange };
+        currentRange_ = static_cast<int>(ranges_->size());
+        ranges_->push_back(range);
+    }
+
     doPrint(node);
 
+    if (ranges_) {
+        (*ranges_)[currentRange_].end = out_.position();
+        currentRange_ = parentRange;
+    }
+
     if (callback_) {
+        out_.flush();
         callback_->onEndPrinting(node);
     }
 }
@@ -205,10 +247,10 @@ void TreePrinter::doPrint(const TreeNode *node) {
 
 void TreePrinter::doPrint(const CompilationUnit *node) {
     foreach (const auto &declaration, node->declarations()) {
-        out_ << endl;
+        out_ << '\n';
         printIndent();
-        print(declaration);
-        out_ << endl;
+        printNode(declaration);
+        out_ << '\n';
     }
 }
 
@@ -246,12 +288,16 @@ void TreePrinter::doPrint(const FunctionDefinition *node) {
     printComment(node);
     printSignature(node);
     out_ << ' ';
-    print(node->block());
+    if (node->bodyText().isEmpty()) {
+        printNode(node->block());
+    } else {
+        out_ << node->bodyText();
+    }
 }
 
 void TreePrinter::printSignature(const FunctionDeclaration *node) {
-    out_ << *node->type()->returnType() << ' ';
-    print(node->functionIdentifier());
+    out_ << typeString(node->type()->returnType()) << ' ';
+    printNode(node->functionIdentifier());
     out_ << '(';
 
     bool comma = false;
@@ -261,8 +307,8 @@ void TreePrinter::printSignature(const FunctionDeclaration *node) {
         } else {
             comma = true;
         }
-        out_ << *argument->type() << ' ';
-        print(argument->variableIdentifier());
+        out_ << typeString(argument->type()) << ' ';
+        printNode(argument->variableIdentifier());
     }
 
     if (node->type()->variadic()) {
@@ -276,16 +322,16 @@ void TreePrinter::printSignature(const FunctionDeclaration *node) {
 }
 
 void TreePrinter::doPrint(const MemberDeclaration *node) {
-    out_ << *node->type() << ' ' << node->identifier() << ';';
+    out_ << typeString(node->type()) << ' ' << node->identifier() << ';';
 }
 
 void TreePrinter::doPrint(const StructTypeDeclaration *node) {
-    out_ << "struct " << node->identifier() << " {" << endl;
+    out_ << "struct " << node->identifier() << " {\n";
     indentMore();
     foreach (const auto &member, node->type()->members()) {
         printIndent();
-        print(member);
-        out_ << endl;
+        printNode(member);
+        out_ << '\n';
     }
     indentLess();
     out_ << "};";
@@ -294,11 +340,11 @@ void TreePrinter::doPrint(const StructTypeDeclaration *node) {
 void TreePrinter::doPrint(const VariableDeclaration *node) {
     printComment(node);
 
-    out_ << *node->type() << ' ';
-    print(node->variableIdentifier());
+    out_ << typeString(node->type()) << ' ';
+    printNode(node->variableIdentifier());
     if (node->initialValue()) {
         out_ << " = ";
-        print(node->initialValue());
+        printNode(node->initialValue());
     }
     out_ << ';';
 }
@@ -355,14 +401,14 @@ void TreePrinter::doPrint(const BinaryOperator *node) {
     if (leftInBraces) {
         out_ << '(';
     }
-    print(node->left());
+    printNode(node->left());
     if (leftInBraces) {
         out_ << ')';
     }
 
     if (node->operatorKind() == BinaryOperator::ARRAY_SUBSCRIPT) {
         out_ << '[';
-        print(node->right());
+        printNode(node->right());
         out_ << ']';
         return;
     }
@@ -440,14 +486,14 @@ void TreePrinter::doPrint(const BinaryOperator *node) {
     if (rightInBraces) {
         out_ << '(';
     }
-    print(node->right());
+    printNode(node->right());
     if (rightInBraces) {
         out_ << ')';
     }
 }
 
 void TreePrinter::doPrint(const CallOperator *node) {
-    print(node->callee());
+    printNode(node->callee());
     out_ << '(';
     bool comma = false;
     foreach (const auto &argument, node->arguments()) {
@@ -456,7 +502,7 @@ void TreePrinter::doPrint(const CallOperator *node) {
         } else {
             comma = true;
         }
-        print(argument);
+        printNode(argument);
     }
     out_ << ')';
 }
@@ -469,9 +515,10 @@ void TreePrinter::doPrint(const IntegerConstant *node) {
     SignedConstantValue val = node->value().size() > 1 ? node->value().signedValue() : node->value().value();
 
     if ((0 <= val && val <= 100) || (-100 <= val && val < 0 && !node->type()->isUnsigned())) {
-        out_ << val;
+        out_.appendDecimal(val);
     } else {
-        out_ << hex << "0x" << node->value().value() << dec;
+        out_ << "0x";
+        out_.appendHex(node->value().value());
     }
 }
 
@@ -487,7 +534,7 @@ void TreePrinter::doPrint(const MemberAccessOperator *node) {
     if (braces) {
         out_ << "(";
     }
-    print(node->compound());
+    printNode(node->compound());
     if (braces) {
         out_ << ")";
     }
@@ -522,26 +569,26 @@ void TreePrinter::doPrint(const Typecast *node) {
 
             bool operandInBraces = absOperandPrecedence > absPrecedence;
 
-            out_ << '(' << *node->type() << ')';
+            out_ << '(' << typeString(node->type()) << ')';
 
             if (operandInBraces) {
                 out_ << '(';
             }
-            print(node->operand());
+            printNode(node->operand());
             if (operandInBraces) {
                 out_ << ')';
             }
             break;
         }
         case Typecast::STATIC_CAST: {
-            out_ << "static_cast<" << *node->type() << ">(";
-            print(node->operand());
+            out_ << "static_cast<" << typeString(node->type()) << ">(";
+            printNode(node->operand());
             out_ << ')';
             break;
         }
         case Typecast::REINTERPRET_CAST: {
-            out_ << "reinterpret_cast<" << *node->type() << ">(";
-            print(node->operand());
+            out_ << "reinterpret_cast<" << typeString(node->type()) << ">(";
+            printNode(node->operand());
             out_ << ')';
             break;
         }
@@ -600,7 +647,7 @@ void TreePrinter::doPrint(const UnaryOperator *node) {
     if (operandInBraces) {
         out_ << '(';
     }
-    print(node->operand());
+    printNode(node->operand());
     if (operandInBraces) {
         out_ << ')';
     }
@@ -664,17 +711,17 @@ void TreePrinter::doPrint(const Statement *node) {
 }
 
 void TreePrinter::doPrint(const Block *node) {
-    out_ << "{" << endl;
+    out_ << "{\n";
     indentMore();
 
     foreach (const auto &declaration, node->declarations()) {
         printIndent();
-        print(declaration);
-        out_ << endl;
+        printNode(declaration);
+        out_ << '\n';
     }
 
     if (!node->declarations().empty() && !node->statements().empty()) {
-        out_ << endl;
+        out_ << '\n';
     }
 
     foreach (const auto &statement, node->statements()) {
@@ -687,8 +734,8 @@ void TreePrinter::doPrint(const Block *node) {
         }
 
         printIndent();
-        print(statement);
-        out_ << endl;
+        printNode(statement);
+        out_ << '\n';
 
         if (isCaseLabel) {
             indentMore();
@@ -710,26 +757,26 @@ void TreePrinter::doPrint(const Continue *) {
 
 void TreePrinter::doPrint(const DoWhile *node) {
     out_ << "do ";
-    print(node->body());
+    printNode(node->body());
     out_ << " while (";
-    print(node->condition());
+    printNode(node->condition());
     out_ << ");";
 }
 
 void TreePrinter::doPrint(const ExpressionStatement *node) {
-    print(node->expression());
+    printNode(node->expression());
     out_ << ';';
 }
 
 void TreePrinter::doPrint(const Goto *node) {
     out_ << "goto ";
-    print(node->destination());
+    printNode(node->destination());
     out_ << ';';
 }
 
 void TreePrinter::doPrint(const If *node) {
     out_ << "if (";
-    print(node->condition());
+    printNode(node->condition());
     out_ << ") ";
     printNestedStatement(node->thenStatement());
     if (node->elseStatement()) {
@@ -739,14 +786,14 @@ void TreePrinter::doPrint(const If *node) {
 }
 
 void TreePrinter::doPrint(const LabelStatement *node) {
-    print(node->identifier());
+    printNode(node->identifier());
     out_ << ':';
 }
 
 void TreePrinter::doPrint(const Return *node) {
     if (node->returnValue()) {
         out_ << "return ";
-        print(node->returnValue());
+        printNode(node->returnValue());
         out_ << ";";
     } else {
         out_ << "return;";
@@ -755,7 +802,7 @@ void TreePrinter::doPrint(const Return *node) {
 
 void TreePrinter::doPrint(const While *node) {
     out_ << "while (";
-    print(node->condition());
+    printNode(node->condition());
     out_ << ") ";
     printNestedStatement(node->body());
 }
@@ -766,14 +813,14 @@ void TreePrinter::doPrint(const InlineAssembly *node) {
 
 void TreePrinter::doPrint(const Switch *node) {
     out_ << "switch (";
-    print(node->expression());
+    printNode(node->expression());
     out_ << ") ";
     printNestedStatement(node->body());
 }
 
 void TreePrinter::doPrint(const CaseLabel *node) {
     out_ << "case ";
-    print(node->expression());
+    printNode(node->expression());
     out_ << ":";
 }
 
@@ -783,12 +830,12 @@ void TreePrinter::doPrint(const DefaultLabel *) {
 
 void TreePrinter::printNestedStatement(const Statement *statement) {
     if (statement->is<Block>()) {
-        print(statement);
+        printNode(statement);
     } else {
-        out_ << endl;
+        out_ << '\n';
         indentMore();
         printIndent();
-        print(statement);
+        printNode(statement);
         indentLess();
     }
 }
@@ -801,15 +848,23 @@ void TreePrinter::printComment(const Commentable *node) {
     QStringList lines = node->comment().split('\n');
 
     if (lines.size() == 1) {
-        out_ << "/* " << lines.first() << " */" << endl;
+        out_ << "/* " << lines.first() << " */\n";
     } else {
-        out_ << "/*" << endl;
+        out_ << "/*\n";
         foreach (const QString &line, lines) {
             printIndent();
-            out_ << " * " << line << endl;
+            out_ << " * " << line << '\n';
         }
-        out_ << " */" << endl;
+        out_ << " */\n";
+    }
+}
+
+const QString &TreePrinter::typeString(const Type *type) {
+    auto &result = typeStrings_[type];
+    if (result.isNull()) {
+        result = type->toString();
     }
+    return result;
 }
 
 void TreePrinter::indentMore() {
@@ -822,7 +877,7 @@ void TreePrinter::indentLess() {
 }
 
 void TreePrinter::printIndent() {
-    out_ << QString(indent_, ' ');
+    out_.appendSpaces(indent_);
 }
 
 } // namespace likec
@@ -5,9 +5,15 @@
 
 #include <nc/config.h>
 
+#include <memory>
+#include <vector>
+
 #include <QTextStream>
 
+#include <boost/unordered_map.hpp>
+
 #include <nc/common/PrintCallback.h>
+#include <nc/common/TextBuffer.h>
 
 namespace nc {
 namespace core {
@@ -43,6 +49,7 @@ class String;
 class StructTypeDeclaration;
 class Switch;
 class TreeNode;
+class Type;
 class Typecast;
 class UnaryOperator;
 class UndeclaredIdentifier;
@@ -51,11 +58,26 @@ class VariableIdentifier;
 class While;
 
 /**
- * This class can print tree nodes into a stream.
+ * Range of text occupied by a printed tree node.
+ */
+struct PrintedRange {
+    const TreeNode *node; ///< The node.
+    int begin; ///< Position of the first character, in UTF-16 code units.
+    int end; ///< Position after the last character, in UTF-16 code units.
+    int parent; ///< Index of the range of the enclosing node, or -1.
+};
+
+/**
+ * This class can print tree nodes into a stream or a text buffer.
  */
 class TreePrinter {
-    QTextStream &out_; ///< Output stream.
+    std::unique_ptr<TextSink> ownedSink_; ///< Sink writing to the output stream, if any.
+    std::unique_ptr<TextBuffer> ownedBuffer_; ///< Buffer writing to the output stream, if any.
+    TextBuffer &out_; ///< Output buffer.
     PrintCallback<const TreeNode *> *callback_; ///< Print callback.
+    std::vector<PrintedRange> *ranges_; ///< Ranges of printed nodes.
+    int currentRange_; ///< Index of the range of the node being printed, or -1.
+    boost::unordered_map<const Type *, QString> typeStrings_; ///< Textual representations of printed types.
     int indentStep_; ///< Size of a single indentation step.
     int indent_; ///< Current indentation.
 
@@ -63,17 +85,39 @@ public:
     /**
      * \param out Output stream.
      * \param callback Pointer to the print callback. Can be NULL.
+     *
+     * \note When a callback is given, the output is flushed to the stream
+     *       before each call to it, which makes printing much slower.
+     *       Consider recording the ranges of nodes instead.
      */
     TreePrinter(QTextStream &out, PrintCallback<const TreeNode *> *callback);
 
     /**
-     * Prints the given node to the stream passed to the constructor.
+     * \param out Output buffer.
+     * \param ranges If not NULL, the ranges of printed nodes are appended
+     *               to this vector, in the order of starting printing them.
+     */
+    TreePrinter(TextBuffer &out, std::vector<PrintedRange> *ranges = nullptr);
+
+    ~TreePrinter();
+
+    /**
+     * Prints the given node to the stream or buffer passed to the constructor.
      *
      * \param node Valid pointer to a node.
      */
     void print(const TreeNode *node);
 
+    /**
+     * Prints a prototype of the given function, even if it is a definition.
+     *
+     * \param node Valid pointer to a function declaration or definition.
+     */
+    void printPrototype(const FunctionDeclaration *node);
+
 private:
+    void printNode(const TreeNode *node);
+
     void doPrint(const TreeNode *node);
 
     void doPrint(const CompilationUnit *node);
@@ -118,6 +162,8 @@ private:
     void printNestedStatement(const Statement *statement);
     void printComment(const Commentable *node);
 
+    const QString &typeString(const Type *type);
+
     void indentMore();
     void indentLess();
     void printIndent();
@@ -0,0 +1,129 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "TypeTable.h"
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <nc/common/CheckedCast.h>
+#include <nc/common/make_unique.h>
+
+#include "Types.h"
+
+namespace nc {
+namespace core {
+namespace likec {
+
+/**
+ * Properties identifying an interned type.
+ */
+class TypeTable::Key {
+public:
+    /** Kinds of interned types. */
+    enum Kind {
+        SIGNED_INTEGER,
+        UNSIGNED_INTEGER,
+        FLOAT,
+        POINTER,
+        ARRAY
+    };
+
+    Kind kind; ///< Kind of the type.
+    SmallBitSize size; ///< Size of the type.
+    const Type *base; ///< Pointee or element type, or nullptr.
+    std::size_t length; ///< Length of an array, or zero.
+
+    Key(Kind kind, SmallBitSize size, const Type *base = nullptr, std::size_t length = 0):
+        kind(kind), size(size), base(base), length(length)
+    {}
+
+    bool operator==(const Key &that) const {
+        return kind == that.kind && size == that.size && base == that.base && length == that.length;
+    }
+
+    friend std::size_t hash_value(const Key &key) {
+        std::size_t result = 0;
+        boost::hash_combine(result, static_cast<int>(key.kind));
+        boost::hash_combine(result, key.size);
+        boost::hash_combine(result, key.base);
+        boost::hash_combine(result, key.length);
+        return result;
+    }
+};
+
+/**
+ * Part of the table guarded by its own mutex.
+ */
+class TypeTable::Shard {
+public:
+    QMutex mutex; ///< Mutex guarding the types.
+    boost::unordered_map<Key, std::unique_ptr<Type>, boost::hash<Key>> types; ///< Interned types.
+};
+
+namespace {
+
+/** Number of shards. A power of two. */
+const std::size_t SHARD_COUNT = 16;
+
+} // anonymous namespace
+
+TypeTable::TypeTable() {
+    shards_.reserve(SHARD_COUNT);
+    for (std::size_t i = 0; i < SHARD_COUNT; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+TypeTable::~TypeTable() {}
+
+template<class T, class Create>
+const T *TypeTable::intern(const Key &key, Create create) {
+    std::size_t hash = hash_value(key);
+    Shard &shard = *shards_[hash & (SHARD_COUNT - 1)];
+
+    QMutexLocker locker(&shard.mutex);
+
+    auto &type = shard.types[key];
+    if (!type) {
+        type = create();
+    }
+    return checked_cast<const T *>(type.get());
+}
+
+const IntegerType *TypeTable::makeIntegerType(SmallBitSize size, bool isUnsigned) {
+    return intern<IntegerType>(Key(isUnsigned ? Key::UNSIGNED_INTEGER : Key::SIGNED_INTEGER, size), [&]() {
+        return std::make_unique<IntegerType>(size, isUnsigned);
+    });
+}
+
+const FloatType *TypeTable::makeFloatType(SmallBitSize size) {
+    return intern<FloatType>(Key(Key::FLOAT, size), [&]() {
+        return std::make_unique<FloatType>(size);
+    });
+}
+
+const PointerType *TypeTable::makePointerType(SmallBitSize size, const Type *pointee) {
+    assert(pointee != nullptr);
+
+    return intern<PointerType>(Key(Key::POINTER, size, pointee), [&]() {
+        return std::make_unique<PointerType>(size, pointee);
+    });
+}
+
+const ArrayType *TypeTable::makeArrayType(SmallBitSize size, const Type *elementType, std::size_t length) {
+    assert(elementType != nullptr);
+
+    return intern<ArrayType>(Key(Key::ARRAY, size, elementType, length), [&]() {
+        return std::make_unique<ArrayType>(size, elementType, length);
+    });
+}
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
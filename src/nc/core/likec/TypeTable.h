@@ -0,0 +1,101 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <cstddef> /* std::size_t */
+#include <memory>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <nc/common/Types.h>
+
+namespace nc {
+namespace core {
+namespace likec {
+
+class ArrayType;
+class FloatType;
+class IntegerType;
+class PointerType;
+class Type;
+
+/**
+ * Table of interned integer, floating-point, pointer, and array types:
+ * types with equal properties are represented by the same object.
+ *
+ * Types are kept in hash tables keyed by the kind, size, pointee or
+ * element type, and length of a type. The tables are split into shards,
+ * each guarded by its own mutex, so that the table can be used by
+ * several threads concurrently.
+ */
+class TypeTable: boost::noncopyable {
+    class Key;
+    class Shard;
+
+    std::vector<std::unique_ptr<Shard>> shards_; ///< Shards of the table.
+
+public:
+    /**
+     * Constructor.
+     */
+    TypeTable();
+
+    /**
+     * Destructor.
+     */
+    ~TypeTable();
+
+    /**
+     * \param[in] size Size.
+     * \param[in] isUnsigned Type must unsigned.
+     *
+     * \return Integer type of given size and signedness.
+     */
+    const IntegerType *makeIntegerType(SmallBitSize size, bool isUnsigned);
+
+    /**
+     * \param[in] size Size.
+     *
+     * \return Float type of given size.
+     */
+    const FloatType *makeFloatType(SmallBitSize size);
+
+    /**
+     * \param[in] size Size.
+     * \param[in] pointee Valid pointer to the pointee type.
+     *
+     * \return Pointer type of given size pointing to given type.
+     */
+    const PointerType *makePointerType(SmallBitSize size, const Type *pointee);
+
+    /**
+     * \param[in] size Type size.
+     * \param[in] elementType Valid pointer to the element type.
+     * \param[in] length Array length.
+     *
+     * \return Array type with required properties.
+     */
+    const ArrayType *makeArrayType(SmallBitSize size, const Type *elementType, std::size_t length);
+
+private:
+    /**
+     * Looks up a type in the table, creating it if necessary.
+     *
+     * \param[in] key Key of the type.
+     * \param[in] create Functor creating the type if it is not in the table.
+     *
+     * \return Valid pointer to the type.
+     */
+    template<class T, class Create>
+    const T *intern(const Key &key, Create create);
+};
+
+} // namespace likec
+} // namespace core
+} // namespace nc
+
+/* vim:set et sts=4 sw=4: */
@@ -24,9 +24,22 @@
 
 #include "CppSyntaxHighlighter.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include <QAbstractTextDocumentLayout>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+
+#ifdef NC_USE_THREADS
+#include <QThreadPool>
+#endif
+
 #include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+
+#include "Activity.h"
 
 namespace nc { namespace gui {
 
@@ -138,12 +151,10 @@ enum State {
 } // namespace `anonymous-namespace`
 
 
-CppSyntaxHighlighter::CppSyntaxHighlighter(QObject *parent, const CxxFormatting *formatting):
-    QSyntaxHighlighter(parent),
-    formatting_(formatting)
+CppLexer::CppLexer():
+    mPreviousState(0),
+    mCurrentState(0)
 {
-    assert(formatting);
-
     /* Init keywords. */
     foreach(const char *cppKeyword, cppKeywords)
         mKeywords.insert(cppKeyword);
@@ -159,11 +170,37 @@ CppSyntaxHighlighter::CppSyntaxHighlighter(QObject *parent, const CxxFormatting
     mSpecialRegexp  = QRegExp("//|\\\"|'|/\\*");
 }
 
-CppSyntaxHighlighter::~CppSyntaxHighlighter() {
-    return;
+int CppLexer::lex(const QString &text, int previousState, std::vector<CppToken> &tokens) {
+    mElements.assign(text.size(), -1);
+    mPreviousState = previousState;
+    mCurrentState = 0;
+
+    lexBlock(text);
+
+    /* Merge the characters of the same element into tokens. */
+    tokens.clear();
+    for (int start = 0, size = text.size(); start < size;) {
+        int end = start + 1;
+        while (end < size && mElements[end] == mElements[start]) {
+            ++end;
+        }
+        if (mElements[start] >= 0) {
+            CppToken token = { start, end - start, static_cast<CxxFormatting::Element>(mElements[start]) };
+            tokens.push_back(token);
+        }
+        start = end;
+    }
+
+    return mCurrentState;
+}
+
+void CppLexer::setFormat(int start, int count, CxxFormatting::Element element) {
+    for (int i = std::max(start, 0), end = std::min(start + count, static_cast<int>(mElements.size())); i < end; ++i) {
+        mElements[i] = element;
+    }
 }
 
-void CppSyntaxHighlighter::highlightBlock(const QString &text) {
+void CppLexer::lexBlock(const QString &text) {
     int startPos;
     int endPos;
     setCurrentBlockState(0);
@@ -187,7 +224,7 @@ void CppSyntaxHighlighter::highlightBlock(const QString &text) {
 
         QString cap = mSpecialRegexp.cap();
         if (cap == "//") {
-            setFormat(startPos, text.length() - startPos, formatting_->getFormat(CxxFormatting::SINGLE_LINE_COMMENT));
+            setFormat(startPos, text.length() - startPos, CxxFormatting::SINGLE_LINE_COMMENT);
             if (text.endsWith("\\"))
                 setCurrentBlockState(IN_SINGLELINE_COMMENT);
             return;
@@ -199,32 +236,32 @@ void CppSyntaxHighlighter::highlightBlock(const QString &text) {
                 --startPos;
 
             if (endPos == -1) {
-                setFormat(startPos, text.length() - startPos, formatting_->getFormat(CxxFormatting::STRING));
+                setFormat(startPos, text.length() - startPos, CxxFormatting::STRING);
                 processEscapeChar(text, startPos, text.length() - startPos);
                 setCurrentBlockState(cap.at(0) == QChar('"')? IN_STRING: IN_SINGLE_STRING);
                 return;
             } else {
                 endPos += 1;
-                setFormat(startPos, endPos - startPos, formatting_->getFormat(CxxFormatting::STRING));
+                setFormat(startPos, endPos - startPos, CxxFormatting::STRING);
                 processEscapeChar(text, startPos, endPos - startPos);
                 startPos = endPos;
             }
         } else if (cap == "/*") {
             endPos = findMultilineCommentEnd(text, startPos + 2);
             if (endPos == -1) {
-                setFormat(startPos, text.length() - startPos, formatting_->getFormat(CxxFormatting::MULTI_LINE_COMMENT));
+                setFormat(startPos, text.length() - startPos, CxxFormatting::MULTI_LINE_COMMENT);
                 setCurrentBlockState(IN_MULTILINE_COMMENT);
                 return;
             } else {
                 endPos += 2;
-                setFormat(startPos, endPos - startPos, formatting_->getFormat(CxxFormatting::MULTI_LINE_COMMENT));
+                setFormat(startPos, endPos - startPos, CxxFormatting::MULTI_LINE_COMMENT);
                 startPos = endPos;
             }
         }
     }
 }
 
-bool CppSyntaxHighlighter::processState(const QString &text, int *const startPos, int *const endPos) {
+bool CppLexer::processState(const QString &text, int *const startPos, int *const endPos) {
     int prevState = previousBlockState();
     *startPos = 0;
     *endPos = text.size();
@@ -235,32 +272,32 @@ bool CppSyntaxHighlighter::processState(const QString &text, int *const startPos
     if ((prevState & IN_STRING) || (prevState & IN_SINGLE_STRING)) {
         *endPos = findStringEnd(text, *startPos, (prevState & IN_SINGLE_STRING)? '\'':'"');
         if (*endPos == -1) {
-            setFormat(0, text.size(), formatting_->getFormat(CxxFormatting::STRING));
+            setFormat(0, text.size(), CxxFormatting::STRING);
             setCurrentBlockState(previousBlockState());
             return true;
         } else {
             *endPos += 1; // "
-            setFormat(0, *endPos - *startPos, formatting_->getFormat(CxxFormatting::STRING));
+            setFormat(0, *endPos - *startPos, CxxFormatting::STRING);
             *startPos = *endPos;
         }
     } else if (prevState & IN_MULTILINE_COMMENT) {
         *endPos = findMultilineCommentEnd(text, *startPos);
         if (*endPos == -1) {
-            setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::MULTI_LINE_COMMENT));
+            setFormat(0, text.length(), CxxFormatting::MULTI_LINE_COMMENT);
             setCurrentBlockState(previousBlockState());
             return true;
         } else {
             *endPos += 2; // */
-            setFormat(0, *endPos - *startPos, formatting_->getFormat(CxxFormatting::MULTI_LINE_COMMENT));
+            setFormat(0, *endPos - *startPos, CxxFormatting::MULTI_LINE_COMMENT);
             *startPos = *endPos;
         }
     } else if (prevState & IN_SINGLELINE_COMMENT) {
-        setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::SINGLE_LINE_COMMENT));
+        setFormat(0, text.length(), CxxFormatting::SINGLE_LINE_COMMENT);
         if (text.endsWith("\\"))
             setCurrentBlockState(IN_SINGLELINE_COMMENT);
         return true;
     } else if (prevState & IN_MACRO) {
-        setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::MACRO));
+        setFormat(0, text.length(), CxxFormatting::MACRO);
         if (text.endsWith("\\"))
             setCurrentBlockState(IN_MACRO);
         /* Think:
@@ -273,7 +310,7 @@ bool CppSyntaxHighlighter::processState(const QString &text, int *const startPos
     return false;
 }
 
-void CppSyntaxHighlighter::processRegexp(QRegExp &regexp, CxxFormatting::Element element, const QString &text, int startPos) {
+void CppLexer::processRegexp(QRegExp &regexp, CxxFormatting::Element element, const QString &text, int startPos) {
     int index = 0;
     int start = startPos;
 
@@ -287,19 +324,19 @@ void CppSyntaxHighlighter::processRegexp(QRegExp &regexp, CxxFormatting::Element
         start = index + length;
         QString cap = regexp.cap();
 
-        setFormat(index, length, formatting_->getFormat(element));
+        setFormat(index, length, element);
         if (element == CxxFormatting::TEXT && mKeywords.contains(cap))
-            setFormat(index, length, formatting_->getFormat(CxxFormatting::KEYWORD));
+            setFormat(index, length, CxxFormatting::KEYWORD);
     }
 }
 
-void CppSyntaxHighlighter::processRegexps(const QString &text, int startPos) {
+void CppLexer::processRegexps(const QString &text, int startPos) {
     processRegexp(mTextRegexp, CxxFormatting::TEXT, text, startPos);
     processRegexp(mOperatorRegexp, CxxFormatting::OPERATOR, text, startPos);
     processRegexp(mNumberRegexp, CxxFormatting::NUMBER, text, startPos);
 }
 
-void CppSyntaxHighlighter::processEscapeChar(const QString &text, int start, int len) {
+void CppLexer::processEscapeChar(const QString &text, int start, int len) {
     for (int pos = start; pos < start + len; pos++) {
         if (text.at(pos) == QChar('\\')) {
             int endPos = pos;
@@ -324,15 +361,15 @@ void CppSyntaxHighlighter::processEscapeChar(const QString &text, int start, int
                     --endPos;
                 }
             }
-            setFormat(pos, endPos - pos + 1, formatting_->getFormat(CxxFormatting::ESCAPE_CHAR));
+            setFormat(pos, endPos - pos + 1, CxxFormatting::ESCAPE_CHAR);
             pos = endPos;
         }
     }
 }
         
-bool CppSyntaxHighlighter::processPreprocessor(const QString &text) {
+bool CppLexer::processPreprocessor(const QString &text) {
     if (text.indexOf(mMultilineMacroRegexp) != -1) {
-        setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::MACRO));
+        setFormat(0, text.length(), CxxFormatting::MACRO);
         /* TODO: This can't handle the following code:
          *  #define some this is / *
          *    blabla... * / a macro definition... */
@@ -340,18 +377,18 @@ bool CppSyntaxHighlighter::processPreprocessor(const QString &text) {
             setCurrentBlockState(IN_MACRO);
     } else if (text.indexOf(mIncludeRegexp) != -1) {
         /* TODO: we can highlight it in a different format */
-        setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::MACRO));
+        setFormat(0, text.length(), CxxFormatting::MACRO);
         int pos = mIncludeRegexp.pos(1);
         if (pos > 0)
-            setFormat(pos, mIncludeRegexp.cap(1).size(), formatting_->getFormat(CxxFormatting::STRING));
+            setFormat(pos, mIncludeRegexp.cap(1).size(), CxxFormatting::STRING);
     } else if (text.indexOf(mMacroRegexp) != -1) {
-        setFormat(0, text.length(), formatting_->getFormat(CxxFormatting::MACRO));
+        setFormat(0, text.length(), CxxFormatting::MACRO);
         return false;
     }
     return true;
 }
 
-int CppSyntaxHighlighter::findStringEnd(const QString &text, int startPos, QChar strChar) {
+int CppLexer::findStringEnd(const QString &text, int startPos, QChar strChar) {
     for (int pos = startPos; pos < text.length(); pos++) {
         if (text.at(pos) == QChar('\\'))
             pos++;
@@ -361,10 +398,321 @@ int CppSyntaxHighlighter::findStringEnd(const QString &text, int startPos, QChar
     return -1;
 }
 
-int CppSyntaxHighlighter::findMultilineCommentEnd(const QString &text, int startPos) {
+int CppLexer::findMultilineCommentEnd(const QString &text, int startPos) {
     return text.indexOf("*/", startPos);
 }
 
+namespace {
+
+/**
+ * Maximal number of blocks lexed by a single background activity.
+ */
+const std::size_t maxLexedBlockCount = 1024;
+
+/**
+ * Tokens of a block, cached in its user data.
+ */
+class BlockTokens: public QTextBlockUserData {
+public:
+    /** Tokens of the block. */
+    std::vector<CppToken> tokens;
+
+    /** State before the block, which the tokens have been computed for. */
+    int previousState;
+
+    /** State after the block. */
+    int state;
+
+    /** Revision of the formats last applied to the block, or -1. */
+    int formatsRevision;
+
+    BlockTokens(): previousState(-1), state(0), formatsRevision(-1) {}
+};
+
+inline BlockTokens *getTokens(const QTextBlock &block) {
+    return static_cast<BlockTokens *>(block.userData());
+}
+
+} // namespace `anonymous-namespace`
+
+/**
+ * Blocks lexed in background.
+ */
+class LexedBlocks {
+public:
+    /** Revision of the text of the document when the blocks were taken. */
+    int textRevision;
+
+    /** Number of the first block. */
+    int firstBlockNumber;
+
+    /** State before the first block. */
+    int previousState;
+
+    /** Texts of the blocks. */
+    std::vector<QString> texts;
+
+    /** Tokens of the blocks. */
+    std::vector<std::vector<CppToken>> tokens;
+
+    /** States after the blocks. */
+    std::vector<int> states;
+};
+
+namespace {
+
+/**
+ * Activity lexing blocks of text.
+ */
+class LexBlocks: public Activity {
+    CppLexer lexer_;
+    std::shared_ptr<LexedBlocks> blocks_;
+
+public:
+    LexBlocks(const CppLexer &lexer, std::shared_ptr<LexedBlocks> blocks):
+        lexer_(lexer), blocks_(std::move(blocks))
+    {}
+
+protected:
+    void work() override {
+        auto size = blocks_->texts.size();
+
+        blocks_->tokens.resize(size);
+        blocks_->states.resize(size);
+
+        int state = blocks_->previousState;
+        for (std::size_t i = 0; i < size; ++i) {
+            state = blocks_->states[i] = lexer_.lex(blocks_->texts[i], state, blocks_->tokens[i]);
+        }
+    }
+};
+
+} // namespace `anonymous-namespace`
+
+CppSyntaxHighlighter::CppSyntaxHighlighter(QObject *parent, const CxxFormatting *formatting):
+    QObject(parent),
+    formatting_(formatting),
+    textRevision_(0),
+    blockCount_(0),
+    provisionalBlockNumber_(-1),
+    formatsRevision_(0)
+{
+    assert(formatting);
+}
+
+CppSyntaxHighlighter::~CppSyntaxHighlighter() {}
+
+void CppSyntaxHighlighter::setDocument(QTextDocument *document) {
+    if (document_) {
+        disconnect(document_, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
+    }
+
+    document_ = document;
+    visibleRange_ = Range<int>();
+    ++textRevision_;
+    blockCount_ = document_ ? document_->blockCount() : 0;
+    provisionalBlockNumber_ = -1;
+
+    if (document_) {
+        connect(document_, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
+    }
+}
+
+void CppSyntaxHighlighter::setVisibleRange(const Range<int> &range) {
+    visibleRange_ = range;
+    highlightVisibleBlocks();
+}
+
+void CppSyntaxHighlighter::rehighlight() {
+    ++formatsRevision_;
+    highlightVisibleBlocks();
+}
+
+void CppSyntaxHighlighter::onContentsChange(int position, int charsRemoved, int charsAdded) {
+    Q_UNUSED(charsRemoved)
+
+    /* Results of lexing the old text are useless now. */
+    ++textRevision_;
+
+    auto block = document_->findBlock(position);
+    auto lastBlock = document_->findBlock(position + charsAdded);
+
+    /* Blocks following the changed ones have been renumbered. */
+    if (provisionalBlockNumber_ > block.blockNumber()) {
+        provisionalBlockNumber_ = std::max(provisionalBlockNumber_ + document_->blockCount() - blockCount_, block.blockNumber());
+    }
+    blockCount_ = document_->blockCount();
+
+    while (block.isValid()) {
+        block.setUserData(nullptr);
+        if (block == lastBlock) {
+            break;
+        }
+        block = block.next();
+    }
+}
+
+void CppSyntaxHighlighter::highlightVisibleBlocks() {
+    if (!document_ || !visibleRange_) {
+        return;
+    }
+
+    auto block = document_->findBlock(visibleRange_.start());
+    auto lastBlock = document_->findBlock(visibleRange_.end() - 1);
+    if (!lastBlock.isValid()) {
+        lastBlock = document_->lastBlock();
+    }
+
+    while (block.isValid()) {
+        auto tokens = getTokens(block);
+        if (!tokens) {
+            startLexing(block, lastBlock);
+        } else if (tokens->formatsRevision != formatsRevision_) {
+            applyFormats(block);
+        }
+
+        if (block == lastBlock) {
+            break;
+        }
+        block = block.next();
+    }
+}
+
+void CppSyntaxHighlighter::startLexing(const QTextBlock &firstBlock, const QTextBlock &lastBlock) {
+    if (lexing_) {
+        /* The blocks will be lexed when the running activity finishes. */
+        return;
+    }
+
+    /* The state before a block is known only when the previous block is lexed. */
+    auto startBlock = firstBlock;
+    for (std::size_t i = 1; i < maxLexedBlockCount && startBlock.previous().isValid() && !getTokens(startBlock.previous()); ++i) {
+        startBlock = startBlock.previous();
+    }
+
+    auto blocks = std::make_shared<LexedBlocks>();
+    blocks->textRevision = textRevision_;
+    blocks->firstBlockNumber = startBlock.blockNumber();
+    blocks->previousState = -1;
+
+    if (startBlock.previous().isValid()) {
+        if (auto previousTokens = getTokens(startBlock.previous())) {
+            blocks->previousState = previousTokens->state;
+        } else {
+            /*
+             * The state is too far to look for: assume the initial one.
+             * If the assumption is wrong, the blocks will be lexed again
+             * when the blocks before them are lexed.
+             */
+            blocks->previousState = 0;
+            if (provisionalBlockNumber_ == -1 || provisionalBlockNumber_ > blocks->firstBlockNumber) {
+                provisionalBlockNumber_ = blocks->firstBlockNumber;
+            }
+        }
+    }
+
+    for (auto block = startBlock; block.isValid(); block = block.next()) {
+        blocks->texts.push_back(block.text());
+        if (block == lastBlock || blocks->texts.size() == maxLexedBlockCount) {
+            break;
+        }
+    }
+
+    lexing_ = blocks;
+
+    auto activity = std::make_unique<LexBlocks>(lexer_, std::move(blocks));
+    connect(activity.get(), SIGNAL(finished()), this, SLOT(onBlocksLexed()), Qt::QueuedConnection);
+
+#ifdef NC_USE_THREADS
+    activity->setAutoDelete(true);
+    QThreadPool::globalInstance()->start(activity.release());
+#else
+    activity->run();
+#endif
+}
+
+void CppSyntaxHighlighter::onBlocksLexed() {
+    auto blocks = std::move(lexing_);
+
+    if (!blocks || !document_ || blocks->textRevision != textRevision_) {
+        highlightVisibleBlocks();
+        return;
+    }
+
+    auto block = document_->findBlockByNumber(blocks->firstBlockNumber);
+    for (std::size_t i = 0; i < blocks->texts.size() && block.isValid(); ++i, block = block.next()) {
+        auto tokens = new BlockTokens();
+        tokens->tokens.swap(blocks->tokens[i]);
+        tokens->previousState = i == 0 ? blocks->previousState : blocks->states[i - 1];
+        tokens->state = blocks->states[i];
+        block.setUserData(tokens);
+    }
+
+    /* Tokens of the next block are stale if they were computed for another state: lex it and the following ones again. */
+    if (block.isValid() && !blocks->states.empty()) {
+        if (auto tokens = getTokens(block)) {
+            if (tokens->previousState != blocks->states.back()) {
+                block.setUserData(nullptr);
+                startLexing(block, document_->lastBlock());
+            }
+        }
+    }
+
+    highlightVisibleBlocks();
+
+    if (!lexing_) {
+        startLexingProvisionalBlocks();
+    }
+}
+
+void CppSyntaxHighlighter::startLexingProvisionalBlocks() {
+    if (provisionalBlockNumber_ == -1) {
+        return;
+    }
+
+    /*
+     * Lex the blocks up to the first provisionally lexed one. If the state
+     * after them differs from the assumed one, onBlocksLexed() will lex the
+     * provisionally lexed blocks again.
+     */
+    auto block = document_->findBlockByNumber(provisionalBlockNumber_);
+    provisionalBlockNumber_ = -1;
+
+    if (block.isValid()) {
+        startLexing(block, block);
+    }
+}
+
+void CppSyntaxHighlighter::applyFormats(QTextBlock &block) {
+    auto tokens = getTokens(block);
+    assert(tokens != nullptr);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    QVector<QTextLayout::FormatRange> ranges;
+#else
+    QList<QTextLayout::FormatRange> ranges;
+#endif
+
+    foreach (const auto &token, tokens->tokens) {
+        QTextLayout::FormatRange range;
+        range.start = token.start;
+        range.length = token.length;
+        range.format = formatting_->getFormat(token.element);
+        ranges.push_back(range);
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    block.layout()->setFormats(ranges);
+#else
+    block.layout()->setAdditionalFormats(ranges);
+#endif
+
+    /* Makes the layout redraw the block. */
+    document_->markContentsDirty(block.position(), block.length());
+
+    tokens->formatsRevision = formatsRevision_;
+}
+
 }} // namespace nc::gui
 
 /* vim:set et sts=4 sw=4: */
@@ -25,13 +25,22 @@
 
 #include <nc/config.h>
 
+#include <memory> /* std::shared_ptr */
+#include <vector>
+
 #include <boost/array.hpp>
 
-#include <QSyntaxHighlighter>
+#include <QObject>
+#include <QPointer>
+#include <QRegExp>
 #include <QSet>
+#include <QTextCharFormat>
 #include <QWidget>
 
+#include <nc/common/RangeClass.h>
+
 QT_BEGIN_NAMESPACE
+class QTextBlock;
 class QTextDocument;
 QT_END_NAMESPACE
 
@@ -119,28 +128,40 @@ private:
 };
 
 /**
- * Syntax highlighter for C++.
+ * Span of text occupied by a single C++ text element.
  */
-class CppSyntaxHighlighter: public QSyntaxHighlighter {
-    Q_OBJECT
+struct CppToken {
+    int start; ///< Position of the first character in the block.
+    int length; ///< Number of characters.
+    CxxFormatting::Element element; ///< Text element.
+};
+
+/**
+ * Lexer splitting blocks (lines) of C++ code into tokens.
+ *
+ * The lexer is reentrant: different copies of it can be used in different threads.
+ */
+class CppLexer {
 public:
     /**
      * Constructor.
-     * 
-     * \param[in] parent Pointer to the parent object. Can be nullptr.
-     * \param[in] formatting Valid pointer to the formatting information.
      */
-    explicit CppSyntaxHighlighter(QObject *parent, const CxxFormatting *formatting);
+    CppLexer();
 
     /**
-     * Virtual destructor.
+     * Splits a block of text into tokens.
+     *
+     * \param[in] text Text of the block.
+     * \param[in] previousState State returned for the previous block, or -1 if there is no previous block.
+     * \param[out] tokens Tokens of the block, in the order of their positions.
+     *
+     * \return State after the end of the block.
      */
-    virtual ~CppSyntaxHighlighter();
-
-protected:
-    virtual void highlightBlock(const QString &text) override;
+    int lex(const QString &text, int previousState, std::vector<CppToken> &tokens);
 
 private:
+    void lexBlock(const QString &text);
+
     bool processState(const QString &text, int *startPos, int *endPos);
 
     void processRegexp(QRegExp &regexp, CxxFormatting::Element element, const QString &text, int startPos = 0);
@@ -155,6 +176,12 @@ private:
 
     int findMultilineCommentEnd(const QString &text, int startPos = 0);
 
+    void setFormat(int start, int count, CxxFormatting::Element element);
+
+    int previousBlockState() const { return mPreviousState; }
+
+    void setCurrentBlockState(int state) { mCurrentState = state; }
+
     /** Keywords. */ 
     QSet<QString> mKeywords;
 
@@ -167,7 +194,115 @@ private:
     QRegExp mOperatorRegexp;
     QRegExp mTextRegexp;
 
+    /** Elements of the characters of the block being lexed, -1 for characters not in any token. */
+    std::vector<int> mElements;
+
+    /** State after the previous block. */
+    int mPreviousState;
+
+    /** State after the block being lexed. */
+    int mCurrentState;
+};
+
+class LexedBlocks;
+
+/**
+ * Syntax highlighter for C++.
+ *
+ * Unlike QSyntaxHighlighter, which highlights the whole document at once,
+ * this highlighter formats only the blocks in the visible range of text.
+ * The blocks are lexed in background, and their tokens are cached in the
+ * user data of the blocks until the blocks are changed.
+ *
+ * Lexing starts from the nearest lexed block before the requested ones.
+ * If there is none within a bounded distance, the blocks are lexed
+ * provisionally, assuming the initial state, and the blocks before them
+ * are lexed afterwards. When the state after a block turns out to differ
+ * from the one the next block was lexed for, the following blocks are
+ * lexed again.
+ */
+class CppSyntaxHighlighter: public QObject {
+    Q_OBJECT
+
+    /** Formatting information. */
     const CxxFormatting *formatting_;
+
+    /** Lexer, copies of which lex the blocks in background. */
+    CppLexer lexer_;
+
+    /** Document being highlighted. */
+    QPointer<QTextDocument> document_;
+
+    /** Range of text visible to the user. */
+    Range<int> visibleRange_;
+
+    /** Number incremented each time the text of the document changes. */
+    int textRevision_;
+
+    /** Number of blocks in the document after its last change. */
+    int blockCount_;
+
+    /**
+     * Number of the first block lexed assuming the initial state before it,
+     * because the state was not known, or -1. Blocks before it are lexed from
+     * known states.
+     */
+    int provisionalBlockNumber_;
+
+    /** Number incremented each time the formats must be reapplied. */
+    int formatsRevision_;
+
+    /** Blocks being lexed in background, if any. */
+    std::shared_ptr<LexedBlocks> lexing_;
+
+public:
+    /**
+     * Constructor.
+     * 
+     * \param[in] parent Pointer to the parent object. Can be nullptr.
+     * \param[in] formatting Valid pointer to the formatting information.
+     */
+    explicit CppSyntaxHighlighter(QObject *parent, const CxxFormatting *formatting);
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~CppSyntaxHighlighter();
+
+    /**
+     * \return Pointer to the document being highlighted. Can be nullptr.
+     */
+    QTextDocument *document() const { return document_; }
+
+    /**
+     * Sets the document to highlight.
+     *
+     * \param document Pointer to the document. Can be nullptr.
+     */
+    void setDocument(QTextDocument *document);
+
+    /**
+     * Sets the range of text visible to the user and highlights the blocks in it.
+     *
+     * \param range Range of positions in the document.
+     */
+    void setVisibleRange(const Range<int> &range);
+
+public Q_SLOTS:
+    /**
+     * Reapplies the formats to the visible blocks, e.g. after the formatting information has changed.
+     */
+    void rehighlight();
+
+private Q_SLOTS:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onBlocksLexed();
+
+private:
+    void highlightVisibleBlocks();
+    void startLexing(const QTextBlock &firstBlock, const QTextBlock &lastBlock);
+    void startLexingProvisionalBlocks();
+    void applyFormats(QTextBlock &block);
 };
 
 }} // namespace nc::gui
@@ -25,10 +25,15 @@
 #include "CxxDocument.h"
 
 #include <QPlainTextDocumentLayout>
-#include <QTextStream>
+
+#include <nc/common/ParallelFor.h>
+#include <nc/common/TextBuffer.h>
+#include <nc/common/make_unique.h>
 
 #include <nc/core/Context.h>
 
+#include <nc/core/arch/Instructions.h>
+
 #include <nc/core/ir/Statement.h>
 #include <nc/core/ir/Term.h>
 
@@ -41,53 +46,122 @@
 #include <nc/core/likec/LabelStatement.h>
 #include <nc/core/likec/Statement.h>
 #include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
 #include <nc/core/likec/VariableDeclaration.h>
 #include <nc/core/likec/VariableIdentifier.h>
 
+#include "DeclarationStream.h"
 #include "RangeTreeBuilder.h"
 
 namespace nc { namespace gui {
 
 namespace {
 
-QString printTree(const core::likec::Tree &tree, RangeTree &rangeTree) {
-    class Callback: public PrintCallback<const core::likec::TreeNode *> {
-        RangeTreeBuilder builder_;
-        const QString &out_;
-
-    public:
-        Callback(RangeTree &tree, const QString &out) : builder_(tree), out_(out) {}
+/**
+ * Passes the given ranges to a builder.
+ *
+ * \param ranges Ranges of printed nodes, recorded in preorder, each one referring to the enclosing one.
+ * \param shift Value to add to the positions in the ranges.
+ * \param builder Range tree builder.
+ * \param first Index of the first range to pass. Ranges of the nodes enclosing it are not passed.
+ */
+void buildRangeTree(const std::vector<core::likec::PrintedRange> &ranges, int shift, RangeTreeBuilder &builder, int first = 0) {
+    std::vector<int> stack;
+
+    auto pop = [&]() {
+        const auto &range = ranges[stack.back()];
+        builder.onEnd((void *)(range.node), range.end + shift);
+        stack.pop_back();
+    };
 
-        void onStartPrinting(const core::likec::TreeNode *node) override {
-            builder_.onStart((void *)(node), out_.size());
+    for (int i = first, size = static_cast<int>(ranges.size()); i < size; ++i) {
+        while (!stack.empty() && stack.back() != ranges[i].parent) {
+            pop();
         }
-        void onEndPrinting(const core::likec::TreeNode *node) override {
-            builder_.onEnd((void *)(node), out_.size());
-        }
-    };
+        builder.onStart((void *)(ranges[i].node), ranges[i].begin + shift);
+        stack.push_back(i);
+    }
+    while (!stack.empty()) {
+        pop();
+    }
+}
 
-    QString result;
-    QTextStream stream(&result);
-    Callback callback(rangeTree, result);
+QString printTree(const core::likec::Tree &tree, RangeTree &rangeTree) {
+    MemoryTextSink sink;
+    std::vector<core::likec::PrintedRange> ranges;
 
-    tree.print(stream, &callback);
+    {
+        TextBuffer buffer(sink);
+        tree.print(buffer, &ranges);
+    }
 
-    return result;
+    RangeTreeBuilder builder(rangeTree);
+    buildRangeTree(ranges, 0, builder);
+
+    return QString::fromUtf8(sink.data());
 }
 
 inline const core::likec::TreeNode *getNode(const RangeNode *rangeNode) {
     return (const core::likec::TreeNode *)rangeNode->data();
 }
 
+inline const core::likec::FunctionDefinition *getDefinition(const RangeNode *rangeNode) {
+    if (auto declaration = getNode(rangeNode)->as<core::likec::Declaration>()) {
+        return declaration->as<core::likec::FunctionDefinition>();
+    }
+    return nullptr;
+}
+
+/**
+ * Number of decompiled instructions starting from which the bodies of
+ * functions are printed only when the functions are shown.
+ */
+const std::size_t lazyInstructionCount = 100000;
+
+/**
+ * Maps the instructions from which the nodes in the given subtree have
+ * originated, and the declarations used in the subtree, to the given
+ * function definition.
+ */
+void mapInstructionsAndUses(const core::likec::TreeNode *node, const core::likec::FunctionDefinition *definition,
+    boost::unordered_map<const core::arch::Instruction *, const core::likec::FunctionDefinition *> &instruction2definition,
+    boost::unordered_map<const core::likec::Declaration *, std::vector<const core::likec::FunctionDefinition *>> &declaration2definitions)
+{
+    const core::ir::Statement *statement;
+    const core::ir::Term *term;
+    const core::arch::Instruction *instruction;
+
+    CxxDocument::getOrigin(node, statement, term, instruction);
+
+    if (instruction) {
+        instruction2definition[instruction] = definition;
+    }
+
+    if (auto declaration = CxxDocument::getDeclarationOfIdentifier(node)) {
+        auto &definitions = declaration2definitions[declaration];
+        if (definitions.empty() || definitions.back() != definition) {
+            definitions.push_back(definition);
+        }
+    }
+
+    node->callOnChildren([&](const core::likec::TreeNode *child) {
+        mapInstructionsAndUses(child, definition, instruction2definition, declaration2definitions);
+    });
+}
+
 } // anonymous namespace
 
-CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context):
+CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context, bool lazy):
     QTextDocument(parent), context_(std::move(context))
 {
     setDocumentLayout(new QPlainTextDocumentLayout(this));
 
     if (context_ && context_->tree()) {
-        setPlainText(printTree(*context_->tree(), rangeTree_));
+        if (lazy) {
+            setPlainText(printFragments(*context_->tree()));
+        } else {
+            setPlainText(printTree(*context_->tree(), rangeTree_));
+        }
         if (rangeTree_.root()) {
             computeReverseMappings(rangeTree_.root());
         }
@@ -96,6 +170,265 @@ CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> c
     connect(this, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
 }
 
+CxxDocument::CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context,
+                         std::shared_ptr<DeclarationStream> stream):
+    CxxDocument(parent, std::move(context))
+{
+    assert(stream != nullptr);
+
+    stream_ = std::move(stream);
+    connect(stream_.get(), SIGNAL(readyRead()), this, SLOT(readStream()));
+
+    /* Some declarations could have been printed before the connection was made. */
+    readStream();
+}
+
+void CxxDocument::readStream() {
+    if (!stream_) {
+        return;
+    }
+
+    QString text;
+    std::vector<core::likec::PrintedRange> ranges;
+    stream_->take(text, ranges);
+
+    if (!text.isEmpty()) {
+        appendDeclarations(text, ranges);
+    }
+}
+
+void CxxDocument::appendDeclarations(const QString &text, const std::vector<core::likec::PrintedRange> &ranges) {
+    /* The document always ends with a paragraph separator that is not a part of the text. */
+    int position = characterCount() - 1;
+
+    /*
+     * Insertion at the end of the text is outside the root range,
+     * so the range tree is not changed by onContentsChange().
+     */
+    QTextCursor cursor(this);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    if (!rangeTree_.root()) {
+        /* The compilation unit is not known until the tree is complete. */
+        auto root = std::make_unique<RangeNode>(nullptr, 0);
+        root->setSize(0);
+        rangeTree_.setRoot(std::move(root));
+    }
+
+    RangeNode *root = rangeTree_.root();
+    const RangeNode *oldChildren = root->children().data();
+    std::size_t firstNewChild = root->children().size();
+
+    {
+        RangeTreeBuilder builder(rangeTree_, root, 0);
+        buildRangeTree(ranges, position, builder);
+    }
+
+    root->setSize(position + text.size());
+
+    auto &children = root->children();
+
+    if (children.data() != oldChildren) {
+        /*
+         * Children of the root have moved. The range tree has fixed the parent
+         * pointers referring to them, but the mappings from nodes must be fixed here.
+         */
+        for (std::size_t i = 0; i < firstNewChild; ++i) {
+            node2rangeNode_[getNode(&children[i])] = &children[i];
+        }
+    }
+
+    for (std::size_t i = firstNewChild; i < children.size(); ++i) {
+        computeReverseMappings(&children[i]);
+
+        /* A lazy stream prints the definitions of functions as placeholders. */
+        if (stream_->isLazy()) {
+            if (auto definition = getDefinition(&children[i])) {
+                addPendingDefinition(definition);
+            }
+        }
+    }
+}
+
+QString CxxDocument::printFragments(const core::likec::Tree &tree) {
+    MemoryTextSink sink;
+    std::vector<core::likec::PrintedRange> ranges;
+
+    {
+        TextBuffer buffer(sink);
+        core::likec::TreePrinter printer(buffer, &ranges);
+
+        /* Same layout as the one of a printed compilation unit. */
+        foreach (auto declaration, tree.root()->declarations()) {
+            buffer << '\n';
+            if (auto definition = declaration->as<core::likec::FunctionDefinition>()) {
+                printPlaceholder(definition, buffer, ranges);
+                addPendingDefinition(definition);
+            } else {
+                printer.print(declaration);
+            }
+            buffer << '\n';
+        }
+    }
+
+    auto root = std::make_unique<RangeNode>((void *)tree.root(), 0);
+    RangeNode *rootPointer = root.get();
+    rangeTree_.setRoot(std::move(root));
+
+    {
+        RangeTreeBuilder builder(rangeTree_, rootPointer, 0);
+        buildRangeTree(ranges, 0, builder);
+    }
+
+    QString result = QString::fromUtf8(sink.data());
+    rootPointer->setSize(result.size());
+    return result;
+}
+
+bool CxxDocument::isLazyFor(const core::arch::Instructions *instructions) {
+    return instructions && instructions->size() >= lazyInstructionCount;
+}
+
+void CxxDocument::printPlaceholder(const core::likec::FunctionDefinition *definition, TextBuffer &buffer,
+                                   std::vector<core::likec::PrintedRange> &ranges)
+{
+    assert(definition != nullptr);
+
+    core::likec::PrintedRange range = { definition, buffer.position(), -1, -1 };
+    core::likec::TreePrinter(buffer).printPrototype(definition);
+    buffer << " /* ... */";
+    range.end = buffer.position();
+    ranges.push_back(range);
+}
+
+bool CxxDocument::renderFragment(const Range<int> &range) {
+    if (pendingDefinitions_.empty() || !rangeTree_.root()) {
+        return false;
+    }
+
+    const RangeNode *root = rangeTree_.root();
+
+    for (auto i = root->getFirstChildNotToTheLeftOf(range.start()), size = root->children().size();
+         i < size && root->childOffset(i) < range.end(); ++i)
+    {
+        if (pendingDefinitions_.count(getDefinition(&root->children()[i]))) {
+            renderFragment(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CxxDocument::renderFragments(const core::arch::Instruction *instruction) {
+    assert(instruction != nullptr);
+
+    if (pendingDefinitions_.empty()) {
+        return;
+    }
+
+    indexPendingDefinitions();
+
+    if (auto definition = nc::find(instruction2pendingDefinition_, instruction)) {
+        renderFragment(definition);
+    }
+}
+
+void CxxDocument::renderFragments(const QRegExp &regexp) {
+    if (pendingDefinitions_.empty() || !rangeTree_.root()) {
+        return;
+    }
+
+    /*
+     * Printing a function is much cheaper than inserting it into the document
+     * and indexing it, so the functions are printed aside, and only those
+     * matching the expression are rendered.
+     */
+    std::vector<const core::likec::FunctionDefinition *> unprinted;
+    foreach (auto definition, pendingDefinitions_) {
+        if (!pendingTexts_.count(definition)) {
+            unprinted.push_back(definition);
+        }
+    }
+
+    std::vector<QString> texts(unprinted.size());
+    parallelFor(unprinted.size(), [&](std::size_t i) {
+        MemoryTextSink sink;
+        {
+            TextBuffer buffer(sink);
+            core::likec::TreePrinter(buffer).print(unprinted[i]);
+        }
+        texts[i] = QString::fromUtf8(sink.data());
+    });
+
+    for (std::size_t i = 0; i < unprinted.size(); ++i) {
+        pendingTexts_[unprinted[i]].swap(texts[i]);
+    }
+
+    const RangeNode *root = rangeTree_.root();
+
+    for (std::size_t i = 0, size = root->children().size(); i < size; ++i) {
+        auto definition = getDefinition(&root->children()[i]);
+        if (pendingDefinitions_.count(definition) && nc::find(pendingTexts_, definition).contains(regexp)) {
+            renderFragment(i);
+        }
+    }
+}
+
+void CxxDocument::renderFragment(const core::likec::FunctionDefinition *definition) {
+    if (pendingDefinitions_.count(definition)) {
+        auto range = getRange(definition);
+        renderFragment(make_range(range.start(), range.start() + 1));
+    }
+}
+
+void CxxDocument::addPendingDefinition(const core::likec::FunctionDefinition *definition) {
+    pendingDefinitions_.insert(definition);
+    unindexedDefinitions_.push_back(definition);
+}
+
+void CxxDocument::indexPendingDefinitions() {
+    /* Indexing does not need printing, so do it for all the pending functions at once. */
+    foreach (auto definition, unindexedDefinitions_) {
+        if (pendingDefinitions_.count(definition)) {
+            mapInstructionsAndUses(definition, definition, instruction2pendingDefinition_, declaration2pendingDefinitions_);
+        }
+    }
+    unindexedDefinitions_.clear();
+}
+
+void CxxDocument::renderFragment(std::size_t index) {
+    RangeNode &fragment = rangeTree_.root()->children()[index];
+    auto definition = getDefinition(&fragment);
+
+    assert(definition != nullptr && pendingDefinitions_.count(definition));
+    pendingDefinitions_.erase(definition);
+    pendingTexts_.erase(definition);
+
+    MemoryTextSink sink;
+    std::vector<core::likec::PrintedRange> ranges;
+
+    {
+        TextBuffer buffer(sink);
+        core::likec::TreePrinter(buffer, &ranges).print(definition);
+    }
+
+    /*
+     * The placeholder text is replaced as a whole, so onContentsChange()
+     * makes the range node of the function cover the printed text.
+     */
+    replaceText(rangeTree_.getRange(&fragment), QString::fromUtf8(sink.data()));
+
+    /* The first range is the one of the function definition itself. */
+    {
+        RangeTreeBuilder builder(rangeTree_, &fragment, 0);
+        buildRangeTree(ranges, 0, builder, 1);
+    }
+
+    computeReverseMappings(&fragment);
+}
+
 void CxxDocument::computeReverseMappings(const RangeNode *rangeNode) {
     assert(rangeNode != nullptr);
 
@@ -148,7 +481,9 @@ std::vector<const core::likec::TreeNode *> CxxDocument::getNodesIn(const Range<i
     result.reserve(result.size());
 
     foreach (auto rangeNode, rangeNodes) {
-        result.push_back(getNode(rangeNode));
+        if (auto node = getNode(rangeNode)) {
+            result.push_back(node);
+        }
     }
 
     return result;
@@ -186,6 +521,13 @@ void CxxDocument::onContentsChange(int position, int charsRemoved, int charsAdde
 void CxxDocument::rename(const core::likec::Declaration *declaration, const QString &newName) {
     assert(declaration != nullptr);
 
+    /* The functions using the declaration would be printed later with the old name. */
+    indexPendingDefinitions();
+
+    foreach (auto definition, nc::find(declaration2pendingDefinitions_, declaration)) {
+        renderFragment(definition);
+    }
+
     foreach (auto use, getUses(declaration)) {
         replaceText(getRange(use), newName);
     }
@@ -29,7 +29,9 @@
 #include <vector>
 
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
+#include <QRegExp>
 #include <QTextDocument>
 
 #include <nc/common/Range.h>
@@ -39,11 +41,14 @@
 
 namespace nc {
 
+class TextBuffer;
+
 namespace core {
     class Context;
 
     namespace arch {
         class Instruction;
+        class Instructions;
     }
 
     namespace ir {
@@ -57,25 +62,42 @@ namespace core {
         class FunctionDefinition;
         class LabelDeclaration;
         class LabelStatement;
+        class Tree;
         class TreeNode;
+        struct PrintedRange;
     }
 }
 
 namespace gui {
 
+class DeclarationStream;
+
 /**
  * Text document containing C++ listing.
+ *
+ * In the lazy mode, each function definition is first shown as its
+ * prototype followed by an ellipsis. The body of the function is printed
+ * and the nodes in it are indexed only when the function is rendered,
+ * e.g. when it is scrolled into view. Navigation to the definitions of
+ * functions works regardless of whether they are rendered. A document
+ * populated from a lazy declaration stream is lazy too.
  */
 class CxxDocument: public QTextDocument {
     Q_OBJECT
 
     std::shared_ptr<const core::Context> context_;
+    std::shared_ptr<DeclarationStream> stream_;
     RangeTree rangeTree_;
     boost::unordered_map<const core::likec::TreeNode *, const RangeNode *> node2rangeNode_;
     boost::unordered_map<const core::arch::Instruction *, std::vector<const RangeNode *>> instruction2rangeNodes_;
     boost::unordered_map<const core::likec::Declaration *, std::vector<const core::likec::TreeNode *>> declaration2uses_;
     boost::unordered_map<const core::likec::LabelDeclaration *, const core::likec::LabelStatement *> label2statement_;
     boost::unordered_map<const core::likec::FunctionDeclaration *, const core::likec::FunctionDefinition *> functionDeclaration2definition_;
+    boost::unordered_set<const core::likec::FunctionDefinition *> pendingDefinitions_;
+    std::vector<const core::likec::FunctionDefinition *> unindexedDefinitions_;
+    boost::unordered_map<const core::arch::Instruction *, const core::likec::FunctionDefinition *> instruction2pendingDefinition_;
+    boost::unordered_map<const core::likec::Declaration *, std::vector<const core::likec::FunctionDefinition *>> declaration2pendingDefinitions_;
+    boost::unordered_map<const core::likec::FunctionDefinition *, QString> pendingTexts_;
 
 public:
     /**
@@ -83,8 +105,62 @@ public:
      *
      * \param parent  Pointer to the parent object. Can be nullptr.
      * \param context Pointer to the context. Can be nullptr.
+     * \param lazy    Whether the bodies of functions must be printed only when they are rendered.
+     */
+    explicit CxxDocument(QObject *parent = nullptr, std::shared_ptr<const core::Context> context = nullptr, bool lazy = false);
+
+    /**
+     * Constructor of a document showing the declarations of the context's tree
+     * as they are generated. Declarations printed to the stream are appended
+     * to the document as soon as they arrive.
+     *
+     * \param parent  Pointer to the parent object. Can be nullptr.
+     * \param context Valid pointer to the context whose tree is being generated.
+     * \param stream  Valid pointer to the stream receiving the declarations of the tree.
+     */
+    CxxDocument(QObject *parent, std::shared_ptr<const core::Context> context, std::shared_ptr<DeclarationStream> stream);
+
+    /**
+     * \return Pointer to the context. Can be nullptr.
+     */
+    const std::shared_ptr<const core::Context> &context() const { return context_; }
+
+    /**
+     * \return True iff the document is populated from a declaration stream.
+     */
+    bool isStreamed() const { return stream_ != nullptr; }
+
+    /**
+     * \return True iff there are functions whose bodies are not printed yet.
+     */
+    bool hasPendingFragments() const { return !pendingDefinitions_.empty(); }
+
+    /**
+     * Prints the body of the first function overlapping the given range,
+     * if its body is not printed yet.
+     *
+     * \param range Range of text.
+     *
+     * \return True iff a function has been rendered.
      */
-    explicit CxxDocument(QObject *parent = nullptr, std::shared_ptr<const core::Context> context = nullptr);
+    bool renderFragment(const Range<int> &range);
+
+    /**
+     * Prints the bodies of the functions containing nodes generated from
+     * the given instruction, if they are not printed yet.
+     *
+     * \param instruction Valid pointer to an instruction.
+     */
+    void renderFragments(const core::arch::Instruction *instruction);
+
+    /**
+     * Prints the bodies of the functions whose text matches the given regular
+     * expression, if they are not printed yet. The text of the other functions
+     * is printed aside and is kept until they are rendered.
+     *
+     * \param regexp Regular expression to look for.
+     */
+    void renderFragments(const QRegExp &regexp);
 
     /**
      * \return Pointer to the deepest tree node at the given position. Can be nullptr.
@@ -106,6 +182,8 @@ public:
     /**
      * \param instruction Valid pointer to an instruction.
      * \param[out] result List of ranges occupied by the nodes generated from this instruction.
+     *
+     * \note Nodes in the functions that are not rendered yet are not included.
      */
     void getRanges(const core::arch::Instruction *instruction, std::vector<Range<int>> &result) const;
 
@@ -113,6 +191,8 @@ public:
      * \param declaration Valid pointer to a declaration tree node.
      *
      * \return All the tree nodes using this declaration.
+     *
+     * \note Uses in the functions that are not rendered yet are not included.
      */
     const std::vector<const core::likec::TreeNode *> &getUses(const core::likec::Declaration *declaration) const {
         assert(declaration != nullptr);
@@ -167,11 +247,42 @@ public:
      */
     static const core::likec::Declaration *getDeclarationOfIdentifier(const core::likec::TreeNode *node);
 
+    /**
+     * \param instructions Pointer to the decompiled instructions. Can be nullptr.
+     *
+     * \return True iff the listing of the program decompiled from these
+     *         instructions must be rendered lazily.
+     */
+    static bool isLazyFor(const core::arch::Instructions *instructions);
+
+    /**
+     * Prints a function definition as it is shown until it is rendered:
+     * its prototype followed by an ellipsis.
+     *
+     * \param definition Valid pointer to a function definition.
+     * \param buffer Output buffer.
+     * \param ranges Ranges of printed nodes. The range of the definition is added to them.
+     */
+    static void printPlaceholder(const core::likec::FunctionDefinition *definition, TextBuffer &buffer,
+                                 std::vector<core::likec::PrintedRange> &ranges);
+
+public Q_SLOTS:
+    /**
+     * Appends the declarations pending in the stream, if any, to the document.
+     */
+    void readStream();
+
 private Q_SLOTS:
     void onContentsChange(int position, int charsRemoved, int charsAdded);
 
 private:
     void computeReverseMappings(const RangeNode *rangeNode);
+    QString printFragments(const core::likec::Tree &tree);
+    void renderFragment(std::size_t index);
+    void renderFragment(const core::likec::FunctionDefinition *definition);
+    void addPendingDefinition(const core::likec::FunctionDefinition *definition);
+    void indexPendingDefinitions();
+    void appendDeclarations(const QString &text, const std::vector<core::likec::PrintedRange> &ranges);
     void replaceText(const Range<int> &range, const QString &text);
 };
 
@@ -28,6 +28,8 @@
 #include <QInputDialog>
 #include <QMenu>
 #include <QPlainTextEdit>
+#include <QRegExp>
+#include <QScrollBar>
 
 #include <nc/common/StringToInt.h>
 #include <nc/core/likec/Expression.h>
@@ -38,6 +40,7 @@
 
 #include "CppSyntaxHighlighter.h"
 #include "CxxDocument.h"
+#include "Searcher.h"
 
 namespace nc { namespace gui {
 
@@ -82,6 +85,13 @@ CxxView::CxxView(QWidget *parent):
 
     textEdit()->viewport()->installEventFilter(this);
 
+    /* Rendering is postponed, as it changes the document being scrolled. */
+    connect(textEdit()->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(renderVisibleFragments()), Qt::QueuedConnection);
+
+    connect(textEdit()->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(highlightVisibleBlocks()));
+    connect(textEdit(), SIGNAL(textChanged()), this, SLOT(highlightVisibleBlocks()));
+    connect(this, SIGNAL(aboutToFind(const QString &, int)), this, SLOT(renderFragments(const QString &, int)));
+
     connect(this, SIGNAL(contextMenuCreated(QMenu *)), this, SLOT(populateContextMenu(QMenu *)));
 }
 
@@ -99,6 +109,8 @@ void CxxView::setDocument(CxxDocument *document) {
 
     textEdit()->blockSignals(false);
 
+    renderVisibleFragments();
+    highlightVisibleBlocks();
     updateSelection();
 }
 
@@ -276,6 +288,12 @@ void CxxView::highlightInstructions(const std::vector<const core::arch::Instruct
         return;
     }
 
+    if (ensureVisible) {
+        foreach (const core::arch::Instruction *instruction, instructions) {
+            document()->renderFragments(instruction);
+        }
+    }
+
     std::vector<Range<int>> ranges;
 
     foreach (const core::arch::Instruction *instruction, instructions) {
@@ -358,9 +376,33 @@ void CxxView::populateContextMenu(QMenu *menu) {
     }
 }
 
+void CxxView::renderVisibleFragments() {
+    if (!document() || !document()->hasPendingFragments()) {
+        return;
+    }
+
+    /* Rendering a function moves the following ones, possibly out of view. */
+    while (document()->renderFragment(getVisibleRange())) {}
+}
+
+void CxxView::highlightVisibleBlocks() {
+    highlighter_->setVisibleRange(getVisibleRange());
+}
+
+void CxxView::renderFragments(const QString &expression, int flags) {
+    if (document()) {
+        document()->renderFragments(QRegExp(expression,
+            (flags & Searcher::FindCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive,
+            (flags & Searcher::FindRegexp) ? QRegExp::RegExp2 : QRegExp::FixedString));
+    }
+}
+
 bool CxxView::eventFilter(QObject *watched, QEvent *event) {
     if (watched == textEdit()->viewport()) {
-        if (event->type() == QEvent::ToolTip) {
+        if (event->type() == QEvent::Resize) {
+            QMetaObject::invokeMethod(this, "renderVisibleFragments", Qt::QueuedConnection);
+            QMetaObject::invokeMethod(this, "highlightVisibleBlocks", Qt::QueuedConnection);
+        } else if (event->type() == QEvent::ToolTip) {
             QHelpEvent *ev = static_cast<QHelpEvent*>(event);
 
             textEdit()->setToolTip(getDeclarationTooltip(textEdit()->cursorForPosition(ev->pos()).position()));
@@ -218,6 +218,25 @@ private Q_SLOTS:
      */
     void rename();
 
+    /**
+     * Renders the functions visible in the text edit widget, if they are not rendered yet.
+     */
+    void renderVisibleFragments();
+
+    /**
+     * Highlights the syntax of the text visible in the text edit widget.
+     */
+    void highlightVisibleBlocks();
+
+    /**
+     * Renders the functions of the document that may contain the string
+     * or the regular expression being searched for, if they are not rendered yet.
+     *
+     * \param expression Search string.
+     * \param flags      Search flags (see Searcher::FindFlags).
+     */
+    void renderFragments(const QString &expression, int flags);
+
     /**
      * Populates the context menu being created.
      *
@@ -0,0 +1,85 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "DeclarationStream.h"
+
+#include <cassert>
+
+#include <QMutexLocker>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/TextBuffer.h>
+
+#include <nc/core/likec/Declaration.h>
+#include <nc/core/likec/FunctionDefinition.h>
+
+#include "CxxDocument.h"
+
+namespace nc {
+namespace gui {
+
+DeclarationStream::DeclarationStream(QObject *parent, bool lazy):
+    QObject(parent), lazy_(lazy)
+{}
+
+DeclarationStream::~DeclarationStream() {}
+
+void DeclarationStream::print(const core::likec::Declaration *declaration) {
+    assert(declaration != nullptr);
+
+    MemoryTextSink sink;
+    std::vector<core::likec::PrintedRange> ranges;
+
+    /* Surround the declaration with newlines, as TreePrinter does when printing a compilation unit. */
+    {
+        TextBuffer buffer(sink);
+        buffer << '\n';
+        auto definition = declaration->as<core::likec::FunctionDefinition>();
+        if (lazy_ && definition) {
+            CxxDocument::printPlaceholder(definition, buffer, ranges);
+        } else {
+            core::likec::TreePrinter(buffer, &ranges).print(declaration);
+        }
+        buffer << '\n';
+    }
+
+    QString text = QString::fromUtf8(sink.data());
+    bool wasEmpty;
+
+    {
+        QMutexLocker lock(&mutex_);
+
+        wasEmpty = text_.isEmpty();
+
+        auto offset = text_.size();
+        auto firstRange = static_cast<int>(ranges_.size());
+
+        foreach (auto range, ranges) {
+            range.begin += offset;
+            range.end += offset;
+            if (range.parent >= 0) {
+                range.parent += firstRange;
+            }
+            ranges_.push_back(range);
+        }
+        text_ += text;
+    }
+
+    if (wasEmpty) {
+        Q_EMIT readyRead();
+    }
+}
+
+void DeclarationStream::take(QString &text, std::vector<core::likec::PrintedRange> &ranges) {
+    QMutexLocker lock(&mutex_);
+
+    text.clear();
+    text.swap(text_);
+
+    ranges.clear();
+    ranges.swap(ranges_);
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,98 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+#include <nc/core/likec/TreePrinter.h>
+
+namespace nc {
+
+namespace core {
+    namespace likec {
+        class Declaration;
+    }
+}
+
+namespace gui {
+
+/**
+ * Thread-safe queue of top-level declarations printed while the C tree
+ * is being generated.
+ *
+ * Declarations are printed by the thread generating the tree, in the same
+ * way as the whole compilation unit would be printed, and are taken by the
+ * GUI thread in chunks. A lazy stream prints function definitions as
+ * placeholders, leaving the printing of their bodies to the document.
+ */
+class DeclarationStream: public QObject {
+    Q_OBJECT
+
+    /** Mutex guarding the pending text and ranges. */
+    QMutex mutex_;
+
+    /** Text of the printed declarations not taken yet. */
+    QString text_;
+
+    /** Ranges of the nodes in the pending text. */
+    std::vector<core::likec::PrintedRange> ranges_;
+
+    /** Whether function definitions are printed as placeholders. */
+    bool lazy_;
+
+public:
+    /**
+     * Constructor.
+     *
+     * \param parent Pointer to the parent object. Can be nullptr.
+     * \param lazy   Whether function definitions must be printed as placeholders
+     *               (see CxxDocument::printPlaceholder()).
+     */
+    explicit DeclarationStream(QObject *parent = nullptr, bool lazy = false);
+
+    /**
+     * Destructor.
+     */
+    ~DeclarationStream();
+
+    /**
+     * \return True iff function definitions are printed as placeholders.
+     */
+    bool isLazy() const { return lazy_; }
+
+    /**
+     * Prints the given declaration and appends it to the pending text.
+     * Can be called from any thread, but not concurrently.
+     *
+     * \param declaration Valid pointer to a complete top-level declaration.
+     */
+    void print(const core::likec::Declaration *declaration);
+
+    /**
+     * Takes the pending text and ranges of the printed nodes.
+     * Positions in the ranges are relative to the beginning of the text.
+     *
+     * \param[out] text Pending text.
+     * \param[out] ranges Ranges of the printed nodes, in preorder.
+     */
+    void take(QString &text, std::vector<core::likec::PrintedRange> &ranges);
+
+    Q_SIGNALS:
+
+    /**
+     * Signal emitted when some text becomes pending after all the text
+     * has been taken.
+     */
+    void readyRead();
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -29,7 +29,10 @@
 #include <nc/common/make_unique.h>
 
 #include <nc/core/Context.h>
+#include <nc/core/arch/Instructions.h>
 
+#include "CxxDocument.h"
+#include "DeclarationStream.h"
 #include "Decompilation.h"
 #include "Project.h"
 
@@ -46,13 +49,28 @@ DecompileAll::DecompileAll(Project *project):
 }
 
 void DecompileAll::work() {
+    if (project_->isDecompiled(*project_->instructions())) {
+        project_->logToken().info(tr("Instructions did not change since the last decompilation."));
+        return;
+    }
+
     auto context = std::make_shared<core::Context>();
     context->setImage(project_->image());
     context->setInstructions(project_->instructions());
     context->setCancellationToken(cancellationToken());
+    context->setFocusToken(project_->focusToken());
     context->setLogToken(project_->logToken());
 
-    project_->setContext(context);
+    /*
+     * Show the declarations as soon as they are generated. The bodies of
+     * the functions of a big program are printed only when they are shown.
+     */
+    auto stream = std::make_shared<DeclarationStream>(nullptr, CxxDocument::isLazyFor(project_->instructions().get()));
+    context->setDeclarationSink([stream](const core::likec::Declaration *declaration) {
+        stream->print(declaration);
+    }, true);
+
+    project_->setContext(context, stream);
 
     delegate(std::make_unique<Decompilation>(context));
 }
@@ -25,6 +25,7 @@
 #include "InstructionsModel.h"
 
 #include <algorithm>
+#include <iterator>
 
 #include <QColor>
 
@@ -47,26 +48,86 @@ enum InstructionsModelColumns {
 
 InstructionsModel::InstructionsModel(QObject *parent, std::shared_ptr<const core::arch::Instructions> instructions):
     QAbstractItemModel(parent),
-    instructions_(std::move(instructions))
+    instructions_(std::move(instructions)),
+    instructionCount_(0)
 {
-    std::vector<const core::arch::Instruction *> vector;
-
     if (instructions_) {
-        instructionsVector_.reserve(instructions_->size());
-
-        foreach (const auto &instruction, instructions_->all()) {
-            instructionsVector_.push_back(instruction.get());
+        instructionCount_ = checked_cast<int>(instructions_->size());
+        chunks_.reserve((instructionCount_ + chunkSize - 1) / chunkSize);
+
+        auto range = instructions_->all();
+        int i = 0;
+        for (auto it = range.begin(); it != range.end(); ++it, ++i) {
+            if (i % chunkSize == 0) {
+                chunks_.push_back(it);
+            }
         }
     }
 }
 
 void InstructionsModel::setHighlightedInstructions(std::vector<const core::arch::Instruction *> instructions) {
-    beginResetModel();
-
     std::sort(instructions.begin(), instructions.end());
+    instructions.erase(std::unique(instructions.begin(), instructions.end()), instructions.end());
+
+    std::vector<const core::arch::Instruction *> changedInstructions;
+    std::set_symmetric_difference(
+        highlightedInstructions_.begin(), highlightedInstructions_.end(),
+        instructions.begin(), instructions.end(),
+        std::back_inserter(changedInstructions));
+
     highlightedInstructions_ = std::move(instructions);
 
-    endResetModel();
+    std::vector<int> changedRows;
+    changedRows.reserve(changedInstructions.size());
+
+    foreach (auto instruction, changedInstructions) {
+        auto index = getIndex(instruction);
+        if (index.isValid()) {
+            changedRows.push_back(index.row());
+        }
+    }
+
+    std::sort(changedRows.begin(), changedRows.end());
+
+    /* Signal the changes in the ranges of consecutive rows. */
+    for (std::size_t i = 0; i < changedRows.size();) {
+        std::size_t j = i + 1;
+        while (j < changedRows.size() && changedRows[j] == changedRows[j - 1] + 1) {
+            ++j;
+        }
+        Q_EMIT dataChanged(index(changedRows[i], 0), index(changedRows[j - 1], IMC_COUNT - 1));
+        i = j;
+    }
+}
+
+const core::arch::Instruction *InstructionsModel::getInstruction(int row) const {
+    assert(0 <= row && row < instructionCount_);
+
+    auto it = chunks_[row / chunkSize];
+    std::advance(it, row % chunkSize);
+    return it->get();
+}
+
+QString InstructionsModel::getText(int row) const {
+    auto instruction = getInstruction(row);
+
+    auto i = instruction2text_.find(instruction);
+    if (i != instruction2text_.end()) {
+        cachedInstructions_.splice(cachedInstructions_.begin(), cachedInstructions_, i->second.second);
+        return i->second.first;
+    }
+
+    if (instruction2text_.size() >= maxCachedTextCount) {
+        instruction2text_.erase(cachedInstructions_.back());
+        cachedInstructions_.pop_back();
+    }
+
+    auto text = tr("%1:\t%2").arg(instruction->addr(), 0, 16).arg(instruction->toString());
+
+    cachedInstructions_.push_front(instruction);
+    instruction2text_[instruction] = std::make_pair(text, cachedInstructions_.begin());
+
+    return text;
 }
 
 const core::arch::Instruction *InstructionsModel::getInstruction(const QModelIndex &index) const {
@@ -76,19 +137,30 @@ const core::arch::Instruction *InstructionsModel::getInstruction(const QModelInd
 QModelIndex InstructionsModel::getIndex(const core::arch::Instruction *instruction) const {
     assert(instruction);
 
-    auto i = std::lower_bound(instructionsVector_.begin(), instructionsVector_.end(), instruction,
-        [](const core::arch::Instruction *a, const core::arch::Instruction *b) { return a->addr() < b->addr(); });
+    /* Find the last chunk starting not after the instruction. */
+    auto chunk = std::upper_bound(chunks_.begin(), chunks_.end(), instruction->addr(),
+        [](ByteAddr addr, const InstructionIterator &it) { return addr < (*it)->addr(); });
 
-    if (i != instructionsVector_.end() && *i == instruction) {
-        return index(i - instructionsVector_.begin(), 0, QModelIndex());
-    } else {
+    if (chunk == chunks_.begin()) {
         return QModelIndex();
     }
+    --chunk;
+
+    int row = checked_cast<int>(chunk - chunks_.begin()) * chunkSize;
+    auto it = *chunk;
+
+    for (int end = std::min(row + chunkSize, instructionCount_); row < end; ++row, ++it) {
+        if (it->get() == instruction) {
+            return index(row, 0, QModelIndex());
+        }
+    }
+
+    return QModelIndex();
 }
 
 int InstructionsModel::rowCount(const QModelIndex &parent) const {
     if (parent == QModelIndex()) {
-        return checked_cast<int>(instructionsVector_.size());
+        return instructionCount_;
     } else {
         return 0;
     }
@@ -99,8 +171,8 @@ int InstructionsModel::columnCount(const QModelIndex & /*parent*/) const {
 }
 
 QModelIndex InstructionsModel::index(int row, int column, const QModelIndex &parent) const {
-    if (row < rowCount(parent)) {
-        return createIndex(row, column, const_cast<core::arch::Instruction *>(instructionsVector_[row]));
+    if (0 <= row && row < rowCount(parent)) {
+        return createIndex(row, column, const_cast<core::arch::Instruction *>(getInstruction(row)));
     } else {
         return QModelIndex();
     }
@@ -112,11 +184,8 @@ QModelIndex InstructionsModel::parent(const QModelIndex & /*index*/) const {
 
 QVariant InstructionsModel::data(const QModelIndex &index, int role) const {
     if (role == Qt::DisplayRole) {
-        auto instruction = getInstruction(index);
-        assert(instruction);
-
         switch (index.column()) {
-            case IMC_INSTRUCTION: return tr("%1:\t%2").arg(instruction->addr(), 0, 16).arg(instruction->toString());
+            case IMC_INSTRUCTION: return getText(index.row());
             default: unreachable();
         }
     } else if (role == Qt::BackgroundRole) {
@@ -25,24 +25,27 @@
 
 #include <nc/config.h>
 
+#include <list>
 #include <memory> /* std::shared_ptr */
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
 #include <QAbstractItemModel>
+#include <QString>
 
-namespace nc {
+#include <nc/core/arch/Instructions.h>
 
-namespace core {
-    namespace arch {
-        class Instruction;
-        class Instructions;
-    }
-}
+namespace nc {
 
 namespace gui {
 
 /**
  * Item model for InstructionsView.
+ *
+ * The model accesses the instructions directly in their container. For random
+ * access by row, it remembers the positions of every chunkSize-th instruction.
+ * Texts of recently shown instructions are cached.
  */
 class InstructionsModel: public QAbstractItemModel {
     Q_OBJECT
@@ -84,11 +87,44 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
 
 private:
+    /** Type of an iterator over the instructions. */
+    typedef core::arch::Instructions::InstructionsRange::iterator InstructionIterator;
+
+    /** Number of instructions in a chunk. */
+    static const int chunkSize = 64;
+
+    /** Maximal number of cached texts of instructions. */
+    static const std::size_t maxCachedTextCount = 4096;
+
+    /**
+     * \param row Row number.
+     *
+     * \return Pointer to the instruction shown in the given row.
+     */
+    const core::arch::Instruction *getInstruction(int row) const;
+
+    /**
+     * \param row Number of the row with a valid instruction.
+     *
+     * \return Text of the instruction shown in the row.
+     */
+    QString getText(int row) const;
+
     /** Associated set of instructions. */
     std::shared_ptr<const core::arch::Instructions> instructions_;
 
-    /** Set of instructions as a vector (needed for direct access by index). */
-    std::vector<const core::arch::Instruction *> instructionsVector_;
+    /** Number of instructions. */
+    int instructionCount_;
+
+    /** Iterators pointing to the first instruction of each chunk. */
+    std::vector<InstructionIterator> chunks_;
+
+    /** Instructions whose texts are cached, the most recently used first. */
+    mutable std::list<const core::arch::Instruction *> cachedInstructions_;
+
+    /** Cached texts of instructions and positions of instructions in cachedInstructions_. */
+    mutable boost::unordered_map<const core::arch::Instruction *,
+        std::pair<QString, std::list<const core::arch::Instruction *>::iterator>> instruction2text_;
 
     /** Sorted vector of instructions that must be highlighted. */
     std::vector<const core::arch::Instruction *> highlightedInstructions_;
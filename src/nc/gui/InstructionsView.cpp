@@ -24,7 +24,7 @@
 
 #include "InstructionsView.h"
 
-#include <QTreeView>
+#include <QListView>
 
 #include <nc/common/Foreach.h>
 
@@ -33,23 +33,21 @@
 namespace nc { namespace gui {
 
 InstructionsView::InstructionsView(QWidget *parent):
-    TreeView(tr("Instructions"), parent),
+    TreeView(tr("Instructions"), parent, new QListView()),
+    listView_(static_cast<QListView *>(itemView())),
     model_(nullptr)
 {
-    treeView()->setHeaderHidden(true);
-    treeView()->setItemsExpandable(false);
-    treeView()->setRootIsDecorated(false);
-    treeView()->setSelectionBehavior(QAbstractItemView::SelectRows);
-    treeView()->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    treeView()->setUniformRowHeights(true);
+    listView()->setSelectionBehavior(QAbstractItemView::SelectRows);
+    listView()->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    listView()->setUniformItemSizes(true);
 }
 
 void InstructionsView::setModel(InstructionsModel *model) {
     if (model != model_) {
         model_ = model;
-        treeView()->setModel(model);
+        listView()->setModel(model);
 
-        connect(treeView()->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
+        connect(listView()->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
                 this, SLOT(updateSelection()));
         updateSelection();
     }
@@ -59,7 +57,7 @@ void InstructionsView::updateSelection() {
     std::vector<const core::arch::Instruction *> instructions;
 
     if (model()) {
-        foreach (const QModelIndex &index, treeView()->selectionModel()->selectedIndexes()) {
+        foreach (const QModelIndex &index, listView()->selectionModel()->selectedIndexes()) {
             /* Process every row only once. */
             if (index.column() == 0) {
                 if (const core::arch::Instruction *instruction = model()->getInstruction(index)) {
@@ -80,7 +78,7 @@ void InstructionsView::highlightInstructions(const std::vector<const core::arch:
         model()->setHighlightedInstructions(instructions);
 
         if (ensureVisible && !instructions.empty()) {
-            treeView()->scrollTo(model()->getIndex(instructions.back()));
+            listView()->scrollTo(model()->getIndex(instructions.back()));
         }
     }
 }
@@ -30,7 +30,7 @@
 #include "TreeView.h"
 
 QT_BEGIN_NAMESPACE
-class QTreeView;
+class QListView;
 QT_END_NAMESPACE
 
 namespace nc {
@@ -47,10 +47,17 @@ class InstructionsModel;
 
 /**
  * Dock widget for showing lists of instructions.
+ *
+ * Instructions are shown in a QListView with uniform item sizes: unlike
+ * QTreeView, it does not keep an item per row, so scrolling through
+ * millions of instructions only asks the model for the visible rows.
  */
 class InstructionsView: public TreeView {
     Q_OBJECT
 
+    /** List view showing the instructions. */
+    QListView *listView_;
+
     /** The model being shown. */
     InstructionsModel *model_;
 
@@ -82,6 +89,11 @@ public:
      */
     const std::vector<const core::arch::Instruction *> &selectedInstructions() const { return selectedInstructions_; }
 
+    /**
+     * \return Valid pointer to the list view showing the instructions.
+     */
+    QListView *listView() const { return listView_; }
+
 public Q_SLOTS:
     /**
      * Highlights given instructions.
@@ -29,6 +29,7 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QLabel>
+#include <QListView>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -37,7 +38,6 @@
 #include <QSettings>
 #include <QStatusBar>
 #include <QTextStream>
-#include <QTreeView>
 
 #include <nc/common/Branding.h>
 #include <nc/common/Exception.h>
@@ -47,6 +47,7 @@
 
 #include <nc/core/Context.h>
 #include <nc/core/Driver.h>
+#include <nc/core/Snapshot.h>
 #include <nc/core/arch/Instructions.h>
 #include <nc/core/image/Image.h>
 #include <nc/core/image/Section.h>
@@ -112,6 +113,7 @@ void MainWindow::createWidgets() {
     addDockWidget(Qt::LeftDockWidgetArea, instructionsView_);
 
     connect(instructionsView_, SIGNAL(instructionSelectionChanged()), this, SLOT(highlightInstructionsInCxx()));
+    connect(instructionsView_, SIGNAL(instructionSelectionChanged()), this, SLOT(updateFocus()));
     connect(instructionsView_, SIGNAL(deleteSelectedInstructions()), this, SLOT(deleteSelectedInstructions()));
     connect(instructionsView_, SIGNAL(decompileSelectedInstructions()), this, SLOT(decompileSelectedInstructions()));
     connect(instructionsView_, SIGNAL(contextMenuCreated(QMenu *)), this, SLOT(populateInstructionsContextMenu(QMenu *)));
@@ -176,6 +178,10 @@ void MainWindow::createActions() {
     openAction_->setShortcuts(QKeySequence::Open);
     connect(openAction_, SIGNAL(triggered()), this, SLOT(open()));
 
+    saveSnapshotAction_ = new QAction(tr("&Save Snapshot..."), this);
+    saveSnapshotAction_->setShortcuts(QKeySequence::Save);
+    connect(saveSnapshotAction_, SIGNAL(triggered()), this, SLOT(saveSnapshot()));
+
     exportCfgAction_ = new QAction(tr("&Export CFG..."), this);
     connect(exportCfgAction_, SIGNAL(triggered()), this, SLOT(exportCfg()));
 
@@ -231,18 +237,19 @@ void MainWindow::createActions() {
     deleteSelectedInstructionsAction_->setShortcut(Qt::Key_Delete);
     deleteSelectedInstructionsAction_->setShortcutContext(Qt::WidgetWithChildrenShortcut);
     connect(deleteSelectedInstructionsAction_, SIGNAL(triggered()), this, SLOT(deleteSelectedInstructions()));
-    instructionsView_->treeView()->addAction(deleteSelectedInstructionsAction_);
+    instructionsView_->listView()->addAction(deleteSelectedInstructionsAction_);
 
     decompileSelectedInstructionsAction_ = new QAction(tr("Decompile"), this);
     decompileSelectedInstructionsAction_->setShortcut(Qt::CTRL + Qt::Key_E);
     decompileSelectedInstructionsAction_->setShortcutContext(Qt::WidgetWithChildrenShortcut);
     connect(decompileSelectedInstructionsAction_, SIGNAL(triggered()), this, SLOT(decompileSelectedInstructions()));
-    instructionsView_->treeView()->addAction(decompileSelectedInstructionsAction_);
+    instructionsView_->listView()->addAction(decompileSelectedInstructionsAction_);
 }
 
 void MainWindow::createMenus() {
     QMenu *fileMenu = menuBar()->addMenu(tr("&File"));
     fileMenu->addAction(openAction_);
+    fileMenu->addAction(saveSnapshotAction_);
     fileMenu->addSeparator();
     fileMenu->addAction(exportCfgAction_);
     fileMenu->addSeparator();
@@ -318,6 +325,7 @@ void MainWindow::saveSettings() {
 }
 
 void MainWindow::updateGuiState() {
+    saveSnapshotAction_->setEnabled(project() != nullptr);
     exportCfgAction_->setEnabled(project() != nullptr);
     disassembleAction_->setEnabled(project() != nullptr);
     decompileAction_->setEnabled(project() != nullptr);
@@ -408,6 +416,7 @@ void MainWindow::open(std::unique_ptr<Project> project) {
     connect(project_.get(), SIGNAL(nameChanged()), this, SLOT(updateGuiState()));
     connect(project_.get(), SIGNAL(imageChanged()), this, SLOT(imageChanged()));
     connect(project_.get(), SIGNAL(instructionsChanged()), this, SLOT(instructionsChanged()));
+    connect(project_.get(), SIGNAL(contextChanged()), this, SLOT(contextChanged()));
     connect(project_.get(), SIGNAL(treeChanged()), this, SLOT(treeChanged()));
 
     /* Connect the project to the progress dialog. */
@@ -442,11 +451,33 @@ void MainWindow::instructionsChanged() {
     instructionsView_->setModel(new InstructionsModel(this, project()->instructions()));
 }
 
-void MainWindow::treeChanged() {
+void MainWindow::contextChanged() {
+    if (!project()->declarationStream()) {
+        return;
+    }
+
+    /* Show the declarations of the new tree as they are generated. */
     if (cxxView_->document()) {
         cxxView_->document()->deleteLater();
     }
-    cxxView_->setDocument(new CxxDocument(this, project()->context()));
+    cxxView_->setDocument(new CxxDocument(this, project()->context(), project()->declarationStream()));
+}
+
+void MainWindow::treeChanged() {
+    auto document = cxxView_->document();
+
+    if (document && document->isStreamed() && document->context() == project()->context()) {
+        /* All the declarations of the tree have been streamed into the document. */
+        document->readStream();
+    } else {
+        if (document) {
+            document->deleteLater();
+        }
+
+        /* Printing and indexing all the functions of a big program at once freezes the GUI. */
+        const auto &context = project()->context();
+        cxxView_->setDocument(new CxxDocument(this, context, CxxDocument::isLazyFor(context->instructions().get())));
+    }
 
     if (inspectorView_->model()) {
         inspectorView_->model()->deleteLater();
@@ -484,6 +515,24 @@ void MainWindow::populateSymbolsContextMenu(QMenu *menu) {
     }
 }
 
+void MainWindow::saveSnapshot() {
+    if (!project()) {
+        return;
+    }
+
+    QString filename = QFileDialog::getSaveFileName(this, tr("Where should I save the snapshot?"), QString(), tr("Snowman snapshots (*.snapshot);;All Files(*)"));
+    if (!filename.isEmpty()) {
+        try {
+            /* Results of a finished decompilation of the current instructions are saved too. */
+            auto context = project()->context();
+            core::Snapshot::save(*project()->image(), *project()->instructions(), filename,
+                project()->isDecompiled(*project()->instructions()) ? context.get() : nullptr);
+        } catch (const nc::Exception &e) {
+            QMessageBox::critical(this, tr("Error"), e.unicodeWhat());
+        }
+    }
+}
+
 void MainWindow::exportCfg() {
     if (!project()) {
         return;
@@ -613,6 +662,25 @@ void MainWindow::highlightInstructionsInCxx() {
     }
 }
 
+void MainWindow::updateFocus() {
+    if (!project()) {
+        return;
+    }
+
+    /* A few instructions are enough to find the functions the user is looking at. */
+    const std::size_t maxAddresses = 16;
+
+    std::vector<ByteAddr> addresses;
+    foreach (auto instruction, instructionsView_->selectedInstructions()) {
+        if (addresses.size() == maxAddresses) {
+            break;
+        }
+        addresses.push_back(instruction->addr());
+    }
+
+    project()->focusToken().setAddresses(std::move(addresses));
+}
+
 void MainWindow::highlightCxxInInstructions() {
     if (instructionsView_->isVisible()) {
         instructionsView_->blockSignals(true);
@@ -78,6 +78,7 @@ class MainWindow: public QMainWindow {
     QProgressBar *statusProgressBar_; ///< Progress bar in the status bar.
 
     QAction *openAction_; ///< Action for opening a file.
+    QAction *saveSnapshotAction_; ///< Action for saving a project snapshot.
     QAction *exportCfgAction_; ///< Action for exporting CFG in DOT format.
     QAction *loadStyleSheetAction_; ///< Action for loading a Qt style sheet.
     QAction *quitAction_; ///< Action for closing the main window.
@@ -267,6 +268,11 @@ private Q_SLOTS:
      */
     void instructionsChanged();
 
+    /**
+     * This slot handles the start of work in a new context.
+     */
+    void contextChanged();
+
     /**
      * This slot handles the event of successful completion of decompilation.
      */
@@ -300,6 +306,12 @@ private Q_SLOTS:
      */
     void populateSymbolsContextMenu(QMenu *menu);
 
+    /**
+     * Saves a snapshot of the project, so that it can be reopened
+     * without parsing and disassembling the executable file again.
+     */
+    void saveSnapshot();
+
     /**
      * Export CFG in DOT format.
      */
@@ -345,6 +357,12 @@ private Q_SLOTS:
      */
     void highlightInstructionsInCxx();
 
+    /**
+     * Tells the running analyses to process the code of the selected
+     * assembler instructions first.
+     */
+    void updateFocus();
+
     /**
      * Highlights instructions producing selected C++ code in instructions view.
      */
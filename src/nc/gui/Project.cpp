@@ -84,15 +84,39 @@ void Project::updateInstructions() {
     setInstructions(context()->instructions());
 }
 
-void Project::setContext(const std::shared_ptr<const core::Context> &context) {
+void Project::setContext(const std::shared_ptr<const core::Context> &context,
+                         const std::shared_ptr<DeclarationStream> &declarationStream)
+{
     assert(context);
 
     if (context_ != context) {
         context_ = context;
+        declarationStream_ = declarationStream;
 
         connect(context_.get(), SIGNAL(instructionsChanged()), this, SLOT(updateInstructions()));
         connect(context_.get(), SIGNAL(treeChanged()), this, SIGNAL(treeChanged()));
+
+        Q_EMIT contextChanged();
+    }
+}
+
+bool Project::isDecompiled(const core::arch::Instructions &instructions) const {
+    auto context = context_;
+
+    /* A tree left by a cancelled decompilation lacks functions. */
+    if (!context->isTreeComplete() || !context->instructions() || context->instructions()->size() != instructions.size()) {
+        return false;
     }
+
+    /* Instructions are immutable and shared between sets, so comparing pointers suffices. */
+    auto i = context->instructions()->all().begin();
+    foreach (const auto &instruction, instructions.all()) {
+        if (*i++ != instruction) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void Project::deleteInstructions(const std::vector<const core::arch::Instruction *> &instructions) {
@@ -31,6 +31,7 @@
 #include <memory>
 #include <vector>
 
+#include <nc/common/FocusToken.h>
 #include <nc/common/Types.h>
 #include <nc/common/LogToken.h>
 
@@ -53,6 +54,7 @@ namespace core {
 namespace gui {
 
 class CommandQueue;
+class DeclarationStream;
 class Decompile;
 
 /**
@@ -73,9 +75,15 @@ class Project: public QObject {
     /** Current context. */
     std::shared_ptr<const core::Context> context_;
 
+    /** Stream of declarations generated in the current context. Can be nullptr. */
+    std::shared_ptr<DeclarationStream> declarationStream_;
+
     /** Log token. */
     LogToken logToken_;
 
+    /** Addresses of the code the user is looking at. */
+    FocusToken focusToken_;
+
     /** Queue of user commands. */
     CommandQueue *commandQueue_;
 
@@ -138,8 +146,29 @@ class Project: public QObject {
      * Sets current context.
      *
      * \param context Valid pointer to the new context.
+     * \param declarationStream Pointer to the stream receiving the declarations
+     *                          of the tree generated in this context. Can be nullptr.
+     */
+    void setContext(const std::shared_ptr<const core::Context> &context,
+                    const std::shared_ptr<DeclarationStream> &declarationStream = nullptr);
+
+    /**
+     * \return Pointer to the stream receiving the declarations of the tree
+     *         generated in the current context. Can be nullptr.
+     */
+    const std::shared_ptr<DeclarationStream> &declarationStream() const { return declarationStream_; }
+
+    /**
+     * \param instructions Set of instructions.
+     *
+     * \return True iff the current context holds the results of a completed
+     *         decompilation of exactly the given instructions.
+     *
+     * \note Results are reused only as a whole: if any instruction differs,
+     *       the whole program is decompiled again, including the functions
+     *       that did not change.
      */
-    void setContext(const std::shared_ptr<const core::Context> &context);
+    bool isDecompiled(const core::arch::Instructions &instructions) const;
 
     /**
      * Sets the log token.
@@ -153,6 +182,13 @@ class Project: public QObject {
      */
     const LogToken &logToken() const { return logToken_; }
 
+    /**
+     * \return Token telling the analyses running in the contexts of this
+     *         project which code the user is looking at. All the returned
+     *         tokens share the same state.
+     */
+    FocusToken focusToken() const { return focusToken_; }
+
     /*
      * \return Valid pointer to command queue.
      */
@@ -222,6 +258,11 @@ class Project: public QObject {
      */
     void instructionsChanged();
 
+    /**
+     * Signal emitted when a new context has been set.
+     */
+    void contextChanged();
+
     /**
      * Signal emitted when C tree is computed.
      */
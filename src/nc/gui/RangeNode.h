@@ -20,49 +20,173 @@ namespace core { namespace likec {
 
 namespace gui {
 
+/**
+ * Node of a range tree.
+ *
+ * The offset of a node is stored relative to its parent. Shifts of the
+ * offsets of the children caused by edits are accumulated in a Fenwick tree
+ * kept in the parent, so that shifting all the children following a given
+ * one takes logarithmic time in the number of children, and so does
+ * computing the offset of a child.
+ *
+ * Parent pointers are always up to date: when the children of a node are
+ * moved to new storage, only the pointers referring to the moved children
+ * are fixed, so that the range of any node can be computed by walking up
+ * the tree without visiting the rest of it.
+ */
 class RangeNode {
     void *data_;
-    int offset_;
+    int offset_; ///< Offset relative to the parent, not counting the shifts recorded in the parent.
     int size_;
     std::vector<RangeNode> children_;
+    std::vector<int> shifts_; ///< Fenwick tree of shifts of the children's offsets. Empty if there are none.
     RangeNode *parent_;
+    std::size_t index_; ///< Index of this node among the children of its parent.
 
 public:
     RangeNode(void *data, int offset):
-        data_(data), offset_(offset), size_(-1), parent_(nullptr)
+        data_(data), offset_(offset), size_(-1), parent_(nullptr), index_(0)
     {
         assert(offset >= 0);
     }
 
     void *data() const { return data_; }
 
-    int offset() const { return offset_; }
-    void setOffset(int offset) { assert(offset >= 0); offset_ = offset; }
-
     int size() const { assert(size_ >= 0); return size_; }
     void setSize(int size) { assert(size >= 0); size_ = size; }
 
-    int endOffset() const { return offset() + size(); }
+    /**
+     * \return Offset of this node relative to its parent.
+     */
+    int offset() const { return parent_ ? parent_->childOffset(index_) : offset_; }
 
-    Range<int> range() const { return make_range(offset(), endOffset()); }
+    Range<int> range() const { int offset = this->offset(); return make_range(offset, offset + size()); }
 
     std::vector<RangeNode> &children() { return children_; }
     const std::vector<RangeNode> &children() const { return children_; }
 
+    /**
+     * \param index Index of a child.
+     *
+     * \return Offset of the child relative to this node.
+     */
+    int childOffset(std::size_t index) const {
+        assert(index < children_.size());
+        return children_[index].offset_ + getShift(index);
+    }
+
+    int childEndOffset(std::size_t index) const { return childOffset(index) + children_[index].size(); }
+
+    Range<int> childRange(std::size_t index) const {
+        int offset = childOffset(index);
+        return make_range(offset, offset + children_[index].size());
+    }
+
+    /**
+     * \param offset Offset relative to this node.
+     *
+     * \return Index of the first child ending after the given offset,
+     *         or the number of children if there is no such child.
+     */
+    std::size_t getFirstChildNotToTheLeftOf(int offset) const {
+        std::size_t first = 0;
+        std::size_t last = children_.size();
+
+        while (first < last) {
+            std::size_t middle = first + (last - first) / 2;
+            if (childEndOffset(middle) <= offset) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * Sets the offset of a single child.
+     *
+     * \param index Index of the child.
+     * \param offset New offset relative to this node.
+     */
+    void setChildOffset(std::size_t index, int offset) {
+        assert(offset >= 0);
+        children_[index].offset_ += offset - childOffset(index);
+    }
+
+    /**
+     * Shifts the offsets of all the children starting from the given one.
+     *
+     * \param first Index of the first child to shift.
+     * \param delta Value to add to the offsets.
+     */
+    void shiftChildren(std::size_t first, int delta) {
+        if (first >= children_.size() || delta == 0) {
+            return;
+        }
+        if (shifts_.empty()) {
+            shifts_.resize(children_.size() + 1);
+        }
+        for (std::size_t i = first + 1; i < shifts_.size(); i += lowestBit(i)) {
+            shifts_[i] += delta;
+        }
+    }
+
     RangeNode *addChild(RangeNode node) {
-        assert(children_.empty() || children_.back().endOffset() <= node.offset());
+        assert(children_.empty() || childEndOffset(children_.size() - 1) <= node.offset_);
+
+        /* The Fenwick tree has a fixed size: apply the shifts and drop it. */
+        if (!shifts_.empty()) {
+            for (std::size_t i = 0; i < children_.size(); ++i) {
+                children_[i].offset_ += getShift(i);
+            }
+            shifts_.clear();
+        }
+
+        const RangeNode *oldChildren = children_.data();
+
+        node.index_ = children_.size();
         children_.push_back(std::move(node));
+
+        /*
+         * The new child and, if the storage has been reallocated, all the
+         * others have moved: their children must point to the new locations.
+         * The storage is reallocated a logarithmic number of times, so each
+         * grandchild is updated at most that many times.
+         */
+        if (children_.data() != oldChildren) {
+            foreach (auto &child, children_) {
+                child.parent_ = this;
+                child.updateChildrenParentPointers();
+            }
+        } else {
+            children_.back().parent_ = this;
+            children_.back().updateChildrenParentPointers();
+        }
+
         return &children_.back();
     }
 
     const RangeNode *parent() const { return parent_; }
 
-    void updateParentPointers() {
+private:
+    void updateChildrenParentPointers() {
         foreach (auto &child, children_) {
             child.parent_ = this;
-            child.updateParentPointers();
         }
     }
+
+    static std::size_t lowestBit(std::size_t i) { return i & (~i + 1); }
+
+    int getShift(std::size_t index) const {
+        int result = 0;
+        if (!shifts_.empty()) {
+            for (std::size_t i = index + 1; i > 0; i -= lowestBit(i)) {
+                result += shifts_[i];
+            }
+        }
+        return result;
+    }
 };
 
 }} // namespace nc::gui
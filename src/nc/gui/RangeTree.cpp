@@ -15,50 +15,36 @@ void RangeTree::setRoot(std::unique_ptr<RangeNode> root) {
     root_ = std::move(root);
 }
 
-namespace {
-
-std::vector<RangeNode>::iterator getFirstChildNotToTheLeftOf(RangeNode &node, int offset) {
-    return std::lower_bound(node.children().begin(), node.children().end(), offset,
-                            [](const RangeNode &node, int offset) { return node.endOffset() <= offset; });
-}
-
-RangeNode *getChildAtOffset(RangeNode &node, int offset) {
-    auto i = getFirstChildNotToTheLeftOf(node, offset);
-
-    if (i != node.children().end() && i->range().contains(offset)) {
-        return &*i;
-    } else {
-        return nullptr;
-    }
-}
-
-} // anonymous namespace
-
 const RangeNode *RangeTree::getLeafAt(int position) const {
     if (!root_ || !root_->range().contains(position)) {
         return nullptr;
     }
 
-    auto node = root_.get();
-    while (auto child = getChildAtOffset(*node, position)) {
-        node = child;
-        position -= node->offset();
+    const RangeNode *node = root_.get();
+    while (true) {
+        auto i = node->getFirstChildNotToTheLeftOf(position);
+        if (i == node->children().size() || !node->childRange(i).contains(position)) {
+            break;
+        }
+        position -= node->childOffset(i);
+        node = &node->children()[i];
     }
     return node;
 }
 
 namespace {
 
-void doGetNodesIn(RangeNode &node, const Range<int> &range, std::vector<const RangeNode *> &result) {
+void doGetNodesIn(const RangeNode &node, const Range<int> &range, std::vector<const RangeNode *> &result) {
     if (range.start() <= 0 && node.size() <= range.end()) {
         result.push_back(&node);
     }
 
-    auto i = getFirstChildNotToTheLeftOf(node, range.start());
-    auto iend = node.children().end();
-
-    for (; i != iend && i->offset() < range.end(); ++i) {
-        doGetNodesIn(*i, range.shifted(-i->offset()), result);
+    for (auto i = node.getFirstChildNotToTheLeftOf(range.start()), size = node.children().size(); i < size; ++i) {
+        int offset = node.childOffset(i);
+        if (offset >= range.end()) {
+            break;
+        }
+        doGetNodesIn(node.children()[i], range.shifted(-offset), result);
     }
 }
 
@@ -76,11 +62,7 @@ Range<int> RangeTree::getRange(const RangeNode *node) const {
     assert(node != nullptr);
     assert(root_ != nullptr);
 
-    if (node->parent() == nullptr && node != root_.get()) {
-        root_->updateParentPointers();
-        assert(node->parent() != nullptr);
-    }
-
+    /* Only the ancestors of the node are visited. */
     int offset = 0;
     for (auto current = node; current != root_.get(); current = current->parent()) {
         offset += current->offset();
@@ -107,18 +89,22 @@ void doHandleRemoval(RangeNode &node, int offset, int nchars, std::vector<const
     node.setSize(node.size() - nchars);
     modified.push_back(&node);
 
-    auto i = getFirstChildNotToTheLeftOf(node, offset);
+    auto i = node.getFirstChildNotToTheLeftOf(offset);
+    auto size = node.children().size();
 
-    for (auto iend = node.children().end(); i != iend; ++i) {
-        if (i->offset() < offset + nchars) {
-            doHandleRemoval(*i, offset - i->offset(), nchars, modified);
-            if (offset < i->offset()) {
-                i->setOffset(offset);
-            }
-        } else {
-            i->setOffset(i->offset() - nchars);
+    for (; i < size; ++i) {
+        int childOffset = node.childOffset(i);
+        if (childOffset >= offset + nchars) {
+            break;
+        }
+        doHandleRemoval(node.children()[i], offset - childOffset, nchars, modified);
+        if (offset < childOffset) {
+            node.setChildOffset(i, offset);
         }
     }
+
+    /* All the following children move to the left. */
+    node.shiftChildren(i, -nchars);
 }
 
 } // anonymous namespace
@@ -139,17 +125,17 @@ void doHandleInsertion(RangeNode &node, int offset, int nchars, std::vector<cons
     node.setSize(node.size() + nchars);
     modified.push_back(&node);
 
-    auto i = getFirstChildNotToTheLeftOf(node, offset - 1);
+    auto i = node.getFirstChildNotToTheLeftOf(offset - 1);
 
-    if (i != node.children().end()) {
-        if (i->range().contains(offset) || i->endOffset() == offset) {
-            doHandleInsertion(*i, offset - i->offset(), nchars, modified);
+    if (i < node.children().size()) {
+        auto range = node.childRange(i);
+        if (range.contains(offset) || range.end() == offset) {
+            doHandleInsertion(node.children()[i], offset - range.start(), nchars, modified);
             ++i;
         }
 
-        for (auto iend = node.children().end(); i != iend; ++i) {
-            i->setOffset(i->offset() + nchars);
-        }
+        /* All the following children move to the right. */
+        node.shiftChildren(i, nchars);
     }
 }
 
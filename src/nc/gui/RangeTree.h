@@ -27,6 +27,7 @@ public:
     ~RangeTree();
 
     const RangeNode *root() const { return root_.get(); }
+    RangeNode *root() { return root_.get(); }
     void setRoot(std::unique_ptr<RangeNode> root);
 
     const RangeNode *getLeafAt(int position) const;
@@ -37,6 +37,11 @@ class RangeTreeBuilder {
 public:
     RangeTreeBuilder(RangeTree &tree): tree_(tree) {}
 
+    RangeTreeBuilder(RangeTree &tree, RangeNode *parent, int position): tree_(tree) {
+        assert(parent != nullptr);
+        stack_.push(RangeNodeAndPosition(parent, position));
+    }
+
     void onStart(void *data, int position) {
         if (stack_.empty()) {
             auto root = std::make_unique<RangeNode>(data, 0);
@@ -24,19 +24,204 @@
 
 #include "TextEditSearcher.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include <QElapsedTimer>
 #include <QPlainTextEdit>
+#include <QRegExp>
 #include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
 
 namespace nc { namespace gui {
 
+namespace {
+
+/**
+ * Time in milliseconds the GUI thread spends indexing chunks between processing events.
+ */
+const qint64 indexingTimeSlice = 10;
+
+/**
+ * Finds an occurrence of a string in a line of text, the way QTextDocument::find() does.
+ *
+ * \param line         Line of text.
+ * \param expression   Search string.
+ * \param from         Position to start searching from. When searching backward,
+ *                     the occurrence must start before this position.
+ * \param flags        Search flags.
+ *
+ * \return Position of the occurrence in the line, or -1 if there is none.
+ */
+int findInLine(const QString &line, const QString &expression, int from, Searcher::FindFlags flags) {
+    auto sensitivity = (flags & Searcher::FindCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    auto next = [&](int position) -> int {
+        if (flags & Searcher::FindBackward) {
+            return position > 0 ? line.lastIndexOf(expression, position - 1, sensitivity) : -1;
+        } else {
+            return line.indexOf(expression, position, sensitivity);
+        }
+    };
+
+    for (int index = next(from); index != -1; index = next((flags & Searcher::FindBackward) ? index : index + 1)) {
+        int end = index + expression.size();
+
+        if (!(flags & Searcher::FindWholeWords) ||
+            ((index == 0 || !line[index - 1].isLetterOrNumber()) &&
+             (end == line.size() || !line[end].isLetterOrNumber())))
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Finds a nonempty match of a regular expression in a line of text.
+ *
+ * \param line         Line of text.
+ * \param regexp       Regular expression.
+ * \param from         Position to start searching from. When searching backward,
+ *                     the match must start before this position.
+ * \param flags        Search flags.
+ * \param[out] length  Length of the match.
+ *
+ * \return Position of the match in the line, or -1 if there is none.
+ */
+int findInLine(const QString &line, QRegExp &regexp, int from, Searcher::FindFlags flags, int &length) {
+    auto next = [&](int position) -> int {
+        if (flags & Searcher::FindBackward) {
+            return position > 0 ? regexp.lastIndexIn(line, position - 1) : -1;
+        } else {
+            return position <= line.size() ? regexp.indexIn(line, position) : -1;
+        }
+    };
+
+    for (int index = next(from); index != -1; index = next((flags & Searcher::FindBackward) ? index : index + 1)) {
+        length = regexp.matchedLength();
+        if (length > 0) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Skips the characters of a regular expression that follow an escaping
+ * backslash and are a part of the escape sequence.
+ *
+ * \param pattern  Regular expression.
+ * \param i        Index of the character following the backslash.
+ *
+ * \return Index of the last character of the escape sequence.
+ */
+int skipEscapeSequence(const QString &pattern, int i) {
+    int maxDigits = 0;
+    if (pattern[i] == 'x') {
+        maxDigits = 4;
+    } else if (pattern[i].isDigit()) {
+        maxDigits = 3;
+    }
+    for (int j = 0; j < maxDigits && i + 1 < pattern.size() && pattern[i + 1].isLetterOrNumber(); ++j) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * Looks for a string that every match of a regular expression contains:
+ * the longest run of literal characters outside of groups and character
+ * classes, not followed by an optional quantifier.
+ *
+ * \param pattern Regular expression.
+ *
+ * \return The string, or an empty string if there is none or the pattern
+ *         is too complex, e.g. has an alternative at the top level.
+ */
+QString getRequiredLiteral(const QString &pattern) {
+    QString result;
+    QString current;
+    int depth = 0;
+
+    auto endRun = [&]() {
+        if (current.size() > result.size()) {
+            result = current;
+        }
+        current.clear();
+    };
+
+    for (int i = 0, size = pattern.size(); i < size; ++i) {
+        QChar c = pattern[i];
+
+        if (c == '\\') {
+            if (++i == size) {
+                break;
+            }
+            if (pattern[i].isLetterOrNumber()) {
+                /* A character class, an assertion, or a character code. */
+                endRun();
+                i = skipEscapeSequence(pattern, i);
+            } else if (depth == 0) {
+                current += pattern[i];
+            }
+        } else if (c == '|') {
+            if (depth == 0) {
+                return QString();
+            }
+        } else if (c == '(') {
+            endRun();
+            ++depth;
+        } else if (c == ')') {
+            endRun();
+            --depth;
+        } else if (c == '[') {
+            endRun();
+            /* A closing bracket right after the opening one is a character of the class. */
+            if (i + 1 < size && pattern[i + 1] == '^') {
+                ++i;
+            }
+            if (i + 1 < size && pattern[i + 1] == ']') {
+                ++i;
+            }
+            while (++i < size && pattern[i] != ']') {
+                if (pattern[i] == '\\') {
+                    ++i;
+                }
+            }
+        } else if (c == '?' || c == '*' || c == '{') {
+            /* The preceding character is optional. */
+            current.chop(1);
+            endRun();
+            if (c == '{') {
+                while (i + 1 < size && pattern[i] != '}') {
+                    ++i;
+                }
+            }
+        } else if (c == '+' || c == '.' || c == '^' || c == '$') {
+            endRun();
+        } else if (depth == 0) {
+            current += c;
+        }
+    }
+    endRun();
+
+    return result;
+}
+
+} // anonymous namespace
+
 TextEditSearcher::TextEditSearcher(QPlainTextEdit *textEdit):
-    textEdit_(textEdit), hvalue_(-1), vvalue_(-1)
+    textEdit_(textEdit), hvalue_(-1), vvalue_(-1), indexingScheduled_(false)
 {
     assert(textEdit != nullptr);
 }
 
+TextEditSearcher::~TextEditSearcher() {}
+
 void TextEditSearcher::startTrackingViewport() {
     connect(textEdit_, SIGNAL(cursorPositionChanged()), this, SLOT(rememberViewport()));
 }
@@ -62,7 +247,7 @@ void TextEditSearcher::restoreViewport() {
 }
 
 Searcher::FindFlags TextEditSearcher::supportedFlags() const {
-    return FindBackward | FindCaseSensitive | FindWholeWords;
+    return FindBackward | FindCaseSensitive | FindWholeWords | FindRegexp;
 }
 
 bool TextEditSearcher::find(const QString &expression, FindFlags flags) {
@@ -70,27 +255,193 @@ bool TextEditSearcher::find(const QString &expression, FindFlags flags) {
         return true;
     }
 
-    auto options = QTextDocument::FindFlags();
+    Q_EMIT aboutToFind(expression, flags);
 
-    if (flags & FindBackward) {
-        options |= QTextDocument::FindBackward;
-    }
-    if (flags & FindCaseSensitive) {
-        options |= QTextDocument::FindCaseSensitively;
+    auto sensitivity = (flags & FindCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    std::vector<int> hashes;
+    LineMatcher matcher;
+    QRegExp regexp;
+
+    if (flags & FindRegexp) {
+        auto pattern = (flags & FindWholeWords) ? QString("\\b(?:%1)\\b").arg(expression) : expression;
+        regexp = QRegExp(pattern, sensitivity, QRegExp::RegExp2);
+        if (!regexp.isValid()) {
+            return false;
+        }
+
+        /* The index is case-insensitive, so it can skip lines for any sensitivity. */
+        hashes = TrigramIndex::getTrigramHashes(getRequiredLiteral(expression));
+        matcher = [&regexp, flags](const QString &line, int from, int &length) -> int {
+            return findInLine(line, regexp, from, flags, length);
+        };
+    } else {
+        hashes = TrigramIndex::getTrigramHashes(expression);
+        matcher = [&expression, flags](const QString &line, int from, int &length) -> int {
+            length = expression.size();
+            return findInLine(line, expression, from, flags);
+        };
     }
-    if (flags & FindWholeWords) {
-        options |= QTextDocument::FindWholeWords;
+
+    /* Strings shorter than a trigram are searched for line by line. */
+    if (!hashes.empty()) {
+        ensureIndex();
     }
 
-    if (textEdit_->find(expression, options)) {
+    if (findIndexed(hashes, matcher, flags)) {
         return true;
     } else {
         QTextCursor cursor = textEdit_->textCursor();
         cursor.movePosition((flags & FindBackward) ? QTextCursor::End : QTextCursor::Start);
         textEdit_->setTextCursor(cursor);
 
-        return textEdit_->find(expression, options);
+        return findIndexed(hashes, matcher, flags);
+    }
+}
+
+void TextEditSearcher::ensureIndex() {
+    auto document = textEdit_->document();
+
+    if (indexedDocument_ != document) {
+        if (indexedDocument_) {
+            disconnect(indexedDocument_, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
+        }
+
+        indexedDocument_ = document;
+        index_ = TrigramIndex();
+        index_.setLineCount(document->blockCount());
+
+        connect(document, SIGNAL(contentsChange(int, int, int)), this, SLOT(onContentsChange(int, int, int)));
     }
+
+    scheduleIndexing();
+}
+
+void TextEditSearcher::scheduleIndexing() {
+    if (!indexingScheduled_ && index_.findUnindexedChunk(0) < index_.lineCount()) {
+        indexingScheduled_ = true;
+        QMetaObject::invokeMethod(this, "indexChunks", Qt::QueuedConnection);
+    }
+}
+
+void TextEditSearcher::onContentsChange(int position, int charsRemoved, int charsAdded) {
+    Q_UNUSED(charsRemoved)
+
+    if (!indexedDocument_) {
+        return;
+    }
+
+    int firstLine = std::max(indexedDocument_->findBlock(position).blockNumber(), 0);
+
+    if (indexedDocument_->blockCount() != index_.lineCount()) {
+        /* Lines following the changed ones have moved. */
+        index_.setLineCount(indexedDocument_->blockCount());
+        index_.invalidate(firstLine, index_.lineCount() - 1);
+    } else {
+        auto lastBlock = indexedDocument_->findBlock(position + charsAdded);
+        index_.invalidate(firstLine, lastBlock.isValid() ? lastBlock.blockNumber() : index_.lineCount() - 1);
+    }
+
+    scheduleIndexing();
+}
+
+void TextEditSearcher::indexChunks() {
+    indexingScheduled_ = false;
+
+    if (!indexedDocument_) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /* Only the lines of a chunk are copied at once, so that the GUI does not freeze on big documents. */
+    for (int line = index_.findUnindexedChunk(0); line < index_.lineCount();
+         line = index_.findUnindexedChunk(line + TrigramIndex::linesPerChunk))
+    {
+        if (timer.elapsed() >= indexingTimeSlice) {
+            scheduleIndexing();
+            break;
+        }
+
+        QString text;
+        auto block = indexedDocument_->findBlockByNumber(line);
+        for (int i = 0; i < TrigramIndex::linesPerChunk && block.isValid(); ++i, block = block.next()) {
+            if (i > 0) {
+                text += '\n';
+            }
+            text += block.text();
+        }
+
+        index_.indexChunk(line, text);
+    }
+}
+
+bool TextEditSearcher::findIndexed(const std::vector<int> &hashes, const LineMatcher &matcher, FindFlags flags) {
+    auto document = textEdit_->document();
+    auto cursor = textEdit_->textCursor();
+
+    /* The index can be used only if it is the index of this document. */
+    bool useIndex = !hashes.empty() && indexedDocument_ == document;
+
+    const int chunkSize = TrigramIndex::linesPerChunk;
+
+    auto select = [&](const QTextBlock &block, int index, int length) {
+        cursor.setPosition(block.position() + index);
+        cursor.setPosition(block.position() + index + length, QTextCursor::KeepAnchor);
+        textEdit_->setTextCursor(cursor);
+        textEdit_->ensureCursorVisible();
+    };
+
+    if (flags & FindBackward) {
+        auto block = document->findBlock(cursor.selectionStart());
+        int from = cursor.selectionStart() - block.position();
+
+        while (block.isValid()) {
+            int line = block.blockNumber();
+            if (useIndex && !index_.mayContain(line, hashes)) {
+                /* Skip to the last line of the previous chunk. */
+                block = document->findBlockByNumber(line - line % chunkSize - 1);
+                from = block.length() - 1;
+                continue;
+            }
+
+            int length;
+            int index = matcher(block.text(), from, length);
+            if (index != -1) {
+                select(block, index, length);
+                return true;
+            }
+
+            block = block.previous();
+            from = block.length() - 1;
+        }
+    } else {
+        auto block = document->findBlock(cursor.selectionEnd());
+        int from = cursor.selectionEnd() - block.position();
+
+        while (block.isValid()) {
+            int line = block.blockNumber();
+            if (useIndex && !index_.mayContain(line, hashes)) {
+                /* Skip to the first line of the next chunk. */
+                block = document->findBlockByNumber(line - line % chunkSize + chunkSize);
+                from = 0;
+                continue;
+            }
+
+            int length;
+            int index = matcher(block.text(), from, length);
+            if (index != -1) {
+                select(block, index, length);
+                return true;
+            }
+
+            block = block.next();
+            from = 0;
+        }
+    }
+
+    return false;
 }
 
 }} // namespace nc::gui
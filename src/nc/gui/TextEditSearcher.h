@@ -25,19 +25,33 @@
 
 #include <nc/config.h>
 
+#include <functional>
+#include <vector>
+
 #include <QObject>
+#include <QPointer>
 #include <QTextCursor>
 
 #include "Searcher.h"
+#include "TrigramIndex.h"
 
 QT_BEGIN_NAMESPACE
 class QPlainTextEdit;
+class QTextDocument;
 QT_END_NAMESPACE
 
 namespace nc { namespace gui {
 
 /**
  * Search controller for QPlainTextEdit.
+ *
+ * The searcher keeps a trigram index of the text and uses it for skipping
+ * the lines that cannot contain the string being searched for, or the
+ * literal part of a regular expression. The index is built the first time
+ * the document is searched, a few chunks of lines at a time, between
+ * the events processed by the GUI thread. When the document changes, only
+ * the chunks of the changed lines are indexed again. Chunks that are not
+ * indexed yet are searched line by line.
  */
 class TextEditSearcher: public QObject, public Searcher {
     Q_OBJECT
@@ -54,6 +68,15 @@ class TextEditSearcher: public QObject, public Searcher {
     /** Remembered vertical scrollbar position. */
     int vvalue_;
 
+    /** Index of the text of the indexed document. */
+    TrigramIndex index_;
+
+    /** Document whose text is indexed. */
+    QPointer<QTextDocument> indexedDocument_;
+
+    /** Whether indexing of the chunks that are not indexed is scheduled. */
+    bool indexingScheduled_;
+
     public:
 
     /**
@@ -63,6 +86,11 @@ class TextEditSearcher: public QObject, public Searcher {
      */
     explicit TextEditSearcher(QPlainTextEdit *textEdit);
 
+    /**
+     * Destructor.
+     */
+    ~TextEditSearcher();
+
     public Q_SLOTS:
 
     virtual void rememberViewport() override;
@@ -75,6 +103,60 @@ class TextEditSearcher: public QObject, public Searcher {
 
     virtual FindFlags supportedFlags() const override;
     virtual bool find(const QString &expression, FindFlags flags) override;
+
+    Q_SIGNALS:
+
+    /**
+     * Signal emitted before searching the document of the widget.
+     *
+     * \param expression Search string.
+     * \param flags      Search flags.
+     */
+    void aboutToFind(const QString &expression, int flags);
+
+    private Q_SLOTS:
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * Indexes the chunks that are not indexed, for a bounded amount of time,
+     * and schedules indexing of the rest, if any.
+     */
+    void indexChunks();
+
+    private:
+
+    /**
+     * Makes the index track the document of the widget and schedules
+     * indexing of the chunks that are not indexed.
+     */
+    void ensureIndex();
+
+    /**
+     * Schedules indexing of the chunks that are not indexed, if there are any.
+     */
+    void scheduleIndexing();
+
+    /**
+     * Function looking for an occurrence in a line of text.
+     *
+     * Arguments are the line of text, the position to start searching from,
+     * and the variable to store the length of the found occurrence to.
+     * The function returns the position of the occurrence, or -1 if there is none.
+     */
+    typedef std::function<int(const QString &, int, int &)> LineMatcher;
+
+    /**
+     * Finds and selects the next occurrence, using the index.
+     * Does not wrap around the end of the document.
+     *
+     * \param hashes    Trigram hashes of a string that every occurrence contains.
+     * \param matcher   Function looking for an occurrence in a line.
+     * \param flags     Search flags.
+     *
+     * \return True if an occurrence was found, false otherwise.
+     */
+    bool findIndexed(const std::vector<int> &hashes, const LineMatcher &matcher, FindFlags flags);
 };
 
 }} // namespace nc::gui
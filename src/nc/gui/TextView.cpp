@@ -63,7 +63,10 @@ TextView::TextView(const QString &title, QWidget *parent):
     connect(textEdit_->horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateExtraSelections()));
     connect(textEdit_->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateExtraSelections()));
 
-    auto searchWidget = new SearchWidget(std::make_unique<TextEditSearcher>(textEdit_), this);
+    auto searcher = std::make_unique<TextEditSearcher>(textEdit_);
+    connect(searcher.get(), SIGNAL(aboutToFind(const QString &, int)), this, SIGNAL(aboutToFind(const QString &, int)));
+
+    auto searchWidget = new SearchWidget(std::move(searcher), this);
     searchWidget->hide();
 
     GotoLineWidget *gotoLineWidget = new GotoLineWidget(textEdit_, this);
@@ -213,17 +216,23 @@ void TextView::highlight(std::vector<Range<int>> ranges, bool ensureVisible) {
     updateExtraSelections();
 }
 
-void TextView::updateExtraSelections() {
+Range<int> TextView::getVisibleRange() const {
     auto size = textEdit()->viewport()->size();
     auto firstVisiblePosition = textEdit()->cursorForPosition(QPoint(0, 0)).position();
     auto lastVisiblePosition = textEdit()->cursorForPosition(QPoint(size.width() - 1, size.height() - 1)).position();
 
-    auto first = std::lower_bound(highlighting_.begin(), highlighting_.end(), firstVisiblePosition,
+    return make_range(firstVisiblePosition, lastVisiblePosition + 1);
+}
+
+void TextView::updateExtraSelections() {
+    auto visibleRange = getVisibleRange();
+
+    auto first = std::lower_bound(highlighting_.begin(), highlighting_.end(), visibleRange.start(),
                                   [](const Range<int> &range, int pos) { return range.end() < pos; });
 
     QList<QTextEdit::ExtraSelection> selections;
 
-    for (auto i = first; i != highlighting_.end() && i->start() <= lastVisiblePosition; ++i) {
+    for (auto i = first; i != highlighting_.end() && i->start() < visibleRange.end(); ++i) {
         QTextEdit::ExtraSelection selection;
         selection.cursor = textEdit()->textCursor();
         selection.cursor.setPosition(i->start());
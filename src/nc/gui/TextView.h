@@ -69,6 +69,11 @@ public:
      */
     QPlainTextEdit *textEdit() const { return textEdit_; }
 
+    /**
+     * \return Range of positions of the characters visible in the text edit widget.
+     */
+    Range<int> getVisibleRange() const;
+
     /**
      * Sets the document shown in the text edit widget.
      *
@@ -148,6 +153,15 @@ Q_SIGNALS:
      */
     void status(const QString &message = QString());
 
+    /**
+     * This signal is emitted before searching the text document.
+     * Intercept this signal to complete the document before it is searched.
+     *
+     * \param expression Search string.
+     * \param flags      Search flags (see Searcher::FindFlags).
+     */
+    void aboutToFind(const QString &expression, int flags);
+
 private Q_SLOTS:
     /**
      * Updates extra selections in the textView() to show highlighted ranges.
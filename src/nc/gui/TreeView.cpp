@@ -43,25 +43,30 @@
 
 namespace nc { namespace gui {
 
-TreeView::TreeView(const QString &title, QWidget *parent):
+TreeView::TreeView(const QString &title, QWidget *parent, QAbstractItemView *itemView):
     QDockWidget(title, parent)
 {
-    treeView_ = new QTreeView(this);
+    if (itemView) {
+        itemView_ = itemView;
+        treeView_ = qobject_cast<QTreeView *>(itemView);
+    } else {
+        itemView_ = treeView_ = new QTreeView(this);
+    }
 
-    treeView_->setContextMenuPolicy(Qt::CustomContextMenu);
-    treeView_->viewport()->installEventFilter(this);
+    itemView_->setContextMenuPolicy(Qt::CustomContextMenu);
+    itemView_->viewport()->installEventFilter(this);
 
-    connect(treeView_, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(showContextMenu(const QPoint &)));
+    connect(itemView_, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(showContextMenu(const QPoint &)));
     connect(this, SIGNAL(contextMenuCreated(QMenu *)), this, SLOT(populateContextMenu(QMenu *)));
 
-    auto searchWidget = new SearchWidget(std::make_unique<TreeViewSearcher>(treeView_), this);
+    auto searchWidget = new SearchWidget(std::make_unique<TreeViewSearcher>(itemView_), this);
     searchWidget->hide();
 
     QWidget *widget = new QWidget(this);
 
     QVBoxLayout *layout = new QVBoxLayout(widget);
     layout->setContentsMargins(QMargins());
-    layout->addWidget(treeView_);
+    layout->addWidget(itemView_);
     layout->addWidget(searchWidget);
 
     setWidget(widget);
@@ -73,7 +78,7 @@ TreeView::TreeView(const QString &title, QWidget *parent):
     copyAction_ = new QAction(tr("Copy"), this);
     copyAction_->setShortcut(QKeySequence::Copy);
     copyAction_->setShortcutContext(Qt::WidgetWithChildrenShortcut);
-    treeView()->addAction(copyAction_);
+    itemView()->addAction(copyAction_);
 
     connect(copyAction_, SIGNAL(triggered()), this, SLOT(copy()));
 
@@ -101,7 +106,7 @@ TreeView::TreeView(const QString &title, QWidget *parent):
     addAction(closeEverythingAction);
 
     connect(closeEverythingAction, SIGNAL(triggered()), searchWidget, SLOT(deactivate()));
-    connect(closeEverythingAction, SIGNAL(triggered()), treeView_, SLOT(setFocus()));
+    connect(closeEverythingAction, SIGNAL(triggered()), itemView_, SLOT(setFocus()));
 
     selectFontAction_ = new QAction(tr("Select Font..."), this);
     addAction(selectFontAction_);
@@ -115,21 +120,21 @@ void TreeView::showContextMenu(const QPoint &pos) {
     Q_EMIT contextMenuCreated(menu.get());
 
     if (!menu->isEmpty()) {
-        menu->exec(treeView()->viewport()->mapToGlobal(pos));
+        menu->exec(itemView()->viewport()->mapToGlobal(pos));
     }
 }
 
 void TreeView::populateContextMenu(QMenu *menu) {
-    if (!treeView_->selectionModel()) {
+    if (!itemView_->selectionModel()) {
         return;
     }
-    if (!treeView_->selectionModel()->selectedIndexes().isEmpty()) {
+    if (!itemView_->selectionModel()->selectedIndexes().isEmpty()) {
         menu->addSeparator();
         menu->addAction(copyAction_);
     }
 
     menu->addSeparator();
-    menu->addAction(tr("Select All"), treeView(), SLOT(selectAll()), QKeySequence::SelectAll);
+    menu->addAction(tr("Select All"), itemView(), SLOT(selectAll()), QKeySequence::SelectAll);
     menu->addSeparator();
     menu->addAction(openSearchAction_);
     menu->addAction(findNextAction_);
@@ -140,7 +145,7 @@ void TreeView::populateContextMenu(QMenu *menu) {
 }
 
 void TreeView::copy() {
-    auto indexes = treeView()->selectionModel()->selectedIndexes();
+    auto indexes = itemView()->selectionModel()->selectedIndexes();
 
     if (indexes.isEmpty()) {
         return;
@@ -183,11 +188,11 @@ void TreeView::zoomOut(int delta) {
 }
 
 const QFont &TreeView::documentFont() const {
-    return treeView()->font();
+    return itemView()->font();
 }
 
 void TreeView::setDocumentFont(const QFont &font) {
-    treeView()->setFont(font);
+    itemView()->setFont(font);
 }
 
 void TreeView::selectFont() {
@@ -195,7 +200,7 @@ void TreeView::selectFont() {
 }
 
 bool TreeView::eventFilter(QObject *watched, QEvent *event) {
-    if (watched == treeView()->viewport()) {
+    if (watched == itemView()->viewport()) {
         if (event->type() == QEvent::Wheel) {
             auto wheelEvent = static_cast<QWheelEvent *>(event);
 
@@ -30,6 +30,7 @@
 #include <memory>
 
 QT_BEGIN_NAMESPACE
+class QAbstractItemView;
 class QMenu;
 class QTreeView;
 QT_END_NAMESPACE
@@ -42,6 +43,7 @@ namespace nc { namespace gui {
 class TreeView: public QDockWidget {
     Q_OBJECT
 
+    QAbstractItemView *itemView_;
     QTreeView *treeView_;
     QAction *copyAction_;
     QAction *openSearchAction_;
@@ -55,11 +57,17 @@ public:
      *
      * \param[in] title     Title of the widget.
      * \param[in] parent    Parent widget.
+     * \param[in] itemView  Item view to show. If nullptr, a QTreeView is created.
      */
-    explicit TreeView(const QString &title, QWidget *parent = nullptr);
+    explicit TreeView(const QString &title, QWidget *parent = nullptr, QAbstractItemView *itemView = nullptr);
 
     /**
-     * \return Valid pointer to the tree widget.
+     * \return Valid pointer to the item view widget.
+     */
+    QAbstractItemView *itemView() const { return itemView_; }
+
+    /**
+     * \return Pointer to the tree widget, or nullptr if the shown item view is not a tree.
      */
     QTreeView *treeView() const { return treeView_; }
 
@@ -111,7 +119,7 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     /**
-     * Shows a context menu for the child tree widget.
+     * Shows a context menu for the child item view widget.
      *
      * \param pos Position at which the menu is requested.
      */
@@ -26,66 +26,66 @@
 
 #include <cassert>
 
+#include <QAbstractItemView>
 #include <QScrollBar>
-#include <QTreeView>
 
 #include <nc/common/Foreach.h>
 
 namespace nc { namespace gui {
 
-TreeViewSearcher::TreeViewSearcher(QTreeView *treeView):
-    treeView_(treeView), hvalue_(-1), vvalue_(-1)
+TreeViewSearcher::TreeViewSearcher(QAbstractItemView *view):
+    view_(view), hvalue_(-1), vvalue_(-1)
 {
-    assert(treeView != nullptr);
+    assert(view != nullptr);
 }
 
 void TreeViewSearcher::startTrackingViewport() {
-    if (treeView_->selectionModel()) {
-        connect(treeView_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
+    if (view_->selectionModel()) {
+        connect(view_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
                 this, SLOT(rememberViewport()));
     }
 }
 
 void TreeViewSearcher::stopTrackingViewport() {
-    if (treeView_->selectionModel()) {
-        disconnect(treeView_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
+    if (view_->selectionModel()) {
+        disconnect(view_->selectionModel(), SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection &)),
             this, SLOT(rememberViewport()));
     }
 }
 
 void TreeViewSearcher::rememberViewport() {
-    if (!treeView_->selectionModel()) {
+    if (!view_->selectionModel()) {
         hvalue_ = vvalue_ = -1;
         selectedIndexes_.clear();
         currentIndex_ = QModelIndex();
         return;
     }
 
-    selectedIndexes_ = treeView_->selectionModel()->selectedIndexes();
-    currentIndex_ = treeView_->selectionModel()->currentIndex();
-    hvalue_ = treeView_->horizontalScrollBar()->value();
-    vvalue_ = treeView_->verticalScrollBar()->value();
+    selectedIndexes_ = view_->selectionModel()->selectedIndexes();
+    currentIndex_ = view_->selectionModel()->currentIndex();
+    hvalue_ = view_->horizontalScrollBar()->value();
+    vvalue_ = view_->verticalScrollBar()->value();
 }
 
 void TreeViewSearcher::restoreViewport() {
-    if (hvalue_ == -1 || !treeView_->selectionModel()) {
+    if (hvalue_ == -1 || !view_->selectionModel()) {
         return;
     }
 
-    treeView_->setCurrentIndex(currentIndex_);
+    view_->setCurrentIndex(currentIndex_);
 
-    treeView_->selectionModel()->blockSignals(true);
-    treeView_->selectionModel()->clearSelection();
+    view_->selectionModel()->blockSignals(true);
+    view_->selectionModel()->clearSelection();
     foreach (const auto &index, selectedIndexes_) {
-        treeView_->selectionModel()->select(index, QItemSelectionModel::Select);
+        view_->selectionModel()->select(index, QItemSelectionModel::Select);
     }
-    treeView_->selectionModel()->blockSignals(false);
+    view_->selectionModel()->blockSignals(false);
 
     /* Trigger TreeView update. */
-    treeView_->selectionModel()->select(QModelIndex(), QItemSelectionModel::NoUpdate);
+    view_->selectionModel()->select(QModelIndex(), QItemSelectionModel::NoUpdate);
 
-    treeView_->horizontalScrollBar()->setValue(hvalue_);
-    treeView_->verticalScrollBar()->setValue(vvalue_);
+    view_->horizontalScrollBar()->setValue(hvalue_);
+    view_->verticalScrollBar()->setValue(vvalue_);
 }
 
 Searcher::FindFlags TreeViewSearcher::supportedFlags() const {
@@ -201,15 +201,15 @@ bool TreeViewSearcher::find(const QString &expression, FindFlags flags) {
         return true;
     }
 
-    if (treeView_->model() == nullptr) {
+    if (view_->model() == nullptr) {
         return false;
     }
 
-    QModelIndex result = findFirst(treeView_->currentIndex(), expression, flags);
+    QModelIndex result = findFirst(view_->currentIndex(), expression, flags);
 
     if (result.isValid()) {
-        treeView_->setCurrentIndex(result);
-        treeView_->scrollTo(result);
+        view_->setCurrentIndex(result);
+        view_->scrollTo(result);
         return true;
     } else {
         return false;
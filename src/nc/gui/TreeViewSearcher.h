@@ -31,19 +31,19 @@
 #include "Searcher.h"
 
 QT_BEGIN_NAMESPACE
-class QTreeView;
+class QAbstractItemView;
 QT_END_NAMESPACE
 
 namespace nc { namespace gui {
 
 /**
- * Search controller for QTreeView.
+ * Search controller for QTreeView, QListView, and other item views.
  */
 class TreeViewSearcher: public QObject, public Searcher {
     Q_OBJECT
 
     /** Controlled widget. */
-    QTreeView *treeView_;
+    QAbstractItemView *view_;
 
     /** Remembered current index. */
     QModelIndex currentIndex_;
@@ -62,9 +62,9 @@ class TreeViewSearcher: public QObject, public Searcher {
     /**
      * Constructor.
      *
-     * \param treeView Valid pointer to the controlled widget.
+     * \param view Valid pointer to the controlled widget.
      */
-    explicit TreeViewSearcher(QTreeView *treeView);
+    explicit TreeViewSearcher(QAbstractItemView *view);
 
     public Q_SLOTS:
 
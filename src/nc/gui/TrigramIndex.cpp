@@ -0,0 +1,127 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "TrigramIndex.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <nc/common/Foreach.h>
+
+namespace nc { namespace gui {
+
+namespace {
+
+const int wordBits = 64;
+
+/**
+ * \return Hash of the trigram consisting of the given case-folded characters.
+ */
+inline int hashTrigram(ushort a, ushort b, ushort c) {
+    quint64 key = (quint64(a) << 32) | (quint64(b) << 16) | quint64(c);
+    /* Fibonacci hashing: the high bits of the product are well mixed. 4096 == 1 << 12. */
+    return static_cast<int>((key * Q_UINT64_C(0x9E3779B97F4A7C15)) >> (64 - 12));
+}
+
+} // anonymous namespace
+
+TrigramIndex::TrigramIndex():
+    lineCount_(0)
+{
+    static_assert(bitsPerChunk == 1 << 12, "hashTrigram() must produce hashes less than bitsPerChunk");
+}
+
+void TrigramIndex::setLineCount(int lineCount) {
+    assert(lineCount >= 0);
+
+    std::size_t chunkCount = (lineCount + linesPerChunk - 1) / linesPerChunk;
+
+    lineCount_ = lineCount;
+    indexed_.resize(chunkCount, false);
+    bits_.resize(chunkCount * wordsPerChunk);
+}
+
+void TrigramIndex::invalidate(int firstLine, int lastLine) {
+    assert(0 <= firstLine && firstLine <= lastLine);
+
+    for (int chunk = firstLine / linesPerChunk, end = std::min(lastLine / linesPerChunk + 1, static_cast<int>(indexed_.size()));
+         chunk < end; ++chunk)
+    {
+        indexed_[chunk] = false;
+    }
+}
+
+int TrigramIndex::findUnindexedChunk(int line) const {
+    for (int chunk = line / linesPerChunk, size = static_cast<int>(indexed_.size()); chunk < size; ++chunk) {
+        if (!indexed_[chunk]) {
+            return chunk * linesPerChunk;
+        }
+    }
+    return lineCount_;
+}
+
+void TrigramIndex::indexChunk(int line, const QString &text) {
+    assert(0 <= line && line < lineCount_ && line % linesPerChunk == 0);
+
+    int chunkIndex = line / linesPerChunk;
+    quint64 *chunk = &bits_[chunkIndex * wordsPerChunk];
+    std::fill(chunk, chunk + wordsPerChunk, 0);
+
+    ushort a = 0, b = 0;
+    int lineLength = 0;
+
+    for (int i = 0, size = text.size(); i < size; ++i) {
+        QChar character = text[i];
+
+        if (character == '\n') {
+            lineLength = 0;
+            continue;
+        }
+
+        ushort c = character.toCaseFolded().unicode();
+        if (++lineLength >= 3) {
+            int hash = hashTrigram(a, b, c);
+            chunk[hash / wordBits] |= quint64(1) << (hash % wordBits);
+        }
+        a = b;
+        b = c;
+    }
+
+    indexed_[chunkIndex] = true;
+}
+
+std::vector<int> TrigramIndex::getTrigramHashes(const QString &string) {
+    std::vector<int> result;
+
+    if (string.size() >= 3) {
+        result.reserve(string.size() - 2);
+
+        QString folded = string.toCaseFolded();
+        for (int i = 2, size = folded.size(); i < size; ++i) {
+            result.push_back(hashTrigram(folded[i - 2].unicode(), folded[i - 1].unicode(), folded[i].unicode()));
+        }
+    }
+
+    return result;
+}
+
+bool TrigramIndex::mayContain(int line, const std::vector<int> &hashes) const {
+    assert(0 <= line && line < lineCount_);
+
+    if (!indexed_[line / linesPerChunk]) {
+        return true;
+    }
+
+    const quint64 *chunk = &bits_[line / linesPerChunk * wordsPerChunk];
+
+    foreach (int hash, hashes) {
+        if (!(chunk[hash / wordBits] & (quint64(1) << (hash % wordBits)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,111 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <vector>
+
+#include <QString>
+#include <QtGlobal>
+
+namespace nc { namespace gui {
+
+/**
+ * Index of trigrams occurring in the lines of a text.
+ *
+ * Lines are grouped into chunks of a fixed size. For each chunk, the index
+ * stores the set of hashes of the trigrams of its case-folded lines. A chunk
+ * can contain a string only if it contains all the trigrams of the string,
+ * so searches need to look only at a small fraction of the chunks.
+ *
+ * Chunks are indexed one by one, so that the index can be built in small
+ * steps and only the chunks of changed lines have to be indexed again.
+ * Chunks that are not indexed may contain any string.
+ */
+class TrigramIndex {
+public:
+    /** Number of lines in a chunk. */
+    static const int linesPerChunk = 64;
+
+    /**
+     * Constructs an index of an empty text.
+     */
+    TrigramIndex();
+
+    /**
+     * \return Number of lines in the indexed text.
+     */
+    int lineCount() const { return lineCount_; }
+
+    /**
+     * Sets the number of lines in the indexed text. The chunks of the added
+     * lines are not indexed. Chunks of the lines that have changed must be
+     * invalidated separately.
+     *
+     * \param lineCount Number of lines.
+     */
+    void setLineCount(int lineCount);
+
+    /**
+     * Marks the chunks of the given lines as not indexed.
+     *
+     * \param firstLine Number of the first line.
+     * \param lastLine Number of the last line.
+     */
+    void invalidate(int firstLine, int lastLine);
+
+    /**
+     * \param line Number of a line to start looking from.
+     *
+     * \return Number of the first line of the first chunk that is not indexed and
+     *         does not end before the given line, or lineCount() if there is none.
+     */
+    int findUnindexedChunk(int line) const;
+
+    /**
+     * Indexes a chunk.
+     *
+     * \param line Number of the first line of the chunk.
+     * \param text Text of the lines of the chunk, separated by '\n'.
+     */
+    void indexChunk(int line, const QString &text);
+
+    /**
+     * \param string A string.
+     *
+     * \return Hashes of the trigrams of the case-folded string.
+     *         Empty if the string is shorter than a trigram.
+     */
+    static std::vector<int> getTrigramHashes(const QString &string);
+
+    /**
+     * \param line Number of a line.
+     * \param hashes Hashes of the trigrams of a string, as returned by getTrigramHashes().
+     *
+     * \return False if the chunk containing the line is indexed and has no
+     *         occurrences of the string, ignoring the case, true if it may have some.
+     */
+    bool mayContain(int line, const std::vector<int> &hashes) const;
+
+private:
+    /** Number of bits in the set of trigram hashes of a chunk. */
+    static const int bitsPerChunk = 4096;
+
+    /** Number of words in the set of trigram hashes of a chunk. */
+    static const int wordsPerChunk = bitsPerChunk / 64;
+
+    /** Number of lines in the indexed text. */
+    int lineCount_;
+
+    /** Sets of trigram hashes of all chunks, one after another. */
+    std::vector<quint64> bits_;
+
+    /** Flags telling whether the chunks are indexed. */
+    std::vector<bool> indexed_;
+};
+
+}} // namespace nc::gui
+
+/* vim:set et sts=4 sw=4: */
@@ -25,13 +25,18 @@
 #include <nc/config.h>
 
 #include <nc/common/Branding.h>
+#include <nc/common/BufferedLogger.h>
 #include <nc/common/Exception.h>
 #include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
+#include <nc/common/Range.h>
 #include <nc/common/StreamLogger.h>
+#include <nc/common/TextBuffer.h>
 #include <nc/common/Unreachable.h>
 
 #include <nc/core/Context.h>
 #include <nc/core/Driver.h>
+#include <nc/core/Snapshot.h>
 #include <nc/core/arch/Architecture.h>
 #include <nc/core/arch/ArchitectureRepository.h>
 #include <nc/core/arch/Instruction.h>
@@ -47,10 +52,21 @@
 #include <nc/core/ir/Statements.h>
 #include <nc/core/ir/Terms.h>
 #include <nc/core/ir/cflow/Graphs.h>
+#include <nc/core/ir/cgen/DefinitionCache.h>
+#include <nc/core/ir/dflow/Dataflows.h>
+#include <nc/core/ir/ssa/Ssa.h>
+#include <nc/core/ir/ssa/SsaBuilder.h>
+#include <nc/core/likec/CompilationUnit.h>
+#include <nc/core/likec/DeclarationDependencies.h>
+#include <nc/core/likec/FunctionDefinition.h>
 #include <nc/core/likec/Tree.h>
+#include <nc/core/likec/TreePrinter.h>
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QFile>
+#include <QRegExp>
+#include <QSet>
 #include <QStringList>
 #include <QTextStream>
 
@@ -78,6 +94,35 @@ void openFileForWritingAndCall(const QString &filename, T functor) {
     }
 }
 
+template<class T>
+void openFileForWritingAndCallWithBuffer(const QString &filename, T functor) {
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    QFile file;
+    if (filename == "-") {
+        qout.flush();
+        if (!file.open(stdout, QIODevice::WriteOnly)) {
+            throw nc::Exception("could not open stdout for writing");
+        }
+    } else {
+        file.setFileName(filename);
+        if (!file.open(QIODevice::WriteOnly)) {
+            throw nc::Exception("could not open file for writing");
+        }
+    }
+
+    nc::FileTextSink sink(file);
+    {
+        nc::TextBuffer buffer(sink);
+        functor(buffer);
+    }
+    if (sink.failed()) {
+        throw nc::Exception("could not write to file");
+    }
+}
+
 void printSections(nc::core::Context &context, QTextStream &out) {
     foreach (auto section, context.image()->sections()) {
         QString flags;
@@ -130,6 +175,113 @@ void printRegionGraphs(nc::core::Context &context, QTextStream &out) {
     out << "}" << endl;
 }
 
+void printSsa(nc::core::Context &context, QTextStream &out) {
+    foreach (const auto *function, context.functions()->list()) {
+        const auto &dataflow = nc::find(*context.dataflows(), function);
+        if (!dataflow) {
+            continue;
+        }
+
+        nc::core::ir::ssa::Ssa ssa;
+        nc::core::ir::ssa::SsaBuilder(ssa, function, *dataflow, context.cancellationToken()).build();
+
+        out << "function" << function << ':' << endl << ssa;
+    }
+}
+
+void printCxxDirectory(nc::core::Context &context, const QString &dirName) {
+    QDir dir(dirName);
+    if (!dir.mkpath(".")) {
+        throw nc::Exception(QString("could not create directory %1").arg(dirName));
+    }
+
+    const auto &compilationUnit = *context.tree()->root();
+
+    std::vector<const nc::core::likec::FunctionDefinition *> definitions;
+    foreach (auto declaration, compilationUnit.declarations()) {
+        if (auto definition = declaration->as<nc::core::likec::FunctionDefinition>()) {
+            definitions.push_back(definition);
+        }
+    }
+
+    std::vector<QString> fileNames;
+    QSet<QString> usedFileNames;
+
+    foreach (auto definition, definitions) {
+        /*
+         * Replace the characters that are invalid in file names on some
+         * systems, avoid reserved device names, and keep the names reasonably
+         * short. Names are compared ignoring case, as file systems may do so.
+         */
+        QString name = definition->identifier().left(200);
+        for (int i = 0; i < name.size(); ++i) {
+            if (name[i].unicode() < 0x20 || QString("<>:\"/\\|?*").contains(name[i])) {
+                name[i] = '_';
+            }
+        }
+        if (name.isEmpty() || QRegExp("(con|prn|aux|nul|com[1-9]|lpt[1-9])", Qt::CaseInsensitive).exactMatch(name)) {
+            name = '_' + name;
+        }
+
+        QString fileName = name + ".cpp";
+        for (int suffix = 1; usedFileNames.contains(fileName.toLower()); ++suffix) {
+            fileName = QString("%1_%2.cpp").arg(name).arg(suffix);
+        }
+        usedFileNames.insert(fileName.toLower());
+        fileNames.push_back(fileName);
+    }
+
+    nc::core::likec::DeclarationDependencies dependencies(compilationUnit);
+
+    nc::parallelFor(definitions.size(), [&](std::size_t index) {
+        QFile file(dir.filePath(fileNames[index]));
+        if (!file.open(QIODevice::WriteOnly)) {
+            throw nc::Exception(QString("could not open file %1 for writing").arg(file.fileName()));
+        }
+
+        nc::FileTextSink sink(file);
+        {
+            nc::TextBuffer out(sink);
+            nc::core::likec::TreePrinter printer(out);
+
+            foreach (auto dependency, dependencies.getDependencies(definitions[index])) {
+                out << '\n';
+                if (auto definition = dependency->as<nc::core::likec::FunctionDefinition>()) {
+                    printer.printPrototype(definition);
+                } else {
+                    printer.print(dependency);
+                }
+                out << '\n';
+            }
+
+            out << '\n';
+            printer.print(definitions[index]);
+            out << '\n';
+        }
+
+        if (sink.failed()) {
+            throw nc::Exception(QString("could not write to file %1").arg(file.fileName()));
+        }
+    });
+
+    QFile manifest(dir.filePath("manifest.txt"));
+    if (!manifest.open(QIODevice::WriteOnly)) {
+        throw nc::Exception(QString("could not open file %1 for writing").arg(manifest.fileName()));
+    }
+    QTextStream out(&manifest);
+
+    for (std::size_t index = 0; index < definitions.size(); ++index) {
+        const auto *function = context.getFunction(definitions[index]);
+        const auto *entry = function ? function->entry() : nullptr;
+        if (entry && entry->address()) {
+            out << QString("0x%1").arg(*entry->address(), 0, 16);
+        } else {
+            out << "-";
+        }
+        out << '\t' << fileNames[index] << endl;
+    }
+}
+
 void help() {
     auto branding = nc::branding();
     branding.setApplicationName("Nocode");
@@ -145,7 +297,16 @@ void help() {
          << "  --print-cfg[=FILE]          Print control flow graph in DOT language to the file." << endl
          << "  --print-ir[=FILE]           Print intermediate representation in DOT language to the file." << endl
          << "  --print-regions[=FILE]      Print results of structural analysis in DOT language to the file." << endl
+         << "  --print-ssa[=FILE]          Print static single assignment form of registers and stack" << endl
+         << "                              slots of each function to the file." << endl
          << "  --print-cxx[=FILE]          Print reconstructed program into given file." << endl
+         << "  --stream-cxx                Print each function as soon as it is reconstructed." << endl
+         << "  --print-cxx-dir=DIR         Print each function with the declarations it uses into" << endl
+         << "                              a separate file in the directory, and write a manifest" << endl
+         << "                              mapping entry addresses to file names into manifest.txt." << endl
+         << "  --cache-dir=DIR             Take the code of functions that have not changed since" << endl
+         << "                              the previous run from the cache in the directory, and" << endl
+         << "                              store the code of the others there." << endl
          << "  --from[=ADDR]               From disassemble boundary." << endl
          << "  --to[=ADDR]                 To disassemble boundary." << endl
          << endl
@@ -181,12 +342,16 @@ int main(int argc, char *argv[]) {
         QString cfgFile;
         QString irFile;
         QString regionsFile;
+        QString ssaFile;
         QString cxxFile;
+        QString cxxDir;
+        QString cacheDir;
         nc::ByteAddr from_addr = 0;
         nc::ByteAddr to_addr = 0;
 
         bool autoDefault = true;
         bool verbose = false;
+        bool streamCxx = false;
 
         std::vector<nc::ByteAddr> functionAddresses;
         std::vector<nc::ByteAddr> callAddresses;
@@ -202,6 +367,13 @@ int main(int argc, char *argv[]) {
                 return 1;
             } else if (arg == "--verbose" || arg == "-v") {
                 verbose = true;
+            } else if (arg == "--stream-cxx") {
+                streamCxx = true;
+            } else if (arg.startsWith("--print-cxx-dir=")) {
+                cxxDir = arg.section('=', 1);
+                autoDefault = false;
+            } else if (arg.startsWith("--cache-dir=")) {
+                cacheDir = arg.section('=', 1);
 
             #define FILE_OPTION(option, variable)       \
             } else if (arg == option) {                 \
@@ -222,6 +394,7 @@ int main(int argc, char *argv[]) {
             FILE_OPTION("--print-cfg", cfgFile)
             FILE_OPTION("--print-ir", irFile)
             FILE_OPTION("--print-regions", regionsFile)
+            FILE_OPTION("--print-ssa", ssaFile)
             FILE_OPTION("--print-cxx", cxxFile)
             ADDR_OPTION("--from", from_addr)
             ADDR_OPTION("--to", to_addr)
@@ -244,6 +417,15 @@ int main(int argc, char *argv[]) {
             cxxFile = "-";
         }
 
+        if (streamCxx && !cxxDir.isEmpty()) {
+            throw nc::Exception("--stream-cxx cannot be combined with --print-cxx-dir");
+        }
+
+        /* Dependencies of definitions are looked up in their bodies, which cached definitions lack. */
+        if (!cacheDir.isEmpty() && !cxxDir.isEmpty()) {
+            throw nc::Exception("--cache-dir cannot be combined with --print-cxx-dir");
+        }
+
         if (files.empty()) {
             throw nc::Exception("no input files");
         }
@@ -251,7 +433,11 @@ int main(int argc, char *argv[]) {
         nc::core::Context context;
 
         if (verbose) {
-            context.setLogToken(nc::LogToken(std::make_shared<nc::StreamLogger>(qerr)));
+            context.setLogToken(nc::LogToken(std::make_shared<nc::BufferedLogger>(std::make_shared<nc::StreamLogger>(qerr))));
+        }
+
+        if (!cacheDir.isEmpty()) {
+            context.setDefinitionCache(std::make_shared<nc::core::ir::cgen::DefinitionCache>(cacheDir));
         }
 
         foreach (const QString &filename, files) {
@@ -267,7 +453,7 @@ int main(int argc, char *argv[]) {
         openFileForWritingAndCall(sectionsFile, [&](QTextStream &out) { printSections(context, out); });
         openFileForWritingAndCall(symbolsFile, [&](QTextStream &out) { printSymbols(context, out); });
 
-        if (!instructionsFile.isEmpty() || !cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !cxxFile.isEmpty()) {
+        if (!instructionsFile.isEmpty() || !cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !ssaFile.isEmpty() || !cxxFile.isEmpty() || !cxxDir.isEmpty()) {
             if(from_addr && to_addr)
             {
                 foreach (const nc::core::image::Section *section, context.image()->sections())
@@ -279,13 +465,45 @@ int main(int argc, char *argv[]) {
 
             openFileForWritingAndCall(instructionsFile, [&](QTextStream &out) { context.instructions()->print(out); });
 
-            if (!cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !cxxFile.isEmpty()) {
-                nc::core::Driver::decompile(context);
+            /* Code stored in a snapshot can be printed as is, if nothing else is needed from decompilation. */
+            auto snapshotResults = context.snapshotResults();
+            if (snapshotResults && snapshotResults->matches(*context.instructions()) && !cxxFile.isEmpty() &&
+                cfgFile.isEmpty() && irFile.isEmpty() && regionsFile.isEmpty() && ssaFile.isEmpty() && cxxDir.isEmpty())
+            {
+                context.logToken().info(QString("Printing the code stored in the snapshot."));
+                openFileForWritingAndCallWithBuffer(cxxFile, [&](nc::TextBuffer &out) {
+                    /* Same layout as when printing the whole compilation unit. */
+                    for (std::size_t i = 0; i < snapshotResults->declarationCount(); ++i) {
+                        out << '\n' << snapshotResults->getDeclarationText(i) << '\n';
+                    }
+                });
+            } else if (!cfgFile.isEmpty() || !irFile.isEmpty() || !regionsFile.isEmpty() || !ssaFile.isEmpty() || !cxxFile.isEmpty() || !cxxDir.isEmpty()) {
+                if (streamCxx && !cxxFile.isEmpty()) {
+                    openFileForWritingAndCallWithBuffer(cxxFile, [&](nc::TextBuffer &out) {
+                        context.setDeclarationSink([&](const nc::core::likec::Declaration *declaration) {
+                            /* Same layout as when printing the whole compilation unit. */
+                            out << '\n';
+                            nc::core::likec::TreePrinter(out).print(declaration);
+                            out << '\n';
+                            out.flush();
+                        });
+                        nc::core::Driver::decompile(context);
+                        context.setDeclarationSink(nullptr);
+                    });
+                } else {
+                    nc::core::Driver::decompile(context);
+                }
 
                 openFileForWritingAndCall(cfgFile,     [&](QTextStream &out) { context.program()->print(out); });
                 openFileForWritingAndCall(irFile,      [&](QTextStream &out) { context.functions()->print(out); });
                 openFileForWritingAndCall(regionsFile, [&](QTextStream &out) { printRegionGraphs(context, out); });
-                openFileForWritingAndCall(cxxFile,     [&](QTextStream &out) { context.tree()->print(out); });
+                openFileForWritingAndCall(ssaFile,     [&](QTextStream &out) { printSsa(context, out); });
+                if (!streamCxx) {
+                    openFileForWritingAndCallWithBuffer(cxxFile, [&](nc::TextBuffer &out) { context.tree()->print(out); });
+                }
+                if (!cxxDir.isEmpty()) {
+                    printCxxDirectory(context, cxxDir);
+                }
             }
         }
     } catch (const nc::Exception &e) {
@@ -0,0 +1,190 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <QByteArray>
+#include <QString>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/Context.h>
+#include <nc/core/Driver.h>
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Section.h>
+#include <nc/core/likec/CompilationUnit.h>
+#include <nc/core/likec/FunctionDefinition.h>
+#include <nc/core/likec/Tree.h>
+
+namespace {
+
+/** Number of functions called from the entry point. */
+const int functionCount = 20;
+
+const nc::ByteAddr entryAddress = 0x1000;
+const nc::ByteAddr functionsAddress = 0x2000;
+const nc::ByteAddr functionAlignment = 0x40;
+const nc::ByteAddr dataAddress = 0x8000;
+const nc::ByteSize dataSize = 0x1000;
+
+nc::ByteAddr functionAddress(int index) {
+    return functionsAddress + index * functionAlignment;
+}
+
+nc::ByteAddr globalAddress(int index) {
+    return dataAddress + index * 4;
+}
+
+void appendInt32(QByteArray &code, nc::ByteAddr value) {
+    for (int i = 0; i < 4; ++i) {
+        code.append(static_cast<char>((value >> (i * 8)) & 0xff));
+    }
+}
+
+/**
+ * Appends a call instruction to the code starting at the given address.
+ */
+void appendCall(QByteArray &code, nc::ByteAddr codeAddress, nc::ByteAddr target) {
+    code.append('\xe8');
+    appendInt32(code, target - (codeAddress + code.size() + 4));
+}
+
+/**
+ * \return The x86 code of a function that reads two fields of the structure
+ *         passed as its argument and a global variable, writes the sum
+ *         to the next global variable, and passes the structure to the next
+ *         function, if there is one.
+ */
+QByteArray makeFunction(int index) {
+    auto address = functionAddress(index);
+
+    QByteArray code;
+    code.append("\x8b\x44\x24\x04", 4); /* mov eax, [esp+4] */
+    code.append("\x8b\x08", 2);         /* mov ecx, [eax] */
+    code.append("\x03\x48\x04", 3);     /* add ecx, [eax+4] */
+    code.append("\x03\x0d", 2);         /* add ecx, [global] */
+    appendInt32(code, globalAddress(index));
+    code.append("\x89\x0d", 2);         /* mov [next global], ecx */
+    appendInt32(code, globalAddress(index + 1));
+    if (index + 1 < functionCount) {
+        code.append('\x50');            /* push eax */
+        appendCall(code, address, functionAddress(index + 1));
+        code.append("\x83\xc4\x04", 3); /* add esp, 4 */
+    }
+    code.append('\xc3');                /* ret */
+
+    check(code.size() <= static_cast<int>(functionAlignment), "function code is too long");
+    return code;
+}
+
+/**
+ * \return The x86 code of the entry point, calling all the functions
+ *         in the reverse order of their addresses.
+ */
+QByteArray makeEntry() {
+    QByteArray code;
+    for (int index = functionCount - 1; index >= 0; --index) {
+        code.append('\x68');            /* push structure */
+        appendInt32(code, dataAddress + dataSize / 2 + index * 8);
+        appendCall(code, entryAddress, functionAddress(index));
+        code.append("\x83\xc4\x04", 3); /* add esp, 4 */
+    }
+    code.append('\xc3');                /* ret */
+    return code;
+}
+
+/**
+ * Decompiles a synthetic program of several functions sharing global
+ * variables, a structure type, and prototypes of called functions.
+ *
+ * \param threadCount Maximal number of threads in the global thread pool.
+ *
+ * \return The text of the generated program.
+ */
+QString decompile(int threadCount) {
+    auto threadPool = QThreadPool::globalInstance();
+    auto maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(threadCount);
+
+    nc::core::Context context;
+    auto image = context.image();
+
+    image->platform().setArchitecture(QLatin1String("i386"));
+
+    auto entry = std::make_unique<nc::core::image::Section>(".init", entryAddress, 0);
+    auto entryCode = makeEntry();
+    entry->setSize(entryCode.size());
+    entry->setContent(entryCode);
+    entry->setAllocated();
+    entry->setReadable();
+    entry->setExecutable();
+    entry->setCode();
+    image->addSection(std::move(entry));
+
+    QByteArray functionsCode;
+    for (int index = 0; index < functionCount; ++index) {
+        auto code = makeFunction(index);
+        code.append(QByteArray(functionAlignment - code.size(), '\x90'));
+        functionsCode.append(code);
+    }
+
+    auto text = std::make_unique<nc::core::image::Section>(".text", functionsAddress, functionsCode.size());
+    text->setContent(functionsCode);
+    text->setAllocated();
+    text->setReadable();
+    text->setExecutable();
+    text->setCode();
+    image->addSection(std::move(text));
+
+    auto data = std::make_unique<nc::core::image::Section>(".data", dataAddress, dataSize);
+    data->setContent(QByteArray(dataSize, '\0'));
+    data->setAllocated();
+    data->setReadable();
+    data->setWritable();
+    data->setData();
+    image->addSection(std::move(data));
+
+    image->setEntryPoint(entryAddress);
+
+    nc::core::Driver::disassemble(context);
+    nc::core::Driver::decompile(context);
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+
+    check(context.tree() != nullptr, "no tree is generated");
+
+    int definitionCount = 0;
+    foreach (const auto &declaration, context.tree()->root()->declarations()) {
+        if (declaration->as<nc::core::likec::FunctionDefinition>()) {
+            ++definitionCount;
+        }
+    }
+    check(definitionCount > functionCount, QString("only %1 functions are generated").arg(definitionCount));
+
+    QString result;
+    QTextStream out(&result);
+    context.tree()->print(out);
+    out.flush();
+    return result;
+}
+
+} // anonymous namespace
+
+void testCodeGenerator() {
+    auto expected = decompile(1);
+
+    for (int i = 0; i < 10; ++i) {
+        auto text = decompile(std::max(QThread::idealThreadCount(), 4));
+        check(text == expected, QString("parallel code generation gives a different text on run %1:\n%2\ninstead of:\n%3")
+            .arg(i).arg(text).arg(expected));
+    }
+}
+
+/* vim:set et sts=4 sw=4: */
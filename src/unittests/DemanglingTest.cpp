@@ -0,0 +1,129 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
+#include <nc/common/make_unique.h>
+
+#include <nc/core/image/Image.h>
+#include <nc/core/image/Symbol.h>
+#include <nc/core/mangling/Demangler.h>
+
+namespace {
+
+using namespace nc::core;
+
+/**
+ * Demangler counting how many times each name is demangled.
+ */
+class CountingDemangler: public mangling::Demangler {
+    mutable QMutex mutex_;
+    mutable QHash<QString, int> counts_;
+
+public:
+    QString demangle(const QString &symbol) const override {
+        {
+            QMutexLocker locker(&mutex_);
+            ++counts_[symbol];
+        }
+        if (symbol.startsWith("_Z")) {
+            return "demangled " + symbol.mid(2);
+        }
+        return QString();
+    }
+
+    int count(const QString &symbol) const {
+        QMutexLocker locker(&mutex_);
+        return counts_.value(symbol);
+    }
+
+    int total() const {
+        QMutexLocker locker(&mutex_);
+        int result = 0;
+        foreach (int count, counts_) {
+            result += count;
+        }
+        return result;
+    }
+};
+
+QString getName(std::size_t index) {
+    return QString("_Z%1").arg(index);
+}
+
+} // anonymous namespace
+
+void testDemangling() {
+    const std::size_t nameCount = 100;
+
+    image::Image image;
+
+    auto demanglerPointer = std::make_unique<CountingDemangler>();
+    auto demangler = demanglerPointer.get();
+    image.setDemangler(std::move(demanglerPointer));
+
+    /* Every name is given to three symbols, plus a name that cannot be demangled. */
+    for (int repetition = 0; repetition < 3; ++repetition) {
+        for (std::size_t i = 0; i < nameCount; ++i) {
+            image.addSymbol(std::make_unique<image::Symbol>(image::SymbolType::FUNCTION, getName(i), boost::none));
+        }
+        image.addSymbol(std::make_unique<image::Symbol>(image::SymbolType::OBJECT, "plain", boost::none));
+    }
+
+    auto threadPool = QThreadPool::globalInstance();
+    auto maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(std::max(QThread::idealThreadCount(), 4));
+
+    /* Bulk demangling demangles each distinct name once. */
+    image.demangleSymbols();
+    for (std::size_t i = 0; i < nameCount; ++i) {
+        check(demangler->count(getName(i)) == 1, QString("%1 is demangled %2 times").arg(getName(i))
+            .arg(demangler->count(getName(i))));
+    }
+    check(demangler->count("plain") == 1, "a name that cannot be demangled is not demangled once");
+
+    image.demangleSymbols();
+    check(demangler->total() == static_cast<int>(nameCount) + 1, "repeated bulk demangling demangles again");
+
+    /* Cached names are looked up concurrently without calling the demangler. */
+    nc::parallelFor(nameCount * 10, [&](std::size_t index) {
+        auto name = getName(index % nameCount);
+        check(image.demangle(name) == "demangled " + name.mid(2), QString("wrong demangled name for %1").arg(name));
+    });
+    check(image.demangle("plain").isNull(), "a name that cannot be demangled is demangled");
+    check(demangler->total() == static_cast<int>(nameCount) + 1, "cached names are demangled again");
+
+    /* Names that are not cached are demangled on demand and cached. */
+    nc::parallelFor(nameCount, [&](std::size_t index) {
+        auto name = getName(nameCount + index);
+        check(image.demangle(name) == "demangled " + name.mid(2), QString("wrong demangled name for %1").arg(name));
+    });
+    for (std::size_t i = 0; i < nameCount; ++i) {
+        image.demangle(getName(nameCount + i));
+    }
+    for (std::size_t i = 0; i < nameCount; ++i) {
+        check(demangler->count(getName(nameCount + i)) == 1, QString("%1 is not cached").arg(getName(nameCount + i)));
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+
+    /* A new demangler starts with an empty cache. */
+    auto newDemanglerPointer = std::make_unique<CountingDemangler>();
+    auto newDemangler = newDemanglerPointer.get();
+    image.setDemangler(std::move(newDemanglerPointer));
+
+    check(image.demangle(getName(0)) == "demangled 0", "wrong demangled name after changing the demangler");
+    check(newDemangler->count(getName(0)) == 1, "the cache is not cleared when changing the demangler");
+}
+
+/* vim:set et sts=4 sw=4: */
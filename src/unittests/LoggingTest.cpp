@@ -0,0 +1,187 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <nc/common/BufferedLogger.h>
+#include <nc/common/LogToken.h>
+#include <nc/common/ParallelFor.h>
+#include <nc/common/StreamLogger.h>
+
+namespace {
+
+/**
+ * Logger remembering the texts of the messages it got.
+ */
+class RecordingLogger: public nc::Logger {
+    mutable QMutex mutex_;
+    nc::LogLevel minLevel_;
+    QStringList texts_;
+
+public:
+    explicit RecordingLogger(nc::LogLevel minLevel): minLevel_(minLevel) {}
+
+    void log(nc::LogLevel level, const QString &text) override {
+        QMutexLocker locker(&mutex_);
+        check(level >= minLevel_, "a message with a disabled level is logged");
+        texts_.push_back(text);
+    }
+
+    bool isEnabled(nc::LogLevel level) const override { return level >= minLevel_; }
+
+    QStringList texts() const {
+        QMutexLocker locker(&mutex_);
+        return texts_;
+    }
+};
+
+QString getText(std::size_t task, std::size_t message) {
+    return QString("task %1 message %2").arg(task).arg(message);
+}
+
+/**
+ * Checks that all the messages of all the tasks are logged, and the
+ * messages of each task are logged in order.
+ */
+void checkTaskMessages(const QStringList &texts, std::size_t taskCount, std::size_t messageCount, const char *what) {
+    check(static_cast<std::size_t>(texts.size()) == taskCount * messageCount, QString("%1: %2 messages instead of %3")
+        .arg(what).arg(texts.size()).arg(taskCount * messageCount));
+
+    for (std::size_t task = 0; task < taskCount; ++task) {
+        int lastPosition = -1;
+        for (std::size_t message = 0; message < messageCount; ++message) {
+            int position = texts.indexOf(getText(task, message));
+            check(position > lastPosition, QString("%1: message %2 of task %3 is lost or reordered")
+                .arg(what).arg(message).arg(task));
+            lastPosition = position;
+        }
+    }
+}
+
+void testLazyLogging() {
+    nc::LogToken silent;
+    check(!silent.isEnabled(nc::LogLevel::ERROR), "a default token logs errors");
+
+    bool computed = false;
+    silent.logLazily(nc::LogLevel::ERROR, [&]() { computed = true; return QString(); });
+    check(!computed, "a default token computes the text of a message");
+
+    QString output;
+    QTextStream stream(&output);
+    nc::LogToken token(std::make_shared<nc::StreamLogger>(stream, nc::LogLevel::WARNING));
+
+    check(!token.isEnabled(nc::LogLevel::INFO) && token.isEnabled(nc::LogLevel::WARNING),
+        "levels are filtered wrongly");
+
+    token.logLazily(nc::LogLevel::DEBUG, [&]() { computed = true; return QString("debug text"); });
+    check(!computed, "the text of a filtered out message is computed");
+
+    token.info("info text");
+    token.logLazily(nc::LogLevel::WARNING, [&]() { computed = true; return QString("warning text"); });
+    token.flush();
+
+    check(computed, "the text of a logged message is not computed");
+    check(output.contains("warning text"), "a message is not logged");
+    check(!output.contains("debug text") && !output.contains("info text"), "a filtered out message is logged");
+}
+
+void testBufferedLogging() {
+    const std::size_t taskCount = 64;
+    const std::size_t messageCount = 100;
+
+    auto threadPool = QThreadPool::globalInstance();
+    auto maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(std::max(QThread::idealThreadCount(), 4));
+
+    /* Messages reach the underlying logger in order when flushed. */
+    {
+        auto recorder = std::make_shared<RecordingLogger>(nc::LogLevel::INFO);
+        auto logger = std::make_shared<nc::BufferedLogger>(recorder, 16);
+        nc::LogToken token(logger);
+
+        check(!token.isEnabled(nc::LogLevel::DEBUG) && token.isEnabled(nc::LogLevel::INFO),
+            "levels of the underlying logger are ignored");
+
+        nc::parallelFor(taskCount, [&](std::size_t task) {
+            for (std::size_t message = 0; message < messageCount; ++message) {
+                token.info(getText(task, message));
+                token.debug("debug text");
+            }
+        });
+        token.flush();
+
+        checkTaskMessages(recorder->texts(), taskCount, messageCount, "flushed");
+    }
+
+    /* Warnings reach the underlying logger at once, after the messages logged before them. */
+    {
+        auto recorder = std::make_shared<RecordingLogger>(nc::LogLevel::INFO);
+        nc::LogToken token(std::make_shared<nc::BufferedLogger>(recorder));
+
+        nc::parallelFor(taskCount, [&](std::size_t task) {
+            token.info(getText(task, 0));
+            token.warning(getText(task, 1));
+
+            auto texts = recorder->texts();
+            auto infoPosition = texts.indexOf(getText(task, 0));
+            check(infoPosition >= 0 && texts.indexOf(getText(task, 1)) > infoPosition,
+                QString("warning of task %1 is not logged at once").arg(task));
+        });
+
+        checkTaskMessages(recorder->texts(), taskCount, 2, "warnings");
+    }
+
+    /* The thread that created the logger logs at once, after the messages buffered before. */
+    {
+        auto recorder = std::make_shared<RecordingLogger>(nc::LogLevel::INFO);
+        nc::LogToken token(std::make_shared<nc::BufferedLogger>(recorder));
+
+        nc::parallelFor(taskCount, [&](std::size_t task) {
+            token.info(getText(task, 0));
+        });
+        token.info("owner text");
+
+        auto texts = recorder->texts();
+        check(texts.size() == static_cast<int>(taskCount) + 1 && texts.back() == "owner text",
+            "messages of the owner thread are not logged at once after the buffered ones");
+    }
+
+    /* Destroying the logger flushes the buffers. */
+    {
+        auto recorder = std::make_shared<RecordingLogger>(nc::LogLevel::INFO);
+        {
+            nc::LogToken token(std::make_shared<nc::BufferedLogger>(recorder));
+
+            nc::parallelFor(taskCount, [&](std::size_t task) {
+                for (std::size_t message = 0; message < messageCount; ++message) {
+                    token.info(getText(task, message));
+                }
+            });
+        }
+
+        checkTaskMessages(recorder->texts(), taskCount, messageCount, "destroyed");
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+} // anonymous namespace
+
+void testLogging() {
+    testLazyLogging();
+    testBufferedLogging();
+}
+
+/* vim:set et sts=4 sw=4: */
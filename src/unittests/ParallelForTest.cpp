@@ -0,0 +1,139 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <nc/common/Exception.h>
+#include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
+
+namespace {
+
+/**
+ * Records the calls made by parallelFor.
+ */
+class Calls {
+    QMutex mutex_;
+    std::vector<std::size_t> indices_;
+    std::size_t running_;
+    bool otherThreads_;
+
+public:
+    Calls(): running_(0), otherThreads_(false) {}
+
+    void enter(std::size_t index) {
+        QMutexLocker locker(&mutex_);
+        indices_.push_back(index);
+        ++running_;
+        if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+            otherThreads_ = true;
+        }
+    }
+
+    void leave() {
+        QMutexLocker locker(&mutex_);
+        --running_;
+    }
+
+    const std::vector<std::size_t> &indices() const { return indices_; }
+    std::size_t running() const { return running_; }
+    bool otherThreads() const { return otherThreads_; }
+};
+
+/**
+ * Checks that every index is processed exactly once.
+ */
+void checkAllOnce(const std::vector<std::size_t> &indices, std::size_t size, const char *what) {
+    check(indices.size() == size, QString("%1: %2 calls instead of %3").arg(what).arg(indices.size()).arg(size));
+
+    std::vector<bool> seen(size);
+    foreach (auto index, indices) {
+        check(index < size && !seen[index], QString("%1: index %2 is processed twice or is out of range")
+            .arg(what).arg(index));
+        seen[index] = true;
+    }
+}
+
+/**
+ * Runs parallelFor over the given number of indices, throwing from the
+ * call for the index failingIndex, if it is less than size.
+ *
+ * \return True if parallelFor has thrown the exception.
+ */
+bool run(Calls &calls, std::size_t size, std::size_t failingIndex) {
+    try {
+        nc::parallelFor(size, [&](std::size_t index) {
+            calls.enter(index);
+            if (index == failingIndex) {
+                calls.leave();
+                throw nc::Exception(QString::number(index));
+            }
+            QThread::yieldCurrentThread();
+            calls.leave();
+        });
+    } catch (const nc::Exception &e) {
+        check(e.unicodeWhat() == QString::number(failingIndex), "wrong exception is rethrown");
+        return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+void testParallelFor() {
+    const std::size_t size = 1000;
+    const std::size_t failingIndex = 100;
+
+    auto threadPool = QThreadPool::globalInstance();
+    auto maxThreadCount = threadPool->maxThreadCount();
+
+    /* With a single thread, parallelFor calls the function sequentially in the calling thread. */
+    threadPool->setMaxThreadCount(1);
+    {
+        Calls calls;
+        check(!run(calls, size, size), "sequential: an exception is thrown");
+        check(!calls.otherThreads(), "sequential: the function is called in another thread");
+
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < size; ++i) {
+            expected.push_back(i);
+        }
+        check(calls.indices() == expected, "sequential: indices are not processed in the increasing order");
+    }
+    {
+        Calls calls;
+        check(run(calls, size, failingIndex), "sequential: the exception is not rethrown");
+        check(calls.indices().size() == failingIndex + 1, "sequential: indices after the failing one are processed");
+    }
+
+    threadPool->setMaxThreadCount(std::max(maxThreadCount, 4));
+    {
+        Calls calls;
+        check(!run(calls, size, size), "parallel: an exception is thrown");
+        checkAllOnce(calls.indices(), size, "parallel");
+        check(calls.running() == 0, "parallel: returned before all calls have finished");
+    }
+    {
+        Calls calls;
+        check(run(calls, size, failingIndex), "parallel: the exception is not rethrown");
+        check(calls.running() == 0, "parallel: the exception is rethrown before all calls have finished");
+    }
+    {
+        Calls calls;
+        check(!run(calls, 0, size), "parallel: an exception is thrown for no indices");
+        check(calls.indices().empty(), "parallel: the function is called for no indices");
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+/* vim:set et sts=4 sw=4: */
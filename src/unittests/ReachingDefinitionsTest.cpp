@@ -0,0 +1,157 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <nc/common/Foreach.h>
+
+#include <nc/core/ir/MemoryDomain.h>
+#include <nc/core/ir/MemoryLocation.h>
+#include <nc/core/ir/Terms.h>
+#include <nc/core/ir/dflow/ReachingDefinitions.h>
+
+namespace {
+
+using namespace nc::core::ir;
+using nc::core::ir::dflow::ReachingDefinitions;
+
+typedef std::vector<std::pair<MemoryLocation, std::vector<const Term *>>> Expected;
+
+/**
+ * Checks that the reaching definitions consist of the given chunks, in the
+ * given order, both when iterated over and when accessed via size(), front(),
+ * and back() of their chunk range.
+ */
+void checkChunks(const ReachingDefinitions &definitions, const Expected &expected, const char *what) {
+    auto chunks = definitions.chunks();
+
+    check(chunks.size() == expected.size(), QString("%1: %2 chunks instead of %3")
+        .arg(what).arg(chunks.size()).arg(expected.size()));
+    check(chunks.empty() == expected.empty(), QString("%1: wrong emptiness").arg(what));
+
+    std::size_t i = 0;
+    foreach (const auto &chunk, chunks) {
+        check(i < expected.size(), QString("%1: too many chunks").arg(what));
+        check(chunk.location() == expected[i].first, QString("%1: wrong location of chunk %2").arg(what).arg(i));
+        check(chunk.definitions() == expected[i].second, QString("%1: wrong definitions in chunk %2").arg(what).arg(i));
+        ++i;
+    }
+    check(i == expected.size(), QString("%1: too few chunks").arg(what));
+
+    if (!expected.empty()) {
+        check(chunks.front().location() == expected.front().first, QString("%1: wrong front()").arg(what));
+        check(chunks.back().location() == expected.back().first, QString("%1: wrong back()").arg(what));
+    }
+}
+
+std::vector<const Term *> terms(const Term *a) {
+    return std::vector<const Term *>(1, a);
+}
+
+std::vector<const Term *> terms(const Term *a, const Term *b) {
+    std::vector<const Term *> result;
+    result.push_back(a);
+    result.push_back(b);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // anonymous namespace
+
+void testReachingDefinitions() {
+    const Constant t1(nc::SizedValue(32, 1));
+    const Constant t2(nc::SizedValue(32, 2));
+    const Constant t3(nc::SizedValue(32, 3));
+
+    const MemoryLocation stack(MemoryDomain::STACK, 0, 32);
+    const MemoryLocation eax(MemoryDomain::FIRST_REGISTER, 0, 32);
+    const MemoryLocation al(MemoryDomain::FIRST_REGISTER, 0, 8);
+    const MemoryLocation ah(MemoryDomain::FIRST_REGISTER, 8, 8);
+    const MemoryLocation eaxHigh(MemoryDomain::FIRST_REGISTER, 16, 16);
+    const MemoryLocation ebx(MemoryDomain::FIRST_REGISTER + 3, 0, 32);
+    const MemoryLocation user(MemoryDomain::USER, 64, 32);
+
+    ReachingDefinitions a;
+    checkChunks(a, Expected(), "empty");
+
+    /* Chunks of all domains come in the order of memory locations. */
+    a.addDefinition(user, &t1);
+    a.addDefinition(ebx, &t1);
+    a.addDefinition(stack, &t1);
+    a.addDefinition(eax, &t2);
+    checkChunks(a, Expected{{stack, terms(&t1)}, {eax, terms(&t2)}, {ebx, terms(&t1)}, {user, terms(&t1)}},
+        "definitions in all domains");
+
+    /* Killing the middle of a definition leaves its ends. */
+    auto b = a;
+    b.killDefinitions(ah);
+    checkChunks(b, Expected{{stack, terms(&t1)}, {al, terms(&t2)}, {eaxHigh, terms(&t2)}, {ebx, terms(&t1)},
+        {user, terms(&t1)}}, "killed a part of a register");
+    checkChunks(a, Expected{{stack, terms(&t1)}, {eax, terms(&t2)}, {ebx, terms(&t1)}, {user, terms(&t1)}},
+        "copy after killing in another copy");
+
+    /* A new definition replaces the overlapping ones. */
+    b.addDefinition(eax, &t3);
+    b.killDefinitions(stack);
+    b.killDefinitions(user);
+    checkChunks(b, Expected{{eax, terms(&t3)}, {ebx, terms(&t1)}}, "redefined a register");
+
+    /* Merging unites the definitions of the same locations. */
+    auto c = a;
+    c.merge(b);
+    checkChunks(c, Expected{{stack, terms(&t1)}, {eax, terms(&t2, &t3)}, {ebx, terms(&t1)}, {user, terms(&t1)}},
+        "merged");
+    check(c != a && c != b, "merged definitions compare equal to a merged one");
+
+    /* Merging is idempotent and commutative. */
+    auto d = c;
+    d.merge(b);
+    d.merge(a);
+    check(d == c, "merging the same definitions twice changes them");
+
+    auto e = b;
+    e.merge(a);
+    check(e == c, "merging depends on the order of arguments");
+
+    /* Merging into an empty object gives a copy. */
+    ReachingDefinitions f;
+    f.merge(a);
+    check(f == a, "merging into empty definitions gives different definitions");
+
+    /* Definitions sharing their storage with a merged copy are not changed by the copy's updates. */
+    f.addDefinition(ebx, &t3);
+    f.killDefinitions(al);
+    f.killDefinitions(MemoryLocation(MemoryDomain::FIRST_REGISTER, 24, 8));
+    checkChunks(f, Expected{{stack, terms(&t1)}, {MemoryLocation(MemoryDomain::FIRST_REGISTER, 8, 16), terms(&t2)},
+        {ebx, terms(&t3)}, {user, terms(&t1)}}, "updated a merged copy");
+    checkChunks(a, Expected{{stack, terms(&t1)}, {eax, terms(&t2)}, {ebx, terms(&t1)}, {user, terms(&t1)}},
+        "merged copy after updating it");
+
+    /* Killing all register definitions leaves the others. */
+    f.killDefinitions(eax);
+    f.killDefinitions(ebx);
+    checkChunks(f, Expected{{stack, terms(&t1)}, {user, terms(&t1)}}, "killed all registers");
+
+    /* Projection cuts the definitions of a part of a register. */
+    ReachingDefinitions g;
+    c.project(ah, g);
+    checkChunks(g, Expected{{ah, terms(&t2, &t3)}}, "projected");
+    c.project(ah, g);
+    checkChunks(g, Expected{{ah, terms(&t2, &t3)}}, "projected again");
+    c.project(MemoryLocation(MemoryDomain::FIRST_REGISTER + 1, 0, 32), g);
+    checkChunks(g, Expected(), "projected onto an undefined register");
+
+    /* Filtering removes single terms and the chunks left without terms. */
+    c.filterOut([&](const MemoryLocation &, const Term *term) { return term == &t1; });
+    checkChunks(c, Expected{{eax, terms(&t2, &t3)}}, "filtered");
+
+    c.clear();
+    checkChunks(c, Expected(), "cleared");
+    check(c != a, "cleared definitions compare equal to nonempty ones");
+}
+
+/* vim:set et sts=4 sw=4: */
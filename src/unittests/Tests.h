@@ -0,0 +1,68 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#pragma once
+
+#include <nc/config.h>
+
+#include <QString>
+
+/*
+ * Each test checks a property of one component and throws nc::Exception
+ * describing the first violated check.
+ */
+
+/**
+ * Throws nc::Exception with the given message if the condition is false.
+ *
+ * \param condition Checked condition.
+ * \param what Description of the violated property.
+ */
+void check(bool condition, const QString &what);
+
+/**
+ * Decompiles a synthetic program whose functions share declarations using
+ * one thread and then several threads, and checks that the generated texts
+ * are the same, i.e. the definitions generated in parallel and the shared
+ * declarations they use are added to the compilation unit in the same order.
+ */
+void testCodeGenerator();
+
+/**
+ * Checks that the image demangles each distinct name of its symbols once
+ * in bulk, answers repeated and concurrent queries from its cache, caches
+ * names demangled on demand, and clears the cache when the demangler changes.
+ */
+void testDemangling();
+
+/**
+ * Checks that log tokens filter messages by level and compute their texts
+ * only when they are logged, and that the buffered logger passes all the
+ * messages logged by several threads in order, warnings and messages of
+ * its owner thread at once, and flushes the buffers when destroyed.
+ */
+void testLogging();
+
+/**
+ * Checks that parallelFor calls the function for every index once, calls
+ * it sequentially in the calling thread when the thread pool has a single
+ * thread, and rethrows the exception thrown by the function after all
+ * running calls have finished.
+ */
+void testParallelFor();
+
+/**
+ * Checks adding, killing, projecting, and merging reaching definitions
+ * in register and non-register domains, the order of the chunks, and that
+ * updating definitions does not change the copies sharing storage with them.
+ */
+void testReachingDefinitions();
+
+/**
+ * Interns types of all kinds in a type table from several threads at once
+ * and checks that all threads get the same types, different keys give
+ * different types, and the types have the requested properties.
+ */
+void testTypeTable();
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,116 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include "Tests.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <nc/common/Foreach.h>
+#include <nc/common/ParallelFor.h>
+
+#include <nc/core/likec/TypeTable.h>
+#include <nc/core/likec/Types.h>
+
+namespace {
+
+using namespace nc::core::likec;
+
+typedef std::function<const Type *()> TypeMaker;
+
+/**
+ * \return Functors interning types of all kinds in the table, including
+ *         pointers and arrays of types interned by other functors.
+ */
+std::vector<TypeMaker> getTypeMakers(TypeTable &table) {
+    std::vector<TypeMaker> result;
+
+    const nc::SmallBitSize integerSizes[] = {8, 16, 32, 64};
+    const nc::SmallBitSize pointerSizes[] = {32, 64};
+    const bool signednesses[] = {false, true};
+    const nc::SmallBitSize floatSizes[] = {32, 64, 80};
+
+    foreach (auto size, integerSizes) {
+        foreach (bool isUnsigned, signednesses) {
+            result.push_back([&table, size, isUnsigned]() -> const Type * {
+                return table.makeIntegerType(size, isUnsigned);
+            });
+            foreach (auto pointerSize, pointerSizes) {
+                result.push_back([&table, size, isUnsigned, pointerSize]() -> const Type * {
+                    return table.makePointerType(pointerSize,
+                        table.makePointerType(pointerSize, table.makeIntegerType(size, isUnsigned)));
+                });
+            }
+            for (std::size_t length = 1; length <= 8; ++length) {
+                result.push_back([&table, size, isUnsigned, length]() -> const Type * {
+                    return table.makeArrayType(size * length, table.makeIntegerType(size, isUnsigned), length);
+                });
+            }
+        }
+    }
+
+    foreach (auto size, floatSizes) {
+        result.push_back([&table, size]() -> const Type * {
+            return table.makeFloatType(size);
+        });
+    }
+
+    return result;
+}
+
+} // anonymous namespace
+
+void testTypeTable() {
+    const std::size_t taskCount = 64;
+
+    TypeTable table;
+    auto makers = getTypeMakers(table);
+
+    auto threadPool = QThreadPool::globalInstance();
+    auto maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(std::max(QThread::idealThreadCount(), 4));
+
+    /* Every task interns all the types, starting from a different one, so that tasks race for the same keys. */
+    std::vector<std::vector<const Type *>> results(taskCount, std::vector<const Type *>(makers.size()));
+
+    nc::parallelFor(taskCount, [&](std::size_t task) {
+        for (std::size_t i = 0; i < makers.size(); ++i) {
+            auto index = (i + task * 7) % makers.size();
+            results[task][index] = makers[index]();
+        }
+    });
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+
+    for (std::size_t task = 1; task < taskCount; ++task) {
+        check(results[task] == results[0], QString("task %1 got different types than task 0").arg(task));
+    }
+
+    auto types = results[0];
+    std::sort(types.begin(), types.end());
+    check(std::adjacent_find(types.begin(), types.end()) == types.end(), "different keys give the same type");
+    check(std::find(types.begin(), types.end(), nullptr) == types.end(), "a type is not created");
+
+    /* Interned types have the requested properties. */
+    auto integer = table.makeIntegerType(16, true);
+    check(integer->size() == 16 && integer->isUnsigned(), "wrong integer type");
+    check(table.makeIntegerType(16, false) != integer && table.makeIntegerType(16, false)->isSigned(),
+        "signedness is not a part of the key");
+
+    auto pointer = table.makePointerType(64, integer);
+    check(pointer->size() == 64 && pointer->pointeeType() == integer, "wrong pointer type");
+    check(table.makePointerType(32, integer) != pointer, "size of a pointer is not a part of the key");
+
+    auto array = table.makeArrayType(16 * 3, integer, 3);
+    check(array->size() == 16 * 3 && array->elementType() == integer && array->length() == 3, "wrong array type");
+    check(table.makeArrayType(16 * 3, integer, 3) == array, "array type is not interned");
+
+    auto floatType = table.makeFloatType(80);
+    check(floatType->size() == 80 && floatType->isFloat(), "wrong float type");
+}
+
+/* vim:set et sts=4 sw=4: */
@@ -0,0 +1,78 @@
+/* The file is part of Snowman decompiler. */
+/* See doc/licenses.asciidoc for the licensing information. */
+
+#include <nc/config.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include <nc/common/Exception.h>
+
+#include "Tests.h"
+
+const char *self = "unittests";
+
+QTextStream qout(stdout, QIODevice::WriteOnly);
+QTextStream qerr(stderr, QIODevice::WriteOnly);
+
+void check(bool condition, const QString &what) {
+    if (!condition) {
+        throw nc::Exception(what);
+    }
+}
+
+void help() {
+    qout << "Usage: " << self << " test" << endl
+         << endl
+         << "Tests:" << endl
+         << "  code-generator              Generating the same code for a synthetic program" << endl
+         << "                              using one and several threads." << endl
+         << "  demangling                  Caching demangled names of symbols." << endl
+         << "  logging                     Lazy and buffered logging." << endl
+         << "  parallel-for                Calling a function for a range of indices in" << endl
+         << "                              parallel." << endl
+         << "  reaching-definitions        Adding, killing, projecting, and merging reaching" << endl
+         << "                              definitions." << endl
+         << "  type-table                  Interning LikeC types from several threads." << endl
+         << endl
+         << "The exit code is nonzero if the test fails." << endl;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    try {
+        auto args = QCoreApplication::arguments();
+
+        if (args.size() != 2 || args[1] == "--help" || args[1] == "-h") {
+            help();
+            return 1;
+        }
+
+        auto test = args[1];
+
+        if (test == "code-generator") {
+            testCodeGenerator();
+        } else if (test == "demangling") {
+            testDemangling();
+        } else if (test == "logging") {
+            testLogging();
+        } else if (test == "parallel-for") {
+            testParallelFor();
+        } else if (test == "reaching-definitions") {
+            testReachingDefinitions();
+        } else if (test == "type-table") {
+            testTypeTable();
+        } else {
+            throw nc::Exception(QString("unknown test: %1").arg(test));
+        }
+    } catch (const nc::Exception &e) {
+        qerr << self << ": " << e.unicodeWhat() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* vim:set et sts=4 sw=4: */